@@ -35,6 +35,12 @@ typedef unsigned short int uint16;
 typedef unsigned int uint32;
 typedef unsigned long long uint64;
 
+
+// Declared in template_db/file_blocks_index.h
+template< class TIndex >
+struct File_Block_Index_Fixed_Size;
+
+
 struct Uint32_Index
 {
   typedef uint32 Id_Type;
@@ -101,6 +107,13 @@ struct Uint32_Index
 };
 
 
+template< >
+struct File_Block_Index_Fixed_Size< Uint32_Index >
+{
+  static uint32 value() { return 4; }
+};
+
+
 inline Uint32_Index inc(Uint32_Index idx)
 {
   return Uint32_Index(idx.val() + 1);
@@ -136,6 +149,13 @@ struct Uint31_Index : Uint32_Index
 };
 
 
+template< >
+struct File_Block_Index_Fixed_Size< Uint31_Index >
+{
+  static uint32 value() { return 4; }
+};
+
+
 inline Uint31_Index inc(Uint31_Index idx)
 {
   if (idx.val() & 0x80000000)
@@ -218,6 +238,63 @@ struct Quad_Coord
 };
 
 
+/** Varint coding for the compact skeleton formats: seven bits per byte, least significant first,
+    the high bit set on all but the last byte. Signed deltas are zigzag encoded first. */
+
+inline uint64 zigzag_encode(int64 value)
+{
+  return (uint64(value)<<1) ^ uint64(value>>63);
+}
+
+
+inline int64 zigzag_decode(uint64 value)
+{
+  return int64(value>>1) ^ -int64(value & 1);
+}
+
+
+inline uint32 varint_size(uint64 value)
+{
+  uint32 size = 1;
+  while (value >= 0x80)
+  {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+
+inline uint8* write_varint(uint8* ptr, uint64 value)
+{
+  while (value >= 0x80)
+  {
+    *ptr++ = uint8(value | 0x80);
+    value >>= 7;
+  }
+  *ptr++ = uint8(value);
+  return ptr;
+}
+
+
+inline uint64 read_varint(const uint8*& ptr)
+{
+  // Most deltas fit into a single byte
+  uint64 byte = *ptr++;
+  if (byte < 0x80)
+    return byte;
+
+  uint64 result = byte & 0x7f;
+  for (uint32 shift = 7; ; shift += 7)
+  {
+    byte = *ptr++;
+    result |= (byte & 0x7f)<<shift;
+    if (byte < 0x80)
+      return result;
+  }
+}
+
+
 template< typename Element_Skeleton >
 struct Attic : public Element_Skeleton
 {
@@ -23,6 +23,7 @@
 #include "../../template_db/file_blocks_index.h"
 #include "../../template_db/random_file_index.h"
 
+#include <cerrno>
 #include <cstdio>
 #include <fstream>
 #include <map>
@@ -50,6 +51,7 @@ struct OSM_File_Properties : public File_Properties
   uint32 get_block_size() const { return block_size/8; }
   uint32 get_compression_factor() const { return 8; }
   uint32 get_compression_method() const { return basic_settings().compression_method; }
+  int get_compression_level() const { return basic_settings().compression_level; }
   uint32 get_map_block_size() const { return map_block_size/8; }
   uint32 get_map_compression_factor() const { return 8; }
   uint32 get_map_compression_method() const { return basic_settings().map_compression_method; }
@@ -103,7 +105,11 @@ Basic_Settings::Basic_Settings()
 #else
   compression_method(File_Blocks_Index< Uint31_Index >::ZLIB_COMPRESSION),
 #endif
-  map_compression_method(File_Blocks_Index< Uint31_Index >::NO_COMPRESSION)
+  map_compression_method(File_Blocks_Index< Uint31_Index >::NO_COMPRESSION),
+  compression_level(0),
+  reverse_refs(false),
+  attic_keyframe_interval(32),
+  attic_keyframe_size(16*1024)
 {}
 
 Basic_Settings& basic_settings()
@@ -142,6 +148,15 @@ Osm_Base_Settings::Osm_Base_Settings()
   RELATION_KEYS(new OSM_File_Properties< Uint32_Index >
       ("relation_keys", 512*1024, 0)),
 
+  NODE_WAYS(new OSM_File_Properties< Node::Id_Type >
+      ("node_ways", 128*1024, 0)),
+  NODE_RELATIONS(new OSM_File_Properties< Node::Id_Type >
+      ("node_relations", 128*1024, 0)),
+  WAY_RELATIONS(new OSM_File_Properties< Way::Id_Type >
+      ("way_relations", 128*1024, 0)),
+  RELATION_RELATIONS(new OSM_File_Properties< Relation::Id_Type >
+      ("relation_relations", 128*1024, 0)),
+
   shared_name(basic_settings().shared_name_base + "_osm_base"),
   max_num_processes(20),
   purge_timeout(900),
@@ -257,9 +272,18 @@ Attic_Settings::Attic_Settings()
   RELATIONS_META(new OSM_File_Properties< Uint31_Index >
       ("relations_meta_attic", 128*1024, 0)),
   RELATION_CHANGELOG(new OSM_File_Properties< Timestamp >
-      ("relation_changelog", 128*1024, 0))
+      ("relation_changelog", 128*1024, 0)),
+
+  NODE_WAYS(new OSM_File_Properties< Node::Id_Type >
+      ("node_ways_attic", 128*1024, 0)),
+  NODE_RELATIONS(new OSM_File_Properties< Node::Id_Type >
+      ("node_relations_attic", 128*1024, 0)),
+  WAY_RELATIONS(new OSM_File_Properties< Way::Id_Type >
+      ("way_relations_attic", 128*1024, 0)),
+  RELATION_RELATIONS(new OSM_File_Properties< Relation::Id_Type >
+      ("relation_relations_attic", 128*1024, 0))
 {
-  idxs_.reserve(21);
+  idxs_.reserve(25);
   idxs_.push_back(NODES);
   idxs_.push_back(NODES_UNDELETED);
   idxs_.push_back(NODE_IDX_LIST);
@@ -281,6 +305,10 @@ Attic_Settings::Attic_Settings()
   idxs_.push_back(RELATION_TAGS_GLOBAL);
   idxs_.push_back(RELATIONS_META);
   idxs_.push_back(RELATION_CHANGELOG);
+  idxs_.push_back(NODE_WAYS);
+  idxs_.push_back(NODE_RELATIONS);
+  idxs_.push_back(WAY_RELATIONS);
+  idxs_.push_back(RELATION_RELATIONS);
 }
 
 
@@ -314,6 +342,60 @@ void show_mem_status()
 
 //-----------------------------------------------------------------------------
 
+bool file_present(const std::string& db_dir, const File_Properties& file_prop)
+{
+  return file_exists(db_dir + file_prop.get_file_name_trunk() + file_prop.get_data_suffix()
+      + file_prop.get_index_suffix());
+}
+
+
+bool reverse_refs_complete(const std::string& db_dir)
+{
+  return file_exists(db_dir + "reverse_refs_complete");
+}
+
+
+void mark_reverse_refs_complete(const std::string& db_dir)
+{
+  std::ofstream marker((db_dir + "reverse_refs_complete").c_str());
+  if (!marker)
+    throw File_Error(errno, db_dir + "reverse_refs_complete", "mark_reverse_refs_complete:1");
+}
+
+//-----------------------------------------------------------------------------
+
+int compression_method_from_name(const std::string& name)
+{
+  if (name == "no")
+    return File_Blocks_Index_Base::NO_COMPRESSION;
+  else if (name == "gz")
+    return File_Blocks_Index_Base::ZLIB_COMPRESSION;
+#ifdef HAVE_LZ4
+  else if (name == "lz4")
+    return File_Blocks_Index_Base::LZ4_COMPRESSION;
+#endif
+#ifdef HAVE_ZSTD
+  else if (name == "zstd")
+    return File_Blocks_Index_Base::ZSTD_COMPRESSION;
+#endif
+  return File_Blocks_Index_Base::USE_DEFAULT;
+}
+
+
+std::string compression_method_names()
+{
+  return "(no|gz"
+#ifdef HAVE_LZ4
+      "|lz4"
+#endif
+#ifdef HAVE_ZSTD
+      "|zstd"
+#endif
+      ")";
+}
+
+//-----------------------------------------------------------------------------
+
 Logger::Logger(const std::string& db_dir)
   : logfile_full_name(db_dir + basic_settings().logfile_name) {}
 
@@ -41,6 +41,15 @@ struct Basic_Settings
 
   uint32 compression_method;
   uint32 map_compression_method;
+  // Zero selects the default level of the compression method
+  int compression_level;
+  // Create the reverse reference files in a new database.
+  // Reverse reference files of a database marked by mark_reverse_refs_complete are always kept up to date.
+  bool reverse_refs;
+  // Store an attic delta in full after this many relative deltas or bytes of relative deltas
+  // of the same object. An interval of zero disables keyframes.
+  uint32 attic_keyframe_interval;
+  uint32 attic_keyframe_size;
 
   Basic_Settings();
 };
@@ -61,6 +70,11 @@ struct Osm_Base_Settings
   File_Properties* RELATION_TAGS_LOCAL;
   File_Properties* RELATION_TAGS_GLOBAL;
   File_Properties* RELATION_KEYS;
+  // Optional reverse references from each member to the ways or relations that contain it
+  File_Properties* NODE_WAYS;
+  File_Properties* NODE_RELATIONS;
+  File_Properties* WAY_RELATIONS;
+  File_Properties* RELATION_RELATIONS;
 
   std::string shared_name;
   uint max_num_processes;
@@ -129,6 +143,11 @@ struct Attic_Settings
   File_Properties* RELATION_TAGS_GLOBAL;
   File_Properties* RELATIONS_META;
   File_Properties* RELATION_CHANGELOG;
+  // References that have been removed from the current reverse references, with the time of their removal
+  File_Properties* NODE_WAYS;
+  File_Properties* NODE_RELATIONS;
+  File_Properties* WAY_RELATIONS;
+  File_Properties* RELATION_RELATIONS;
 
   Attic_Settings();
 
@@ -143,10 +162,15 @@ struct Clone_Settings
 {
   uint32 compression_method;
   uint32 map_compression_method;
+  int compression_level;
+  // Train a dictionary for each bin file compressed with zstd
+  bool compression_dictionary;
 
   Clone_Settings()
       : compression_method(File_Blocks_Index_Base::USE_DEFAULT),
-      map_compression_method(File_Blocks_Index_Base::USE_DEFAULT) {}
+      map_compression_method(File_Blocks_Index_Base::USE_DEFAULT),
+      compression_level(File_Blocks_Index_Base::USE_DEFAULT),
+      compression_dictionary(false) {}
 };
 
 
@@ -158,6 +182,19 @@ const Attic_Settings& attic_settings();
 
 void show_mem_status();
 
+// True if the optional file has been created in the database in db_dir
+bool file_present(const std::string& db_dir, const File_Properties& file_prop);
+
+// True if the reverse reference files in db_dir have been maintained since the database has been created.
+// Only then do they contain every reference.
+bool reverse_refs_complete(const std::string& db_dir);
+void mark_reverse_refs_complete(const std::string& db_dir);
+
+// Returns File_Blocks_Index_Base::USE_DEFAULT if the name is not known or not compiled in
+int compression_method_from_name(const std::string& name);
+// The names accepted by compression_method_from_name, e.g. "(no|gz|lz4)"
+std::string compression_method_names();
+
 
 class Logger
 {
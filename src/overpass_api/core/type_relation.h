@@ -100,6 +100,11 @@ struct Relation_Equal_Id {
 struct Relation_Delta;
 
 
+/** Relation_Skeleton is stored in a compact format: the id, the marker 0xffffffff in place of the
+    number of members, and the total size in bytes. Then follow as varints the numbers of members,
+    node_idxs and way_idxs, for each member the role and type combined and the zigzag encoded delta
+    to the previous member of the same type, and the deltas between consecutive node_idxs and way_idxs.
+    The total size is padded to four bytes. The original format with raw entries is still read. */
 struct Relation_Skeleton
 {
   typedef Relation::Id_Type Id_Type;
@@ -110,12 +115,34 @@ struct Relation_Skeleton
   std::vector< Uint31_Index > node_idxs;
   std::vector< Uint31_Index > way_idxs;
 
+  static const uint32 COMPACT_FORMAT = 0xffffffff;
+
   Relation_Skeleton() : id(0u) {}
 
   Relation_Skeleton(Relation::Id_Type id_) : id(id_) {}
 
   Relation_Skeleton(void* data) : id(*(Id_Type*)data)
   {
+    if (*((uint32*)data + 1) == COMPACT_FORMAT)
+    {
+      const uint8* ptr = (uint8*)data + 12;
+      members.resize(read_varint(ptr));
+      node_idxs.resize(read_varint(ptr), 0u);
+      way_idxs.resize(read_varint(ptr), 0u);
+      uint64 refs[4] = { 0, 0, 0, 0 };
+      for (std::vector< Relation_Entry >::iterator it = members.begin(); it != members.end(); ++it)
+      {
+        uint64 role_type = read_varint(ptr);
+        it->type = role_type & 0x3;
+        it->role = role_type>>2;
+        refs[it->type] += zigzag_decode(read_varint(ptr));
+        it->ref = refs[it->type];
+      }
+      read_idxs(ptr, node_idxs);
+      read_idxs(ptr, way_idxs);
+      return;
+    }
+
     members.resize(*((uint32*)data + 1));
     node_idxs.resize(*((uint32*)data + 2), 0u);
     way_idxs.resize(*((uint32*)data + 3), 0u);
@@ -143,11 +170,20 @@ struct Relation_Skeleton
 
   uint32 size_of() const
   {
-    return 16 + 12*members.size() + 4*node_idxs.size() + 4*way_idxs.size();
+    uint32 size = 12 + varint_size(members.size()) + varint_size(node_idxs.size()) + varint_size(way_idxs.size());
+    uint64 refs[4] = { 0, 0, 0, 0 };
+    for (std::vector< Relation_Entry >::const_iterator it = members.begin(); it != members.end(); ++it)
+    {
+      size += varint_size(role_type(*it)) + varint_size(zigzag_encode(it->ref.val() - refs[it->type & 0x3]));
+      refs[it->type & 0x3] = it->ref.val();
+    }
+    return (size + idxs_size(node_idxs) + idxs_size(way_idxs) + 3) & ~3u;
   }
 
   static uint32 size_of(void* data)
   {
+    if (*((uint32*)data + 1) == COMPACT_FORMAT)
+      return *((uint32*)data + 2);
     return 16 + 12 * *((uint32*)data + 1) + 4* *((uint32*)data + 2) + 4* *((uint32*)data + 3);
   }
 
@@ -158,22 +194,25 @@ struct Relation_Skeleton
 
   void to_data(void* data) const
   {
+    uint32 size = size_of();
     *(Id_Type*)data = id.val();
-    *((uint32*)data + 1) = members.size();
-    *((uint32*)data + 2) = node_idxs.size();
-    *((uint32*)data + 3) = way_idxs.size();
-    for (uint i = 0; i < members.size(); ++i)
+    *((uint32*)data + 1) = COMPACT_FORMAT;
+    *((uint32*)data + 2) = size;
+
+    uint8* ptr = write_varint((uint8*)data + 12, members.size());
+    ptr = write_varint(ptr, node_idxs.size());
+    ptr = write_varint(ptr, way_idxs.size());
+    uint64 refs[4] = { 0, 0, 0, 0 };
+    for (std::vector< Relation_Entry >::const_iterator it = members.begin(); it != members.end(); ++it)
     {
-      *(uint64*)((uint32*)data + 4 + 3*i) = members[i].ref.val();
-      *((uint32*)data + 6 + 3*i) = members[i].role & 0xffffff;
-      *((uint8*)data + 27 + 12*i) = members[i].type;
+      ptr = write_varint(ptr, role_type(*it));
+      ptr = write_varint(ptr, zigzag_encode(it->ref.val() - refs[it->type & 0x3]));
+      refs[it->type & 0x3] = it->ref.val();
     }
-    Uint31_Index* start_ptr = (Uint31_Index*)data + 4 + 3*members.size();
-    for (uint i = 0; i < node_idxs.size(); ++i)
-      *(start_ptr + i) = node_idxs[i];
-    start_ptr = (Uint31_Index*)data + 4 + 3*members.size() + node_idxs.size();
-    for (uint i = 0; i < way_idxs.size(); ++i)
-      *(start_ptr + i) = way_idxs[i];
+    ptr = write_idxs(ptr, node_idxs);
+    ptr = write_idxs(ptr, way_idxs);
+    while (ptr < (uint8*)data + size)
+      *ptr++ = 0;
   }
 
   bool operator<(const Relation_Skeleton& a) const
@@ -185,6 +224,130 @@ struct Relation_Skeleton
   {
     return this->id == a.id;
   }
+
+private:
+  static uint64 role_type(const Relation_Entry& entry)
+  {
+    return (uint64(entry.role & 0xffffff)<<2) | (entry.type & 0x3);
+  }
+
+  static uint32 idxs_size(const std::vector< Uint31_Index >& idxs)
+  {
+    uint32 size = 0;
+    int64 last = 0;
+    for (std::vector< Uint31_Index >::const_iterator it = idxs.begin(); it != idxs.end(); ++it)
+    {
+      size += varint_size(zigzag_encode(it->val() - last));
+      last = it->val();
+    }
+    return size;
+  }
+
+  static uint8* write_idxs(uint8* ptr, const std::vector< Uint31_Index >& idxs)
+  {
+    int64 last = 0;
+    for (std::vector< Uint31_Index >::const_iterator it = idxs.begin(); it != idxs.end(); ++it)
+    {
+      ptr = write_varint(ptr, zigzag_encode(it->val() - last));
+      last = it->val();
+    }
+    return ptr;
+  }
+
+  static void read_idxs(const uint8*& ptr, std::vector< Uint31_Index >& idxs)
+  {
+    int64 last = 0;
+    for (std::vector< Uint31_Index >::iterator it = idxs.begin(); it != idxs.end(); ++it)
+    {
+      last += zigzag_decode(read_varint(ptr));
+      *it = Uint31_Index(uint32(last));
+    }
+  }
+};
+
+
+/** Reads the id and the members of a stored Relation_Skeleton or Attic< Relation_Skeleton > in place,
+    without decoding it into vectors. The view does not own the data and is only valid as long as
+    the buffer it points into. */
+class Relation_Skeleton_View
+{
+public:
+  Relation_Skeleton_View(const void* data_) : data((const uint8*)data_) {}
+
+  class Member_Iterator
+  {
+  public:
+    Member_Iterator(const uint8* ptr_, uint32 remaining_, bool compact_)
+        : ptr(ptr_), remaining(remaining_), compact(compact_)
+    {
+      refs[0] = refs[1] = refs[2] = refs[3] = 0;
+      if (remaining > 0)
+        read();
+    }
+
+    bool is_end() const { return remaining == 0; }
+    const Relation_Entry& operator*() const { return entry; }
+    const Relation_Entry* operator->() const { return &entry; }
+
+    Member_Iterator& operator++()
+    {
+      if (--remaining > 0)
+        read();
+      return *this;
+    }
+
+  private:
+    const uint8* ptr;
+    uint32 remaining;
+    bool compact;
+    uint64 refs[4];
+    Relation_Entry entry;
+
+    void read()
+    {
+      if (compact)
+      {
+        uint64 role_type = read_varint(ptr);
+        entry.type = role_type & 0x3;
+        entry.role = role_type>>2;
+        refs[entry.type] += zigzag_decode(read_varint(ptr));
+        entry.ref = refs[entry.type];
+      }
+      else
+      {
+        entry.ref = *(const uint64*)ptr;
+        entry.role = *(const uint32*)(ptr + 8) & 0xffffff;
+        entry.type = *(ptr + 11);
+        ptr += 12;
+      }
+    }
+  };
+
+  Relation_Skeleton::Id_Type id() const { return *(const uint32*)data; }
+
+  uint32 members_size() const
+  {
+    if (!is_compact())
+      return *((const uint32*)data + 1);
+    const uint8* ptr = data + 12;
+    return read_varint(ptr);
+  }
+
+  Member_Iterator members_begin() const
+  {
+    if (!is_compact())
+      return Member_Iterator(data + 16, *((const uint32*)data + 1), false);
+    const uint8* ptr = data + 12;
+    uint32 size = read_varint(ptr);
+    read_varint(ptr);
+    read_varint(ptr);
+    return Member_Iterator(ptr, size, true);
+  }
+
+private:
+  const uint8* data;
+
+  bool is_compact() const { return *((const uint32*)data + 1) == Relation_Skeleton::COMPACT_FORMAT; }
 };
 
 
@@ -279,6 +279,33 @@ struct Tag_Index_Global
 };
 
 
+/** Compares the key and value of a stored Tag_Index_Global in place, without copying them into strings.
+    The view does not own the data and is only valid as long as the buffer it points into. */
+class Tag_Index_Global_View
+{
+public:
+  Tag_Index_Global_View(const void* data_) : data((const uint8*)data_) {}
+
+  bool key_equals(const std::string& key) const
+  {
+    return key.size() == key_size() && memcmp(data + 4, key.data(), key.size()) == 0;
+  }
+
+  bool value_equals(const std::string& value) const
+  {
+    return value.size() == value_size() && memcmp(data + 4 + key_size(), value.data(), value.size()) == 0;
+  }
+
+  std::string key() const { return std::string((const char*)data + 4, key_size()); }
+
+private:
+  const uint8* data;
+
+  uint32 key_size() const { return *(const uint16*)data; }
+  uint32 value_size() const { return *((const uint16*)data + 1); }
+};
+
+
 template< typename Id_Type_ >
 struct Tag_Object_Global
 {
@@ -83,6 +83,11 @@ struct Way_Equal_Id {
 struct Way_Delta;
 
 
+/** Way_Skeleton is stored in a compact format: the id, the marker 0xffff in place of the number of
+    node refs, two bytes zero, and the total size in bytes. Then follow as varints the number of refs,
+    the number of coordinates, the zigzag encoded deltas between consecutive refs, and the deltas of
+    ll_upper and ll_lower between consecutive coordinates. The total size is padded to four bytes.
+    The original format with raw refs and coordinates is still read. */
 struct Way_Skeleton
 {
   typedef Way::Id_Type Id_Type;
@@ -92,12 +97,37 @@ struct Way_Skeleton
   std::vector< Node::Id_Type > nds;
   std::vector< Quad_Coord > geometry;
 
+  static const uint16 COMPACT_FORMAT = 0xffff;
+
   Way_Skeleton() : id(0u) {}
 
   Way_Skeleton(Way::Id_Type id_) : id(id_) {}
 
   Way_Skeleton(void* data) : id(*(Id_Type*)data)
   {
+    if (*((uint16*)data + 2) == COMPACT_FORMAT)
+    {
+      const uint8* ptr = (uint8*)data + 12;
+      nds.resize(read_varint(ptr));
+      geometry.resize(read_varint(ptr));
+      uint64 ref = 0;
+      for (std::vector< Node::Id_Type >::iterator it = nds.begin(); it != nds.end(); ++it)
+      {
+        ref += zigzag_decode(read_varint(ptr));
+        *it = ref;
+      }
+      int64 ll_upper = 0;
+      int64 ll_lower = 0;
+      for (std::vector< Quad_Coord >::iterator it = geometry.begin(); it != geometry.end(); ++it)
+      {
+        ll_upper += zigzag_decode(read_varint(ptr));
+        ll_lower += zigzag_decode(read_varint(ptr));
+        it->ll_upper = ll_upper;
+        it->ll_lower = ll_lower;
+      }
+      return;
+    }
+
     nds.reserve(*((uint16*)data + 2));
     for (int i(0); i < *((uint16*)data + 2); ++i)
       nds.push_back(*(uint64*)((uint16*)data + 4 + 4*i));
@@ -115,11 +145,29 @@ struct Way_Skeleton
 
   uint32 size_of() const
   {
-    return 8 + 8*nds.size() + 8*geometry.size();
+    uint32 size = 12 + varint_size(nds.size()) + varint_size(geometry.size());
+    uint64 ref = 0;
+    for (std::vector< Node::Id_Type >::const_iterator it = nds.begin(); it != nds.end(); ++it)
+    {
+      size += varint_size(zigzag_encode(it->val() - ref));
+      ref = it->val();
+    }
+    int64 ll_upper = 0;
+    int64 ll_lower = 0;
+    for (std::vector< Quad_Coord >::const_iterator it = geometry.begin(); it != geometry.end(); ++it)
+    {
+      size += varint_size(zigzag_encode(it->ll_upper - ll_upper))
+          + varint_size(zigzag_encode(it->ll_lower - ll_lower));
+      ll_upper = it->ll_upper;
+      ll_lower = it->ll_lower;
+    }
+    return (size + 3) & ~3u;
   }
 
   static uint32 size_of(void* data)
   {
+    if (*((uint16*)data + 2) == COMPACT_FORMAT)
+      return *((uint32*)data + 2);
     return (8 + 8 * *((uint16*)data + 2) + 8 * *((uint16*)data + 3));
   }
 
@@ -130,17 +178,31 @@ struct Way_Skeleton
 
   void to_data(void* data) const
   {
+    uint32 size = size_of();
     *(Id_Type*)data = id.val();
-    *((uint16*)data + 2) = nds.size();
-    *((uint16*)data + 3) = geometry.size();
-    for (uint i(0); i < nds.size(); ++i)
-      *(uint64*)((uint16*)data + 4 + 4*i) = nds[i].val();
-    uint16* start_ptr = (uint16*)data + 4 + 4*nds.size();
-    for (uint i(0); i < geometry.size(); ++i)
+    *((uint16*)data + 2) = COMPACT_FORMAT;
+    *((uint16*)data + 3) = 0;
+    *((uint32*)data + 2) = size;
+
+    uint8* ptr = write_varint((uint8*)data + 12, nds.size());
+    ptr = write_varint(ptr, geometry.size());
+    uint64 ref = 0;
+    for (std::vector< Node::Id_Type >::const_iterator it = nds.begin(); it != nds.end(); ++it)
     {
-      *(uint32*)(start_ptr + 4*i) = geometry[i].ll_upper;
-      *(uint32*)(start_ptr + 4*i + 2) = geometry[i].ll_lower;
+      ptr = write_varint(ptr, zigzag_encode(it->val() - ref));
+      ref = it->val();
     }
+    int64 ll_upper = 0;
+    int64 ll_lower = 0;
+    for (std::vector< Quad_Coord >::const_iterator it = geometry.begin(); it != geometry.end(); ++it)
+    {
+      ptr = write_varint(ptr, zigzag_encode(it->ll_upper - ll_upper));
+      ptr = write_varint(ptr, zigzag_encode(it->ll_lower - ll_lower));
+      ll_upper = it->ll_upper;
+      ll_lower = it->ll_lower;
+    }
+    while (ptr < (uint8*)data + size)
+      *ptr++ = 0;
   }
 
   bool operator<(const Way_Skeleton& a) const
@@ -155,6 +217,96 @@ struct Way_Skeleton
 };
 
 
+/** Reads the id and the node refs of a stored Way_Skeleton or Attic< Way_Skeleton > in place,
+    without decoding it into vectors. The view does not own the data and is only valid as long as
+    the buffer it points into. */
+class Way_Skeleton_View
+{
+public:
+  Way_Skeleton_View(const void* data_) : data((const uint8*)data_) {}
+
+  class Nd_Iterator
+  {
+  public:
+    Nd_Iterator(const uint8* ptr_, uint32 remaining_, bool compact_)
+        : ptr(ptr_), remaining(remaining_), compact(compact_), ref(0)
+    {
+      if (remaining > 0)
+        read();
+    }
+
+    bool is_end() const { return remaining == 0; }
+    Node::Id_Type operator*() const { return ref; }
+
+    Nd_Iterator& operator++()
+    {
+      if (--remaining > 0)
+        read();
+      return *this;
+    }
+
+  private:
+    const uint8* ptr;
+    uint32 remaining;
+    bool compact;
+    uint64 ref;
+
+    void read()
+    {
+      if (compact)
+        ref += zigzag_decode(read_varint(ptr));
+      else
+      {
+        ref = *(const uint64*)ptr;
+        ptr += 8;
+      }
+    }
+  };
+
+  Way_Skeleton::Id_Type id() const { return *(const uint32*)data; }
+
+  uint32 nds_size() const
+  {
+    if (!is_compact())
+      return *((const uint16*)data + 2);
+    const uint8* ptr = data + 12;
+    return read_varint(ptr);
+  }
+
+  Nd_Iterator nds_begin() const
+  {
+    if (!is_compact())
+      return Nd_Iterator(data + 8, *((const uint16*)data + 2), false);
+    const uint8* ptr = data + 12;
+    uint32 size = read_varint(ptr);
+    read_varint(ptr);
+    return Nd_Iterator(ptr, size, true);
+  }
+
+  // pos must be less than nds_size()
+  Node::Id_Type nd(uint32 pos) const
+  {
+    if (!is_compact())
+      return *(const uint64*)(data + 8 + 8*pos);
+    Nd_Iterator it = nds_begin();
+    for (; pos > 0; --pos)
+      ++it;
+    return *it;
+  }
+
+  bool is_closed() const
+  {
+    uint32 size = nds_size();
+    return size > 0 && nd(0) == nd(size - 1);
+  }
+
+private:
+  const uint8* data;
+
+  bool is_compact() const { return *((const uint16*)data + 2) == Way_Skeleton::COMPACT_FORMAT; }
+};
+
+
 struct Way_Delta
 {
   typedef Way_Skeleton::Id_Type Id_Type;
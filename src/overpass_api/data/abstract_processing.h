@@ -24,6 +24,9 @@
 #include "collect_items.h"
 #include "filenames.h"
 
+#include <functional>
+#include <iterator>
+
 
 //-----------------------------------------------------------------------------
 
@@ -127,6 +130,32 @@ inline bool has_a_child_with_id_and_role
 }
 
 
+inline bool has_a_child_with_id
+    (const Relation_Skeleton_View& relation, const std::vector< Uint64 >& ids, uint32 type)
+{
+  for (Relation_Skeleton_View::Member_Iterator it3 = relation.members_begin(); !it3.is_end(); ++it3)
+  {
+    if (it3->type == type &&
+        std::binary_search(ids.begin(), ids.end(), it3->ref))
+      return true;
+  }
+  return false;
+}
+
+
+inline bool has_a_child_with_id_and_role
+    (const Relation_Skeleton_View& relation, const std::vector< Uint64 >& ids, uint32 type, uint32 role_id)
+{
+  for (Relation_Skeleton_View::Member_Iterator it3 = relation.members_begin(); !it3.is_end(); ++it3)
+  {
+    if (it3->type == type && it3->role == role_id &&
+        std::binary_search(ids.begin(), ids.end(), it3->ref))
+      return true;
+  }
+  return false;
+}
+
+
 inline bool has_a_child_with_id
     (const Way_Skeleton& way, const std::vector< int >* pos, const std::vector< Node::Id_Type >& ids)
 {
@@ -159,55 +188,109 @@ inline bool has_a_child_with_id
 }
 
 
+inline bool has_a_child_with_id
+    (const Way_Skeleton_View& way, const std::vector< int >* pos, const std::vector< Node::Id_Type >& ids)
+{
+  if (pos)
+  {
+    int size = way.nds_size();
+    std::vector< int >::const_iterator it3 = pos->begin();
+    for (; it3 != pos->end() && *it3 < 0; ++it3)
+    {
+      if (*it3 + size >= 0 &&
+          std::binary_search(ids.begin(), ids.end(), way.nd(*it3 + size)))
+        return true;
+    }
+    for (; it3 != pos->end(); ++it3)
+    {
+      if (*it3 > 0 && *it3 < size+1 &&
+          std::binary_search(ids.begin(), ids.end(), way.nd(*it3-1)))
+        return true;
+    }
+  }
+  else
+  {
+    for (Way_Skeleton_View::Nd_Iterator it3 = way.nds_begin(); !it3.is_end(); ++it3)
+    {
+      if (std::binary_search(ids.begin(), ids.end(), *it3))
+        return true;
+    }
+  }
+  return false;
+}
+
+
+// If candidates is set, the predicates of the parents check first whether the id is one of the candidates
+inline bool is_candidate(const std::vector< Uint32_Index >* candidates, const Uint32_Index& id)
+{
+  return !candidates || std::binary_search(candidates->begin(), candidates->end(), id);
+}
+
+
 class Get_Parent_Rels_Predicate
 {
 public:
-  Get_Parent_Rels_Predicate(const std::vector< Uint64 >& ids_, uint32 child_type_)
-    : ids(ids_), child_type(child_type_) {}
+  Get_Parent_Rels_Predicate(const std::vector< Uint64 >& ids_, uint32 child_type_,
+      const std::vector< Relation::Id_Type >* candidates_ = 0)
+    : ids(ids_), child_type(child_type_), candidates(candidates_) {}
   bool match(const Relation_Skeleton& obj) const
-  { return has_a_child_with_id(obj, ids, child_type); }
+  { return is_candidate(candidates, obj.id) && has_a_child_with_id(obj, ids, child_type); }
   bool match(const Handle< Relation_Skeleton >& h) const
-  { return has_a_child_with_id(h.object(), ids, child_type); }
+  { return is_candidate(candidates, h.id())
+      && has_a_child_with_id(Relation_Skeleton_View(h.get_ptr_to_raw()), ids, child_type); }
   bool match(const Handle< Attic< Relation_Skeleton > >& h) const
-  { return has_a_child_with_id(h.object(), ids, child_type); }
+  { return is_candidate(candidates, h.id())
+      && has_a_child_with_id(Relation_Skeleton_View(h.get_ptr_to_raw()), ids, child_type); }
 
 private:
   const std::vector< Uint64 >& ids;
   uint32 child_type;
+  const std::vector< Relation::Id_Type >* candidates;
 };
 
 
 class Get_Parent_Rels_Role_Predicate
 {
 public:
-  Get_Parent_Rels_Role_Predicate(const std::vector< Uint64 >& ids_, uint32 child_type_, uint32 role_id_)
-    : ids(ids_), child_type(child_type_), role_id(role_id_) {}
+  Get_Parent_Rels_Role_Predicate(const std::vector< Uint64 >& ids_, uint32 child_type_, uint32 role_id_,
+      const std::vector< Relation::Id_Type >* candidates_ = 0)
+    : ids(ids_), child_type(child_type_), role_id(role_id_), candidates(candidates_) {}
   bool match(const Relation_Skeleton& obj) const
-  { return has_a_child_with_id_and_role(obj, ids, child_type, role_id); }
+  { return is_candidate(candidates, obj.id) && has_a_child_with_id_and_role(obj, ids, child_type, role_id); }
   bool match(const Handle< Relation_Skeleton >& h) const
-  { return has_a_child_with_id_and_role(h.object(), ids, child_type, role_id); }
+  { return is_candidate(candidates, h.id())
+      && has_a_child_with_id_and_role(Relation_Skeleton_View(h.get_ptr_to_raw()), ids, child_type, role_id); }
   bool match(const Handle< Attic< Relation_Skeleton > >& h) const
-  { return has_a_child_with_id_and_role(h.object(), ids, child_type, role_id); }
+  { return is_candidate(candidates, h.id())
+      && has_a_child_with_id_and_role(Relation_Skeleton_View(h.get_ptr_to_raw()), ids, child_type, role_id); }
 
 private:
   const std::vector< Uint64 >& ids;
   uint32 child_type;
   uint32 role_id;
+  const std::vector< Relation::Id_Type >* candidates;
 };
 
 
 class Get_Parent_Ways_Predicate
 {
 public:
-  Get_Parent_Ways_Predicate(const std::vector< Node::Id_Type >& ids_, const std::vector< int >* pos_)
-    : ids(ids_), pos(pos_) {}
-  bool match(const Way_Skeleton& obj) const { return has_a_child_with_id(obj, pos, ids); }
-  bool match(const Handle< Way_Skeleton >& h) const { return has_a_child_with_id(h.object(), pos, ids); }
-  bool match(const Handle< Attic< Way_Skeleton > >& h) const { return has_a_child_with_id(h.object(), pos, ids); }
+  Get_Parent_Ways_Predicate(const std::vector< Node::Id_Type >& ids_, const std::vector< int >* pos_,
+      const std::vector< Way::Id_Type >* candidates_ = 0)
+    : ids(ids_), pos(pos_), candidates(candidates_) {}
+  bool match(const Way_Skeleton& obj) const
+  { return is_candidate(candidates, obj.id) && has_a_child_with_id(obj, pos, ids); }
+  bool match(const Handle< Way_Skeleton >& h) const
+  { return is_candidate(candidates, h.id())
+      && has_a_child_with_id(Way_Skeleton_View(h.get_ptr_to_raw()), pos, ids); }
+  bool match(const Handle< Attic< Way_Skeleton > >& h) const
+  { return is_candidate(candidates, h.id())
+      && has_a_child_with_id(Way_Skeleton_View(h.get_ptr_to_raw()), pos, ids); }
 
 private:
   const std::vector< Node::Id_Type >& ids;
   const std::vector< int >* pos;
+  const std::vector< Way::Id_Type >* candidates;
 };
 
 
@@ -342,50 +425,110 @@ struct Compare_By_Id
 };
 
 
+// Returns the first position in [begin, end) whose element is not less than value.
+// It searches with steps growing exponentially from begin, hence is fast if the position is close to begin.
+template< class Iterator, class TObject, class Compare >
+Iterator gallop_lower_bound(Iterator begin, Iterator end, const TObject& value, Compare less)
+{
+  if (begin == end || !less(*begin, value))
+    return begin;
+
+  Iterator lower = begin;
+  typename std::iterator_traits< Iterator >::difference_type step = 1;
+  while (step < end - lower && less(*(lower + step), value))
+  {
+    lower += step;
+    step *= 2;
+  }
+  Iterator upper = (step < end - lower ? lower + step : end);
+  return std::lower_bound(lower + 1, upper, value, less);
+}
+
+
+// Counts what indexed_set_union has added to its result
+struct Set_Growth
+{
+  Set_Growth() : idxs(0), elems(0) {}
+
+  uint64 idxs;
+  uint64 elems;
+};
+
+
 template< class TIndex, class TObject >
 bool indexed_set_union(std::map< TIndex, std::vector< TObject > >& result,
-		       const std::map< TIndex, std::vector< TObject > >& summand)
+		       const std::map< TIndex, std::vector< TObject > >& summand, Set_Growth* growth = 0)
 {
   bool result_has_grown = false;
+  Compare_By_Id< TObject > less;
 
+  typename std::map< TIndex, std::vector< TObject > >::iterator it_result = result.begin();
   for (typename std::map< TIndex, std::vector< TObject > >::const_iterator
       it = summand.begin(); it != summand.end(); ++it)
   {
     if (it->second.empty())
       continue;
 
-    std::vector< TObject >& target = result[it->first];
+    // Both maps are walked in ascending order, so the hint avoids most of the tree lookups
+    while (it_result != result.end() && it_result->first < it->first)
+      ++it_result;
+    if (it_result == result.end() || it->first < it_result->first)
+    {
+      it_result = result.insert(it_result, std::make_pair(it->first, it->second));
+      result_has_grown = true;
+      if (growth)
+      {
+        ++growth->idxs;
+        growth->elems += it->second.size();
+      }
+      continue;
+    }
+
+    std::vector< TObject >& target = it_result->second;
     if (target.empty())
     {
       target = it->second;
       result_has_grown = true;
+      if (growth)
+        growth->elems += it->second.size();
       continue;
     }
 
-    if (it->second.size() == 1 && target.size() > 64)
+    // Most unions add little or nothing, hence first check without touching target
+    uint64 num_new = 0;
+    typename std::vector< TObject >::iterator it_new_pos = target.end();
+    typename std::vector< TObject >::const_iterator it_new = it->second.end();
+    typename std::vector< TObject >::iterator it_target = target.begin();
+    for (typename std::vector< TObject >::const_iterator it_summand = it->second.begin();
+        it_summand != it->second.end(); ++it_summand)
     {
-      typename std::vector< TObject >::iterator it_target
-          = std::lower_bound(target.begin(), target.end(), it->second.front());
-      if (it_target == target.end())
-      {
-        target.push_back(it->second.front());
-        result_has_grown = true;
-      }
-      else if (!(*it_target == it->second.front()))
+      it_target = gallop_lower_bound(it_target, target.end(), *it_summand, less);
+      if (it_target == target.end() || less(*it_summand, *it_target))
       {
-        target.insert(it_target, it->second.front());
-        result_has_grown = true;
+        if (num_new == 0)
+        {
+          it_new_pos = it_target;
+          it_new = it_summand;
+        }
+        ++num_new;
       }
     }
+
+    if (num_new == 0)
+      continue;
+    else if (num_new == 1)
+      target.insert(it_new_pos, *it_new);
     else
     {
       std::vector< TObject > other;
+      other.reserve(target.size() + num_new);
+      std::set_union(it->second.begin(), it->second.end(), target.begin(), target.end(),
+                back_inserter(other), less);
       other.swap(target);
-      std::set_union(it->second.begin(), it->second.end(), other.begin(), other.end(),
-                back_inserter(target), Compare_By_Id< TObject >());
-
-      result_has_grown |= (target.size() > other.size());
     }
+    result_has_grown = true;
+    if (growth)
+      growth->elems += num_new;
   }
 
   return result_has_grown;
@@ -397,14 +540,33 @@ template< class TIndex, class TObject >
 void indexed_set_difference(std::map< TIndex, std::vector< TObject > >& result,
                             const std::map< TIndex, std::vector< TObject > >& to_substract)
 {
+  typename std::map< TIndex, std::vector< TObject > >::iterator it_result = result.begin();
   for (typename std::map< TIndex, std::vector< TObject > >::const_iterator
       it = to_substract.begin(); it != to_substract.end(); ++it)
   {
-    std::vector< TObject > other;
-    other.swap(result[it->first]);
-    std::sort(other.begin(), other.end());
-    std::set_difference(other.begin(), other.end(), it->second.begin(), it->second.end(),
-                   back_inserter(result[it->first]));
+    while (it_result != result.end() && it_result->first < it->first)
+      ++it_result;
+    if (it_result == result.end())
+      break;
+    if (it->first < it_result->first || it->second.empty())
+      continue;
+
+    // Removes the elements in place in a single pass
+    std::vector< TObject >& target = it_result->second;
+    std::sort(target.begin(), target.end());
+    typename std::vector< TObject >::const_iterator it_substract = it->second.begin();
+    typename std::vector< TObject >::iterator it_target = target.begin();
+    for (typename std::vector< TObject >::iterator it_source = target.begin(); it_source != target.end(); ++it_source)
+    {
+      it_substract = gallop_lower_bound(it_substract, it->second.end(), *it_source, std::less< TObject >());
+      if (it_substract == it->second.end() || *it_source < *it_substract)
+      {
+        if (it_target != it_source)
+          *it_target = *it_source;
+        ++it_target;
+      }
+    }
+    target.erase(it_target, target.end());
   }
 }
 
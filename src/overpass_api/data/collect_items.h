@@ -72,14 +72,6 @@ void reconstruct_items(const Statement* stmt, Resource_Manager& rman,
   std::vector< Attic< typename Object::Delta > > deltas;
   std::vector< std::pair< typename Object::Id_Type, uint64 > > local_timestamp_by_id;
 
-  while (!(current_it == current_end) && current_it.index() == idx)
-  {
-    timestamp_by_id.push_back(std::make_pair(current_it.object().id, NOW));
-    local_timestamp_by_id.push_back(std::make_pair(current_it.object().id, NOW));
-    skels.push_back(current_it.object());
-    ++current_it;
-  }
-
   while (!(attic_it == attic_end) && attic_it.index() == idx)
   {
     if (timestamp < attic_it.object().timestamp)
@@ -91,14 +83,51 @@ void reconstruct_items(const Statement* stmt, Resource_Manager& rman,
     ++attic_it;
   }
 
-  std::vector< const Attic< typename Object::Delta >* > delta_refs;
-  delta_refs.reserve(deltas.size());
+  std::vector< const Attic< typename Object::Delta >* > all_delta_refs;
+  all_delta_refs.reserve(deltas.size());
   for (typename std::vector< Attic< typename Object::Delta > >::const_iterator it = deltas.begin();
       it != deltas.end(); ++it)
-    delta_refs.push_back(&*it);
+    all_delta_refs.push_back(&*it);
+  std::sort(all_delta_refs.begin(), all_delta_refs.end(),
+      Delta_Ref_Comparator< Attic< typename Object::Delta > >());
+
+  // Of the deltas of each object, ordered from the youngest to the oldest, only the oldest one is requested.
+  // A full delta does not need its reference, hence the expansion can start at the oldest full delta.
+  std::vector< const Attic< typename Object::Delta >* > delta_refs;
+  std::vector< typename Object::Id_Type > delta_ids;
+  delta_refs.reserve(all_delta_refs.size());
+  typename std::vector< const Attic< typename Object::Delta >* >::const_iterator chain_begin
+      = all_delta_refs.begin();
+  for (typename std::vector< const Attic< typename Object::Delta >* >::const_iterator
+      it = all_delta_refs.begin(); it != all_delta_refs.end(); ++it)
+  {
+    if (!((*chain_begin)->id == (*it)->id))
+      chain_begin = it;
+    if ((*it)->full)
+      chain_begin = it;
+
+    typename std::vector< const Attic< typename Object::Delta >* >::const_iterator next = it;
+    ++next;
+    if (next == all_delta_refs.end() || !((*next)->id == (*it)->id))
+    {
+      if (!(*chain_begin)->full)
+        delta_ids.push_back((*it)->id);
+      delta_refs.insert(delta_refs.end(), chain_begin, next);
+    }
+  }
+
+  // Only the current objects that match or are the reference of a delta chain need to be decoded
+  while (!(current_it == current_end) && current_it.index() == idx)
+  {
+    typename Object::Id_Type id = current_it.handle().id();
+    timestamp_by_id.push_back(std::make_pair(id, NOW));
+    local_timestamp_by_id.push_back(std::make_pair(id, NOW));
+    if (predicate.match(current_it.handle()) || std::binary_search(delta_ids.begin(), delta_ids.end(), id))
+      skels.push_back(current_it.object());
+    ++current_it;
+  }
 
   std::sort(skels.begin(), skels.end());
-  std::sort(delta_refs.begin(), delta_refs.end(), Delta_Ref_Comparator< Attic< typename Object::Delta > >());
   std::sort(local_timestamp_by_id.begin(), local_timestamp_by_id.end());
 
   std::vector< Attic< Object > > attics;
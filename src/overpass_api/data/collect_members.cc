@@ -1202,6 +1202,83 @@ void collect_ways(const Statement& query, Resource_Manager& rman,
 }
 
 
+template< typename Child_Id >
+void collect_reverse_refs(Resource_Manager& rman,
+    const File_Properties& current_file, const File_Properties& attic_file,
+    const std::vector< Child_Id >& child_ids, std::vector< Uint32_Index >& result)
+{
+  Block_Backend< Child_Id, Uint32_Index, typename std::vector< Child_Id >::const_iterator >
+      current_db(rman.get_transaction()->data_index(&current_file));
+  for (typename Block_Backend< Child_Id, Uint32_Index, typename std::vector< Child_Id >::const_iterator >
+      ::Discrete_Iterator it(current_db.discrete_begin(child_ids.begin(), child_ids.end()));
+      !(it == current_db.discrete_end()); ++it)
+    result.push_back(it.object());
+
+  if (rman.get_desired_timestamp() != NOW)
+  {
+    // A reference from the past is stored with a timestamp no earlier than its removal
+    Block_Backend< Child_Id, Attic< Uint32_Index >, typename std::vector< Child_Id >::const_iterator >
+        attic_db(rman.get_transaction()->data_index(&attic_file));
+    for (typename Block_Backend< Child_Id, Attic< Uint32_Index >,
+          typename std::vector< Child_Id >::const_iterator >
+        ::Discrete_Iterator it(attic_db.discrete_begin(child_ids.begin(), child_ids.end()));
+        !(it == attic_db.discrete_end()); ++it)
+    {
+      if (it.object().timestamp > rman.get_desired_timestamp())
+        result.push_back(it.object());
+    }
+  }
+}
+
+
+Parent_Candidates::Parent_Candidates(Resource_Manager& rman, uint32 child_type, uint32 parent_type,
+    const std::vector< Uint64 >& child_ids) : found_(false)
+{
+  // Files that have been started on a populated database lack the references of the older elements
+  if (!reverse_refs_complete(rman.get_transaction()->get_db_dir()))
+    return;
+
+  if (child_type == Relation_Entry::NODE)
+  {
+    std::vector< Uint64 > node_ids = child_ids;
+    node_ids.erase(std::unique(node_ids.begin(), node_ids.end()), node_ids.end());
+
+    if (parent_type == Relation_Entry::WAY)
+      collect_reverse_refs(rman, *osm_base_settings().NODE_WAYS, *attic_settings().NODE_WAYS,
+          node_ids, ids_);
+    else
+      collect_reverse_refs(rman, *osm_base_settings().NODE_RELATIONS,
+          *attic_settings().NODE_RELATIONS, node_ids, ids_);
+  }
+  else if (parent_type == Relation_Entry::RELATION)
+  {
+    std::vector< Uint32_Index > child_ids_32;
+    for (std::vector< Uint64 >::const_iterator it = child_ids.begin(); it != child_ids.end(); ++it)
+      child_ids_32.push_back(Uint32_Index(it->val()));
+    child_ids_32.erase(std::unique(child_ids_32.begin(), child_ids_32.end()), child_ids_32.end());
+
+    if (child_type == Relation_Entry::WAY)
+      collect_reverse_refs(rman, *osm_base_settings().WAY_RELATIONS, *attic_settings().WAY_RELATIONS,
+          child_ids_32, ids_);
+    else
+      collect_reverse_refs(rman, *osm_base_settings().RELATION_RELATIONS,
+          *attic_settings().RELATION_RELATIONS, child_ids_32, ids_);
+  }
+  else
+    return;
+
+  found_ = true;
+
+  std::sort(ids_.begin(), ids_.end());
+  ids_.erase(std::unique(ids_.begin(), ids_.end()), ids_.end());
+
+  std::vector< Uint31_Index > idxs = (parent_type == Relation_Entry::WAY
+      ? get_indexes_< Uint31_Index, Way_Skeleton >(ids_, rman)
+      : get_indexes_< Uint31_Index, Relation_Skeleton >(ids_, rman));
+  idxs_.insert(idxs.begin(), idxs.end());
+}
+
+
 void collect_ways
     (const Statement& stmt, Resource_Manager& rman,
      const std::map< Uint32_Index, std::vector< Node_Skeleton > >& nodes,
@@ -1210,11 +1287,12 @@ void collect_ways
 {
   std::vector< Uint64 > ids = extract_children_ids< Uint32_Index, Node_Skeleton, Uint64 >(nodes);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(nodes);
+  Parent_Candidates parents(rman, Relation_Entry::NODE, Relation_Entry::WAY, ids);
+  std::set< Uint31_Index > req = parents.found() ? parents.idxs() : extract_parent_indices(nodes);
   rman.health_check(stmt);
 
   collect_items_discrete(&stmt, rman, *osm_base_settings().WAYS, req,
-      Get_Parent_Ways_Predicate(ids, pos), result);
+      Get_Parent_Ways_Predicate(ids, pos, parents.ids()), result);
 }
 
 
@@ -1227,14 +1305,16 @@ void collect_ways
 {
   std::vector< Uint64 > children_ids = extract_children_ids< Uint32_Index, Node_Skeleton, Uint64 >(nodes);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(nodes);
+  Parent_Candidates parents(rman, Relation_Entry::NODE, Relation_Entry::WAY, children_ids);
+  std::set< Uint31_Index > req = parents.found() ? parents.idxs() : extract_parent_indices(nodes);
   rman.health_check(stmt);
 
   if (!invert_ids)
     collect_items_discrete(&stmt, rman, *osm_base_settings().WAYS, req,
         And_Predicate< Way_Skeleton,
 	    Id_Predicate< Way_Skeleton >, Get_Parent_Ways_Predicate >
-	    (Id_Predicate< Way_Skeleton >(ids), Get_Parent_Ways_Predicate(children_ids, pos)), result);
+	    (Id_Predicate< Way_Skeleton >(ids), Get_Parent_Ways_Predicate(children_ids, pos, parents.ids())),
+        result);
   else
     collect_items_discrete(&stmt, rman, *osm_base_settings().WAYS, req,
         And_Predicate< Way_Skeleton,
@@ -1242,7 +1322,7 @@ void collect_ways
 	    Get_Parent_Ways_Predicate >
 	    (Not_Predicate< Way_Skeleton, Id_Predicate< Way_Skeleton > >
 	      (Id_Predicate< Way_Skeleton >(ids)),
-	     Get_Parent_Ways_Predicate(children_ids, pos)), result);
+	     Get_Parent_Ways_Predicate(children_ids, pos, parents.ids())), result);
 }
 
 
@@ -1256,23 +1336,25 @@ void collect_ways
 {
   std::vector< Uint64 > current_ids = extract_children_ids< Uint32_Index, Node_Skeleton, Uint64 >(nodes);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(nodes);
-  rman.health_check(stmt);
-
   std::vector< Uint64 > attic_ids = extract_children_ids< Uint32_Index, Attic< Node_Skeleton >, Uint64 >
       (attic_nodes);
   rman.health_check(stmt);
-  std::set< Uint31_Index > attic_req = extract_parent_indices(attic_nodes);
-  rman.health_check(stmt);
 
   std::vector< Uint64 > ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(ids));
-  for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
-    req.insert(*it);
+  Parent_Candidates parents(rman, Relation_Entry::NODE, Relation_Entry::WAY, ids);
+  std::set< Uint31_Index > req = parents.idxs();
+  if (!parents.found())
+  {
+    req = extract_parent_indices(nodes);
+    std::set< Uint31_Index > attic_req = extract_parent_indices(attic_nodes);
+    req.insert(attic_req.begin(), attic_req.end());
+  }
+  rman.health_check(stmt);
 
   collect_items_discrete_by_timestamp(&stmt, rman, req,
-      Get_Parent_Ways_Predicate(ids, pos), result, attic_result);
+      Get_Parent_Ways_Predicate(ids, pos, parents.ids()), result, attic_result);
 }
 
 
@@ -1287,26 +1369,28 @@ void collect_ways
 {
   std::vector< Uint64 > current_ids = extract_children_ids< Uint32_Index, Node_Skeleton, Uint64 >(nodes);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(nodes);
-  rman.health_check(stmt);
-
   std::vector< Uint64 > attic_ids = extract_children_ids< Uint32_Index, Attic< Node_Skeleton >, Uint64 >
       (attic_nodes);
   rman.health_check(stmt);
-  std::set< Uint31_Index > attic_req = extract_parent_indices(attic_nodes);
-  rman.health_check(stmt);
 
   std::vector< Uint64 > children_ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(children_ids));
-  for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
-    req.insert(*it);
+  Parent_Candidates parents(rman, Relation_Entry::NODE, Relation_Entry::WAY, children_ids);
+  std::set< Uint31_Index > req = parents.idxs();
+  if (!parents.found())
+  {
+    req = extract_parent_indices(nodes);
+    std::set< Uint31_Index > attic_req = extract_parent_indices(attic_nodes);
+    req.insert(attic_req.begin(), attic_req.end());
+  }
+  rman.health_check(stmt);
 
   if (!invert_ids)
     collect_items_discrete_by_timestamp(&stmt, rman, req,
         And_Predicate< Way_Skeleton,
             Id_Predicate< Way_Skeleton >, Get_Parent_Ways_Predicate >
-            (Id_Predicate< Way_Skeleton >(ids), Get_Parent_Ways_Predicate(children_ids, pos)),
+            (Id_Predicate< Way_Skeleton >(ids), Get_Parent_Ways_Predicate(children_ids, pos, parents.ids())),
         result, attic_result);
   else
     collect_items_discrete_by_timestamp(&stmt, rman, req,
@@ -1315,7 +1399,7 @@ void collect_ways
             Get_Parent_Ways_Predicate >
             (Not_Predicate< Way_Skeleton, Id_Predicate< Way_Skeleton > >
               (Id_Predicate< Way_Skeleton >(ids)),
-             Get_Parent_Ways_Predicate(children_ids, pos)),
+             Get_Parent_Ways_Predicate(children_ids, pos, parents.ids())),
         result, attic_result);
 }
 
@@ -1091,6 +1091,30 @@ std::set< Uint31_Index > extract_parent_indices(const std::map< TIndex, std::vec
 }
 
 
+/* The possible parents of a set of children, looked up in the optional reverse reference files.
+ * If the reverse references of the database are not complete, found() is false
+ * and the parents must be searched in all indexes that may contain a parent of the children.
+ * Otherwise, ids() is a sorted superset of the parents at the desired timestamp
+ * and idxs() contains the indexes of all these parents. */
+class Parent_Candidates
+{
+public:
+  // child_type and parent_type are Relation_Entry::NODE, WAY, or RELATION
+  Parent_Candidates(Resource_Manager& rman, uint32 child_type, uint32 parent_type,
+      const std::vector< Uint64 >& child_ids);
+
+  bool found() const { return found_; }
+  // Zero if no candidates have been found
+  const std::vector< Uint32_Index >* ids() const { return found_ ? &ids_ : 0; }
+  const std::set< Uint31_Index >& idxs() const { return idxs_; }
+
+private:
+  bool found_;
+  std::vector< Uint32_Index > ids_;
+  std::set< Uint31_Index > idxs_;
+};
+
+
 void collect_ways(const Statement& query, Resource_Manager& rman,
 		  const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& rels,
 		  const std::set< std::pair< Uint31_Index, Uint31_Index > >& ranges,
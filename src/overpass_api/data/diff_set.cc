@@ -128,7 +128,7 @@ const std::pair< Quad_Coord, Quad_Coord* >* bound_variant(Double_Coords& double_
 
 void print_nodes(const std::vector< std::pair< Node_With_Context, Node_With_Context > >& different_nodes,
     uint32 output_mode, Output_Handler* output,
-    const std::map< uint32, std::string >& users, bool add_deletion_information)
+    const User_Data_Cache& users, bool add_deletion_information)
 {
   for (std::vector< std::pair< Node_With_Context, Node_With_Context > >::const_iterator
       it = different_nodes.begin(); it != different_nodes.end(); ++it)
@@ -188,7 +188,7 @@ void print_nodes(const std::vector< std::pair< Node_With_Context, Node_With_Cont
 
 void print_ways(const std::vector< std::pair< Way_With_Context, Way_With_Context > >& different_ways,
     uint32 output_mode, Output_Handler* output,
-    const std::map< uint32, std::string >& users, bool add_deletion_information)
+    const User_Data_Cache& users, bool add_deletion_information)
 {
   for (std::vector< std::pair< Way_With_Context, Way_With_Context > >::const_iterator it = different_ways.begin();
       it != different_ways.end(); ++it)
@@ -255,7 +255,7 @@ void print_ways(const std::vector< std::pair< Way_With_Context, Way_With_Context
 void print_relations(
     const std::vector< std::pair< Relation_With_Context, Relation_With_Context > >& different_relations,
     uint32 output_mode, Output_Handler* output,
-    const std::map< uint32, std::string >& users, const std::map< uint32, std::string >& roles,
+    const User_Data_Cache& users, const std::map< uint32, std::string >& roles,
     bool add_deletion_information)
 {
   for (std::vector< std::pair< Relation_With_Context, Relation_With_Context > >::const_iterator it = different_relations.begin();
@@ -338,7 +338,7 @@ void print_deriveds(
 
 void print_diff_set(const Diff_Set& result,
     uint32 output_mode, Output_Handler* output,
-    const std::map< uint32, std::string >& users, const std::map< uint32, std::string >& roles,
+    const User_Data_Cache& users, const std::map< uint32, std::string >& roles,
     bool add_deletion_information)
 {
   print_nodes(result.different_nodes, output_mode, output, users, add_deletion_information);
@@ -21,6 +21,7 @@
 
 
 #include "../core/datatypes.h"
+#include "user_data_cache.h"
 
 #include <map>
 #include <string>
@@ -145,7 +146,7 @@ class Output_Handler;
 
 void print_diff_set(const Diff_Set& result,
     uint32 output_mode, Output_Handler* output,
-    const std::map< uint32, std::string >& users, const std::map< uint32, std::string >& roles,
+    const User_Data_Cache& users, const std::map< uint32, std::string >& roles,
     bool add_deletion_information);
 
 
@@ -34,39 +34,77 @@ std::set< Tag_Index_Global > get_kv_req(const std::string& key, const std::strin
 }
 
 
-std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > get_k_req(const std::string& key)
+// Returns the least string that is greater than all strings starting with prefix.
+// It is empty if there is no such string, i.e. if prefix is empty or consists of 0xff bytes only.
+std::string prefix_upper_bound(const std::string& prefix)
+{
+  std::string result = prefix;
+  while (!result.empty() && (unsigned char)result[result.size()-1] == 0xff)
+    result.resize(result.size()-1);
+  if (!result.empty())
+    result[result.size()-1] = (char)((unsigned char)result[result.size()-1] + 1);
+  return result;
+}
+
+
+// Returns the range of all values of the key that start with value_prefix.
+std::pair< Tag_Index_Global, Tag_Index_Global > get_k_range(
+    const std::string& key, const std::string& value_prefix)
 {
-  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > result;
   std::pair< Tag_Index_Global, Tag_Index_Global > idx_pair;
   idx_pair.first.key = key;
-  idx_pair.first.value = "";
-  idx_pair.second.key = key + (char)0;
-  idx_pair.second.value = "";
-  result.insert(idx_pair);
+  idx_pair.first.value = value_prefix;
+  idx_pair.second.value = prefix_upper_bound(value_prefix);
+  if (idx_pair.second.value.empty())
+    idx_pair.second.key = key + (char)0;
+  else
+    idx_pair.second.key = key;
+  return idx_pair;
+}
+
+
+std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > get_k_req(
+    const std::string& key, const std::string& value_prefix = "")
+{
+  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > result;
+  result.insert(get_k_range(key, value_prefix));
+  return result;
+}
+
+
+// Returns the range of all keys that can match the key regex, or an empty set
+// if the regex has no anchored prefix and the whole file must be scanned.
+std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > get_regk_prefix_req(const Regular_Expression& key)
+{
+  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > result;
+  std::string upper = prefix_upper_bound(key.anchored_prefix());
+  if (!upper.empty())
+  {
+    std::pair< Tag_Index_Global, Tag_Index_Global > idx_pair;
+    idx_pair.first.key = key.anchored_prefix();
+    idx_pair.first.value = "";
+    idx_pair.second.key = upper;
+    idx_pair.second.value = "";
+    result.insert(idx_pair);
+  }
   return result;
 }
 
 
 template< typename Skeleton >
 std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > get_regk_req
-    (Regular_Expression* key, Resource_Manager& rman, Statement& stmt)
+    (Regular_Expression* key, Resource_Manager& rman, Statement& stmt, const std::string& value_prefix = "")
 {
   std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > result;
+  const std::string& key_prefix = key->anchored_prefix();
 
   Block_Backend< Uint32_Index, String_Object > db
       (rman.get_transaction()->data_index(key_file_properties< Skeleton >()));
   for (Block_Backend< Uint32_Index, String_Object >::Flat_Iterator
        it(db.flat_begin()); !(it == db.flat_end()); ++it)
   {
-    if (key->matches(it.object().val()))
-    {
-      std::pair< Tag_Index_Global, Tag_Index_Global > idx_pair;
-      idx_pair.first.key = it.object().val();
-      idx_pair.first.value = "";
-      idx_pair.second.key = it.object().val() + (char)0;
-      idx_pair.second.value = "";
-      result.insert(idx_pair);
-    }
+    if (it.object().val().compare(0, key_prefix.size(), key_prefix) == 0 && key->matches(it.object().val()))
+      result.insert(get_k_range(it.object().val(), value_prefix));
   }
   rman.health_check(stmt);
 
@@ -195,7 +233,8 @@ std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_kregv(
     Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >& attic_tags_db)
 {
   std::map< Id_Type, std::pair< uint64, Uint31_Index > > timestamp_per_id;
-  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req = get_k_req(krit->first);
+  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
+      = get_k_req(krit->first, krit->second->anchored_prefix());
 
   for (typename Block_Backend< Tag_Index_Global, Tag_Object_Global< Id_Type > >::Range_Iterator
       it2(tags_db.range_begin
@@ -222,6 +261,8 @@ std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_kregv(
     }
   }
 
+  // A later version may have any value for the key
+  range_req = get_k_req(krit->first);
   for (typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Range_Iterator
       it2(attic_tags_db.range_begin(Default_Range_Iterator< Tag_Index_Global >(range_req.begin()),
           Default_Range_Iterator< Tag_Index_Global >(range_req.end())));
@@ -243,45 +284,23 @@ std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_kregv(
 }
 
 
-template< typename Skeleton, typename Id_Type >
-std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_regkregv(
+// Records for each id and matching key the earliest attic version later than timestamp.
+template< typename Id_Type, typename Iterator >
+void collect_attic_regkregv_versions(Iterator& it2, const Iterator& end,
     std::vector< std::pair< Regular_Expression*, Regular_Expression* > >::const_iterator krit, uint64 timestamp,
-    Block_Backend< Tag_Index_Global, Tag_Object_Global< Id_Type > >& tags_db,
-    Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >& attic_tags_db,
-    Resource_Manager& rman, Statement& stmt)
+    std::map< Id_Type, std::map< std::string, std::pair< uint64, Uint31_Index > > >& timestamp_per_id)
 {
-  std::map< Id_Type, std::map< std::string, std::pair< uint64, Uint31_Index > > > timestamp_per_id;
-  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
-      = get_regk_req< Skeleton >(krit->first, rman, stmt);
-
   std::string last_key = void_tag_value();
   bool matches = false;
-  for (typename Block_Backend< Tag_Index_Global, Tag_Object_Global< Id_Type > >::Range_Iterator
-      it2(tags_db.range_begin
-        (Default_Range_Iterator< Tag_Index_Global >(range_req.begin()),
-      Default_Range_Iterator< Tag_Index_Global >(range_req.end())));
-      !(it2 == tags_db.range_end()); ++it2)
+  for (; !(it2 == end); ++it2)
   {
-    if (it2.index().key != last_key)
+    if (!Tag_Index_Global_View(it2.index_handle().get_ptr_to_raw()).key_equals(last_key))
     {
       last_key = it2.index().key;
-      matches = krit->first->matches(it2.index().key);
+      matches = krit->first->matches(last_key);
     }
-    if (matches && krit->second->matches(it2.index().value))
-      timestamp_per_id[it2.object().id][last_key] = std::make_pair(NOW, it2.object().idx);
-  }
-
-  last_key = void_tag_value();
-  matches = false;
-  for (typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Flat_Iterator
-      it2(attic_tags_db.flat_begin()); !(it2 == attic_tags_db.flat_end()); ++it2)
-  {
-    if (it2.index().key != last_key)
-    {
-      last_key = it2.index().key;
-      matches = krit->first->matches(it2.index().key);
-    }
-    if (it2.object().timestamp > timestamp && matches && it2.index().value != void_tag_value()
+    if (it2.object().timestamp > timestamp && matches
+        && !Tag_Index_Global_View(it2.index_handle().get_ptr_to_raw()).value_equals(void_tag_value())
         && krit->second->matches(it2.index().value))
     {
       std::pair< uint64, Uint31_Index >& ref = timestamp_per_id[it2.object().id][last_key];
@@ -289,16 +308,23 @@ std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_regkregv(
         ref = std::make_pair(it2.object().timestamp, it2.object().idx);
     }
   }
+}
 
-  last_key = void_tag_value();
-  matches = false;
-  for (typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Flat_Iterator
-      it2(attic_tags_db.flat_begin()); !(it2 == attic_tags_db.flat_end()); ++it2)
+
+// Drops the recorded versions that are preceded by another change of the same key.
+template< typename Id_Type, typename Iterator >
+void remove_superseded_regkregv_versions(Iterator& it2, const Iterator& end,
+    std::vector< std::pair< Regular_Expression*, Regular_Expression* > >::const_iterator krit, uint64 timestamp,
+    std::map< Id_Type, std::map< std::string, std::pair< uint64, Uint31_Index > > >& timestamp_per_id)
+{
+  std::string last_key = void_tag_value();
+  bool matches = false;
+  for (; !(it2 == end); ++it2)
   {
-    if (it2.index().key != last_key)
+    if (!Tag_Index_Global_View(it2.index_handle().get_ptr_to_raw()).key_equals(last_key))
     {
       last_key = it2.index().key;
-      matches = krit->first->matches(it2.index().key);
+      matches = krit->first->matches(last_key);
     }
     if (matches && it2.object().timestamp > timestamp)
     {
@@ -316,6 +342,61 @@ std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_regkregv(
       }
     }
   }
+}
+
+
+template< typename Skeleton, typename Id_Type >
+std::map< Id_Type, std::pair< uint64, Uint31_Index > > collect_attic_regkregv(
+    std::vector< std::pair< Regular_Expression*, Regular_Expression* > >::const_iterator krit, uint64 timestamp,
+    Block_Backend< Tag_Index_Global, Tag_Object_Global< Id_Type > >& tags_db,
+    Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >& attic_tags_db,
+    Resource_Manager& rman, Statement& stmt)
+{
+  std::map< Id_Type, std::map< std::string, std::pair< uint64, Uint31_Index > > > timestamp_per_id;
+  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
+      = get_regk_req< Skeleton >(krit->first, rman, stmt, krit->second->anchored_prefix());
+
+  std::string last_key = void_tag_value();
+  bool matches = false;
+  for (typename Block_Backend< Tag_Index_Global, Tag_Object_Global< Id_Type > >::Range_Iterator
+      it2(tags_db.range_begin
+        (Default_Range_Iterator< Tag_Index_Global >(range_req.begin()),
+      Default_Range_Iterator< Tag_Index_Global >(range_req.end())));
+      !(it2 == tags_db.range_end()); ++it2)
+  {
+    if (!Tag_Index_Global_View(it2.index_handle().get_ptr_to_raw()).key_equals(last_key))
+    {
+      last_key = it2.index().key;
+      matches = krit->first->matches(last_key);
+    }
+    if (matches && krit->second->matches(it2.index().value))
+      timestamp_per_id[it2.object().id][last_key] = std::make_pair(NOW, it2.object().idx);
+  }
+
+  // The attic passes scan all keys, but an anchored key regex restricts them to a single range of keys.
+  std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > key_range_req = get_regk_prefix_req(*krit->first);
+  if (key_range_req.empty())
+  {
+    typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Flat_Iterator
+        it2(attic_tags_db.flat_begin());
+    collect_attic_regkregv_versions(it2, attic_tags_db.flat_end(), krit, timestamp, timestamp_per_id);
+    typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Flat_Iterator
+        it3(attic_tags_db.flat_begin());
+    remove_superseded_regkregv_versions(it3, attic_tags_db.flat_end(), krit, timestamp, timestamp_per_id);
+  }
+  else
+  {
+    typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Range_Iterator
+        it2(attic_tags_db.range_begin
+          (Default_Range_Iterator< Tag_Index_Global >(key_range_req.begin()),
+          Default_Range_Iterator< Tag_Index_Global >(key_range_req.end())));
+    collect_attic_regkregv_versions(it2, attic_tags_db.range_end(), krit, timestamp, timestamp_per_id);
+    typename Block_Backend< Tag_Index_Global, Attic< Tag_Object_Global< Id_Type > > >::Range_Iterator
+        it3(attic_tags_db.range_begin
+          (Default_Range_Iterator< Tag_Index_Global >(key_range_req.begin()),
+          Default_Range_Iterator< Tag_Index_Global >(key_range_req.end())));
+    remove_superseded_regkregv_versions(it3, attic_tags_db.range_end(), krit, timestamp, timestamp_per_id);
+  }
 
   std::map< Id_Type, std::pair< uint64, Uint31_Index > > result;
   for (typename std::map< Id_Type, std::map< std::string, std::pair< uint64, Uint31_Index > > >::const_iterator
@@ -0,0 +1,1022 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "regular_expression.h"
+
+#include <langinfo.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+  struct Unsupported_Regex {};
+
+
+  inline unsigned char ascii_lower(unsigned char c)
+  {
+    return ('A' <= c && c <= 'Z') ? c - 'A' + 'a' : c;
+  }
+
+
+  // Tells whether the next eight bytes are all ASCII.
+  inline bool ascii_word(const void* pos)
+  {
+    unsigned long long word;
+    memcpy(&word, pos, sizeof(word));
+    return !(word & 0x8080808080808080ull);
+  }
+
+
+  bool is_ascii(const char* begin, const char* end)
+  {
+    while (end - begin >= 8 && ascii_word(begin))
+      begin += 8;
+    for (; begin != end; ++begin)
+    {
+      if (*begin & 0x80)
+        return false;
+    }
+    return true;
+  }
+
+
+  // Accepts only the shortest encoding of code points outside the surrogate range.
+  bool is_valid_utf8(const char* begin, const char* end)
+  {
+    const unsigned char* it = (const unsigned char*)begin;
+    const unsigned char* it_end = (const unsigned char*)end;
+    while (it != it_end)
+    {
+      // Most tag values are plain ASCII, so skip over it in larger steps.
+      while (it_end - it >= 8 && ascii_word(it))
+        it += 8;
+      if (it == it_end)
+        break;
+
+      unsigned char c = *it;
+      int length = 0;
+      unsigned char min_second = 0x80;
+      unsigned char max_second = 0xbf;
+      if (c < 0x80)
+      {
+        ++it;
+        continue;
+      }
+      else if (0xc2 <= c && c <= 0xdf)
+        length = 2;
+      else if (0xe0 <= c && c <= 0xef)
+      {
+        length = 3;
+        if (c == 0xe0)
+          min_second = 0xa0;
+        else if (c == 0xed)
+          max_second = 0x9f;
+      }
+      else if (0xf0 <= c && c <= 0xf4)
+      {
+        length = 4;
+        if (c == 0xf0)
+          min_second = 0x90;
+        else if (c == 0xf4)
+          max_second = 0x8f;
+      }
+      else
+        return false;
+
+      if (it_end - it < length || it[1] < min_second || max_second < it[1])
+        return false;
+      for (int i = 2; i < length; ++i)
+      {
+        if ((it[i] & 0xc0) != 0x80)
+          return false;
+      }
+      it += length;
+    }
+    return true;
+  }
+
+
+  struct Byte_Set
+  {
+    Byte_Set() { memset(bits, 0, sizeof(bits)); }
+
+    void add(unsigned char c) { bits[c>>5] |= (1u<<(c & 31)); }
+    void add_range(unsigned char lower, unsigned char upper)
+    {
+      for (unsigned int c = lower; c <= upper; ++c)
+        add(c);
+    }
+    void remove(unsigned char c) { bits[c>>5] &= ~(1u<<(c & 31)); }
+    bool contains(unsigned char c) const { return bits[c>>5] & (1u<<(c & 31)); }
+
+    void add_other_cases()
+    {
+      for (unsigned int c = 'A'; c <= 'Z'; ++c)
+      {
+        if (contains(c) || contains(ascii_lower(c)))
+        {
+          add(c);
+          add(ascii_lower(c));
+        }
+      }
+    }
+
+    unsigned int bits[8];
+  };
+
+
+  /** Parser for the subset of POSIX extended regular expressions the DFA supports: ------*/
+
+  struct Regex_Node
+  {
+    enum Kind { bytes, any_char, line_begin, line_end, concat, alternative, repeat };
+
+    Regex_Node(Kind kind_) : kind(kind_), literal(-1), min(0), max(0) {}
+
+    Kind kind;
+    // For bytes the accepted bytes, for any_char the excluded ASCII characters.
+    Byte_Set set;
+    // For bytes, the character in the pattern if the node stands for a single character.
+    int literal;
+    // For repeat, max < 0 stands for no upper bound.
+    int min;
+    int max;
+    std::vector< int > children;
+  };
+
+
+  class Regex_Parser
+  {
+  public:
+    Regex_Parser(const std::string& regex_, bool case_sensitive_, bool multibyte_)
+        : regex(regex_), pos(0), case_sensitive(case_sensitive_), multibyte(multibyte_) {}
+
+    // Throws Unsupported_Regex for everything outside the supported subset.
+    int parse()
+    {
+      int root = parse_alternative(0);
+      if (pos != regex.size())
+        throw Unsupported_Regex();
+      return root;
+    }
+
+    const std::vector< Regex_Node >& get_nodes() const { return nodes; }
+
+  private:
+    static const int MAX_DEPTH = 64;
+    static const int MAX_REPEAT = 100;
+
+    std::string regex;
+    std::string::size_type pos;
+    bool case_sensitive;
+    bool multibyte;
+    std::vector< Regex_Node > nodes;
+
+    int new_node(Regex_Node::Kind kind)
+    {
+      nodes.push_back(Regex_Node(kind));
+      return nodes.size() - 1;
+    }
+
+    int new_literal(unsigned char c)
+    {
+      int result = new_node(Regex_Node::bytes);
+      nodes[result].set.add(c);
+      if (!case_sensitive)
+        nodes[result].set.add_other_cases();
+      nodes[result].literal = c;
+      return result;
+    }
+
+    int parse_alternative(int depth)
+    {
+      if (depth > MAX_DEPTH)
+        throw Unsupported_Regex();
+
+      std::vector< int > branches;
+      branches.push_back(parse_concat(depth));
+      while (pos < regex.size() && regex[pos] == '|')
+      {
+        ++pos;
+        branches.push_back(parse_concat(depth));
+      }
+      if (branches.size() == 1)
+        return branches.front();
+
+      int result = new_node(Regex_Node::alternative);
+      nodes[result].children = branches;
+      return result;
+    }
+
+    int parse_concat(int depth)
+    {
+      std::vector< int > items;
+      while (pos < regex.size() && regex[pos] != '|' && regex[pos] != ')')
+        items.push_back(parse_repeat(depth));
+
+      // Empty branches and a stray closing parenthesis are treated specially by the library.
+      if (items.empty() || (depth == 0 && pos < regex.size() && regex[pos] == ')'))
+        throw Unsupported_Regex();
+
+      if (items.size() == 1)
+        return items.front();
+      int result = new_node(Regex_Node::concat);
+      nodes[result].children = items;
+      return result;
+    }
+
+    int parse_number()
+    {
+      int result = 0;
+      std::string::size_type start = pos;
+      while (pos < regex.size() && '0' <= regex[pos] && regex[pos] <= '9' && result <= MAX_REPEAT)
+        result = 10*result + (regex[pos++] - '0');
+      if (pos == start || result > MAX_REPEAT)
+        throw Unsupported_Regex();
+      return result;
+    }
+
+    int parse_repeat(int depth)
+    {
+      int result = parse_atom(depth);
+      while (pos < regex.size())
+      {
+        int min = 0;
+        int max = 0;
+        if (regex[pos] == '*')
+          max = -1;
+        else if (regex[pos] == '+')
+        {
+          min = 1;
+          max = -1;
+        }
+        else if (regex[pos] == '?')
+          max = 1;
+        else if (regex[pos] == '{')
+        {
+          ++pos;
+          min = parse_number();
+          max = min;
+          if (pos < regex.size() && regex[pos] == ',')
+          {
+            ++pos;
+            max = (pos < regex.size() && regex[pos] == '}') ? -1 : parse_number();
+          }
+          if (pos >= regex.size() || regex[pos] != '}' || (max >= 0 && max < min))
+            throw Unsupported_Regex();
+        }
+        else
+          break;
+        ++pos;
+
+        if (nodes[result].kind == Regex_Node::line_begin || nodes[result].kind == Regex_Node::line_end)
+          throw Unsupported_Regex();
+
+        int repeat = new_node(Regex_Node::repeat);
+        nodes[repeat].min = min;
+        nodes[repeat].max = max;
+        nodes[repeat].children.push_back(result);
+        result = repeat;
+      }
+      return result;
+    }
+
+    int parse_atom(int depth)
+    {
+      unsigned char c = regex[pos];
+      if (c == '(')
+      {
+        ++pos;
+        int result = parse_alternative(depth + 1);
+        if (pos >= regex.size() || regex[pos] != ')')
+          throw Unsupported_Regex();
+        ++pos;
+        return result;
+      }
+      else if (c == '[')
+        return parse_bracket();
+      else if (c == '.')
+      {
+        ++pos;
+        return new_node(Regex_Node::any_char);
+      }
+      else if (c == '^')
+      {
+        ++pos;
+        return new_node(Regex_Node::line_begin);
+      }
+      else if (c == '$')
+      {
+        ++pos;
+        return new_node(Regex_Node::line_end);
+      }
+      else if (c == '\\')
+      {
+        // The library gives other escapes like \w or \< a special meaning.
+        if (pos + 1 >= regex.size() || std::string("^.[$()|*+?{}\\").find(regex[pos + 1]) == std::string::npos)
+          throw Unsupported_Regex();
+        pos += 2;
+        return new_literal(regex[pos - 1]);
+      }
+      else if (c == '*' || c == '+' || c == '?' || c == '{')
+        throw Unsupported_Regex();
+      else if ((c & 0x80) && multibyte)
+        return parse_multibyte_char();
+
+      ++pos;
+      return new_literal(c);
+    }
+
+    // A quantifier after a multibyte character applies to the whole character.
+    int parse_multibyte_char()
+    {
+      // We do not know how the library folds the case of non-ASCII characters.
+      if (!case_sensitive)
+        throw Unsupported_Regex();
+
+      unsigned char c = regex[pos];
+      std::string::size_type length = (c >= 0xf0 ? 4 : (c >= 0xe0 ? 3 : 2));
+      if (pos + length > regex.size() || !is_valid_utf8(&regex[pos], &regex[pos] + length))
+        throw Unsupported_Regex();
+
+      int result = new_node(Regex_Node::concat);
+      for (std::string::size_type i = 0; i < length; ++i)
+      {
+        int byte = new_literal(regex[pos + i]);
+        nodes[result].children.push_back(byte);
+      }
+      pos += length;
+      return result;
+    }
+
+    int parse_bracket()
+    {
+      ++pos;
+      bool negated = (pos < regex.size() && regex[pos] == '^');
+      if (negated)
+        ++pos;
+
+      Byte_Set set;
+      bool first = true;
+      while (pos < regex.size() && (first || regex[pos] != ']'))
+      {
+        first = false;
+        unsigned char c = regex[pos];
+        // Character classes, equivalence classes and collating symbols depend on the locale.
+        if ((c == '[' && pos + 1 < regex.size()
+            && (regex[pos + 1] == ':' || regex[pos + 1] == '=' || regex[pos + 1] == '.'))
+            || (c & 0x80))
+          throw Unsupported_Regex();
+
+        if (pos + 2 < regex.size() && regex[pos + 1] == '-' && regex[pos + 2] != ']')
+        {
+          unsigned char upper = regex[pos + 2];
+          // The library folds ranges differently from single characters.
+          if ((upper & 0x80) || upper == '[' || upper < c || !case_sensitive)
+            throw Unsupported_Regex();
+          set.add_range(c, upper);
+          pos += 3;
+        }
+        else
+        {
+          set.add(c);
+          ++pos;
+        }
+      }
+      if (pos >= regex.size())
+        throw Unsupported_Regex();
+      ++pos;
+
+      if (!case_sensitive)
+        set.add_other_cases();
+
+      int result = new_node(negated ? Regex_Node::any_char : Regex_Node::bytes);
+      nodes[result].set = set;
+      return result;
+    }
+  };
+
+
+  /** Literal engine: --------------------------------------------------------------------*/
+
+  // Handles patterns that are a plain string, optionally anchored at one or both ends.
+  class Literal_Engine : public Regular_Expression_Engine
+  {
+  public:
+    enum Position { anywhere, prefix, suffix, whole };
+
+    Literal_Engine(const std::string& literal_, Position position_, bool case_sensitive_)
+        : literal(literal_), position(position_), case_sensitive(case_sensitive_)
+    {
+      if (!case_sensitive)
+      {
+        for (std::string::size_type i = 0; i < literal.size(); ++i)
+          literal[i] = ascii_lower(literal[i]);
+      }
+    }
+
+    Verdict matches(const char* begin, const char* end) const
+    {
+      std::string::size_type size = end - begin;
+      if (size < literal.size())
+        return no_match;
+
+      if (position == whole)
+        return (size == literal.size() && equal_at(begin)) ? match : no_match;
+      else if (position == prefix)
+        return equal_at(begin) ? match : no_match;
+      else if (position == suffix)
+        return equal_at(end - literal.size()) ? match : no_match;
+
+      if (literal.empty())
+        return match;
+      if (case_sensitive)
+        return std::search(begin, end, literal.begin(), literal.end()) != end ? match : no_match;
+
+      for (const char* it = begin; it + literal.size() <= end; ++it)
+      {
+        if (equal_at(it))
+          return match;
+      }
+      return no_match;
+    }
+
+    std::string name() const
+    {
+      static const char* names[] = { "literal", "prefix", "suffix", "whole" };
+      return names[position];
+    }
+
+  private:
+    std::string literal;
+    Position position;
+    bool case_sensitive;
+
+    bool equal_at(const char* it) const
+    {
+      if (case_sensitive)
+        return memcmp(it, literal.data(), literal.size()) == 0;
+      for (std::string::size_type i = 0; i < literal.size(); ++i)
+      {
+        if (ascii_lower(it[i]) != (unsigned char)literal[i])
+          return false;
+      }
+      return true;
+    }
+  };
+
+
+  void flatten(const std::vector< Regex_Node >& nodes, int idx, std::vector< int >& leaves)
+  {
+    if (nodes[idx].kind == Regex_Node::concat)
+    {
+      for (std::vector< int >::const_iterator it = nodes[idx].children.begin();
+          it != nodes[idx].children.end(); ++it)
+        flatten(nodes, *it, leaves);
+    }
+    else
+      leaves.push_back(idx);
+  }
+
+
+  Literal_Engine* new_literal_engine(const std::vector< Regex_Node >& nodes, int root, bool case_sensitive)
+  {
+    std::vector< int > leaves;
+    flatten(nodes, root, leaves);
+
+    std::vector< int >::const_iterator begin = leaves.begin();
+    std::vector< int >::const_iterator end = leaves.end();
+    bool anchored_begin = (begin != end && nodes[*begin].kind == Regex_Node::line_begin);
+    if (anchored_begin)
+      ++begin;
+    bool anchored_end = (begin != end && nodes[*(end - 1)].kind == Regex_Node::line_end);
+    if (anchored_end)
+      --end;
+
+    std::string literal;
+    for (std::vector< int >::const_iterator it = begin; it != end; ++it)
+    {
+      if (nodes[*it].kind != Regex_Node::bytes || nodes[*it].literal < 0)
+        return 0;
+      literal += (char)nodes[*it].literal;
+    }
+
+    if (anchored_begin)
+      return new Literal_Engine(literal, anchored_end ? Literal_Engine::whole : Literal_Engine::prefix,
+          case_sensitive);
+    return new Literal_Engine(literal, anchored_end ? Literal_Engine::suffix : Literal_Engine::anywhere,
+        case_sensitive);
+  }
+
+
+  /** NFA construction: ------------------------------------------------------------------*/
+
+  struct Nfa_State
+  {
+    enum Type { byte_set, split, empty, line_begin, line_end, accept };
+
+    Nfa_State(Type type_) : type(type_), out(-1), out1(-1) {}
+
+    Type type;
+    Byte_Set set;
+    int out;
+    int out1;
+  };
+
+
+  class Nfa_Builder
+  {
+  public:
+    Nfa_Builder(const std::vector< Regex_Node >& nodes_, bool multibyte_)
+        : nodes(&nodes_), multibyte(multibyte_) {}
+
+    // Returns the start state.
+    int build(int root)
+    {
+      Fragment fragment = build_fragment(root);
+      int accept = new_state(Nfa_State::accept);
+      patch(fragment.outs, accept);
+      return fragment.start;
+    }
+
+    const std::vector< Nfa_State >& get_states() const { return states; }
+
+  private:
+    static const unsigned int MAX_STATES = 4096;
+
+    struct Fragment
+    {
+      Fragment() : start(-1) {}
+
+      int start;
+      // Each entry is a state and whether its out (0) or its out1 (1) is still open.
+      std::vector< std::pair< int, int > > outs;
+    };
+
+    const std::vector< Regex_Node >* nodes;
+    bool multibyte;
+    std::vector< Nfa_State > states;
+
+    int new_state(Nfa_State::Type type)
+    {
+      if (states.size() >= MAX_STATES)
+        throw Unsupported_Regex();
+      states.push_back(Nfa_State(type));
+      return states.size() - 1;
+    }
+
+    void patch(const std::vector< std::pair< int, int > >& outs, int target)
+    {
+      for (std::vector< std::pair< int, int > >::const_iterator it = outs.begin(); it != outs.end(); ++it)
+      {
+        if (it->second == 0)
+          states[it->first].out = target;
+        else
+          states[it->first].out1 = target;
+      }
+    }
+
+    Fragment single(Nfa_State::Type type, const Byte_Set& set)
+    {
+      Fragment result;
+      result.start = new_state(type);
+      states[result.start].set = set;
+      result.outs.push_back(std::make_pair(result.start, 0));
+      return result;
+    }
+
+    Fragment sequence(const std::vector< Byte_Set >& sets)
+    {
+      Fragment result = single(Nfa_State::byte_set, sets[0]);
+      for (std::vector< Byte_Set >::size_type i = 1; i < sets.size(); ++i)
+      {
+        Fragment next = single(Nfa_State::byte_set, sets[i]);
+        patch(result.outs, next.start);
+        result.outs = next.outs;
+      }
+      return result;
+    }
+
+    Fragment either(const Fragment& lhs, const Fragment& rhs)
+    {
+      Fragment result;
+      result.start = new_state(Nfa_State::split);
+      states[result.start].out = lhs.start;
+      states[result.start].out1 = rhs.start;
+      result.outs = lhs.outs;
+      result.outs.insert(result.outs.end(), rhs.outs.begin(), rhs.outs.end());
+      return result;
+    }
+
+    void append(Fragment& result, const Fragment& next)
+    {
+      if (result.start < 0)
+        result = next;
+      else
+      {
+        patch(result.outs, next.start);
+        result.outs = next.outs;
+      }
+    }
+
+    // Any single character except NUL and the excluded ASCII characters.
+    Fragment any_char(const Byte_Set& excluded)
+    {
+      Byte_Set first;
+      first.add_range(1, multibyte ? 0x7f : 0xff);
+      for (unsigned int c = 0; c < 0x80; ++c)
+      {
+        if (excluded.contains(c))
+          first.remove(c);
+      }
+      Fragment result = single(Nfa_State::byte_set, first);
+      if (!multibyte)
+        return result;
+
+      // The subject is known to be valid UTF-8, so the ranges can be loose.
+      Byte_Set continuation;
+      continuation.add_range(0x80, 0xbf);
+      for (int length = 2; length <= 4; ++length)
+      {
+        std::vector< Byte_Set > sets(length, continuation);
+        sets[0] = Byte_Set();
+        if (length == 2)
+          sets[0].add_range(0xc2, 0xdf);
+        else if (length == 3)
+          sets[0].add_range(0xe0, 0xef);
+        else
+          sets[0].add_range(0xf0, 0xf4);
+        result = either(result, sequence(sets));
+      }
+      return result;
+    }
+
+    Fragment build_fragment(int idx)
+    {
+      const Regex_Node& node = (*nodes)[idx];
+      if (node.kind == Regex_Node::bytes)
+        return single(Nfa_State::byte_set, node.set);
+      else if (node.kind == Regex_Node::any_char)
+        return any_char(node.set);
+      else if (node.kind == Regex_Node::line_begin)
+        return single(Nfa_State::line_begin, Byte_Set());
+      else if (node.kind == Regex_Node::line_end)
+        return single(Nfa_State::line_end, Byte_Set());
+      else if (node.kind == Regex_Node::concat)
+      {
+        Fragment result;
+        for (std::vector< int >::const_iterator it = node.children.begin(); it != node.children.end(); ++it)
+          append(result, build_fragment(*it));
+        return result;
+      }
+      else if (node.kind == Regex_Node::alternative)
+      {
+        Fragment result = build_fragment(node.children.back());
+        for (std::vector< int >::const_reverse_iterator it = node.children.rbegin() + 1;
+            it != node.children.rend(); ++it)
+          result = either(build_fragment(*it), result);
+        return result;
+      }
+
+      // Repetitions are expanded into copies of the repeated fragment.
+      Fragment result;
+      for (int i = 0; i < node.min; ++i)
+        append(result, build_fragment(node.children.front()));
+      if (node.max < 0)
+      {
+        Fragment body = build_fragment(node.children.front());
+        Fragment loop;
+        loop.start = new_state(Nfa_State::split);
+        states[loop.start].out = body.start;
+        patch(body.outs, loop.start);
+        loop.outs.push_back(std::make_pair(loop.start, 1));
+        append(result, loop);
+      }
+      else
+      {
+        for (int i = node.min; i < node.max; ++i)
+        {
+          Fragment body = build_fragment(node.children.front());
+          Fragment optional;
+          optional.start = new_state(Nfa_State::split);
+          states[optional.start].out = body.start;
+          optional.outs = body.outs;
+          optional.outs.push_back(std::make_pair(optional.start, 1));
+          append(result, optional);
+        }
+      }
+      if (result.start < 0)
+        result = single(Nfa_State::empty, Byte_Set());
+      return result;
+    }
+  };
+
+
+  /** Lazy DFA engine: -------------------------------------------------------------------*/
+
+  // Builds the states of the DFA on demand from the NFA by subset construction.
+  class Dfa_Engine : public Regular_Expression_Engine
+  {
+  public:
+    Dfa_Engine(const std::vector< Nfa_State >& nfa_, int nfa_start_)
+        : nfa(nfa_), nfa_start(nfa_start_), initial_state(-2) {}
+
+    ~Dfa_Engine()
+    {
+      for (std::vector< Dfa_State* >::iterator it = states.begin(); it != states.end(); ++it)
+        delete *it;
+    }
+
+    Verdict matches(const char* begin, const char* end) const
+    {
+      if (begin == end)
+      {
+        std::vector< int > closure;
+        std::vector< char > visited(nfa.size(), 0);
+        add_closure(nfa_start, true, true, closure, visited);
+        return contains_accept(closure) ? match : no_match;
+      }
+
+      if (initial_state == -2)
+      {
+        std::vector< int > closure;
+        std::vector< char > visited(nfa.size(), 0);
+        add_closure(nfa_start, true, false, closure, visited);
+        initial_state = state_for(closure);
+      }
+      int current = initial_state;
+      if (current < 0)
+        return undecided;
+
+      for (const unsigned char* it = (const unsigned char*)begin; it != (const unsigned char*)end; ++it)
+      {
+        if (states[current]->accepting)
+          return match;
+        int next = states[current]->next[*it];
+        if (next == UNKNOWN)
+        {
+          next = successor(current, *it);
+          if (next < 0)
+            return undecided;
+          states[current]->next[*it] = next;
+        }
+        current = next;
+        // Without an anchor at the beginning, the start state is part of every state.
+        if (states[current]->nfa_states.empty())
+          return no_match;
+      }
+      return (states[current]->accepting || accepting_at_end(current)) ? match : no_match;
+    }
+
+    std::string name() const { return "dfa"; }
+
+  private:
+    static const unsigned int MAX_DFA_STATES = 1024;
+    static const int UNKNOWN = -1;
+
+    struct Dfa_State
+    {
+      Dfa_State(const std::vector< int >& nfa_states_, bool accepting_)
+          : nfa_states(nfa_states_), accepting(accepting_), accepting_at_end(-1)
+      {
+        for (int i = 0; i < 256; ++i)
+          next[i] = UNKNOWN;
+      }
+
+      std::vector< int > nfa_states;
+      bool accepting;
+      int accepting_at_end;
+      int next[256];
+    };
+
+    std::vector< Nfa_State > nfa;
+    int nfa_start;
+    mutable int initial_state;
+    mutable std::vector< Dfa_State* > states;
+    mutable std::map< std::vector< int >, int > state_ids;
+
+    // Collects the states reachable by epsilon moves. Pending end-of-line assertions are kept
+    // in the result such that the check at the end of the string can resume from there.
+    void add_closure(int idx, bool at_begin, bool at_end,
+        std::vector< int >& result, std::vector< char >& visited) const
+    {
+      if (idx < 0 || visited[idx])
+        return;
+      visited[idx] = 1;
+
+      const Nfa_State& state = nfa[idx];
+      if (state.type == Nfa_State::byte_set || state.type == Nfa_State::accept)
+        result.push_back(idx);
+      else if (state.type == Nfa_State::split)
+      {
+        add_closure(state.out, at_begin, at_end, result, visited);
+        add_closure(state.out1, at_begin, at_end, result, visited);
+      }
+      else if (state.type == Nfa_State::empty)
+        add_closure(state.out, at_begin, at_end, result, visited);
+      else if (state.type == Nfa_State::line_begin)
+      {
+        if (at_begin)
+          add_closure(state.out, at_begin, at_end, result, visited);
+      }
+      else if (state.type == Nfa_State::line_end)
+      {
+        if (at_end)
+          add_closure(state.out, at_begin, at_end, result, visited);
+        else
+          result.push_back(idx);
+      }
+    }
+
+    bool contains_accept(const std::vector< int >& nfa_states) const
+    {
+      for (std::vector< int >::const_iterator it = nfa_states.begin(); it != nfa_states.end(); ++it)
+      {
+        if (nfa[*it].type == Nfa_State::accept)
+          return true;
+      }
+      return false;
+    }
+
+    int state_for(std::vector< int >& nfa_states) const
+    {
+      std::sort(nfa_states.begin(), nfa_states.end());
+      std::map< std::vector< int >, int >::const_iterator it = state_ids.find(nfa_states);
+      if (it != state_ids.end())
+        return it->second;
+
+      if (states.size() >= MAX_DFA_STATES)
+        return -1;
+      states.push_back(new Dfa_State(nfa_states, contains_accept(nfa_states)));
+      state_ids.insert(std::make_pair(nfa_states, (int)states.size() - 1));
+      return states.size() - 1;
+    }
+
+    int successor(int current, unsigned char c) const
+    {
+      std::vector< int > closure;
+      std::vector< char > visited(nfa.size(), 0);
+      const std::vector< int >& nfa_states = states[current]->nfa_states;
+      for (std::vector< int >::const_iterator it = nfa_states.begin(); it != nfa_states.end(); ++it)
+      {
+        if (nfa[*it].type == Nfa_State::byte_set && nfa[*it].set.contains(c))
+          add_closure(nfa[*it].out, false, false, closure, visited);
+      }
+      // A new match may start at every position.
+      add_closure(nfa_start, false, false, closure, visited);
+      return state_for(closure);
+    }
+
+    bool accepting_at_end(int current) const
+    {
+      if (states[current]->accepting_at_end < 0)
+      {
+        std::vector< int > closure;
+        std::vector< char > visited(nfa.size(), 0);
+        const std::vector< int >& nfa_states = states[current]->nfa_states;
+        for (std::vector< int >::const_iterator it = nfa_states.begin(); it != nfa_states.end(); ++it)
+        {
+          if (nfa[*it].type == Nfa_State::line_end)
+            add_closure(nfa[*it].out, false, true, closure, visited);
+        }
+        states[current]->accepting_at_end = contains_accept(closure);
+      }
+      return states[current]->accepting_at_end;
+    }
+  };
+}
+
+
+Regular_Expression_Engine* new_regular_expression_engine(
+    const std::string& regex, bool case_sensitive, bool multibyte)
+{
+  try
+  {
+    Regex_Parser parser(regex, case_sensitive, multibyte);
+    int root = parser.parse();
+
+    Regular_Expression_Engine* literal = new_literal_engine(parser.get_nodes(), root, case_sensitive);
+    if (literal)
+      return literal;
+
+    Nfa_Builder builder(parser.get_nodes(), multibyte);
+    int start = builder.build(root);
+    return new Dfa_Engine(builder.get_states(), start);
+  }
+  catch (const Unsupported_Regex&) {}
+
+  return 0;
+}
+
+
+std::string anchored_literal_prefix(const std::string& regex, bool case_sensitive, bool multibyte)
+{
+  // With case folding, the matching strings do not form a single range.
+  if (!case_sensitive)
+    return "";
+
+  try
+  {
+    Regex_Parser parser(regex, case_sensitive, multibyte);
+    int root = parser.parse();
+    const std::vector< Regex_Node >& nodes = parser.get_nodes();
+
+    std::vector< int > leaves;
+    flatten(nodes, root, leaves);
+    if (leaves.empty() || nodes[leaves.front()].kind != Regex_Node::line_begin)
+      return "";
+
+    std::string result;
+    for (std::vector< int >::const_iterator it = leaves.begin() + 1; it != leaves.end(); ++it)
+    {
+      if (nodes[*it].kind != Regex_Node::bytes || nodes[*it].literal < 0)
+        break;
+      result += (char)nodes[*it].literal;
+    }
+    return result;
+  }
+  catch (const Unsupported_Regex&) {}
+
+  return "";
+}
+
+
+Regular_Expression::Regular_Expression(const std::string& regex, bool case_sensitive_)
+    : case_sensitive(case_sensitive_), multibyte(false), engine(0), cache_available(false), prev_result(false)
+{
+  if (regex == ".*")
+    strategy = match_anything;
+  else if (regex == ".")
+    strategy = match_nonempty;
+  else
+    strategy = call_library;
+
+  if (strategy == call_library)
+  {
+    setlocale(LC_ALL, "C.UTF-8");
+    int case_flag = case_sensitive ? 0 : REG_ICASE;
+    int error_no = regcomp(&preg, regex.c_str(), REG_EXTENDED|REG_NOSUB|case_flag);
+    if (error_no != 0)
+      throw Regular_Expression_Error(error_no);
+
+    // The engines know only single byte locales and UTF-8.
+    multibyte = (MB_CUR_MAX > 1);
+    if (!multibyte || std::string(nl_langinfo(CODESET)) == "UTF-8")
+    {
+      engine = new_regular_expression_engine(regex, case_sensitive, multibyte);
+      prefix = anchored_literal_prefix(regex, case_sensitive, multibyte);
+    }
+  }
+}
+
+
+Regular_Expression::~Regular_Expression()
+{
+  if (strategy == call_library)
+    regfree(&preg);
+  delete engine;
+}
+
+
+bool Regular_Expression::matches_uncached(const std::string& line) const
+{
+  if (engine)
+  {
+    // Like the library, we see the string only up to the first NUL.
+    const char* begin = line.data();
+    const char* end = (const char*)memchr(begin, 0, line.size());
+    if (!end)
+      end = begin + line.size();
+
+    // Only the library knows how to fold non-ASCII characters or to treat invalid UTF-8.
+    if (!multibyte || (case_sensitive ? is_valid_utf8(begin, end) : is_ascii(begin, end)))
+    {
+      Regular_Expression_Engine::Verdict verdict = engine->matches(begin, end);
+      if (verdict != Regular_Expression_Engine::undecided)
+        return verdict == Regular_Expression_Engine::match;
+    }
+  }
+
+  return (regexec(&preg, line.c_str(), 0, 0, 0) == 0);
+}
@@ -24,6 +24,7 @@
 #include "regex.h"
 
 #include <iostream>
+#include <map>
 #include <string>
 
 
@@ -35,39 +36,39 @@ struct Regular_Expression_Error
 };
 
 
-class Regular_Expression
+/* An engine decides for a string whether the regular expression matches somewhere in it.
+ * It may refuse to decide for particular strings, e.g. if it cannot guarantee the same
+ * semantics as the C library for them. Regular_Expression then asks the C library. */
+class Regular_Expression_Engine
 {
   public:
-    enum Strategy { call_library, match_anything, match_nonempty };
+    enum Verdict { no_match = 0, match = 1, undecided = -1 };
 
-    Regular_Expression(const std::string& regex, bool case_sensitive)
-    {
-      if (regex == ".*")
-        strategy = match_anything;
-      else if (regex == ".")
-        strategy = match_nonempty;
-      else
-        strategy = call_library;
+    virtual ~Regular_Expression_Engine() {}
+    virtual Verdict matches(const char* begin, const char* end) const = 0;
+    virtual std::string name() const = 0;
+};
 
-//       cache_available = false;
-//       prev_line = "";
-//       prev_result = false;
 
-      if (strategy == call_library)
-      {
-        setlocale(LC_ALL, "C.UTF-8");
-        int case_flag = case_sensitive ? 0 : REG_ICASE;
-        int error_no = regcomp(&preg, regex.c_str(), REG_EXTENDED|REG_NOSUB|case_flag);
-        if (error_no != 0)
-          throw Regular_Expression_Error(error_no);
-      }
-    }
+/* Returns the fastest engine that supports the given regex or zero if only the C library can
+ * evaluate it. The regex must have been accepted by regcomp with the same flags before.
+ * multibyte tells whether the current locale is UTF-8. */
+Regular_Expression_Engine* new_regular_expression_engine(
+    const std::string& regex, bool case_sensitive, bool multibyte);
 
-    ~Regular_Expression()
-    {
-      if (strategy == call_library)
-        regfree(&preg);
-    }
+
+/* Returns a string that every string matched by the regex starts with. This is the literal
+ * text after a leading ^, up to the first operator. It is empty if there is no such prefix. */
+std::string anchored_literal_prefix(const std::string& regex, bool case_sensitive, bool multibyte);
+
+
+class Regular_Expression
+{
+  public:
+    enum Strategy { call_library, match_anything, match_nonempty };
+
+    Regular_Expression(const std::string& regex, bool case_sensitive);
+    ~Regular_Expression();
 
     inline bool matches(const std::string& line) const
     {
@@ -75,27 +76,54 @@ class Regular_Expression
         return true;
       else if (strategy == match_nonempty)
         return !line.empty();
-//       if (is_cache_available && line == prev_line)
-//         return prev_result;
 
-      bool result = (regexec(&preg, line.c_str(), 0, 0, 0) == 0);
+      // Tag entries come grouped by key and value, and the same values appear again
+      // in every index block. Hence we evaluate the regex only once per distinct string.
+      if (cache_available && line == prev_line)
+        return prev_result;
 
-//       is_cache_available = true;
-//       prev_result = result;
-//       prev_line = line;
+      bool result = false;
+      std::map< std::string, bool >::const_iterator it = verdicts.find(line);
+      if (it != verdicts.end())
+        result = it->second;
+      else
+      {
+        result = matches_uncached(line);
+        if (verdicts.size() < MAX_CACHED_VERDICTS)
+          verdicts.insert(std::make_pair(line, result));
+      }
+
+      cache_available = true;
+      prev_result = result;
+      prev_line = line;
 
       return (result);
     }
 
+    bool matches_uncached(const std::string& line) const;
+
+    const Regular_Expression_Engine* get_engine() const { return engine; }
+
+    // Every matching string starts with this prefix. Callers can restrict sorted scans to it.
+    const std::string& anchored_prefix() const { return prefix; }
+
   private:
     Regular_Expression(const Regular_Expression&);
     const Regular_Expression& operator=(const Regular_Expression&);
 
+    // Values like names are mostly unique. Stop to remember them beyond this limit.
+    static const std::map< std::string, bool >::size_type MAX_CACHED_VERDICTS = 64*1024;
+
     regex_t preg;
     Strategy strategy;
-//     mutable bool cache_available;
-//     mutable std::string prev_line;
-//     mutable bool prev_result;
+    bool case_sensitive;
+    bool multibyte;
+    Regular_Expression_Engine* engine;
+    std::string prefix;
+    mutable bool cache_available;
+    mutable std::string prev_line;
+    mutable bool prev_result;
+    mutable std::map< std::string, bool > verdicts;
 };
 
 #endif
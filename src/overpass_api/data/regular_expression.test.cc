@@ -0,0 +1,207 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "regular_expression.h"
+
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+// Evaluates the regex with the C library only, as Regular_Expression did before it had engines.
+struct Library_Regex
+{
+  Library_Regex(const std::string& regex, bool case_sensitive)
+  {
+    setlocale(LC_ALL, "C.UTF-8");
+    regcomp(&preg, regex.c_str(), REG_EXTENDED|REG_NOSUB|(case_sensitive ? 0 : REG_ICASE));
+  }
+  ~Library_Regex() { regfree(&preg); }
+
+  bool matches(const std::string& line) const { return regexec(&preg, line.c_str(), 0, 0, 0) == 0; }
+
+  regex_t preg;
+};
+
+
+const char* default_patterns[] = {
+  "^(primary|secondary)$", "^Main", "Street$", "^yes$", "str", "^[0-9]+$", "^[A-Z][a-z]+ [A-Z]",
+  "(St|Rd|Ave)\\.?$", "a.b", "^.{3}$", "^[^a-z]*$", "x|y|z", "^(a|b)*c", "b{2,3}", "^$",
+  "München", "^.ü", "stra(ss|ß)e$", "^[^ ]+$", "\\(", "^ab?c$", "(ab)+$", 0 };
+
+
+const char* default_values[] = {
+  "", "primary", "secondary", "tertiary", "primary_link", "Main Street", "main street", "Mainz",
+  "yes", "Yes", "no", "123", "12a", "Baker St", "Baker St.", "Baker Rd.", "Park Ave", "aXb", "a\xc3\xbc" "b",
+  "abc", "a\xc3\xbc" "c", "\xc3\xbc\xc3\xbc\xc3\xbc", "ABC", "Abc Def", "xyz", "bbb", "bb", "aababc", "c",
+  "M\xc3\xbcnchen", "MÜNCHEN", "Hauptstra\xc3\x9f" "e", "Hauptstrasse", "(", "ac", "abbc", "ababab",
+  "\xff\xfe", "a\xe2\x82\xac" "b", "a\nb", "STR", "Str", 0 };
+
+
+void check_equivalence(const std::string& regex, bool case_sensitive, const std::vector< std::string >& values)
+{
+  Regular_Expression fast(regex, case_sensitive);
+  Library_Regex reference(regex, case_sensitive);
+
+  uint differences = 0;
+  for (std::vector< std::string >::const_iterator it = values.begin(); it != values.end(); ++it)
+  {
+    if (fast.matches_uncached(*it) != reference.matches(*it))
+    {
+      std::cout<<"failed: \""<<regex<<"\" "<<(case_sensitive ? "" : "(i) ")<<"on \""<<*it<<"\"\n";
+      ++differences;
+    }
+  }
+  if (differences == 0)
+    std::cout<<"OK\n";
+}
+
+
+double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec/1000000.;
+}
+
+
+// Reads one tag value per line, e.g. as exported with [out:csv(name; false)].
+void benchmark(const std::string& corpus_file, const std::vector< std::string >& patterns, bool case_sensitive)
+{
+  std::vector< std::string > values;
+  std::ifstream in(corpus_file.c_str());
+  std::string line;
+  while (std::getline(in, line))
+    values.push_back(line);
+  std::cout<<values.size()<<" values from "<<corpus_file<<'\n';
+
+  for (std::vector< std::string >::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+  {
+    Regular_Expression fast(*it, case_sensitive);
+    Library_Regex reference(*it, case_sensitive);
+
+    double start = now();
+    uint library_count = 0;
+    for (std::vector< std::string >::const_iterator vit = values.begin(); vit != values.end(); ++vit)
+      library_count += reference.matches(*vit);
+    double library_time = now() - start;
+
+    start = now();
+    uint engine_count = 0;
+    for (std::vector< std::string >::const_iterator vit = values.begin(); vit != values.end(); ++vit)
+      engine_count += fast.matches_uncached(*vit);
+    double engine_time = now() - start;
+
+    std::cout<<'"'<<*it<<"\"\t"<<(fast.get_engine() ? fast.get_engine()->name() : "library")
+        <<"\tlibrary "<<library_time<<" s\tengine "<<engine_time<<" s\tspeedup "
+        <<(engine_time > 0 ? library_time/engine_time : 0)
+        <<(library_count == engine_count ? "" : "\tRESULTS DIFFER")<<'\n';
+  }
+}
+
+
+int main(int argc, char* args[])
+{
+  if (argc < 2)
+  {
+    std::cout<<"Usage: "<<args[0]<<" (test_to_execute | --benchmark=corpus_file [--case-insensitive] [regex ...])\n";
+    return 0;
+  }
+  std::string test_to_execute = args[1];
+
+  if (test_to_execute.substr(0, 12) == "--benchmark=")
+  {
+    bool case_sensitive = true;
+    std::vector< std::string > patterns;
+    for (int i = 2; i < argc; ++i)
+    {
+      if (std::string(args[i]) == "--case-insensitive")
+        case_sensitive = false;
+      else
+        patterns.push_back(args[i]);
+    }
+    if (patterns.empty())
+    {
+      for (const char** it = default_patterns; *it; ++it)
+        patterns.push_back(*it);
+    }
+    benchmark(test_to_execute.substr(12), patterns, case_sensitive);
+    return 0;
+  }
+
+  std::vector< std::string > values;
+  for (const char** it = default_values; *it; ++it)
+    values.push_back(*it);
+
+  if (test_to_execute.empty() || test_to_execute == "1")
+  {
+    // Case sensitive patterns against the library
+    for (const char** it = default_patterns; *it; ++it)
+      check_equivalence(*it, true, values);
+  }
+
+  if (test_to_execute.empty() || test_to_execute == "2")
+  {
+    // Case insensitive patterns against the library
+    for (const char** it = default_patterns; *it; ++it)
+      check_equivalence(*it, false, values);
+  }
+
+  if (test_to_execute.empty() || test_to_execute == "3")
+  {
+    // Random strings over a small alphabet against the library
+    const char* alphabet[] = { "a", "b", "c", "A", "B", " ", ".", "1", "\xc3\xbc", "\xe2\x82\xac", "\xff" };
+    srand(42);
+    std::vector< std::string > random_values;
+    for (int i = 0; i < 2000; ++i)
+    {
+      std::string value;
+      int length = rand() % 8;
+      for (int j = 0; j < length; ++j)
+        value += alphabet[rand() % (sizeof(alphabet)/sizeof(alphabet[0]))];
+      random_values.push_back(value);
+    }
+    const char* patterns[] = { "^a", "b$", "^(a|b)+$", "a.c", "^.$", "^..$", "[^a]", "^[ab]*c?$",
+        "a{2}", "^(ab|c)*$", "1\\.", "\xc3\xbc+", "^[a-c]+ [A-B]$", "(a|\xe2\x82\xac)b", "^.*c$", 0 };
+    for (const char** it = patterns; *it; ++it)
+    {
+      check_equivalence(*it, true, random_values);
+      check_equivalence(*it, false, random_values);
+    }
+  }
+
+  if (test_to_execute.empty() || test_to_execute == "4")
+  {
+    // Literal prefixes of anchored patterns
+    const char* patterns[] = { "^Berlin", "^Main St", "^Ber.in", "^M\xc3\xbcn+", "^ab?c", "^(ab)c",
+        "Berlin", "^a|^b", "^Berlin$", "^\\.x", ".*", 0 };
+    for (const char** it = patterns; *it; ++it)
+    {
+      Regular_Expression case_sensitive(*it, true);
+      Regular_Expression case_insensitive(*it, false);
+      std::cout<<'"'<<*it<<"\" \""<<case_sensitive.anchored_prefix()<<"\" \""
+          <<case_insensitive.anchored_prefix()<<"\"\n";
+    }
+  }
+
+  return 0;
+}
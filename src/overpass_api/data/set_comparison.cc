@@ -59,7 +59,7 @@ Extra_Data_For_Diff::Extra_Data_For_Diff(
 }
 
 
-const std::map< uint32, std::string >* Extra_Data_For_Diff::get_users() const
+const User_Data_Cache* Extra_Data_For_Diff::get_users() const
 {
   return users;
 }
@@ -86,7 +86,7 @@ void Set_Comparison::set_target(bool target)
 void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Node_Skeleton& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Node_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users)
+                    const User_Data_Cache* users)
 {
   if (final_target)
     compare_item(ll_upper, skel, tags, NOW, meta, users);
@@ -98,7 +98,7 @@ void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper
 void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Attic< Node_Skeleton >& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Node_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users)
+                    const User_Data_Cache* users)
 {
   if (final_target)
     compare_item(ll_upper, skel, tags, skel.timestamp, meta, users);
@@ -110,7 +110,7 @@ void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper
 void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Way_Skeleton& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Way_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users)
+                    const User_Data_Cache* users)
 {
   if (extra_data.way_geometry_store)
   {
@@ -140,7 +140,7 @@ void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper
 void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Attic< Way_Skeleton >& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Way_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users)
+                    const User_Data_Cache* users)
 {
   if (extra_data.attic_way_geometry_store)
   {
@@ -170,7 +170,7 @@ void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper
 void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Relation_Skeleton& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Relation_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users)
+                    const User_Data_Cache* users)
 {
   if (extra_data.relation_geometry_store)
   {
@@ -200,7 +200,7 @@ void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper
 void Set_Comparison::print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Attic< Relation_Skeleton >& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Relation_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users)
+                    const User_Data_Cache* users)
 {
   if (extra_data.attic_relation_geometry_store)
   {
@@ -428,7 +428,7 @@ std::map< typename Skeleton::Id_Type, OSM_Element_Metadata_Skeleton< typename Sk
 void Set_Comparison::store_item(uint32 ll_upper, const Node_Skeleton& skel,
                             const std::vector< std::pair< std::string, std::string > >* tags,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-                            const std::map< uint32, std::string >* users, const Output_Handler::Feature_Action& action,
+                            const User_Data_Cache* users, const Output_Handler::Feature_Action& action,
 			    const OSM_Element_Metadata_Skeleton< Node::Id_Type >* new_meta)
 {
   nodes.push_back(Node_With_Context(ll_upper, skel, timestamp,
@@ -440,7 +440,7 @@ void Set_Comparison::store_item(uint32 ll_upper, const Node_Skeleton& skel,
 void Set_Comparison::compare_item(uint32 ll_upper, const Node_Skeleton& skel,
                             const std::vector< std::pair< std::string, std::string > >* tags,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-                            const std::map< uint32, std::string >* users, const Output_Handler::Feature_Action& action,
+                            const User_Data_Cache* users, const Output_Handler::Feature_Action& action,
 			    const OSM_Element_Metadata_Skeleton< Node::Id_Type >* new_meta)
 {
   std::vector< Node_With_Context >::iterator nodes_it
@@ -550,7 +550,7 @@ void Set_Comparison::store_item(uint32 ll_upper, const Way_Skeleton& skel,
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< Quad_Coord >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-                            const std::map< uint32, std::string >* users, const Output_Handler::Feature_Action& action,
+                            const User_Data_Cache* users, const Output_Handler::Feature_Action& action,
 			    const OSM_Element_Metadata_Skeleton< Way::Id_Type >* new_meta)
 {
   ways.push_back(Way_With_Context(ll_upper, skel,
@@ -565,7 +565,7 @@ void Set_Comparison::compare_item(uint32 ll_upper, const Way_Skeleton& skel,
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< Quad_Coord >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-                            const std::map< uint32, std::string >* users, const Output_Handler::Feature_Action& action,
+                            const User_Data_Cache* users, const Output_Handler::Feature_Action& action,
 			    const OSM_Element_Metadata_Skeleton< Way::Id_Type >* new_meta)
 {
   std::vector< Way_With_Context >::iterator ways_it
@@ -682,7 +682,7 @@ void Set_Comparison::store_item(uint32 ll_upper, const Relation_Skeleton& skel,
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< std::vector< Quad_Coord > >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
-                            const std::map< uint32, std::string >* users, const Output_Handler::Feature_Action& action,
+                            const User_Data_Cache* users, const Output_Handler::Feature_Action& action,
 			    const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* new_meta)
 {
   relations.push_back(Relation_With_Context(ll_upper, skel,
@@ -697,7 +697,7 @@ void Set_Comparison::compare_item(uint32 ll_upper, const Relation_Skeleton& skel
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< std::vector< Quad_Coord > >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
-                            const std::map< uint32, std::string >* users, const Output_Handler::Feature_Action& action,
+                            const User_Data_Cache* users, const Output_Handler::Feature_Action& action,
 			    const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* new_meta)
 {
   std::vector< Relation_With_Context >::iterator relations_it
@@ -41,7 +41,7 @@ struct Extra_Data_For_Diff
       double south, double north, double west, double east);
   ~Extra_Data_For_Diff();
 
-  const std::map< uint32, std::string >* get_users() const;
+  const User_Data_Cache* get_users() const;
 
   unsigned int mode;
   Way_Bbox_Geometry_Store* way_geometry_store;
@@ -49,7 +49,7 @@ struct Extra_Data_For_Diff
   Relation_Geometry_Store* relation_geometry_store;
   Relation_Geometry_Store* attic_relation_geometry_store;
   const std::map< uint32, std::string >* roles;
-  const std::map< uint32, std::string >* users;
+  const User_Data_Cache* users;
 };
 
 
@@ -71,38 +71,38 @@ private:
   void print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Node_Skeleton& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Node_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users);
+                    const User_Data_Cache* users);
   void print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Attic< Node_Skeleton >& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Node_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users);
+                    const User_Data_Cache* users);
   void store_item(uint32 ll_upper, const Node_Skeleton& skel,
                             const std::vector< std::pair< std::string, std::string > >* tags,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta = 0,
-                            const std::map< uint32, std::string >* users = 0,
+                            const User_Data_Cache* users = 0,
                             const Output_Handler::Feature_Action& action = Output_Handler::keep,
                             const OSM_Element_Metadata_Skeleton< Node::Id_Type >* new_meta = 0);
   void compare_item(uint32 ll_upper, const Node_Skeleton& skel,
                             const std::vector< std::pair< std::string, std::string > >* tags,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta = 0,
-                            const std::map< uint32, std::string >* users = 0,
+                            const User_Data_Cache* users = 0,
                             const Output_Handler::Feature_Action& action = Output_Handler::keep,
                             const OSM_Element_Metadata_Skeleton< Node::Id_Type >* new_meta = 0);
 
   void print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Way_Skeleton& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Way_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users);
+                    const User_Data_Cache* users);
   void print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Attic< Way_Skeleton >& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Way_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users);
+                    const User_Data_Cache* users);
   void store_item(uint32 ll_upper, const Way_Skeleton& skel,
                             const std::vector< std::pair< std::string, std::string > >* tags,
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< Quad_Coord >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta = 0,
-                            const std::map< uint32, std::string >* users = 0,
+                            const User_Data_Cache* users = 0,
                             const Output_Handler::Feature_Action& action = Output_Handler::keep,
                             const OSM_Element_Metadata_Skeleton< Way::Id_Type >* new_meta = 0);
   void compare_item(uint32 ll_upper, const Way_Skeleton& skel,
@@ -110,24 +110,24 @@ private:
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< Quad_Coord >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta = 0,
-                            const std::map< uint32, std::string >* users = 0,
+                            const User_Data_Cache* users = 0,
                             const Output_Handler::Feature_Action& action = Output_Handler::keep,
                             const OSM_Element_Metadata_Skeleton< Way::Id_Type >* new_meta = 0);
 
   void print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Relation_Skeleton& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Relation_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users);
+                    const User_Data_Cache* users);
   void print_item(Extra_Data_For_Diff& extra_data, uint32 ll_upper, const Attic< Relation_Skeleton >& skel,
                     const std::vector< std::pair< std::string, std::string > >* tags,
                     const OSM_Element_Metadata_Skeleton< Relation_Skeleton::Id_Type >* meta,
-                    const std::map< uint32, std::string >* users);
+                    const User_Data_Cache* users);
   void store_item(uint32 ll_upper, const Relation_Skeleton& skel,
                             const std::vector< std::pair< std::string, std::string > >* tags,
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< std::vector< Quad_Coord > >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta = 0,
-                            const std::map< uint32, std::string >* users = 0,
+                            const User_Data_Cache* users = 0,
                             const Output_Handler::Feature_Action& action = Output_Handler::keep,
                             const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* new_meta = 0);
   void compare_item(uint32 ll_upper, const Relation_Skeleton& skel,
@@ -135,7 +135,7 @@ private:
                             const std::pair< Quad_Coord, Quad_Coord* >* bounds,
                             const std::vector< std::vector< Quad_Coord > >* geometry,
                             uint64 timestamp, const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta = 0,
-                            const std::map< uint32, std::string >* users = 0,
+                            const User_Data_Cache* users = 0,
                             const Output_Handler::Feature_Action& action = Output_Handler::keep,
                             const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* new_meta = 0);
 
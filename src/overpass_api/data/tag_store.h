@@ -22,10 +22,14 @@
 
 #include "filenames.h"
 #include "../core/datatypes.h"
+#include "../dispatch/resource_manager.h"
 #include "../../template_db/block_backend.h"
 #include "../../template_db/transaction.h"
 
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -44,12 +48,22 @@ public:
   void prefetch_chunk(const std::map< Index, std::vector< Attic< Object > > >& elems,
       typename Object::Id_Type lower_id_bound, typename Object::Id_Type upper_id_bound);
 
+  // Reads in a single pass over the tag file the tags of all elems with ids from lower_id_bound on.
+  // If these are more than max_tags tags or if rman finds them too big, only the tags of the lowest ids are kept.
+  // Returns the id up to which the tags are complete or Id_Type() if they are complete for all elems.
+  typename Object::Id_Type prefetch_by_id(const std::map< Index, std::vector< Object > >& elems,
+      typename Object::Id_Type lower_id_bound, uint64 max_tags, Resource_Manager& rman, const Statement* stmt);
+
   const std::vector< std::pair< std::string, std::string > >* get(const Index& index, const Object& elem);
 
 private:
   std::map< typename Object::Id_Type, std::vector< std::pair< std::string, std::string > > > tags_by_id;
   Transaction* transaction;
   bool use_index;
+  bool use_id_order;
+  std::vector< std::pair< std::string, std::string > > distinct_tags;
+  std::vector< std::pair< typename Object::Id_Type, uint32 > > tag_refs;
+  std::vector< std::pair< std::string, std::string > > found_tags;
   Index stored_index;
   std::map< uint32, std::vector< typename Object::Id_Type > > ids_by_coarse;
   std::map< uint32, std::vector< Attic< typename Object::Id_Type > > > attic_ids_by_coarse;
@@ -71,6 +85,9 @@ public:
   void prefetch_all(const std::map< Uint31_Index, std::vector< Derived_Structure > >& elems) {}
   void prefetch_chunk(const std::map< Uint31_Index, std::vector< Derived_Structure > >& elems,
       Derived_Structure::Id_Type lower_id_bound, Derived_Structure::Id_Type upper_id_bound) {}
+  Derived_Structure::Id_Type prefetch_by_id(const std::map< Uint31_Index, std::vector< Derived_Structure > >& elems,
+      Derived_Structure::Id_Type lower_id_bound, uint64 max_tags, Resource_Manager& rman, const Statement* stmt)
+  { return Derived_Structure::Id_Type(); }
 
   const std::vector< std::pair< std::string, std::string > >* get(
       const Uint31_Index& index, const Derived_Structure& elem) const { return &elem.tags; }
@@ -266,9 +283,134 @@ void collect_tags_framed
 }
 
 
+// Orders positions in distinct_tags by the tags they point to, such that each tag is stored only once
+struct Tag_Position_Less
+{
+  Tag_Position_Less(const std::vector< std::pair< std::string, std::string > >& tags_) : tags(&tags_) {}
+
+  bool operator()(uint32 lhs, uint32 rhs) const { return (*tags)[lhs] < (*tags)[rhs]; }
+
+private:
+  const std::vector< std::pair< std::string, std::string > >* tags;
+};
+
+
+// Orders tag references by id only. Sorted stably, the tags of each id stay in file order.
+template< class Id_Type >
+bool tag_ref_id_less(const std::pair< Id_Type, uint32 >& lhs, const std::pair< Id_Type, uint32 >& rhs)
+{
+  return lhs.first < rhs.first;
+}
+
+
+inline uint64 tag_buffer_size(const std::pair< std::string, std::string >& tag)
+{
+  return tag.first.size() + tag.second.size() + sizeof(tag) + 48;
+}
+
+
+// Drops the entries of distinct_tags that are no longer referenced and renumbers the references
+template< class Id_Type >
+void compact_distinct_tags
+  (std::vector< std::pair< std::string, std::string > >& distinct_tags,
+   std::vector< std::pair< Id_Type, uint32 > >& tag_refs,
+   std::set< uint32, Tag_Position_Less >& tag_positions, uint64& distinct_tags_size)
+{
+  std::vector< uint32 > new_positions(distinct_tags.size(), std::numeric_limits< uint32 >::max());
+  std::vector< std::pair< std::string, std::string > > compacted;
+  distinct_tags_size = 0;
+  for (typename std::vector< std::pair< Id_Type, uint32 > >::iterator it = tag_refs.begin();
+      it != tag_refs.end(); ++it)
+  {
+    if (new_positions[it->second] == std::numeric_limits< uint32 >::max())
+    {
+      new_positions[it->second] = compacted.size();
+      compacted.push_back(std::pair< std::string, std::string >());
+      compacted.back().first.swap(distinct_tags[it->second].first);
+      compacted.back().second.swap(distinct_tags[it->second].second);
+      distinct_tags_size += tag_buffer_size(compacted.back());
+    }
+    it->second = new_positions[it->second];
+  }
+
+  tag_positions.clear();
+  distinct_tags.swap(compacted);
+  for (uint32 i = 0; i < distinct_tags.size(); ++i)
+    tag_positions.insert(i);
+}
+
+
+// Keeps the tags of the found ids as references into distinct_tags.
+// Whenever there are more than max_tags references or rman finds the references and strings too big,
+// those of the upper half of ids are dropped.
+template< class Id_Type >
+void collect_tags_by_id
+  (std::vector< std::pair< std::string, std::string > >& distinct_tags,
+   std::set< uint32, Tag_Position_Less >& tag_positions, uint64& distinct_tags_size,
+   std::vector< std::pair< Id_Type, uint32 > >& tag_refs,
+   const Block_Backend< Tag_Index_Local, Id_Type >& items_db,
+   typename Block_Backend< Tag_Index_Local, Id_Type >::Range_Iterator& tag_it,
+   const std::vector< Id_Type >& ids, uint32 coarse_index,
+   Id_Type lower_id_bound, Id_Type& upper_id_bound, uint64 max_tags,
+   Resource_Manager& rman, const Statement* stmt, uint32& count)
+{
+  while ((!(tag_it == items_db.range_end())) &&
+      (((tag_it.index().index) & 0x7fffff00) < coarse_index))
+    ++tag_it;
+  while ((!(tag_it == items_db.range_end())) &&
+      (((tag_it.index().index) & 0x7fffff00) == coarse_index))
+  {
+    const Id_Type& id = tag_it.object();
+    if (!(id < lower_id_bound) && (upper_id_bound == Id_Type() || id < upper_id_bound)
+        && binary_search(ids.begin(), ids.end(), id))
+    {
+      const Tag_Index_Local& tag_idx = tag_it.index();
+      distinct_tags.push_back(std::make_pair(tag_idx.key, tag_idx.value));
+      std::pair< std::set< uint32, Tag_Position_Less >::iterator, bool > inserted
+          = tag_positions.insert(distinct_tags.size() - 1);
+      if (inserted.second)
+        distinct_tags_size += tag_buffer_size(distinct_tags.back());
+      else
+        distinct_tags.pop_back();
+      tag_refs.push_back(std::make_pair(id, *inserted.first));
+
+      bool too_much_data = (tag_refs.size() > max_tags);
+      if (++count >= 256*1024 && stmt)
+      {
+        count = 0;
+        too_much_data |= rman.health_check(*stmt, 0,
+            distinct_tags_size + tag_refs.size()*sizeof(std::pair< Id_Type, uint32 >));
+      }
+      if (too_much_data)
+      {
+        std::stable_sort(tag_refs.begin(), tag_refs.end(), tag_ref_id_less< Id_Type >);
+        typename std::vector< std::pair< Id_Type, uint32 > >::iterator it_bound
+            = std::lower_bound(tag_refs.begin(), tag_refs.end(),
+                std::make_pair(tag_refs[tag_refs.size()/2].first, uint32(0)), tag_ref_id_less< Id_Type >);
+        if (it_bound == tag_refs.begin())
+        {
+          Id_Type next_id = tag_refs.front().first;
+          ++next_id;
+          it_bound = std::lower_bound(tag_refs.begin(), tag_refs.end(), std::make_pair(next_id, uint32(0)),
+              tag_ref_id_less< Id_Type >);
+        }
+        if (it_bound != tag_refs.end())
+        {
+          upper_id_bound = it_bound->first;
+          tag_refs.erase(it_bound, tag_refs.end());
+          compact_distinct_tags(distinct_tags, tag_refs, tag_positions, distinct_tags_size);
+        }
+      }
+    }
+    ++tag_it;
+  }
+}
+
+
 template< typename Index, typename Object >
 Tag_Store< Index, Object >::Tag_Store(Transaction& transaction_)
-    : transaction(&transaction_), use_index(false), items_db(0), tag_it(0), attic_items_db(0), attic_tag_it(0) {}
+    : transaction(&transaction_), use_index(false), use_id_order(false),
+    items_db(0), tag_it(0), attic_items_db(0), attic_tag_it(0) {}
 
 
 template< typename Index, typename Object >
@@ -400,6 +542,45 @@ void Tag_Store< Index, Object >::prefetch_chunk(const std::map< Index, std::vect
 }
 
 
+template< typename Index, typename Object >
+typename Object::Id_Type Tag_Store< Index, Object >::prefetch_by_id(
+    const std::map< Index, std::vector< Object > >& elems,
+    typename Object::Id_Type lower_id_bound, uint64 max_tags, Resource_Manager& rman, const Statement* stmt)
+{
+  use_id_order = true;
+  distinct_tags.clear();
+  tag_refs.clear();
+
+  if (ids_by_coarse.empty())
+  {
+    generate_ids_by_coarse(ids_by_coarse, elems);
+    range_set.clear();
+    formulate_range_query(range_set, ids_by_coarse);
+  }
+
+  Block_Backend< Tag_Index_Local, typename Object::Id_Type > items_db
+      (transaction->data_index(current_local_tags_file_properties< Object >()));
+  typename Block_Backend< Tag_Index_Local, typename Object::Id_Type >::Range_Iterator
+      tag_it(items_db.range_begin
+      (Default_Range_Iterator< Tag_Index_Local >(range_set.begin()),
+       Default_Range_Iterator< Tag_Index_Local >(range_set.end())));
+
+  // Only for the duration of the pass, because it holds a node per distinct tag
+  std::set< uint32, Tag_Position_Less > tag_positions((Tag_Position_Less(distinct_tags)));
+  uint64 distinct_tags_size = 0;
+  uint32 count = 0;
+
+  typename Object::Id_Type upper_id_bound;
+  for (typename std::map< uint32, std::vector< typename Object::Id_Type > >::const_iterator
+      it = ids_by_coarse.begin(); it != ids_by_coarse.end(); ++it)
+    collect_tags_by_id< typename Object::Id_Type >(distinct_tags, tag_positions, distinct_tags_size, tag_refs,
+        items_db, tag_it, it->second, it->first, lower_id_bound, upper_id_bound, max_tags, rman, stmt, count);
+
+  std::stable_sort(tag_refs.begin(), tag_refs.end(), tag_ref_id_less< typename Object::Id_Type >);
+  return upper_id_bound;
+}
+
+
 template< typename Index, typename Object >
 Tag_Store< Index, Object >::~Tag_Store()
 {
@@ -414,6 +595,20 @@ template< typename Index, typename Object >
 const std::vector< std::pair< std::string, std::string > >*
     Tag_Store< Index, Object >::get(const Index& index, const Object& elem)
 {
+  if (use_id_order)
+  {
+    typename std::vector< std::pair< typename Object::Id_Type, uint32 > >::const_iterator
+        it = std::lower_bound(tag_refs.begin(), tag_refs.end(), std::make_pair(elem.id, uint32(0)),
+            tag_ref_id_less< typename Object::Id_Type >);
+    if (it == tag_refs.end() || !(it->first == elem.id))
+      return 0;
+
+    found_tags.clear();
+    for (; it != tag_refs.end() && it->first == elem.id; ++it)
+      found_tags.push_back(distinct_tags[it->second]);
+    return &found_tags;
+  }
+
   if (use_index && stored_index < Index(index.val() & 0x7fffff00))
   {
     tags_by_id.clear();
@@ -21,6 +21,7 @@
 
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -29,32 +30,100 @@
 #include "../core/datatypes.h"
 #include "../core/settings.h"
 
-struct User_Data_Cache
+
+/* Resolves user ids to user names.
+ *
+ * The user data is indexed by the user id with the lowest eight bits cleared.
+ * A lookup reads only the index of the requested user and keeps all names found there.
+ * After MAX_LAZY_LOOKUPS distinct indexes, a query obviously prints many users,
+ * and the cache reads the whole user data at once. */
+class User_Data_Cache
 {
-  User_Data_Cache() : loaded(false) {}
-  const std::map< uint32, std::string >& users(Transaction& transaction);
+public:
+  User_Data_Cache() : transaction(0), lazy_lookups(0), loaded(false) {}
+
+  const User_Data_Cache& users(Transaction& transaction);
+
+  // Returns 0 if the user id is unknown.
+  const std::string* get_name(uint32 user_id) const;
+
+  static const uint MAX_LAZY_LOOKUPS = 64;
 
 private:
-  std::map< uint32, std::string > users_;
-  bool loaded;
+  Transaction* transaction;
+  mutable std::map< uint32, std::string > users_;
+  mutable std::set< Uint32_Index > loaded_idxs;
+  mutable uint lazy_lookups;
+  mutable bool loaded;
+
+  void load_idx(Uint32_Index idx) const;
+  void load_all() const;
 };
 
 
-inline const std::map< uint32, std::string >& User_Data_Cache::users(
-    Transaction& transaction)
+inline const User_Data_Cache& User_Data_Cache::users(Transaction& transaction_)
 {
-  if (!loaded)
+  if (transaction != &transaction_)
   {
-    Block_Backend< Uint32_Index, User_Data > user_db
-        (transaction.data_index(meta_settings().USER_DATA));
-    for (Block_Backend< Uint32_Index, User_Data >::Flat_Iterator it = user_db.flat_begin();
-        !(it == user_db.flat_end()); ++it)
-      users_[it.object().id] = it.object().name;
+    transaction = &transaction_;
+    users_.clear();
+    loaded_idxs.clear();
+    lazy_lookups = 0;
+    loaded = false;
+  }
+  return *this;
+}
+
 
-    loaded = true;
+inline const std::string* User_Data_Cache::get_name(uint32 user_id) const
+{
+  if (!transaction)
+    return 0;
+
+  if (!loaded)
+  {
+    Uint32_Index idx(user_id & 0xffffff00);
+    if (loaded_idxs.find(idx) == loaded_idxs.end())
+    {
+      if (lazy_lookups < MAX_LAZY_LOOKUPS)
+        load_idx(idx);
+      else
+        load_all();
+    }
   }
 
-  return users_;
+  std::map< uint32, std::string >::const_iterator it = users_.find(user_id);
+  if (it == users_.end())
+    return 0;
+  return &it->second;
+}
+
+
+inline void User_Data_Cache::load_idx(Uint32_Index idx) const
+{
+  std::set< Uint32_Index > req;
+  req.insert(idx);
+
+  Block_Backend< Uint32_Index, User_Data > user_db
+      (transaction->data_index(meta_settings().USER_DATA));
+  for (Block_Backend< Uint32_Index, User_Data >::Discrete_Iterator
+      it(user_db.discrete_begin(req.begin(), req.end())); !(it == user_db.discrete_end()); ++it)
+    users_[it.object().id] = it.object().name;
+
+  loaded_idxs.insert(idx);
+  ++lazy_lookups;
+}
+
+
+inline void User_Data_Cache::load_all() const
+{
+  Block_Backend< Uint32_Index, User_Data > user_db
+      (transaction->data_index(meta_settings().USER_DATA));
+  for (Block_Backend< Uint32_Index, User_Data >::Flat_Iterator it = user_db.flat_begin();
+      !(it == user_db.flat_end()); ++it)
+    users_[it.object().id] = it.object().name;
+
+  loaded = true;
 }
 
 
@@ -182,6 +182,7 @@ int main(int argc, char* argv[])
   uint64 max_allowed_space = 0;
   uint64 max_allowed_time_units = 0;
   int rate_limit = -1;
+  uint64 block_cache_size = 0;
 
   int argpos(1);
   while (argpos < argc)
@@ -218,6 +219,8 @@ int main(int argc, char* argv[])
       max_allowed_time_units = atoll(((std::string)argv[argpos]).substr(7).c_str());
     else if (!(strncmp(argv[argpos], "--rate-limit=", 13)))
       rate_limit = atoll(((std::string)argv[argpos]).substr(13).c_str());
+    else if (!(strncmp(argv[argpos], "--block-cache=", 14)))
+      block_cache_size = atoll(((std::string)argv[argpos]).substr(14).c_str())*1024*1024;
     else
     {
       std::cout<<"Unknown argument: "<<argv[argpos]<<"\n\n"
@@ -236,7 +239,8 @@ int main(int argc, char* argv[])
       "  --query_token: Returns the pid of a running query for the same client IP.\n"
       "  --space=number: Set the memory limit for the total of all running processes to this value in bytes.\n"
       "  --time=number: Set the time unit  limit for the total of all running processes to this value in bytes.\n"
-      "  --rate-limit=number: Set the maximum allowed number of concurrent accesses from a single IP.\n";
+      "  --rate-limit=number: Set the maximum allowed number of concurrent accesses from a single IP.\n"
+      "  --block-cache=number: Share this many megabytes of decompressed blocks between the running processes.\n";
 
       return 0;
     }
@@ -401,6 +405,10 @@ int main(int argc, char* argv[])
     files_to_manage.push_back(osm_base_settings().RELATION_TAGS_LOCAL);
     files_to_manage.push_back(osm_base_settings().RELATION_TAGS_GLOBAL);
     files_to_manage.push_back(osm_base_settings().RELATION_KEYS);
+    files_to_manage.push_back(osm_base_settings().NODE_WAYS);
+    files_to_manage.push_back(osm_base_settings().NODE_RELATIONS);
+    files_to_manage.push_back(osm_base_settings().WAY_RELATIONS);
+    files_to_manage.push_back(osm_base_settings().RELATION_RELATIONS);
 
     std::vector< File_Properties* >* file_target = (meta || attic) ? &files_to_manage : &files_to_avoid;
 
@@ -435,6 +443,10 @@ int main(int argc, char* argv[])
     file_target->push_back(attic_settings().RELATION_TAGS_GLOBAL);
     file_target->push_back(attic_settings().RELATIONS_META);
     file_target->push_back(attic_settings().RELATION_CHANGELOG);
+    file_target->push_back(attic_settings().NODE_WAYS);
+    file_target->push_back(attic_settings().NODE_RELATIONS);
+    file_target->push_back(attic_settings().WAY_RELATIONS);
+    file_target->push_back(attic_settings().RELATION_RELATIONS);
 
     suspicious_files_present |= assure_files_absent(db_dir, files_to_avoid, "--attic");
   }
@@ -483,7 +495,7 @@ int main(int argc, char* argv[])
 	 areas ? area_settings().purge_timeout : osm_base_settings().purge_timeout,
 	 max_allowed_space,
 	 max_allowed_time_units,
-	 files_to_manage, &disp_logger);
+	 files_to_manage, &disp_logger, block_cache_size);
     if (rate_limit > -1)
       dispatcher.set_rate_limit(rate_limit);
     dispatcher.standby_loop(0);
@@ -87,12 +87,89 @@ void set_limits(uint32 time, uint64 space)
 }
 
 
+void load_osm_base_indexes(Transaction& transaction, meta_modes meta)
+{
+  transaction.data_index(osm_base_settings().NODES);
+  transaction.random_index(osm_base_settings().NODES);
+  transaction.data_index(osm_base_settings().NODE_TAGS_LOCAL);
+  transaction.data_index(osm_base_settings().NODE_TAGS_GLOBAL);
+  transaction.data_index(osm_base_settings().NODE_KEYS);
+  transaction.data_index(osm_base_settings().WAYS);
+  transaction.random_index(osm_base_settings().WAYS);
+  transaction.data_index(osm_base_settings().WAY_TAGS_LOCAL);
+  transaction.data_index(osm_base_settings().WAY_TAGS_GLOBAL);
+  transaction.data_index(osm_base_settings().WAY_KEYS);
+  transaction.data_index(osm_base_settings().RELATIONS);
+  transaction.random_index(osm_base_settings().RELATIONS);
+  transaction.data_index(osm_base_settings().RELATION_ROLES);
+  transaction.data_index(osm_base_settings().RELATION_TAGS_LOCAL);
+  transaction.data_index(osm_base_settings().RELATION_TAGS_GLOBAL);
+  transaction.data_index(osm_base_settings().RELATION_KEYS);
+  transaction.data_index(osm_base_settings().NODE_WAYS);
+  transaction.data_index(osm_base_settings().NODE_RELATIONS);
+  transaction.data_index(osm_base_settings().WAY_RELATIONS);
+  transaction.data_index(osm_base_settings().RELATION_RELATIONS);
+
+  if (meta == keep_meta || meta == keep_attic)
+  {
+    for (uint i = 0; i < meta_settings().idxs().size(); ++i)
+      transaction.data_index(meta_settings().idxs()[i]);
+  }
+
+  if (meta == keep_attic)
+  {
+    for (uint i = 0; i < meta_settings().idxs().size(); ++i)
+      transaction.data_index(meta_settings().idxs()[i]);
+    for (uint i = 0; i < attic_settings().idxs().size(); ++i)
+      transaction.data_index(attic_settings().idxs()[i]);
+  }
+}
+
+
+bool Index_Snapshot::refresh()
+{
+  if (transaction && probe_commit_counter(osm_base_settings().shared_name) == commit_counter)
+    return false;
+
+  Dispatcher_Client dispatcher_client(osm_base_settings().shared_name);
+  Logger logger(dispatcher_client.get_db_dir());
+  logger.annotated_log("Index_Snapshot::refresh() start");
+
+  dispatcher_client.request_read_and_idx(0, 0, 0);
+  Nonsynced_Transaction* new_transaction = 0;
+  try
+  {
+    new_transaction = new Nonsynced_Transaction(false, false, dispatcher_client.get_db_dir(), "");
+    load_osm_base_indexes(*new_transaction, keep_attic);
+  }
+  catch (...)
+  {
+    delete new_transaction;
+    dispatcher_client.read_finished();
+    throw;
+  }
+  // The dispatcher does not commit while we are registered as reading the index,
+  // hence the counter matches exactly the loaded version.
+  uint32 new_commit_counter = dispatcher_client.get_commit_counter();
+  dispatcher_client.read_idx_finished();
+  dispatcher_client.read_finished();
+
+  delete transaction;
+  transaction = new_transaction;
+  commit_counter = new_commit_counter;
+
+  logger.annotated_log("Index_Snapshot::refresh() end");
+  return true;
+}
+
+
 Dispatcher_Stub::Dispatcher_Stub
     (std::string db_dir_, Error_Output* error_output_, std::string xml_raw, meta_modes meta_, int area_level,
-     uint32 max_allowed_time, uint64 max_allowed_space, Parsed_Query& global_settings)
+     uint32 max_allowed_time, uint64 max_allowed_space, Parsed_Query& global_settings,
+     const Index_Snapshot* snapshot)
     : db_dir(db_dir_), error_output(error_output_),
       dispatcher_client(0), area_dispatcher_client(0),
-      transaction(0), area_transaction(0), rman(0), meta(meta_), client_token(0)
+      transaction(0), area_transaction(0), owns_transaction(true), rman(0), meta(meta_), client_token(0)
 {
   if (max_allowed_time > 0)
     set_limits(2*max_allowed_time + 60, 2*max_allowed_space + 1024*1024*1024);
@@ -106,7 +183,15 @@ Dispatcher_Stub::Dispatcher_Stub
     {
       logger.annotated_log("request_read_and_idx() start");
       dispatcher_client->request_read_and_idx(max_allowed_time, max_allowed_space, client_token);
-      logger.annotated_log("request_read_and_idx() end");
+      if (dispatcher_client->get_queue_position() > 0)
+      {
+        std::ostringstream out;
+        out<<"request_read_and_idx() end, queued at position "<<dispatcher_client->get_queue_position()
+            <<" eta "<<dispatcher_client->get_queue_eta();
+        logger.annotated_log(out.str());
+      }
+      else
+        logger.annotated_log("request_read_and_idx() end");
     }
     catch (const File_Error& e)
     {
@@ -118,38 +203,18 @@ Dispatcher_Stub::Dispatcher_Stub
       logger.annotated_log(out.str());
       throw;
     }
-    transaction = new Nonsynced_Transaction
-        (false, false, dispatcher_client->get_db_dir(), "");
-
-    transaction->data_index(osm_base_settings().NODES);
-    transaction->random_index(osm_base_settings().NODES);
-    transaction->data_index(osm_base_settings().NODE_TAGS_LOCAL);
-    transaction->data_index(osm_base_settings().NODE_TAGS_GLOBAL);
-    transaction->data_index(osm_base_settings().NODE_KEYS);
-    transaction->data_index(osm_base_settings().WAYS);
-    transaction->random_index(osm_base_settings().WAYS);
-    transaction->data_index(osm_base_settings().WAY_TAGS_LOCAL);
-    transaction->data_index(osm_base_settings().WAY_TAGS_GLOBAL);
-    transaction->data_index(osm_base_settings().WAY_KEYS);
-    transaction->data_index(osm_base_settings().RELATIONS);
-    transaction->random_index(osm_base_settings().RELATIONS);
-    transaction->data_index(osm_base_settings().RELATION_ROLES);
-    transaction->data_index(osm_base_settings().RELATION_TAGS_LOCAL);
-    transaction->data_index(osm_base_settings().RELATION_TAGS_GLOBAL);
-    transaction->data_index(osm_base_settings().RELATION_KEYS);
-
-    if (meta == keep_meta || meta == keep_attic)
+    Nonsynced_Transaction* snapshot_transaction =
+        snapshot ? snapshot->get_transaction(dispatcher_client->get_commit_counter()) : 0;
+    if (snapshot_transaction)
     {
-      for (uint i = 0; i < meta_settings().idxs().size(); ++i)
-        transaction->data_index(meta_settings().idxs()[i]);
+      transaction = snapshot_transaction;
+      owns_transaction = false;
     }
-
-    if (meta == keep_attic)
+    else
     {
-      for (uint i = 0; i < meta_settings().idxs().size(); ++i)
-        transaction->data_index(meta_settings().idxs()[i]);
-      for (uint i = 0; i < attic_settings().idxs().size(); ++i)
-        transaction->data_index(attic_settings().idxs()[i]);
+      transaction = new Nonsynced_Transaction
+          (false, false, dispatcher_client->get_db_dir(), "");
+      load_osm_base_indexes(*transaction, meta);
     }
 
     {
@@ -367,7 +432,7 @@ Dispatcher_Stub::~Dispatcher_Stub()
   bool areas_written = (rman->area_updater() != 0);
   std::vector< uint64 > cpu_runtime = rman ? rman->cpu_time() : std::vector< uint64 >();
   delete rman;
-  if (transaction)
+  if (transaction && owns_transaction)
     delete transaction;
   if (area_transaction)
     delete area_transaction;
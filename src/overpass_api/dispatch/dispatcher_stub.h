@@ -42,15 +42,48 @@
 struct Exit_Error {};
 
 
+// Keeps the index files of the osm base database loaded between queries.
+// A long-running query worker refreshes it whenever the dispatcher has committed,
+// and the Dispatcher_Stub of each query reuses it if it is still current.
+class Index_Snapshot
+{
+  public:
+    Index_Snapshot() : transaction(0), commit_counter(0) {}
+    ~Index_Snapshot() { delete transaction; }
+
+    // Reloads all index files if the dispatcher has committed since the last call.
+    // Returns true if the index files have been reloaded.
+    bool refresh();
+
+    // Returns the loaded transaction if it belongs to the database version with the given
+    // commit counter and zero otherwise.
+    Nonsynced_Transaction* get_transaction(uint32 current_commit_counter) const
+    { return transaction && current_commit_counter == commit_counter ? transaction : 0; }
+
+  private:
+    Index_Snapshot(const Index_Snapshot&);
+    Index_Snapshot& operator=(const Index_Snapshot&);
+
+    Nonsynced_Transaction* transaction;
+    uint32 commit_counter;
+};
+
+
+// Loads all index files of the osm base database that a query with the given meta mode may use.
+void load_osm_base_indexes(Transaction& transaction, meta_modes meta);
+
+
 class Dispatcher_Stub : public Watchdog_Callback
 {
   public:
     // Opens the connection to the database, sets db_dir accordingly
     // and registers the process. error_output_ must remain valid over the
-    // entire lifetime of this object.
+    // entire lifetime of this object. If snapshot is nonzero and still current,
+    // its index files are used instead of loading them again.
     Dispatcher_Stub(std::string db_dir_, Error_Output* error_output_, std::string xml_raw,
 		    meta_modes meta_, int area_level,
-		    uint32 max_allowed_time, uint64 max_allowed_space, Parsed_Query& global_settings_);
+		    uint32 max_allowed_time, uint64 max_allowed_space, Parsed_Query& global_settings_,
+		    const Index_Snapshot* snapshot = 0);
 
     // Called once per minute from the resource manager
     virtual void ping() const;
@@ -74,6 +107,7 @@ class Dispatcher_Stub : public Watchdog_Callback
     Dispatcher_Client* area_dispatcher_client;
     Nonsynced_Transaction* transaction;
     Nonsynced_Transaction* area_transaction;
+    bool owns_transaction;
     Resource_Manager* rman;
     meta_modes meta;
 
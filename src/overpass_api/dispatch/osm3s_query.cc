@@ -98,44 +98,30 @@ int main(int argc, char *argv[])
       xml_raw = ((std::string)argv[argpos]).substr(10);
     else if (!(strncmp(argv[argpos], "--clone-compression=", 20)))
     {
-      if (std::string(argv[argpos]).substr(20) == "no")
-        clone_settings.compression_method = File_Blocks_Index< Uint31_Index >::NO_COMPRESSION;
-      else if (std::string(argv[argpos]).substr(20) == "gz")
-        clone_settings.compression_method = File_Blocks_Index< Uint31_Index >::ZLIB_COMPRESSION;
-#ifdef HAVE_LZ4
-      else if (std::string(argv[argpos]).substr(20) == "lz4")
-        clone_settings.compression_method = File_Blocks_Index< Uint31_Index >::LZ4_COMPRESSION;
-#endif
-      else
+      int method = compression_method_from_name(std::string(argv[argpos]).substr(20));
+      if (method == File_Blocks_Index_Base::USE_DEFAULT)
       {
-#ifdef HAVE_LZ4
-        std::cerr<<"For --clone-compression, please use \"no\", \"gz\", or \"lz4\" as value.\n";
-#else
-        std::cerr<<"For --clone-compression, please use \"no\" or \"gz\" as value.\n";
-#endif
+        std::cerr<<"For --clone-compression, please use one of "<<compression_method_names()<<" as value.\n";
         return 0;
       }
+      clone_settings.compression_method = method;
     }
     else if (!(strncmp(argv[argpos], "--clone-map-compression=", 24)))
     {
-      if (std::string(argv[argpos]).substr(24) == "no")
-        clone_settings.map_compression_method = File_Blocks_Index< Uint31_Index >::NO_COMPRESSION;
-      else if (std::string(argv[argpos]).substr(24) == "gz")
-        clone_settings.map_compression_method = File_Blocks_Index< Uint31_Index >::ZLIB_COMPRESSION;
-#ifdef HAVE_LZ4
-      else if (std::string(argv[argpos]).substr(24) == "lz4")
-        clone_settings.map_compression_method = File_Blocks_Index< Uint31_Index >::LZ4_COMPRESSION;
-#endif
-      else
+      int method = compression_method_from_name(std::string(argv[argpos]).substr(24));
+      if (method == File_Blocks_Index_Base::USE_DEFAULT)
       {
-#ifdef HAVE_LZ4
-        std::cerr<<"For --clone-map-compression, please use \"no\", \"gz\", or \"lz4\" as value.\n";
-#else
-        std::cerr<<"For --clone-map-compression, please use \"no\" or \"gz\" as value.\n";
-#endif
+        std::cerr<<"For --clone-map-compression, please use one of "<<compression_method_names()<<" as value.\n";
         return 0;
       }
+      clone_settings.map_compression_method = method;
     }
+    else if (!(strncmp(argv[argpos], "--clone-compression-level=", 26)))
+      clone_settings.compression_level = atoi(std::string(argv[argpos]).substr(26).c_str());
+#ifdef HAVE_ZSTD
+    else if (!(strcmp(argv[argpos], "--clone-dictionary")))
+      clone_settings.compression_dictionary = true;
+#endif
     else if (!(strcmp(argv[argpos], "--version")))
     {
       std::cout<<"Overpass API version "<<basic_settings().version<<" "<<basic_settings().source_hash<<"\n";
@@ -155,6 +141,10 @@ int main(int argc, char *argv[])
       "  --clone=$TARGET_DIR: Write a consistent copy of the entire database to the given $TARGET_DIR.\n"
       "  --clone-compression=$METHOD: Use a specific compression method $METHOD for clone bin files\n"
       "  --clone-map-compression=$METHOD: Use a specific compression method $METHOD for clone map files\n"
+      "  --clone-compression-level=$LEVEL: Use compression level $LEVEL for clone bin and map files\n"
+#ifdef HAVE_ZSTD
+      "  --clone-dictionary: Train a dictionary for each bin file cloned with zstd compression\n"
+#endif
       "  --rules: Ignore all time limits and allow area creation by this query.\n"
       "  --request=$QL: Use $QL instead of standard input as the request text.\n"
       "  --quiet: Don't print anything on stderr.\n"
@@ -184,6 +174,8 @@ int main(int argc, char *argv[])
       copy_file(dispatcher.resource_manager().get_transaction()->get_db_dir() + "/replicate_id",
 		clone_db_dir + "/replicate_id");
 
+      // A clone reads whole files, hence reading ahead pays off
+      block_read_ahead_enabled() = true;
       clone_database(*dispatcher.resource_manager().get_transaction(), clone_db_dir, clone_settings);
 
       return 0;
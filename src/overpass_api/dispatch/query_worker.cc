@@ -0,0 +1,257 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "query_worker.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+extern char** environ;
+
+
+namespace
+{
+  // Acknowledges that the worker has taken over the request.
+  const uint32 WORKER_ACK = 1;
+
+  volatile sig_atomic_t terminate_requested = 0;
+
+  void handle_sigterm(int)
+  {
+    terminate_requested = 1;
+  }
+
+
+  bool send_all(int fd, const char* buf, uint64 size)
+  {
+    while (size > 0)
+    {
+      ssize_t written = send(fd, buf, size, 0);
+      if (written <= 0)
+        return false;
+      buf += written;
+      size -= written;
+    }
+    return true;
+  }
+
+
+  bool recv_all(int fd, char* buf, uint64 size)
+  {
+    while (size > 0)
+    {
+      ssize_t bytes_read = recv(fd, buf, size, 0);
+      if (bytes_read <= 0)
+        return false;
+      buf += bytes_read;
+      size -= bytes_read;
+    }
+    return true;
+  }
+
+
+  // Receives the environment and the stdin and stdout descriptors of the front process,
+  // installs them for this process and runs the query.
+  int serve_connection(int connection_fd, const Index_Snapshot& snapshot, Query_Handler handler)
+  {
+    uint32 env_size = 0;
+    int fds[2] = { -1, -1 };
+
+    struct iovec iov;
+    iov.iov_base = &env_size;
+    iov.iov_len = sizeof(env_size);
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(connection_fd, &msg, 0) != sizeof(env_size))
+      return 1;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS
+        || cmsg->cmsg_len != CMSG_LEN(sizeof(fds)))
+      return 1;
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+    // The strings must stay valid for putenv until the process exits.
+    std::vector< char >* env_buf = new std::vector< char >(env_size + 1, 0);
+    if (!recv_all(connection_fd, &(*env_buf)[0], env_size))
+      return 1;
+
+    if (!send_all(connection_fd, (const char*)&WORKER_ACK, sizeof(WORKER_ACK)))
+      return 1;
+
+    dup2(fds[0], STDIN_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+
+    clearenv();
+    for (uint32 pos = 0; pos < env_size; pos += strlen(&(*env_buf)[pos]) + 1)
+    {
+      if ((*env_buf)[pos])
+        putenv(&(*env_buf)[pos]);
+    }
+
+    int result = handler(&snapshot);
+    std::cout.flush();
+    return result;
+  }
+}
+
+
+bool forward_to_query_worker(const std::string& socket_name)
+{
+  try
+  {
+    Unix_Socket socket(socket_name);
+
+    std::string env_block;
+    for (char** it = environ; it && *it; ++it)
+    {
+      env_block += *it;
+      env_block += '\0';
+    }
+
+    uint32 env_size = env_block.size();
+    int fds[2] = { STDIN_FILENO, STDOUT_FILENO };
+
+    struct iovec iov;
+    iov.iov_base = &env_size;
+    iov.iov_len = sizeof(env_size);
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(socket.descriptor(), &msg, 0) != sizeof(env_size))
+      return false;
+    if (!send_all(socket.descriptor(), env_block.data(), env_block.size()))
+      return false;
+
+    // Until the worker has acknowledged, we can still answer the request ourselves.
+    uint32 ack = 0;
+    if (!recv_all(socket.descriptor(), (char*)&ack, sizeof(ack)) || ack != WORKER_ACK)
+      return false;
+
+    // The worker writes directly to our stdout. Wait until it has finished.
+    char buf[64];
+    while (recv(socket.descriptor(), buf, sizeof(buf), 0) > 0)
+      ;
+    return true;
+  }
+  catch (const File_Error& e)
+  {
+    return false;
+  }
+}
+
+
+void run_query_worker(const std::string& socket_name, uint max_children, Query_Handler handler)
+{
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGTERM, handle_sigterm);
+  signal(SIGINT, handle_sigterm);
+
+  remove(socket_name.c_str());
+  Unix_Socket socket("", max_children);
+  socket.open(socket_name);
+
+  Index_Snapshot snapshot;
+  uint running = 0;
+
+  while (!terminate_requested)
+  {
+    while (running > 0 && waitpid(-1, 0, WNOHANG) > 0)
+      --running;
+
+    try
+    {
+      snapshot.refresh();
+    }
+    catch (const File_Error& e)
+    {
+      // Without a current snapshot, the queries load the index files themselves.
+      std::cerr<<"File_Error "<<e.error_number<<' '<<strerror(e.error_number)<<' '
+          <<e.filename<<' '<<e.origin<<'\n';
+      millisleep(1000);
+    }
+
+    if (running >= max_children)
+    {
+      millisleep(10);
+      continue;
+    }
+
+    fd_set read_set;
+    FD_ZERO(&read_set);
+    FD_SET(socket.descriptor(), &read_set);
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    if (select(socket.descriptor() + 1, &read_set, 0, 0, &timeout) <= 0)
+      continue;
+
+    int connection_fd = accept(socket.descriptor(), 0, 0);
+    if (connection_fd == -1)
+      continue;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      signal(SIGTERM, SIG_DFL);
+      signal(SIGINT, SIG_DFL);
+      close(socket.descriptor());
+      int result = serve_connection(connection_fd, snapshot, handler);
+      close(STDOUT_FILENO);
+      close(connection_fd);
+      exit(result);
+    }
+    else if (pid > 0)
+      ++running;
+    close(connection_fd);
+  }
+
+  remove(socket_name.c_str());
+}
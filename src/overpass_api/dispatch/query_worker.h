@@ -0,0 +1,49 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___OVERPASS_API__DISPATCH__QUERY_WORKER_H
+#define DE__OSM3S___OVERPASS_API__DISPATCH__QUERY_WORKER_H
+
+#include "dispatcher_stub.h"
+
+#include <string>
+
+
+/* The query worker is a long-running process that keeps the index files, the settings
+ * and the statement registry loaded. A CGI front process connects to its unix socket and
+ * hands over its environment and its stdin and stdout. The worker forks for every query
+ * such that each query still runs with its own resource limits and a clean heap.
+ */
+
+
+// Called in the forked child for every query. The environment, stdin and stdout
+// are those of the CGI front process.
+typedef int (*Query_Handler)(const Index_Snapshot* snapshot);
+
+
+// Connects to the query worker on socket_name and lets it answer the current CGI request.
+// Returns false if no worker is reachable; the caller should then answer the request itself.
+bool forward_to_query_worker(const std::string& socket_name);
+
+
+// Runs the accept loop of the query worker until it receives SIGTERM.
+// At most max_children queries are executed concurrently.
+void run_query_worker(const std::string& socket_name, uint max_children, Query_Handler handler);
+
+
+#endif
@@ -21,76 +21,83 @@
 #include "../data/utils.h"
 #include "../statements/statement.h"
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 #include <sstream>
 
 
-uint64 eval_map(const std::map< Uint32_Index, std::vector< Node_Skeleton > >& nodes)
+// Bytes allocated and bytes kept free by malloc. Both are zero where the C library cannot tell.
+struct Heap_Usage
 {
-  uint64 size(0);
-  for (std::map< Uint32_Index, std::vector< Node_Skeleton > >::const_iterator
-      it(nodes.begin()); it != nodes.end(); ++it)
-    size += it->second.size()*8 + 64;
-  return size;
-}
+  Heap_Usage() : in_use(0), free(0) {}
 
+  uint64 in_use;
+  uint64 free;
+};
 
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Way_Skeleton > >& ways)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Way_Skeleton > >::const_iterator
-      it(ways.begin()); it != ways.end(); ++it)
-    size += it->second.size()*128 + 64;
-  return size;
-}
 
-
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& relations)
+Heap_Usage heap_usage()
 {
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Relation_Skeleton > >::const_iterator
-      it(relations.begin()); it != relations.end(); ++it)
-    size += it->second.size()*192 + 64;
-  return size;
+  Heap_Usage result;
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 info = mallinfo2();
+  result.in_use = info.uordblks + info.hblkhd;
+  result.free = info.fordblks;
+#endif
+  return result;
 }
 
 
-uint64 eval_map(const std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >& nodes)
-{
-  uint64 size(0);
-  for (std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >::const_iterator
-      it(nodes.begin()); it != nodes.end(); ++it)
-    size += it->second.size()*16 + 64;
-  return size;
-}
+// Estimated memory use of a single element in a Set. eval_map adds 64 bytes per index.
+template< typename Object >
+uint64 eval_elem();
 
+template< > uint64 eval_elem< Node_Skeleton >() { return 8; }
+template< > uint64 eval_elem< Way_Skeleton >() { return 128; }
+template< > uint64 eval_elem< Relation_Skeleton >() { return 192; }
+template< > uint64 eval_elem< Attic< Node_Skeleton > >() { return 16; }
+template< > uint64 eval_elem< Attic< Way_Skeleton > >() { return 136; }
+template< > uint64 eval_elem< Attic< Relation_Skeleton > >() { return 200; }
+template< > uint64 eval_elem< Area_Skeleton >() { return 128; }
 
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >& ways)
+
+template< typename Index, typename Object >
+uint64 eval_map_(const std::map< Index, std::vector< Object > >& elems)
 {
   uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >::const_iterator
-      it(ways.begin()); it != ways.end(); ++it)
-    size += it->second.size()*136 + 64;
+  for (typename std::map< Index, std::vector< Object > >::const_iterator
+      it(elems.begin()); it != elems.end(); ++it)
+    size += it->second.size()*eval_elem< Object >() + 64;
   return size;
 }
 
 
+uint64 eval_map(const std::map< Uint32_Index, std::vector< Node_Skeleton > >& nodes) { return eval_map_(nodes); }
+uint64 eval_map(const std::map< Uint31_Index, std::vector< Way_Skeleton > >& ways) { return eval_map_(ways); }
+uint64 eval_map(const std::map< Uint31_Index, std::vector< Relation_Skeleton > >& relations)
+{ return eval_map_(relations); }
+
+uint64 eval_map(const std::map< Uint32_Index, std::vector< Attic< Node_Skeleton > > >& nodes)
+{ return eval_map_(nodes); }
+uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Way_Skeleton > > >& ways)
+{ return eval_map_(ways); }
 uint64 eval_map(const std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >& relations)
-{
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >::const_iterator
-      it(relations.begin()); it != relations.end(); ++it)
-    size += it->second.size()*200 + 64;
-  return size;
-}
+{ return eval_map_(relations); }
 
+uint64 eval_map(const std::map< Uint31_Index, std::vector< Area_Skeleton > >& areas) { return eval_map_(areas); }
 
-uint64 eval_map(const std::map< Uint31_Index, std::vector< Area_Skeleton > >& areas)
+
+// Unites summand into target and adds to size what eval_map would add for the new elements
+template< typename Index, typename Object >
+bool indexed_set_union_and_eval(std::map< Index, std::vector< Object > >& target,
+    const std::map< Index, std::vector< Object > >& summand, uint64& size)
 {
-  uint64 size(0);
-  for (std::map< Uint31_Index, std::vector< Area_Skeleton > >::const_iterator
-      it(areas.begin()); it != areas.end(); ++it)
-    size += it->second.size()*128 + 64;
-  return size;
+  Set_Growth growth;
+  bool result = indexed_set_union(target, summand, &growth);
+  size += growth.idxs*64 + growth.elems*eval_elem< Object >();
+  return result;
 }
 
 
@@ -102,7 +109,7 @@ uint64 eval_set(const Set& set_)
 }
 
 
-Set* Runtime_Stack_Frame::get_set(const std::string& set_name)
+const Set* Runtime_Stack_Frame::get_set(const std::string& set_name)
 {
   std::map< std::string, Set >::iterator it = sets.find(set_name);
   if (it != sets.end())
@@ -150,6 +157,7 @@ void Runtime_Stack_Frame::swap_diff_set(const std::string& set_name, Diff_Set& s
 {
   sets.erase(set_name);
   key_values.erase(set_name);
+  size_per_set[set_name] = 0;
   Diff_Set& to_swap = diff_sets[set_name];
   set_.swap(to_swap);
 }
@@ -213,7 +221,7 @@ void Runtime_Stack_Frame::clear_sets()
 
 void Runtime_Stack_Frame::copy_outward(const std::string& inner_set_name, const std::string& top_set_name)
 {
-  Set* from = 0;
+  const Set* from = 0;
 
   if (parent)
     from = parent->get_set(inner_set_name);
@@ -267,25 +275,26 @@ void Runtime_Stack_Frame::move_outward(const std::string& inner_set_name, const
 bool Runtime_Stack_Frame::union_inward(const std::string& top_set_name, const std::string& inner_set_name)
 {
   bool new_elements_found = false;
-  Set* source = get_set(top_set_name);
+  const Set* source = get_set(top_set_name);
 
   if (source && parent)
   {
     Set& target = parent->sets[inner_set_name];
+    // Every other function that changes a set recomputes its size with eval_set,
+    // hence it suffices to add the size of the new elements
+    uint64& size = parent->size_per_set[inner_set_name];
 
-    new_elements_found |= indexed_set_union(target.nodes, source->nodes);
-    new_elements_found |= indexed_set_union(target.attic_nodes, source->attic_nodes);
+    new_elements_found |= indexed_set_union_and_eval(target.nodes, source->nodes, size);
+    new_elements_found |= indexed_set_union_and_eval(target.attic_nodes, source->attic_nodes, size);
 
-    new_elements_found |= indexed_set_union(target.ways, source->ways);
-    new_elements_found |= indexed_set_union(target.attic_ways, source->attic_ways);
+    new_elements_found |= indexed_set_union_and_eval(target.ways, source->ways, size);
+    new_elements_found |= indexed_set_union_and_eval(target.attic_ways, source->attic_ways, size);
 
-    new_elements_found |= indexed_set_union(target.relations, source->relations);
-    new_elements_found |= indexed_set_union(target.attic_relations, source->attic_relations);
+    new_elements_found |= indexed_set_union_and_eval(target.relations, source->relations, size);
+    new_elements_found |= indexed_set_union_and_eval(target.attic_relations, source->attic_relations, size);
 
-    new_elements_found |= indexed_set_union(target.areas, source->areas);
+    new_elements_found |= indexed_set_union_and_eval(target.areas, source->areas, size);
     new_elements_found |= indexed_set_union(target.deriveds, source->deriveds);
-
-    parent->size_per_set[inner_set_name] = eval_set(target);
   }
   parent->diff_sets.erase(inner_set_name);
   parent->key_values.erase(top_set_name);
@@ -302,7 +311,7 @@ void Runtime_Stack_Frame::copy_inward(const std::string& top_set_name, const std
   std::map< std::string, Set >::iterator it = sets.find(top_set_name);
   if (it == sets.end())
   {
-    Set* source = parent->get_set(top_set_name);
+    const Set* source = parent->get_set(top_set_name);
     if (!source)
       parent->sets[inner_set_name] = Set();
     else if (source != &parent->sets[inner_set_name])
@@ -310,6 +319,7 @@ void Runtime_Stack_Frame::copy_inward(const std::string& top_set_name, const std
   }
   else
     parent->sets[inner_set_name] = it->second;
+  parent->size_per_set[inner_set_name] = eval_set(parent->sets[inner_set_name]);
 
   parent->diff_sets.erase(inner_set_name);
   parent->key_values.erase(inner_set_name);
@@ -318,7 +328,7 @@ void Runtime_Stack_Frame::copy_inward(const std::string& top_set_name, const std
 
 void Runtime_Stack_Frame::substract_from_inward(const std::string& top_set_name, const std::string& inner_set_name)
 {
-  Set* source = get_set(top_set_name);
+  const Set* source = get_set(top_set_name);
 
   if (source && parent)
   {
@@ -406,7 +416,8 @@ Resource_Manager::Resource_Manager(
         area_transaction(0), area_updater_(0),
         watchdog(watchdog_), global_settings(global_settings_), global_settings_owned(false),
 	start_time(time(NULL)), last_ping_time(0), last_report_time(0),
-	max_allowed_time(0), max_allowed_space(0)
+	max_allowed_time(0), max_allowed_space(0),
+	heap_base(heap_usage().in_use), heap_in_use(0), free_at_last_trim(0)
 {
   if (!global_settings)
   {
@@ -425,7 +436,8 @@ Resource_Manager::Resource_Manager(
       area_transaction(&area_transaction_), area_updater_(area_updater__),
       watchdog(watchdog_), global_settings(&global_settings_), global_settings_owned(false),
       start_time(time(NULL)), last_ping_time(0), last_report_time(0),
-      max_allowed_time(0), max_allowed_space(0)
+      max_allowed_time(0), max_allowed_space(0),
+      heap_base(heap_usage().in_use), heap_in_use(0), free_at_last_trim(0)
 {
   runtime_stack.push_back(new Runtime_Stack_Frame());
 }
@@ -629,6 +641,26 @@ void Resource_Manager::log_and_display_error(std::string message)
 }
 
 
+void Resource_Manager::check_heap()
+{
+  // maxsize keeps referring to the estimate of the sets. The heap also holds tags, geometries and buffers,
+  // hence it is only reported, such that existing limits keep their meaning.
+  Heap_Usage heap = heap_usage();
+  heap_in_use = (heap.in_use > heap_base ? heap.in_use - heap_base : 0);
+
+  // Give the pages of the sets that died since the last call back to the operating system
+  if (heap.free > free_at_last_trim + 64*1024*1024)
+  {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    free_at_last_trim = heap_usage().free;
+  }
+  else if (heap.free < free_at_last_trim)
+    free_at_last_trim = heap.free;
+}
+
+
 bool Resource_Manager::health_check(const Statement& stmt, uint32 extra_time, uint64 extra_space)
 {
   bool extra_space_uses_half_empty = false;
@@ -652,6 +684,7 @@ bool Resource_Manager::health_check(const Statement& stmt, uint32 extra_time, ui
 	     runtime_stack.back()->stack_progress());
       }
       last_report_time = elapsed_time;
+      check_heap();
     }
   }
 
@@ -666,6 +699,7 @@ bool Resource_Manager::health_check(const Statement& stmt, uint32 extra_time, ui
 
   if (elapsed_time > max_allowed_time || size > max_allowed_space)
   {
+    check_heap();
     if (error_output)
     {
       error_output->display_statement_progress
@@ -687,7 +721,7 @@ bool Resource_Manager::health_check(const Statement& stmt, uint32 extra_time, ui
     else
       out<<"Oversized:";
     out<<" runtime "<<error.runtime<<" seconds, size "<<error.size<<" bytes, "
-        "in line "<<error.line_number<<", statement "<<error.stmt_name;
+        "heap "<<heap_in_use<<" bytes, in line "<<error.line_number<<", statement "<<error.stmt_name;
     logger.annotated_log(out.str());
 
     throw error;
@@ -56,7 +56,8 @@ public:
   // Returns the used RAM including the used RAM of parent frames
   uint64 total_used_space() const;
 
-  Set* get_set(const std::string& set_name);
+  // Sets can only be changed through the functions below, because each of them keeps size_per_set up to date
+  const Set* get_set(const std::string& set_name);
   Diff_Set* get_diff_set(const std::string& set_name);
   const std::string* get_value(const std::string& set_name, const std::string& key);
   const std::map< std::string, std::string >* get_set_key_values(const std::string& set_name);
@@ -165,6 +166,10 @@ public:
     max_allowed_space = max_allowed_space_;
   }
 
+  // Bytes allocated by this process since the resource manager has been created, as seen by the last progress report.
+  // This is reported alongside the estimate but does not count against maxsize.
+  uint64 get_heap_in_use() const { return heap_in_use; }
+
   Transaction* get_transaction() { return transaction; }
   Transaction* get_area_transaction() { return area_transaction; }
 
@@ -179,13 +184,16 @@ public:
   void switch_diff_show_from(const std::string& diff_set_name);
   void switch_diff_show_to(const std::string& diff_set_name);
 
-  const std::map< uint32, std::string >& users() { return user_data_cache.users(*transaction); }
+  const User_Data_Cache& users() { return user_data_cache.users(*transaction); }
 
   void start_cpu_timer(uint index);
   void stop_cpu_timer(uint index);
   const std::vector< uint64 >& cpu_time() const { return cpu_runtime; }
 
 private:
+  // Walking the heap costs time proportional to its free chunks, hence this runs only with the progress report
+  void check_heap();
+
   std::vector< Runtime_Stack_Frame* > runtime_stack;
 
   Transaction* transaction;
@@ -201,6 +209,9 @@ private:
   uint32 last_report_time;
   uint32 max_allowed_time;
   uint64 max_allowed_space;
+  uint64 heap_base;
+  uint64 heap_in_use;
+  uint64 free_at_last_trim;
 
   std::vector< clock_t > cpu_start_time;
   std::vector< uint64 > cpu_runtime;
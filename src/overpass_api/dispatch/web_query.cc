@@ -16,6 +16,7 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "query_worker.h"
 #include "resource_manager.h"
 #include "scripting_core.h"
 #include "../frontend/web_output.h"
@@ -44,7 +45,7 @@
 #include <vector>
 
 
-int main(int argc, char *argv[])
+int execute_web_query(const Index_Snapshot* snapshot)
 {
   Parsed_Query global_settings;
   Web_Output error_output(Error_Output::ASSISTING);
@@ -93,7 +94,7 @@ int main(int argc, char *argv[])
       int area_level = determine_area_level(&error_output, 0);
       Dispatcher_Stub dispatcher("", &error_output, global_settings.get_input_params().find("data")->second,
 			         get_uses_meta_data(), area_level,
-				 max_allowed_time, max_allowed_space, global_settings);
+				 max_allowed_time, max_allowed_space, global_settings, snapshot);
       if (osm_script && osm_script->get_desired_timestamp())
         dispatcher.resource_manager().set_desired_timestamp(osm_script->get_desired_timestamp());
 
@@ -188,3 +189,38 @@ int main(int argc, char *argv[])
 
   return 0;
 }
+
+
+int main(int argc, char *argv[])
+{
+  std::string worker_socket;
+  uint max_children = osm_base_settings().max_num_processes;
+
+  int argpos = 1;
+  while (argpos < argc)
+  {
+    if (!(strncmp(argv[argpos], "--worker=", 9)))
+      worker_socket = ((std::string)argv[argpos]).substr(9);
+    else if (!(strncmp(argv[argpos], "--max-children=", 15)))
+      max_children = atoi(((std::string)argv[argpos]).substr(15).c_str());
+    ++argpos;
+  }
+
+  if (worker_socket != "")
+  {
+    // Initialize the settings before forking such that all queries share them.
+    osm_base_settings();
+    meta_settings();
+    attic_settings();
+    area_settings();
+    run_query_worker(worker_socket, max_children > 0 ? max_children : 1, &execute_web_query);
+    return 0;
+  }
+
+  // If the web server announces a query worker, let it answer the request.
+  char* worker_socket_c = getenv("OVERPASS_QUERY_WORKER");
+  if (worker_socket_c && forward_to_query_worker(worker_socket_c))
+    return 0;
+
+  return execute_web_query(0);
+}
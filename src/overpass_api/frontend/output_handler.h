@@ -22,6 +22,7 @@
 
 #include "../core/datatypes.h"
 #include "../core/geometry.h"
+#include "../data/user_data_cache.h"
 
 
 struct Output_Mode
@@ -70,7 +71,7 @@ public:
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action = keep,
       const Node_Skeleton* new_skel = 0,
@@ -82,7 +83,7 @@ public:
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action = keep,
       const Way_Skeleton* new_skel = 0,
@@ -95,7 +96,7 @@ public:
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action = keep,
       const Relation_Skeleton* new_skel = 0,
@@ -0,0 +1,209 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../template_db/block_backend.h"
+#include "../../template_db/dispatcher_client.h"
+#include "../../template_db/transaction.h"
+#include "../core/settings.h"
+#include "../frontend/output.h"
+#include "basic_updater.h"
+
+
+/* Adds to keyframes the keyframes for the deltas of a single index. A delta only refers to a version
+ * in the same index, hence the chain of each object ends at its current skeleton in this index
+ * or at a full delta. Returns the number of added keyframes. */
+template< typename Skeleton >
+uint32 keyframes_of_index(Uint31_Index idx, const std::vector< Skeleton >& references,
+    std::vector< Attic< typename Skeleton::Delta > >& deltas,
+    std::map< Uint31_Index, std::set< Attic< typename Skeleton::Delta > > >& keyframes)
+{
+  typedef Attic< typename Skeleton::Delta > Attic_Delta;
+
+  // Ordered by id and then from the oldest to the youngest version
+  std::sort(deltas.begin(), deltas.end());
+
+  std::map< Uint31_Index, std::set< Attic_Delta > > found;
+  std::vector< std::pair< Uint31_Index, const Attic_Delta* > > chain;
+  typename std::vector< Skeleton >::const_iterator ref_it = references.begin();
+  for (typename std::vector< Attic_Delta >::const_iterator it = deltas.begin(); it != deltas.end(); ++it)
+  {
+    chain.push_back(std::make_pair(idx, &*it));
+    typename std::vector< Attic_Delta >::const_iterator next = it;
+    ++next;
+    if (next != deltas.end() && next->id == it->id)
+      continue;
+
+    while (ref_it != references.end() && ref_it->id < it->id)
+      ++ref_it;
+    add_keyframes(ref_it != references.end() && ref_it->id == it->id ? *ref_it : Skeleton(),
+        chain, Delta_Run(), found);
+    chain.clear();
+  }
+
+  uint32 count = 0;
+  for (typename std::map< Uint31_Index, std::set< Attic_Delta > >::const_iterator it = found.begin();
+      it != found.end(); ++it)
+  {
+    keyframes[it->first].insert(it->second.begin(), it->second.end());
+    count += it->second.size();
+  }
+  return count;
+}
+
+
+/* Rewrites the attic deltas of one type such that they contain keyframes as if they had been written
+ * with the current keyframe settings. The file is processed in batches of whole indexes. */
+template< typename Skeleton >
+void backfill_keyframes(Transaction& transaction,
+    const File_Properties& current_file_properties, const File_Properties& attic_file_properties)
+{
+  typedef Attic< typename Skeleton::Delta > Attic_Delta;
+
+  Uint31_Index start(0u);
+  bool finished = false;
+  while (!finished)
+  {
+    std::map< Uint31_Index, std::set< Attic_Delta > > keyframes;
+    uint32 count = 0;
+    finished = true;
+    {
+      std::set< std::pair< Uint31_Index, Uint31_Index > > range;
+      range.insert(std::make_pair(start, Uint31_Index(0xffffffffu)));
+
+      Block_Backend< Uint31_Index, Skeleton > current_db(transaction.data_index(&current_file_properties));
+      typename Block_Backend< Uint31_Index, Skeleton >::Range_Iterator current_it
+          = current_db.range_begin(Default_Range_Iterator< Uint31_Index >(range.begin()),
+              Default_Range_Iterator< Uint31_Index >(range.end()));
+      Block_Backend< Uint31_Index, Attic_Delta > attic_db(transaction.data_index(&attic_file_properties));
+      typename Block_Backend< Uint31_Index, Attic_Delta >::Range_Iterator attic_it
+          = attic_db.range_begin(Default_Range_Iterator< Uint31_Index >(range.begin()),
+              Default_Range_Iterator< Uint31_Index >(range.end()));
+
+      while (!(attic_it == attic_db.range_end()))
+      {
+        Uint31_Index idx = attic_it.index();
+        if (count >= 64*1024)
+        {
+          start = idx;
+          finished = false;
+          break;
+        }
+
+        std::vector< Attic_Delta > deltas;
+        std::vector< typename Skeleton::Id_Type > delta_ids;
+        while (!(attic_it == attic_db.range_end()) && attic_it.index() == idx)
+        {
+          deltas.push_back(attic_it.object());
+          delta_ids.push_back(attic_it.object().id);
+          ++attic_it;
+        }
+        std::sort(delta_ids.begin(), delta_ids.end());
+
+        // Only the current skeletons that are the reference of a delta need to be decoded
+        while (!(current_it == current_db.range_end()) && current_it.index() < idx)
+          ++current_it;
+        std::vector< Skeleton > references;
+        while (!(current_it == current_db.range_end()) && current_it.index() == idx)
+        {
+          if (std::binary_search(delta_ids.begin(), delta_ids.end(), current_it.handle().id()))
+            references.push_back(current_it.object());
+          ++current_it;
+        }
+        std::sort(references.begin(), references.end());
+
+        count += keyframes_of_index(idx, references, deltas, keyframes);
+      }
+    }
+
+    Block_Backend< Uint31_Index, Attic_Delta > attic_db(transaction.data_index(&attic_file_properties));
+    attic_db.update(keyframes, keyframes);
+    std::cerr<<'.';
+  }
+}
+
+
+int main(int argc, char* argv[])
+{
+  std::string db_dir;
+  bool abort = false;
+
+  int argpos = 1;
+  while (argpos < argc)
+  {
+    if (!(strncmp(argv[argpos], "--db-dir=", 9)))
+    {
+      db_dir = ((std::string)argv[argpos]).substr(9);
+      if ((db_dir.size() > 0) && (db_dir[db_dir.size()-1] != '/'))
+	db_dir += '/';
+    }
+    else if (!(strncmp(argv[argpos], "--keyframe-interval=", 20)))
+      basic_settings().attic_keyframe_interval = atoi(std::string(argv[argpos]).substr(20).c_str());
+    else
+    {
+      std::cerr<<"Unkown argument: "<<argv[argpos]<<'\n';
+      abort = true;
+    }
+    ++argpos;
+  }
+  if (abort || db_dir.empty() || basic_settings().attic_keyframe_interval == 0)
+  {
+    std::cerr<<"Usage: "<<argv[0]<<" --db-dir=DIR [--keyframe-interval=VERSIONS]\n"
+        "Adds keyframes to the attic ways and relations of an existing database.\n"
+        "The database must not be served by a dispatcher or updated while this runs.\n";
+    return 1;
+  }
+
+  try
+  {
+    // The deltas are rewritten in place, hence no dispatcher must serve or update this database meanwhile
+    if (file_present(db_dir + osm_base_settings().shared_name))
+      throw Context_Error("File " + db_dir + osm_base_settings().shared_name + " present, "
+          "which indicates a running dispatcher. Delete file if no dispatcher is running.");
+
+    Nonsynced_Transaction transaction(true, false, db_dir, "");
+
+    std::cerr<<"Adding keyframes to ways ";
+    backfill_keyframes< Way_Skeleton >(transaction, *osm_base_settings().WAYS, *attic_settings().WAYS);
+    std::cerr<<" done.\nAdding keyframes to relations ";
+    backfill_keyframes< Relation_Skeleton >(
+        transaction, *osm_base_settings().RELATIONS, *attic_settings().RELATIONS);
+    std::cerr<<" done.\n";
+  }
+  catch (Context_Error e)
+  {
+    std::cerr<<"Context error: "<<e.message<<'\n';
+    return 3;
+  }
+  catch (File_Error e)
+  {
+    report_file_error(e);
+    return 2;
+  }
+
+  return 0;
+}
@@ -20,12 +20,14 @@
 #define DE__OSM3S___OVERPASS_API__OSM_BACKEND__BASIC_UPDATER_H
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 #include <set>
 #include <vector>
 
 #include "../../template_db/block_backend.h"
 #include "../../template_db/transaction.h"
+#include "../../template_db/worker_pool.h"
 #include "../core/datatypes.h"
 #include "../core/settings.h"
 
@@ -176,13 +178,41 @@ std::map< Uint31_Index, std::set< Element_Skeleton > > get_existing_skeletons
 }
 
 
+/* The relative deltas of an object that are younger than its youngest full delta.
+ * These are at most the deltas to apply before any older version can be reconstructed. */
+struct Delta_Run
+{
+  Delta_Run() : count(0), size(0) {}
+
+  void add(bool full, uint32 delta_size)
+  {
+    if (full)
+      *this = Delta_Run();
+    else
+    {
+      ++count;
+      size += delta_size;
+    }
+  }
+
+  uint32 count;
+  uint64 size;
+};
+
+
+inline bool is_full_delta(const Node_Skeleton& delta) { return true; }
+inline bool is_full_delta(const Way_Delta& delta) { return delta.full; }
+inline bool is_full_delta(const Relation_Delta& delta) { return delta.full; }
+
+
 template< typename Index, typename Element_Skeleton, typename Element_Skeleton_Delta >
 std::map< typename Element_Skeleton::Id_Type, std::pair< Index, Attic< Element_Skeleton_Delta > > >
     get_existing_attic_skeleton_timestamps
     (const std::vector< std::pair< typename Element_Skeleton::Id_Type, Uint31_Index > >& ids_with_position,
      const std::map< typename Element_Skeleton::Id_Type, std::set< Uint31_Index > >& existing_idx_lists,
      Transaction& transaction, const File_Properties& skel_file_properties,
-     const File_Properties& undelete_file_properties)
+     const File_Properties& undelete_file_properties,
+     std::map< typename Element_Skeleton::Id_Type, Delta_Run >* delta_runs = 0)
 {
   std::set< Uint31_Index > req;
   for (typename std::vector< std::pair< typename Element_Skeleton::Id_Type, Uint31_Index > >::const_iterator
@@ -198,6 +228,7 @@ std::map< typename Element_Skeleton::Id_Type, std::pair< Index, Attic< Element_S
 
   std::map< typename Element_Skeleton::Id_Type, std::pair< Index, Attic< Element_Skeleton_Delta > > > result;
   Idx_Agnostic_Compare< typename Element_Skeleton::Id_Type > comp;
+  std::map< Attic< typename Element_Skeleton::Id_Type >, std::pair< bool, uint32 > > delta_kinds;
 
   Block_Backend< Uint31_Index, Attic< Element_Skeleton_Delta > > db(transaction.data_index(&skel_file_properties));
   for (typename Block_Backend< Uint31_Index, Attic< Element_Skeleton_Delta > >::Discrete_Iterator
@@ -206,6 +237,9 @@ std::map< typename Element_Skeleton::Id_Type, std::pair< Index, Attic< Element_S
     if (binary_search(ids_with_position.begin(), ids_with_position.end(),
         std::make_pair(it.object().id, 0), comp))
     {
+      if (delta_runs)
+        delta_kinds[Attic< typename Element_Skeleton::Id_Type >(it.object().id, it.object().timestamp)]
+            = std::make_pair(is_full_delta(it.object()), it.object().size_of());
       typename std::map< typename Element_Skeleton::Id_Type,
           std::pair< Index, Attic< Element_Skeleton_Delta > > >::iterator
           rit = result.find(it.object().id);
@@ -236,10 +270,141 @@ std::map< typename Element_Skeleton::Id_Type, std::pair< Index, Attic< Element_S
     }
   }
 
+  if (delta_runs)
+  {
+    for (typename std::map< Attic< typename Element_Skeleton::Id_Type >, std::pair< bool, uint32 > >
+        ::const_iterator it = delta_kinds.begin(); it != delta_kinds.end(); ++it)
+      (*delta_runs)[it->first].add(it->second.first, it->second.second);
+  }
+
   return result;
 }
 
 
+/* Collects in keyframes full versions of those deltas in chain that would otherwise extend the run
+ * of relative deltas beyond the configured keyframe interval or size. The chain holds the deltas of
+ * a single object from the oldest to the youngest one and continues the given run.
+ * Deltas refer to the next younger version, hence the versions are expanded from reference downwards.
+ * If the chain cannot be expanded then no keyframes are added. */
+template< typename Element_Skeleton >
+void add_keyframes(const Element_Skeleton& reference,
+    const std::vector< std::pair< Uint31_Index, const Attic< typename Element_Skeleton::Delta >* > >& chain,
+    Delta_Run run,
+    std::map< Uint31_Index, std::set< Attic< typename Element_Skeleton::Delta > > >& keyframes)
+{
+  typedef Attic< typename Element_Skeleton::Delta > Attic_Delta;
+
+  if (basic_settings().attic_keyframe_interval == 0)
+    return;
+
+  std::vector< bool > is_keyframe(chain.size(), false);
+  uint32 oldest_keyframe = chain.size();
+  for (uint32 i = 0; i < chain.size(); ++i)
+  {
+    run.add(chain[i].second->full, chain[i].second->size_of());
+    if (run.count >= basic_settings().attic_keyframe_interval
+        || run.size >= basic_settings().attic_keyframe_size)
+    {
+      is_keyframe[i] = true;
+      if (oldest_keyframe == chain.size())
+        oldest_keyframe = i;
+      run = Delta_Run();
+    }
+  }
+  if (oldest_keyframe == chain.size())
+    return;
+
+  std::vector< std::pair< Uint31_Index, Attic_Delta > > found;
+  Element_Skeleton skel = reference;
+  try
+  {
+    for (uint32 i = chain.size(); i > oldest_keyframe; )
+    {
+      --i;
+      skel = chain[i].second->expand(skel);
+      if (skel.id.val() == 0)
+        return;
+      if (is_keyframe[i])
+        found.push_back(std::make_pair(chain[i].first, Attic_Delta(
+            typename Element_Skeleton::Delta(Element_Skeleton(), skel), chain[i].second->timestamp)));
+    }
+  }
+  catch (const std::exception&)
+  {
+    return;
+  }
+
+  for (typename std::vector< std::pair< Uint31_Index, Attic_Delta > >::const_iterator it = found.begin();
+      it != found.end(); ++it)
+    keyframes[it->first].insert(it->second);
+}
+
+
+/* Replaces those of the new attic deltas by full deltas that would otherwise extend the run
+ * of relative deltas of their object beyond the configured keyframe interval or size. */
+template< typename Element_Skeleton >
+void add_attic_keyframes(
+    const std::map< Uint31_Index, std::set< Element_Skeleton > >& current_skeletons,
+    const std::map< typename Element_Skeleton::Id_Type, Delta_Run >& existing_runs,
+    std::map< Uint31_Index, std::set< Attic< typename Element_Skeleton::Delta > > >& full_attic)
+{
+  typedef Attic< typename Element_Skeleton::Delta > Attic_Delta;
+  typedef typename Element_Skeleton::Id_Type Id_Type;
+
+  std::map< Attic< Id_Type >, std::pair< Uint31_Index, const Attic_Delta* > > deltas;
+  for (typename std::map< Uint31_Index, std::set< Attic_Delta > >::const_iterator it = full_attic.begin();
+      it != full_attic.end(); ++it)
+  {
+    for (typename std::set< Attic_Delta >::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+      deltas[Attic< Id_Type >(it2->id, it2->timestamp)] = std::make_pair(it->first, &*it2);
+  }
+
+  std::map< Id_Type, const Element_Skeleton* > references;
+  for (typename std::map< Uint31_Index, std::set< Element_Skeleton > >::const_iterator
+      it = current_skeletons.begin(); it != current_skeletons.end(); ++it)
+  {
+    for (typename std::set< Element_Skeleton >::const_iterator it2 = it->second.begin();
+        it2 != it->second.end(); ++it2)
+    {
+      typename std::map< Attic< Id_Type >, std::pair< Uint31_Index, const Attic_Delta* > >::const_iterator
+          dit = deltas.lower_bound(Attic< Id_Type >(it2->id, 0ull));
+      if (dit != deltas.end() && dit->first.val() == it2->id.val())
+        references[it2->id] = &*it2;
+    }
+  }
+
+  std::map< Uint31_Index, std::set< Attic_Delta > > keyframes;
+  std::vector< std::pair< Uint31_Index, const Attic_Delta* > > chain;
+  for (typename std::map< Attic< Id_Type >, std::pair< Uint31_Index, const Attic_Delta* > >::const_iterator
+      it = deltas.begin(); it != deltas.end(); ++it)
+  {
+    chain.push_back(it->second);
+    typename std::map< Attic< Id_Type >, std::pair< Uint31_Index, const Attic_Delta* > >::const_iterator
+        next = it;
+    ++next;
+    if (next != deltas.end() && next->first.val() == it->first.val())
+      continue;
+
+    typename std::map< Id_Type, Delta_Run >::const_iterator rit = existing_runs.find(it->first);
+    typename std::map< Id_Type, const Element_Skeleton* >::const_iterator cit = references.find(it->first);
+    add_keyframes(cit == references.end() ? Element_Skeleton() : *cit->second, chain,
+        rit == existing_runs.end() ? Delta_Run() : rit->second, keyframes);
+    chain.clear();
+  }
+
+  for (typename std::map< Uint31_Index, std::set< Attic_Delta > >::const_iterator it = keyframes.begin();
+      it != keyframes.end(); ++it)
+  {
+    std::set< Attic_Delta >& target = full_attic[it->first];
+    for (typename std::set< Attic_Delta >::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+    {
+      target.erase(*it2);
+      target.insert(*it2);
+    }
+  }
+}
+
+
 template< typename Element_Skeleton >
 std::map< Uint31_Index, std::set< Element_Skeleton > > get_existing_meta
     (const std::vector< std::pair< typename Element_Skeleton::Id_Type, Uint31_Index > >& ids_with_position,
@@ -494,26 +659,81 @@ std::vector< std::pair< typename Element_Skeleton::Id_Type, Uint31_Index > > new
 
 
 template< typename Id_Type >
-void update_map_positions
-    (std::vector< std::pair< Id_Type, Uint31_Index > > new_idx_positions,
-     Transaction& transaction, const File_Properties& file_properties)
+struct Update_Map_Positions_Job : Worker_Pool::Job
 {
-  Random_File< Id_Type, Uint31_Index > random(transaction.random_index(&file_properties));
+  Update_Map_Positions_Job(const std::vector< std::pair< Id_Type, Uint31_Index > >& new_idx_positions_,
+      Random_File_Index* index_)
+      : new_idx_positions(new_idx_positions_), index(index_) {}
 
-  for (typename std::vector< std::pair< Id_Type, Uint31_Index > >::const_iterator
-      it = new_idx_positions.begin(); it != new_idx_positions.end(); ++it)
-    random.put(it->first.val(), it->second);
+  void run()
+  {
+    Random_File< Id_Type, Uint31_Index > random(index);
+
+    for (typename std::vector< std::pair< Id_Type, Uint31_Index > >::const_iterator
+        it = new_idx_positions.begin(); it != new_idx_positions.end(); ++it)
+      random.put(it->first.val(), it->second);
+  }
+
+private:
+  std::vector< std::pair< Id_Type, Uint31_Index > > new_idx_positions;
+  Random_File_Index* index;
+};
+
+
+/* The file updates of an updater touch pairwise distinct files. They are therefore run as jobs on a pool.
+   The indexes are fetched here in the calling thread because the transaction is not thread safe.
+   The maps are referenced, not copied, and must stay unchanged until the pool has finished. */
+
+template< typename Id_Type >
+void update_map_positions
+    (const std::vector< std::pair< Id_Type, Uint31_Index > >& new_idx_positions,
+     Transaction& transaction, const File_Properties& file_properties, Worker_Pool& pool)
+{
+  pool.add(new Update_Map_Positions_Job< Id_Type >
+      (new_idx_positions, transaction.random_index(&file_properties)));
 }
 
 
+template< typename Index, typename Object >
+struct Update_Elements_Job : Worker_Pool::Job
+{
+  Update_Elements_Job(const std::map< Index, std::set< Object > >* attic_objects_,
+      const std::map< Index, std::set< Object > >& new_objects_, File_Blocks_Index_Base* index_)
+      : attic_objects(attic_objects_), new_objects(new_objects_), index(index_) {}
+
+  void run()
+  {
+    Block_Backend< Index, Object > db(index);
+    db.update(attic_objects ? *attic_objects : no_objects, new_objects);
+  }
+
+private:
+  const std::map< Index, std::set< Object > >* attic_objects;
+  const std::map< Index, std::set< Object > >& new_objects;
+  File_Blocks_Index_Base* index;
+  std::map< Index, std::set< Object > > no_objects;
+};
+
+
 template< typename Index, typename Object >
 void update_elements
     (const std::map< Index, std::set< Object > >& attic_objects,
      const std::map< Index, std::set< Object > >& new_objects,
-     Transaction& transaction, const File_Properties& file_properties)
+     Transaction& transaction, const File_Properties& file_properties, Worker_Pool& pool)
+{
+  pool.add(new Update_Elements_Job< Index, Object >
+      (&attic_objects, new_objects, transaction.data_index(&file_properties)));
+}
+
+
+// Like update_elements, but only adds objects
+template< typename Index, typename Object >
+void add_elements
+    (const std::map< Index, std::set< Object > >& new_objects,
+     Transaction& transaction, const File_Properties& file_properties, Worker_Pool& pool)
 {
-  Block_Backend< Index, Object > db(transaction.data_index(&file_properties));
-  db.update(attic_objects, new_objects);
+  pool.add(new Update_Elements_Job< Index, Object >
+      (0, new_objects, transaction.data_index(&file_properties)));
 }
 
 
@@ -1201,6 +1421,169 @@ void store_new_keys(const Data_By_Id< Skeleton >& new_data,
 }
 
 
+// Reverse references are kept up to date exactly if they have been complete so far
+inline bool maintain_reverse_refs(Transaction& transaction)
+{
+  return reverse_refs_complete(transaction.get_db_dir());
+}
+
+
+// Appends the ids of the nodes of a way
+struct Way_Node_Refs
+{
+  typedef Node::Id_Type Child_Id;
+
+  void operator()(const Way_Skeleton& way, std::vector< Child_Id >& result) const
+  { result.insert(result.end(), way.nds.begin(), way.nds.end()); }
+};
+
+
+// Appends the ids of the members of one type of a relation
+template< typename Child_Id_ >
+struct Relation_Member_Refs
+{
+  typedef Child_Id_ Child_Id;
+
+  Relation_Member_Refs(uint32 type_) : type(type_) {}
+
+  void operator()(const Relation_Skeleton& relation, std::vector< Child_Id >& result) const
+  {
+    for (std::vector< Relation_Entry >::const_iterator it = relation.members.begin();
+        it != relation.members.end(); ++it)
+    {
+      if (it->type == type)
+        result.push_back(Child_Id(it->ref.val()));
+    }
+  }
+
+private:
+  uint32 type;
+};
+
+
+template< typename Skeleton, typename Child_Refs >
+void add_children_by_id(const std::map< Uint31_Index, std::set< Skeleton > >& skeletons,
+    const Child_Refs& child_refs,
+    std::map< typename Skeleton::Id_Type, std::vector< typename Child_Refs::Child_Id > >& result)
+{
+  for (typename std::map< Uint31_Index, std::set< Skeleton > >::const_iterator it = skeletons.begin();
+       it != skeletons.end(); ++it)
+  {
+    for (typename std::set< Skeleton >::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+      child_refs(*it2, result[it2->id]);
+  }
+}
+
+
+template< typename Id_Type, typename Child_Id >
+void sort_children(std::map< Id_Type, std::vector< Child_Id > >& children)
+{
+  for (typename std::map< Id_Type, std::vector< Child_Id > >::iterator it = children.begin();
+       it != children.end(); ++it)
+  {
+    std::sort(it->second.begin(), it->second.end());
+    it->second.erase(std::unique(it->second.begin(), it->second.end()), it->second.end());
+  }
+}
+
+
+/* Compares the children of the replaced and the new skeletons to determine which reverse references
+ * from a child to its parent must be deleted and which must be inserted. */
+template< typename Skeleton, typename Child_Refs >
+void new_current_reverse_refs
+    (const std::map< Uint31_Index, std::set< Skeleton > >& attic_skeletons,
+     const std::map< Uint31_Index, std::set< Skeleton > >& new_skeletons,
+     const Child_Refs& child_refs,
+     std::map< typename Child_Refs::Child_Id, std::set< typename Skeleton::Id_Type > >& attic_refs,
+     std::map< typename Child_Refs::Child_Id, std::set< typename Skeleton::Id_Type > >& new_refs)
+{
+  typedef typename Skeleton::Id_Type Id_Type;
+  typedef typename Child_Refs::Child_Id Child_Id;
+
+  std::map< Id_Type, std::vector< Child_Id > > old_children;
+  add_children_by_id(attic_skeletons, child_refs, old_children);
+  sort_children(old_children);
+  std::map< Id_Type, std::vector< Child_Id > > new_children;
+  add_children_by_id(new_skeletons, child_refs, new_children);
+  sort_children(new_children);
+  std::vector< Child_Id > no_children;
+
+  for (typename std::map< Id_Type, std::vector< Child_Id > >::const_iterator it = old_children.begin();
+       it != old_children.end(); ++it)
+  {
+    typename std::map< Id_Type, std::vector< Child_Id > >::const_iterator it_new = new_children.find(it->first);
+    const std::vector< Child_Id >& current = (it_new == new_children.end() ? no_children : it_new->second);
+    std::vector< Child_Id > removed;
+    std::set_difference(it->second.begin(), it->second.end(), current.begin(), current.end(),
+        std::back_inserter(removed));
+    for (typename std::vector< Child_Id >::const_iterator it2 = removed.begin(); it2 != removed.end(); ++it2)
+      attic_refs[*it2].insert(it->first);
+  }
+
+  for (typename std::map< Id_Type, std::vector< Child_Id > >::const_iterator it = new_children.begin();
+       it != new_children.end(); ++it)
+  {
+    typename std::map< Id_Type, std::vector< Child_Id > >::const_iterator it_old = old_children.find(it->first);
+    const std::vector< Child_Id >& past = (it_old == old_children.end() ? no_children : it_old->second);
+    std::vector< Child_Id > added;
+    std::set_difference(it->second.begin(), it->second.end(), past.begin(), past.end(),
+        std::back_inserter(added));
+    for (typename std::vector< Child_Id >::const_iterator it2 = added.begin(); it2 != added.end(); ++it2)
+      new_refs[*it2].insert(it->first);
+  }
+}
+
+
+/* Determines for the elements in new_data the children that they have referred to in their replaced
+ * version or one of their new versions but not in their latest version. The references get the timestamp
+ * of the latest version, hence they are no later than the removal of the reference. Together with the
+ * current reverse references, these are therefore a superset of the parents at any given time. */
+template< typename Skeleton, typename Child_Refs >
+std::map< typename Child_Refs::Child_Id, std::set< Attic< typename Skeleton::Id_Type > > >
+    new_attic_reverse_refs
+    (const Data_By_Id< Skeleton >& new_data,
+     const std::map< Uint31_Index, std::set< Skeleton > >& attic_skeletons,
+     const Child_Refs& child_refs)
+{
+  typedef typename Skeleton::Id_Type Id_Type;
+  typedef typename Child_Refs::Child_Id Child_Id;
+
+  std::map< Child_Id, std::set< Attic< Id_Type > > > result;
+
+  std::map< Id_Type, std::vector< Child_Id > > past_children;
+  add_children_by_id(attic_skeletons, child_refs, past_children);
+
+  typename std::vector< typename Data_By_Id< Skeleton >::Entry >::const_iterator next_it
+      = new_data.data.begin();
+  for (typename std::vector< typename Data_By_Id< Skeleton >::Entry >::const_iterator
+      it = new_data.data.begin(); it != new_data.data.end(); ++it)
+  {
+    std::vector< Child_Id >& past = past_children[it->elem.id];
+    ++next_it;
+    if (next_it != new_data.data.end() && it->elem.id == next_it->elem.id)
+    {
+      child_refs(it->elem, past);
+      continue;
+    }
+
+    std::vector< Child_Id > current;
+    if (!(it->idx == Uint31_Index(0u)))
+      child_refs(it->elem, current);
+
+    std::sort(past.begin(), past.end());
+    past.erase(std::unique(past.begin(), past.end()), past.end());
+    std::sort(current.begin(), current.end());
+    std::vector< Child_Id > removed;
+    std::set_difference(past.begin(), past.end(), current.begin(), current.end(),
+        std::back_inserter(removed));
+    for (typename std::vector< Child_Id >::const_iterator it2 = removed.begin(); it2 != removed.end(); ++it2)
+      result[*it2].insert(Attic< Id_Type >(it->elem.id, it->meta.timestamp));
+  }
+
+  return result;
+}
+
+
 std::map< Node_Skeleton::Id_Type, std::vector< std::pair< Uint31_Index, Attic< Node_Skeleton > > > >
     collect_nodes_by_id(
     const std::map< Uint31_Index, std::set< Attic< Node_Skeleton > > >& new_attic_node_skeletons,
@@ -23,6 +23,39 @@
 #include "../../template_db/file_blocks.h"
 #include "../../template_db/random_file.h"
 
+#include <cstdio>
+
+
+// Trains the dictionary from blocks spread evenly over the whole file
+template< class TIndex >
+std::string train_dictionary(
+    File_Blocks< TIndex, typename std::set< TIndex >::const_iterator, Default_Range_Iterator< TIndex > >& src_file,
+    uint32 block_size)
+{
+  const uint32 max_samples = 256;
+  const uint32 max_sample_size = 64*1024;
+
+  uint32 num_blocks = 0;
+  for (typename File_Blocks< TIndex, typename std::set< TIndex >::const_iterator,
+      Default_Range_Iterator< TIndex > >::Flat_Iterator it = src_file.flat_begin(); !it.is_end(); ++it)
+    ++num_blocks;
+
+  std::vector< std::string > samples;
+  uint32 i = 0;
+  for (typename File_Blocks< TIndex, typename std::set< TIndex >::const_iterator,
+      Default_Range_Iterator< TIndex > >::Flat_Iterator it = src_file.flat_begin(); !it.is_end(); ++it)
+  {
+    if (i++ % (num_blocks / max_samples + 1) == 0)
+    {
+      uint64* buf = src_file.read_block(it, false);
+      samples.push_back(std::string((const char*)buf,
+          std::min(std::min(*(uint32*)buf, block_size), max_sample_size)));
+    }
+  }
+
+  return Zstd_Dictionary::train(samples, 112*1024);
+}
+
 
 template< class TIndex >
 void clone_bin_file(const File_Properties& src_file_prop, const File_Properties& dest_file_prop,
@@ -44,21 +77,37 @@ void clone_bin_file(const File_Properties& src_file_prop, const File_Properties&
     File_Blocks< TIndex, typename std::set< TIndex >::const_iterator, Default_Range_Iterator< TIndex > >
 	src_file(&src_idx);
 
+    // A dictionary must not survive from an earlier clone into a file with different blocks
+    std::string dict_file_name = dictionary_file_name(
+        dest_db_dir + dest_file_prop.get_file_name_trunk() + dest_file_prop.get_data_suffix());
+    remove(dict_file_name.c_str());
+    int compression_method = clone_settings.compression_method == (uint32)File_Blocks_Index_Base::USE_DEFAULT
+        ? dest_file_prop.get_compression_method() : clone_settings.compression_method;
+    if (compression_method == File_Blocks_Index_Base::ZSTD_COMPRESSION && clone_settings.compression_dictionary)
+    {
+      std::string dictionary = train_dictionary(src_file, block_size);
+      if (!dictionary.empty())
+        save_dictionary(dict_file_name, dictionary);
+    }
+
     File_Blocks_Index< TIndex > dest_idx(dest_file_prop, true, false, dest_db_dir, "",
-        clone_settings.compression_method);
+        clone_settings.compression_method, clone_settings.compression_level);
     File_Blocks< TIndex, typename std::set< TIndex >::const_iterator, Default_Range_Iterator< TIndex > >
 	dest_file(&dest_idx);
 
     typename File_Blocks< TIndex, typename std::set< TIndex >::const_iterator,
         Default_Range_Iterator< TIndex > >::Flat_Iterator
 	src_it = src_file.flat_begin();
+    typename File_Blocks< TIndex, typename std::set< TIndex >::const_iterator,
+        Default_Range_Iterator< TIndex > >::Flat_Iterator
+	src_end = src_file.flat_end();
 
     uint32 excess_bytes = 0;
     while (!src_it.is_end())
     {
       if (excess_bytes > 0)
       {
-        uint64* buf = src_file.read_block(src_it, false);
+        uint64* buf = src_file.read_block_ahead(src_it, src_end, false);
         dest_file.insert_block(
             dest_file.write_end(), buf, std::min(excess_bytes, block_size),
             src_it.block_it->max_keysize, src_it.block_it->index);
@@ -66,13 +115,14 @@ void clone_bin_file(const File_Properties& src_file_prop, const File_Properties&
       }
       else
       {
-        uint64* buf = src_file.read_block(src_it);
+        uint64* buf = src_file.read_block_ahead(src_it, src_end);
         dest_file.insert_block(dest_file.write_end(), buf, src_it.block_it->max_keysize);
         if (((uint32*)buf)[1] > block_size)
           excess_bytes = ((uint32*)buf)[1] - block_size;
       }
       ++src_it;
     }
+    dest_file.flush();
   }
   catch (File_Error e)
   {
@@ -89,7 +139,8 @@ void clone_map_file(const File_Properties& file_prop, Transaction& transaction,
     Random_File_Index& src_idx = *transaction.random_index(&file_prop);
     Random_File< Key, TIndex > src_file(&src_idx);
 
-    Random_File_Index dest_idx(file_prop, true, false, dest_db_dir, "", clone_settings.map_compression_method);
+    Random_File_Index dest_idx(file_prop, true, false, dest_db_dir, "",
+        clone_settings.map_compression_method, clone_settings.compression_level);
     Random_File< Key, TIndex > dest_file(&dest_idx);
 
     for (std::vector< uint32 >::size_type i = 0; i < src_idx.get_blocks().size(); ++i)
@@ -150,6 +201,21 @@ void clone_database(Transaction& transaction, const std::string& dest_db_dir, co
   clone_bin_file< Uint32_Index >(*osm_base_settings().RELATION_KEYS, *osm_base_settings().RELATION_KEYS,
 				 transaction, dest_db_dir, clone_settings);
 
+  // Incomplete reverse reference files are not worth cloning, because they are never used
+  if (reverse_refs_complete(transaction.get_db_dir()))
+  {
+    clone_bin_file< Node::Id_Type >(*osm_base_settings().NODE_WAYS, *osm_base_settings().NODE_WAYS,
+                                    transaction, dest_db_dir, clone_settings);
+    clone_bin_file< Node::Id_Type >(*osm_base_settings().NODE_RELATIONS, *osm_base_settings().NODE_RELATIONS,
+                                    transaction, dest_db_dir, clone_settings);
+    clone_bin_file< Way::Id_Type >(*osm_base_settings().WAY_RELATIONS, *osm_base_settings().WAY_RELATIONS,
+                                   transaction, dest_db_dir, clone_settings);
+    clone_bin_file< Relation::Id_Type >(
+        *osm_base_settings().RELATION_RELATIONS, *osm_base_settings().RELATION_RELATIONS,
+        transaction, dest_db_dir, clone_settings);
+    mark_reverse_refs_complete(dest_db_dir);
+  }
+
   clone_bin_file< Uint31_Index >(*meta_settings().NODES_META, *meta_settings().NODES_META,
 				 transaction, dest_db_dir, clone_settings);
   clone_bin_file< Uint31_Index >(*meta_settings().WAYS_META, *meta_settings().WAYS_META,
@@ -211,5 +277,18 @@ void clone_database(Transaction& transaction, const std::string& dest_db_dir, co
                                    transaction, dest_db_dir, clone_settings);
     clone_bin_file< Timestamp >(*attic_settings().RELATION_CHANGELOG, *attic_settings().RELATION_CHANGELOG,
                                 transaction, dest_db_dir, clone_settings);
+
+    if (reverse_refs_complete(transaction.get_db_dir()))
+    {
+      clone_bin_file< Node::Id_Type >(*attic_settings().NODE_WAYS, *attic_settings().NODE_WAYS,
+                                      transaction, dest_db_dir, clone_settings);
+      clone_bin_file< Node::Id_Type >(*attic_settings().NODE_RELATIONS, *attic_settings().NODE_RELATIONS,
+                                      transaction, dest_db_dir, clone_settings);
+      clone_bin_file< Way::Id_Type >(*attic_settings().WAY_RELATIONS, *attic_settings().WAY_RELATIONS,
+                                     transaction, dest_db_dir, clone_settings);
+      clone_bin_file< Relation::Id_Type >(
+          *attic_settings().RELATION_RELATIONS, *attic_settings().RELATION_RELATIONS,
+          transaction, dest_db_dir, clone_settings);
+    }
   }
 }
@@ -5834,9 +5834,65 @@ int main(int argc, char* args[])
       "    <tag k=\"full\" v=\"\"/>\n"
       "    <tag k=\"vertexrefpos\" v=\"\"/>\n"
       "  </per-member>\n";
+    if (std::string(args[2]) == "convert_16")
+      std::cout<<
+      "  <folded id=\"2\">\n"
+      "    <tag k=\"seconds\" v=\""<<(global_node_offset + 7)*3600 + 20<<"\"/>\n"
+      "    <tag k=\"branch\" v=\""<<(global_node_offset + 7)<<"\"/>\n"
+      "    <tag k=\"seven\" v=\""<<(global_node_offset == 0 ? 1 : 0)<<"\"/>\n"
+      "  </folded>\n"
+      "  <folded id=\"3\">\n"
+      "    <tag k=\"seconds\" v=\""<<(global_node_offset + 14)*3600 + 20<<"\"/>\n"
+      "    <tag k=\"branch\" v=\""<<(global_node_offset + 14)<<"\"/>\n"
+      "    <tag k=\"seven\" v=\"0\"/>\n"
+      "  </folded>\n"
+      "  <folded id=\"4\">\n"
+      "    <tag k=\"seconds\" v=\"25220\"/>\n"
+      "    <tag k=\"branch\" v=\"7\"/>\n"
+      "    <tag k=\"seven\" v=\"1\"/>\n"
+      "  </folded>\n"
+      "  <folded id=\"5\">\n"
+      "    <tag k=\"seconds\" v=\"25220\"/>\n"
+      "    <tag k=\"branch\" v=\"7\"/>\n"
+      "    <tag k=\"seven\" v=\"1\"/>\n"
+      "  </folded>\n"
+      "  <folded id=\"6\">\n"
+      "    <tag k=\"seconds\" v=\"3620\"/>\n"
+      "    <tag k=\"branch\" v=\"1\"/>\n"
+      "    <tag k=\"seven\" v=\"0\"/>\n"
+      "  </folded>\n"
+      "  <way id=\"7\"/>\n";
 
     std::cout<<"</osm>\n";
   }
+  else if ((argc > 2) && (std::string(args[2]) == "bbox_query_9" || std::string(args[2]) == "bbox_query_10"
+      || std::string(args[2]) == "bbox_query_11"))
+  {
+    std::cout<<
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<osm>\n";
+    if (std::string(args[2]) == "bbox_query_9")
+      std::cout<<"Bbox (-10.0, -15.0, 8.0, 9.0): several pieces, "
+          "script output identical, streamed output identical.\n";
+    else if (std::string(args[2]) == "bbox_query_10")
+      std::cout<<"Bbox (-10.0, 93.0, -1.0, -3.0): several pieces, "
+          "script output identical, streamed output identical.\n";
+    else
+      std::cout<<"Bbox (-80.0, -170.0, -70.0, -160.0): empty result, a single piece, "
+          "script output identical, streamed output identical.\n";
+    std::cout<<"</osm>\n";
+  }
+  else if ((argc > 2) && (std::string(args[2]) == "print_6"))
+  {
+    std::cout<<
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<osm>\n"
+    "Tags of nodes with tags are identical in several passes.\n"
+    "Tags of ways with tags are identical in several passes.\n"
+    "Tags of relations with tags are identical in several passes.\n"
+    "Tags of relations with tags are identical in several passes.\n"
+    "</osm>\n";
+  }
   else if ((argc > 2) && (std::string(args[2]) == "complete_6"))
   {
     std::cout<<
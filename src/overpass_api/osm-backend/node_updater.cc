@@ -541,26 +541,31 @@ void Node_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_sto
   callback->update_started();
   callback->prepare_delete_tags_finished();
 
-  store_new_keys(new_data, keys, *transaction);
+  {
+    Worker_Pool pool;
 
-  // Update id indexes
-  update_map_positions(new_map_positions, *transaction, *osm_base_settings().NODES);
-  callback->update_ids_finished();
+    // Update id indexes
+    update_map_positions(new_map_positions, *transaction, *osm_base_settings().NODES, pool);
 
-  // Update skeletons
-  update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().NODES);
-  callback->update_coords_finished();
+    // Update skeletons
+    update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().NODES, pool);
 
-  // Update meta
-  if (meta)
-    update_elements(attic_meta, new_meta, *transaction, *meta_settings().NODES_META);
+    // Update meta
+    if (meta)
+      update_elements(attic_meta, new_meta, *transaction, *meta_settings().NODES_META, pool);
 
-  // Update local tags
-  update_elements(attic_local_tags, new_local_tags, *transaction, *osm_base_settings().NODE_TAGS_LOCAL);
-  callback->tags_local_finished();
+    // Update local tags
+    update_elements(attic_local_tags, new_local_tags, *transaction, *osm_base_settings().NODE_TAGS_LOCAL, pool);
 
-  // Update global tags
-  update_elements(attic_global_tags, new_global_tags, *transaction, *osm_base_settings().NODE_TAGS_GLOBAL);
+    // Update global tags
+    update_elements(attic_global_tags, new_global_tags, *transaction, *osm_base_settings().NODE_TAGS_GLOBAL, pool);
+
+    store_new_keys(new_data, keys, *transaction);
+    pool.wait();
+  }
+  callback->update_ids_finished();
+  callback->update_coords_finished();
+  callback->tags_local_finished();
   callback->tags_global_finished();
 
   std::map< uint32, std::vector< uint32 > > idxs_by_id;
@@ -615,36 +620,32 @@ void Node_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_sto
     // Prepare user indices
     copy_idxs_by_id(attic_meta, idxs_by_id);
 
+    Worker_Pool pool;
+
     // Update id indexes
-    update_map_positions(new_attic_map_positions, *transaction, *attic_settings().NODES);
+    update_map_positions(new_attic_map_positions, *transaction, *attic_settings().NODES, pool);
 
     // Update id index lists
     update_elements(existing_idx_lists, new_attic_idx_lists,
-                    *transaction, *attic_settings().NODE_IDX_LIST);
+                    *transaction, *attic_settings().NODE_IDX_LIST, pool);
 
     // Add attic elements
-    update_elements(std::map< Uint31_Index, std::set< Attic< Node_Skeleton > > >(), new_attic_skeletons,
-                    *transaction, *attic_settings().NODES);
+    add_elements(new_attic_skeletons, *transaction, *attic_settings().NODES, pool);
 
     // Add attic elements
-    update_elements(std::map< Uint31_Index, std::set< Attic< Node_Skeleton::Id_Type > > >(),
-                    new_undeleted, *transaction, *attic_settings().NODES_UNDELETED);
+    add_elements(new_undeleted, *transaction, *attic_settings().NODES_UNDELETED, pool);
 
     // Add attic meta
-    update_elements
-        (std::map< Uint31_Index, std::set< OSM_Element_Metadata_Skeleton< Node_Skeleton::Id_Type > > >(),
-         attic_meta, *transaction, *attic_settings().NODES_META);
+    add_elements(attic_meta, *transaction, *attic_settings().NODES_META, pool);
 
     // Update tags
-    update_elements(std::map< Tag_Index_Local, std::set< Attic < Node_Skeleton::Id_Type > > >(),
-                    new_attic_local_tags, *transaction, *attic_settings().NODE_TAGS_LOCAL);
-    update_elements(std::map< Tag_Index_Global,
-                    std::set< Attic < Tag_Object_Global< Node_Skeleton::Id_Type > > > >(),
-                    new_attic_global_tags, *transaction, *attic_settings().NODE_TAGS_GLOBAL);
+    add_elements(new_attic_local_tags, *transaction, *attic_settings().NODE_TAGS_LOCAL, pool);
+    add_elements(new_attic_global_tags, *transaction, *attic_settings().NODE_TAGS_GLOBAL, pool);
 
     // Write changelog
-    update_elements(std::map< Timestamp, std::set< Change_Entry< Node_Skeleton::Id_Type > > >(), changelog,
-                    *transaction, *attic_settings().NODE_CHANGELOG);
+    add_elements(changelog, *transaction, *attic_settings().NODE_CHANGELOG, pool);
+
+    pool.wait();
   }
 
   if (meta != only_data)
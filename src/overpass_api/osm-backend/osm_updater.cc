@@ -18,6 +18,7 @@
 
 #include "node_updater.h"
 #include "osm_updater.h"
+#include "pbf_reader.h"
 #include "relation_updater.h"
 #include "tags_updater.h"
 #include "way_updater.h"
@@ -39,6 +40,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <sstream>
 
@@ -134,10 +136,61 @@ namespace
   }
 
 
-  inline void node_start(const char **attr)
+  inline void enter_nodes()
   {
     if (state == 0)
       state = IN_NODES;
+  }
+
+
+  inline void enter_ways()
+  {
+    if (state == IN_NODES)
+    {
+      callback->nodes_finished();
+      node_updater->update(callback, cpu_stopwatch, false);
+      //way_updater->update_moved_idxs(callback, node_updater->get_moved_nodes(), update_way_logger);
+      callback->parser_started();
+      osm_element_count = 0;
+      state = IN_WAYS;
+    }
+    else if (state == 0)
+      state = IN_WAYS;
+  }
+
+
+  inline void enter_relations()
+  {
+    if (state == IN_NODES)
+    {
+      callback->nodes_finished();
+      node_updater->update(callback, cpu_stopwatch, false);
+//       relation_updater->update_moved_idxs
+//           (node_updater->get_moved_nodes(), way_updater->get_moved_ways(), update_relation_logger);
+      callback->parser_started();
+      osm_element_count = 0;
+      state = IN_RELATIONS;
+    }
+    else if (state == IN_WAYS)
+    {
+      callback->ways_finished();
+      way_updater->update(callback, cpu_stopwatch, false,
+                          node_updater->get_new_skeletons(), node_updater->get_attic_skeletons(),
+                          node_updater->get_new_attic_skeletons());
+//       relation_updater->update_moved_idxs
+//           (node_updater->get_moved_nodes(), way_updater->get_moved_ways(), update_relation_logger);
+      callback->parser_started();
+      osm_element_count = 0;
+      state = IN_RELATIONS;
+    }
+    else if (state == 0)
+      state = IN_RELATIONS;
+  }
+
+
+  inline void node_start(const char **attr)
+  {
+    enter_nodes();
     if (meta)
       *meta = OSM_Element_Metadata();
 
@@ -197,17 +250,7 @@ namespace
 
   inline void way_start(const char **attr)
   {
-    if (state == IN_NODES)
-    {
-      callback->nodes_finished();
-      node_updater->update(callback, cpu_stopwatch, false);
-      //way_updater->update_moved_idxs(callback, node_updater->get_moved_nodes(), update_way_logger);
-      callback->parser_started();
-      osm_element_count = 0;
-      state = IN_WAYS;
-    }
-    else if (state == 0)
-      state = IN_WAYS;
+    enter_ways();
     if (meta)
       *meta = OSM_Element_Metadata();
 
@@ -281,30 +324,7 @@ namespace
 
   inline void relation_start(const char **attr)
   {
-    if (state == IN_NODES)
-    {
-      callback->nodes_finished();
-      node_updater->update(callback, cpu_stopwatch, false);
-//       relation_updater->update_moved_idxs
-//           (node_updater->get_moved_nodes(), way_updater->get_moved_ways(), update_relation_logger);
-      callback->parser_started();
-      osm_element_count = 0;
-      state = IN_RELATIONS;
-    }
-    else if (state == IN_WAYS)
-    {
-      callback->ways_finished();
-      way_updater->update(callback, cpu_stopwatch, false,
-                          node_updater->get_new_skeletons(), node_updater->get_attic_skeletons(),
-                          node_updater->get_new_attic_skeletons());
-//       relation_updater->update_moved_idxs
-//           (node_updater->get_moved_nodes(), way_updater->get_moved_ways(), update_relation_logger);
-      callback->parser_started();
-      osm_element_count = 0;
-      state = IN_RELATIONS;
-    }
-    else if (state == 0)
-      state = IN_RELATIONS;
+    enter_relations();
     if (meta)
       *meta = OSM_Element_Metadata();
 
@@ -334,6 +354,67 @@ namespace
     }
     current_relation = Relation(id.val());
   }
+
+
+  // Feeds the elements of a decoded PBF block through the same path as the XML callbacks.
+  // Each element counts like its XML end tags, such that --flush-size means the same for both formats.
+  void feed_pbf_block(Pbf_Block& block)
+  {
+    for (uint i = 0; i < block.nodes.elements.size(); ++i)
+    {
+      enter_nodes();
+      if (meta)
+        *meta = (block.nodes.meta.empty() ? OSM_Element_Metadata() : block.nodes.meta[i]);
+      modify_mode = (block.nodes.deleted[i] ? DELETE : 0);
+      std::swap(current_node, block.nodes.elements[i]);
+      uint32 count = 1 + current_node.tags.size();
+      node_end();
+      osm_element_count += count;
+    }
+
+    for (uint i = 0; i < block.ways.elements.size(); ++i)
+    {
+      enter_ways();
+      if (meta)
+        *meta = (block.ways.meta.empty() ? OSM_Element_Metadata() : block.ways.meta[i]);
+      modify_mode = (block.ways.deleted[i] ? DELETE : 0);
+      std::swap(current_way, block.ways.elements[i]);
+      uint32 count = 1 + current_way.tags.size() + current_way.nds.size();
+      way_end();
+      osm_element_count += count;
+    }
+
+    std::vector< uint32 > role_ids(block.strings.size(), std::numeric_limits< uint32 >::max());
+    for (uint i = 0; i < block.relations.elements.size(); ++i)
+    {
+      enter_relations();
+      if (meta)
+        *meta = (block.relations.meta.empty() ? OSM_Element_Metadata() : block.relations.meta[i]);
+      modify_mode = (block.relations.deleted[i] ? DELETE : 0);
+      std::swap(current_relation, block.relations.elements[i]);
+      for (std::vector< Relation_Entry >::iterator it = current_relation.members.begin();
+          it != current_relation.members.end(); ++it)
+      {
+        if (role_ids[it->role] == std::numeric_limits< uint32 >::max())
+          role_ids[it->role] = relation_updater->get_role_id(block.strings[it->role]);
+        it->role = role_ids[it->role];
+      }
+      uint32 count = 1 + current_relation.tags.size() + current_relation.members.size();
+      relation_end();
+      osm_element_count += count;
+    }
+
+    modify_mode = 0;
+  }
+
+
+  void parse_pbf(FILE* in, const std::string& source_name, int element_types, uint num_threads)
+  {
+    Pbf_Reader reader(in, source_name, element_types, meta != 0, num_threads);
+    Pbf_Block block;
+    while (reader.read_block(block))
+      feed_pbf_block(block);
+  }
 }
 
 
@@ -483,6 +564,14 @@ void Osm_Updater::parse_file_completely(FILE* in)
   finish_updater();
 }
 
+void Osm_Updater::parse_pbf_completely(FILE* in, const std::string& source_name, uint num_threads)
+{
+  callback->parser_started();
+  parse_pbf(in, source_name, Pbf_Reader::NODES | Pbf_Reader::WAYS | Pbf_Reader::RELATIONS, num_threads);
+
+  finish_updater();
+}
+
 void parse_nodes_only(FILE* in)
 {
   parse(in, node_start, node_end);
@@ -498,11 +587,49 @@ void parse_relations_only(FILE* in)
   parse(in, relation_start, relation_end);
 }
 
+void parse_pbf_nodes_only(FILE* in, const std::string& source_name, uint num_threads)
+{
+  parse_pbf(in, source_name, Pbf_Reader::NODES, num_threads);
+}
+
+void parse_pbf_ways_only(FILE* in, const std::string& source_name, uint num_threads)
+{
+  parse_pbf(in, source_name, Pbf_Reader::WAYS, num_threads);
+}
+
+void parse_pbf_relations_only(FILE* in, const std::string& source_name, uint num_threads)
+{
+  parse_pbf(in, source_name, Pbf_Reader::RELATIONS, num_threads);
+}
+
+// Reverse references are only complete if they have been maintained since the first element
+void prepare_reverse_refs(const std::string& db_dir)
+{
+  if (!basic_settings().reverse_refs || reverse_refs_complete(db_dir))
+    return;
+
+  if (file_present(db_dir, *osm_base_settings().NODES) || file_present(db_dir, *osm_base_settings().WAYS)
+      || file_present(db_dir, *osm_base_settings().RELATIONS))
+    throw Context_Error("--reverse-refs can only be used when the database is created, "
+        "because the references of the elements already present would be missing.");
+
+  mark_reverse_refs_complete(db_dir);
+}
+
 Osm_Updater::Osm_Updater(Osm_Backend_Callback* callback_, const std::string& data_version_,
 			 meta_modes meta_, unsigned int flush_limit_)
   : dispatcher_client(0), meta(meta_)
 {
   dispatcher_client = new Dispatcher_Client(osm_base_settings().shared_name);
+  try
+  {
+    prepare_reverse_refs(dispatcher_client->get_db_dir());
+  }
+  catch (...)
+  {
+    delete dispatcher_client;
+    throw;
+  }
   Logger logger(dispatcher_client->get_db_dir());
   logger.annotated_log("write_start() start version='" + data_version_ + '\'');
   dispatcher_client->write_start();
@@ -542,6 +669,7 @@ Osm_Updater::Osm_Updater
   if (file_present(db_dir + osm_base_settings().shared_name))
     throw Context_Error("File " + db_dir + osm_base_settings().shared_name + " present, "
         "which indicates a running dispatcher. Delete file if no dispatcher is running.");
+  prepare_reverse_refs(db_dir);
 
   {
     std::ofstream version((db_dir + "osm_base_version").c_str());
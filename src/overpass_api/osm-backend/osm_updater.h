@@ -41,6 +41,8 @@ class Osm_Updater
 
     void finish_updater();
     void parse_file_completely(FILE* in);
+    // Reads OSM PBF instead of OSM XML. The blobs are decoded by num_threads threads.
+    void parse_pbf_completely(FILE* in, const std::string& source_name, uint num_threads);
 
   private:
     Nonsynced_Transaction* transaction;
@@ -57,5 +59,8 @@ class Osm_Updater
 void parse_nodes_only(FILE* in);
 void parse_ways_only(FILE* in);
 void parse_relations_only(FILE* in);
+void parse_pbf_nodes_only(FILE* in, const std::string& source_name, uint num_threads);
+void parse_pbf_ways_only(FILE* in, const std::string& source_name, uint num_threads);
+void parse_pbf_relations_only(FILE* in, const std::string& source_name, uint num_threads);
 
 #endif
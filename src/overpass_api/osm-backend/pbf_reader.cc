@@ -0,0 +1,811 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pbf_reader.h"
+#include "../../template_db/types.h"
+#include "../../template_db/zlib_wrapper.h"
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+
+/* The message and field numbers follow fileformat.proto and osmformat.proto of the OSM PBF format.
+ * Only the fields that the database stores are decoded, all other fields are skipped. */
+
+namespace
+{
+  const uint32 MAX_BLOB_HEADER_SIZE = 64*1024;
+  const uint32 MAX_BLOB_SIZE = 32*1024*1024;
+
+
+  struct Proto_Error
+  {
+    Proto_Error(const std::string& origin_) : origin(origin_) {}
+    std::string origin;
+  };
+
+
+  typedef std::pair< const char*, const char* > Byte_Range;
+
+
+  inline uint64 read_varint(const char*& pos, const char* end)
+  {
+    uint64 result = 0;
+    for (uint shift = 0; shift < 64; shift += 7)
+    {
+      if (pos >= end)
+        throw Proto_Error("truncated_varint");
+      uint8 byte = *pos++;
+      result |= uint64(byte & 0x7f)<<shift;
+      if (!(byte & 0x80))
+        return result;
+    }
+    throw Proto_Error("overlong_varint");
+  }
+
+
+  inline int64 zigzag(uint64 value)
+  {
+    return (value>>1) ^ -int64(value & 0x1);
+  }
+
+
+  // Iterates over the fields of a protobuf message
+  class Proto_Message
+  {
+  public:
+    Proto_Message(const Byte_Range& range) : pos(range.first), end(range.second), field(0), wire_type(0) {}
+
+    bool next()
+    {
+      if (pos >= end)
+        return false;
+      uint64 key = read_varint(pos, end);
+      field = key>>3;
+      wire_type = key & 0x7;
+      return true;
+    }
+
+    uint32 get_field() const { return field; }
+
+    uint64 varint()
+    {
+      if (wire_type != 0)
+        throw Proto_Error("wire_type");
+      return read_varint(pos, end);
+    }
+
+    int64 svarint() { return zigzag(varint()); }
+
+    Byte_Range bytes()
+    {
+      if (wire_type != 2)
+        throw Proto_Error("wire_type");
+      uint64 size = read_varint(pos, end);
+      if (size > uint64(end - pos))
+        throw Proto_Error("truncated_field");
+      Byte_Range result(pos, pos + size);
+      pos += size;
+      return result;
+    }
+
+    std::string string()
+    {
+      Byte_Range range = bytes();
+      return std::string(range.first, range.second);
+    }
+
+    void skip()
+    {
+      if (wire_type == 0)
+        read_varint(pos, end);
+      else if (wire_type == 2)
+        bytes();
+      else if ((wire_type == 1 && end - pos >= 8) || (wire_type == 5 && end - pos >= 4))
+        pos += (wire_type == 1 ? 8 : 4);
+      else
+        throw Proto_Error("wire_type");
+    }
+
+  private:
+    const char* pos;
+    const char* end;
+    uint32 field;
+    uint32 wire_type;
+  };
+
+
+  // Iterates over a packed repeated field of varints
+  class Packed_Varints
+  {
+  public:
+    Packed_Varints() : pos(0), end(0) {}
+    Packed_Varints(const Byte_Range& range) : pos(range.first), end(range.second) {}
+
+    bool at_end() const { return pos >= end; }
+    uint64 next() { return read_varint(pos, end); }
+    int64 next_signed() { return zigzag(read_varint(pos, end)); }
+    // Returns the default if the field has been omitted or is exhausted
+    uint64 next_or(uint64 default_value) { return at_end() ? default_value : next(); }
+    int64 next_signed_or(int64 default_value) { return at_end() ? default_value : next_signed(); }
+
+  private:
+    const char* pos;
+    const char* end;
+  };
+
+
+  uint64 to_timestamp(int64 seconds)
+  {
+    time_t time = seconds;
+    struct tm parts;
+    if (!gmtime_r(&time, &parts))
+      return 0;
+    return Timestamp(parts.tm_year + 1900, parts.tm_mon + 1, parts.tm_mday,
+        parts.tm_hour, parts.tm_min, parts.tm_sec).timestamp;
+  }
+
+
+  struct Block_Context
+  {
+    Block_Context() : granularity(100), lat_offset(0), lon_offset(0), date_granularity(1000) {}
+
+    std::vector< std::string >* strings;
+    int64 granularity;
+    int64 lat_offset;
+    int64 lon_offset;
+    int64 date_granularity;
+
+    const std::string& string(uint64 index) const
+    {
+      if (index >= strings->size())
+        throw Proto_Error("string_index");
+      return (*strings)[index];
+    }
+
+    Node make_node(Node::Id_Type id, int64 lat, int64 lon) const
+    {
+      double lat_ = .000000001*(lat_offset + granularity*lat);
+      double lon_ = .000000001*(lon_offset + granularity*lon);
+      if (lat_ >= -90. && lat_ <= 90. && lon_ >= -180. && lon_ <= 180.)
+        return Node(id, lat_, lon_);
+      return Node(id, 100., 200.);
+    }
+  };
+
+
+  void decode_tags(const Block_Context& context, Packed_Varints keys, Packed_Varints vals,
+      std::vector< std::pair< std::string, std::string > >& tags)
+  {
+    while (!keys.at_end() && !vals.at_end())
+    {
+      const std::string& key = context.string(keys.next());
+      tags.push_back(std::make_pair(key, context.string(vals.next())));
+    }
+  }
+
+
+  // Decodes an Info message and returns whether the element is visible. Skips the metadata if meta is null.
+  bool decode_info(const Block_Context& context, const Byte_Range& range, OSM_Element_Metadata* meta)
+  {
+    bool visible = true;
+    Proto_Message message(range);
+    while (message.next())
+    {
+      if (message.get_field() == 6)
+        visible = message.varint();
+      else if (!meta)
+        message.skip();
+      else if (message.get_field() == 1)
+        meta->version = message.varint();
+      else if (message.get_field() == 2)
+        meta->timestamp = to_timestamp(message.varint() * context.date_granularity / 1000);
+      else if (message.get_field() == 3)
+        meta->changeset = message.varint();
+      else if (message.get_field() == 4)
+        meta->user_id = message.varint();
+      else if (message.get_field() == 5)
+        meta->user_name = context.string(message.varint());
+      else
+        message.skip();
+    }
+    return visible;
+  }
+
+
+  template< typename Element >
+  void push_info(const Block_Context& context, bool with_meta, const Byte_Range& info,
+      Pbf_Elements< Element >& target)
+  {
+    if (with_meta)
+      target.meta.push_back(OSM_Element_Metadata());
+    target.deleted.push_back(info.first && !decode_info(context, info, with_meta ? &target.meta.back() : 0));
+  }
+
+
+  void decode_node(const Block_Context& context, const Byte_Range& range, bool with_meta,
+      Pbf_Elements< Node >& target)
+  {
+    int64 id = 0;
+    int64 lat = 0;
+    int64 lon = 0;
+    Byte_Range keys;
+    Byte_Range vals;
+    Byte_Range info;
+    Proto_Message message(range);
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+        id = message.svarint();
+      else if (message.get_field() == 2)
+        keys = message.bytes();
+      else if (message.get_field() == 3)
+        vals = message.bytes();
+      else if (message.get_field() == 4)
+        info = message.bytes();
+      else if (message.get_field() == 8)
+        lat = message.svarint();
+      else if (message.get_field() == 9)
+        lon = message.svarint();
+      else
+        message.skip();
+    }
+
+    target.elements.push_back(context.make_node(id, lat, lon));
+    decode_tags(context, keys, vals, target.elements.back().tags);
+    push_info(context, with_meta, info, target);
+  }
+
+
+  void decode_dense_nodes(const Block_Context& context, const Byte_Range& range, bool with_meta,
+      Pbf_Elements< Node >& target)
+  {
+    Packed_Varints ids;
+    Packed_Varints lats;
+    Packed_Varints lons;
+    Packed_Varints keys_vals;
+    Byte_Range dense_info;
+    Proto_Message message(range);
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+        ids = message.bytes();
+      else if (message.get_field() == 5)
+        dense_info = message.bytes();
+      else if (message.get_field() == 8)
+        lats = message.bytes();
+      else if (message.get_field() == 9)
+        lons = message.bytes();
+      else if (message.get_field() == 10)
+        keys_vals = message.bytes();
+      else
+        message.skip();
+    }
+
+    Packed_Varints versions;
+    Packed_Varints timestamps;
+    Packed_Varints changesets;
+    Packed_Varints uids;
+    Packed_Varints user_sids;
+    Packed_Varints visibles;
+    bool has_info = (dense_info.first != 0);
+    if (has_info)
+    {
+      Proto_Message info_message(dense_info);
+      while (info_message.next())
+      {
+        if (info_message.get_field() == 1)
+          versions = info_message.bytes();
+        else if (info_message.get_field() == 2)
+          timestamps = info_message.bytes();
+        else if (info_message.get_field() == 3)
+          changesets = info_message.bytes();
+        else if (info_message.get_field() == 4)
+          uids = info_message.bytes();
+        else if (info_message.get_field() == 5)
+          user_sids = info_message.bytes();
+        else if (info_message.get_field() == 6)
+          visibles = info_message.bytes();
+        else
+          info_message.skip();
+      }
+    }
+
+    // All fields except version and visible are delta coded
+    int64 id = 0;
+    int64 lat = 0;
+    int64 lon = 0;
+    int64 timestamp = 0;
+    int64 changeset = 0;
+    int64 uid = 0;
+    int64 user_sid = 0;
+    while (!ids.at_end())
+    {
+      id += ids.next_signed();
+      lat += lats.next_signed_or(0);
+      lon += lons.next_signed_or(0);
+      target.elements.push_back(context.make_node(id, lat, lon));
+
+      Node& node = target.elements.back();
+      while (!keys_vals.at_end())
+      {
+        uint64 key = keys_vals.next();
+        if (key == 0)
+          break;
+        const std::string& key_ = context.string(key);
+        node.tags.push_back(std::make_pair(key_, context.string(keys_vals.next_or(0))));
+      }
+
+      target.deleted.push_back(!visibles.next_or(1));
+      if (with_meta)
+      {
+        target.meta.push_back(OSM_Element_Metadata());
+        if (has_info)
+        {
+          OSM_Element_Metadata& meta = target.meta.back();
+          meta.version = versions.next_or(0);
+          timestamp += timestamps.next_signed_or(0);
+          meta.timestamp = to_timestamp(timestamp * context.date_granularity / 1000);
+          changeset += changesets.next_signed_or(0);
+          meta.changeset = changeset;
+          uid += uids.next_signed_or(0);
+          meta.user_id = uid;
+          user_sid += user_sids.next_signed_or(0);
+          meta.user_name = context.string(user_sid);
+        }
+      }
+    }
+  }
+
+
+  void decode_way(const Block_Context& context, const Byte_Range& range, bool with_meta,
+      Pbf_Elements< Way >& target)
+  {
+    uint64 id = 0;
+    Byte_Range keys;
+    Byte_Range vals;
+    Byte_Range info;
+    Packed_Varints refs;
+    Proto_Message message(range);
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+        id = message.varint();
+      else if (message.get_field() == 2)
+        keys = message.bytes();
+      else if (message.get_field() == 3)
+        vals = message.bytes();
+      else if (message.get_field() == 4)
+        info = message.bytes();
+      else if (message.get_field() == 8)
+        refs = message.bytes();
+      else
+        message.skip();
+    }
+
+    target.elements.push_back(Way(id));
+    Way& way = target.elements.back();
+    decode_tags(context, keys, vals, way.tags);
+    int64 ref = 0;
+    while (!refs.at_end())
+    {
+      ref += refs.next_signed();
+      way.nds.push_back(ref);
+    }
+    push_info(context, with_meta, info, target);
+  }
+
+
+  void decode_relation(const Block_Context& context, const Byte_Range& range, bool with_meta,
+      Pbf_Elements< Relation >& target)
+  {
+    uint64 id = 0;
+    Byte_Range keys;
+    Byte_Range vals;
+    Byte_Range info;
+    Packed_Varints roles;
+    Packed_Varints memids;
+    Packed_Varints types;
+    Proto_Message message(range);
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+        id = message.varint();
+      else if (message.get_field() == 2)
+        keys = message.bytes();
+      else if (message.get_field() == 3)
+        vals = message.bytes();
+      else if (message.get_field() == 4)
+        info = message.bytes();
+      else if (message.get_field() == 8)
+        roles = message.bytes();
+      else if (message.get_field() == 9)
+        memids = message.bytes();
+      else if (message.get_field() == 10)
+        types = message.bytes();
+      else
+        message.skip();
+    }
+
+    target.elements.push_back(Relation(id));
+    Relation& relation = target.elements.back();
+    decode_tags(context, keys, vals, relation.tags);
+    int64 ref = 0;
+    while (!memids.at_end())
+    {
+      ref += memids.next_signed();
+      Relation_Entry entry;
+      entry.ref = ref;
+      uint64 type = types.next_or(0);
+      if (type == 0)
+        entry.type = Relation_Entry::NODE;
+      else if (type == 1)
+        entry.type = Relation_Entry::WAY;
+      else if (type == 2)
+        entry.type = Relation_Entry::RELATION;
+      entry.role = roles.next_or(0);
+      if (entry.role >= context.strings->size())
+        throw Proto_Error("string_index");
+      relation.members.push_back(entry);
+    }
+    push_info(context, with_meta, info, target);
+  }
+
+
+  void decode_primitive_block(const Byte_Range& range, int element_types, bool with_meta, Pbf_Block& block)
+  {
+    // The block parameters follow the groups, hence the groups are decoded in a second pass
+    Block_Context context;
+    context.strings = &block.strings;
+    std::vector< Byte_Range > groups;
+    Proto_Message message(range);
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+      {
+        Proto_Message string_table(message.bytes());
+        while (string_table.next())
+        {
+          if (string_table.get_field() == 1)
+            block.strings.push_back(string_table.string());
+          else
+            string_table.skip();
+        }
+      }
+      else if (message.get_field() == 2)
+        groups.push_back(message.bytes());
+      else if (message.get_field() == 17)
+        context.granularity = message.varint();
+      else if (message.get_field() == 18)
+        context.date_granularity = message.varint();
+      else if (message.get_field() == 19)
+        context.lat_offset = message.varint();
+      else if (message.get_field() == 20)
+        context.lon_offset = message.varint();
+      else
+        message.skip();
+    }
+
+    for (std::vector< Byte_Range >::const_iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+      Proto_Message group(*it);
+      while (group.next())
+      {
+        if (group.get_field() == 1 && (element_types & Pbf_Reader::NODES))
+          decode_node(context, group.bytes(), with_meta, block.nodes);
+        else if (group.get_field() == 2 && (element_types & Pbf_Reader::NODES))
+          decode_dense_nodes(context, group.bytes(), with_meta, block.nodes);
+        else if (group.get_field() == 3 && (element_types & Pbf_Reader::WAYS))
+          decode_way(context, group.bytes(), with_meta, block.ways);
+        else if (group.get_field() == 4 && (element_types & Pbf_Reader::RELATIONS))
+          decode_relation(context, group.bytes(), with_meta, block.relations);
+        else
+          group.skip();
+      }
+    }
+  }
+
+
+  // Returns the payload of a Blob message. It points into data or into buffer.
+  Byte_Range uncompress_blob(const std::string& data, std::string& buffer)
+  {
+    Byte_Range raw;
+    Byte_Range zlib_data;
+    uint64 raw_size = 0;
+    Proto_Message message(Byte_Range(data.data(), data.data() + data.size()));
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+        raw = message.bytes();
+      else if (message.get_field() == 2)
+        raw_size = message.varint();
+      else if (message.get_field() == 3)
+        zlib_data = message.bytes();
+      else if (message.get_field() >= 4 && message.get_field() <= 7)
+        throw Proto_Error("unsupported_compression");
+      else
+        message.skip();
+    }
+
+    if (raw.first)
+      return raw;
+    if (!zlib_data.first)
+      return Byte_Range(data.data(), data.data());
+    if (raw_size > MAX_BLOB_SIZE)
+      throw Proto_Error("blob_too_large");
+
+    buffer.resize(raw_size);
+    if (raw_size > 0)
+    {
+      Zlib_Inflate inflate;
+      if (inflate.decompress(zlib_data.first, zlib_data.second - zlib_data.first, &buffer[0], raw_size)
+          != (int)raw_size)
+        throw Proto_Error("raw_size");
+    }
+    return Byte_Range(buffer.data(), buffer.data() + buffer.size());
+  }
+}
+
+
+Pbf_Reader::Pbf_Reader(FILE* in_, const std::string& source_name_, int element_types_, bool with_meta_,
+    uint num_threads)
+    : in(in_), source_name(source_name_), element_types(element_types_), with_meta(with_meta_), eof(false),
+      max_jobs(num_threads > 0 ? 2*num_threads : 1), shutting_down(false)
+{
+  std::string type;
+  std::string data;
+  if (!read_blob(type, data) || type != "OSMHeader")
+    throw File_Error(0, source_name, "Pbf_Reader::no_header");
+
+  try
+  {
+    std::string buffer;
+    Proto_Message header(uncompress_blob(data, buffer));
+    while (header.next())
+    {
+      if (header.get_field() == 4)
+      {
+        std::string feature = header.string();
+        if (feature != "OsmSchema-V0.6" && feature != "DenseNodes" && feature != "HistoricalInformation")
+          throw File_Error(0, source_name, "Pbf_Reader::unsupported_feature::" + feature);
+      }
+      else
+        header.skip();
+    }
+  }
+  catch (const Proto_Error& e)
+  {
+    throw File_Error(0, source_name, "Pbf_Reader::header::" + e.origin);
+  }
+  catch (const Zlib_Inflate::Error& e)
+  {
+    throw File_Error(e.error_code, source_name, "Pbf_Reader::header::zlib");
+  }
+
+  pthread_mutex_init(&mutex, 0);
+  pthread_cond_init(&job_added, 0);
+  pthread_cond_init(&job_done, 0);
+  for (uint i = 0; i < num_threads; ++i)
+  {
+    pthread_t worker;
+    if (pthread_create(&worker, 0, &Pbf_Reader::work, this) == 0)
+      workers.push_back(worker);
+  }
+}
+
+
+Pbf_Reader::~Pbf_Reader()
+{
+  pthread_mutex_lock(&mutex);
+  shutting_down = true;
+  pthread_cond_broadcast(&job_added);
+  pthread_mutex_unlock(&mutex);
+  for (std::vector< pthread_t >::const_iterator it = workers.begin(); it != workers.end(); ++it)
+    pthread_join(*it, 0);
+
+  for (std::deque< Job* >::const_iterator it = jobs.begin(); it != jobs.end(); ++it)
+    delete *it;
+  pthread_cond_destroy(&job_done);
+  pthread_cond_destroy(&job_added);
+  pthread_mutex_destroy(&mutex);
+}
+
+
+bool Pbf_Reader::read_blob(std::string& type, std::string& data)
+{
+  uint8 size_buf[4];
+  size_t bytes_read = fread(size_buf, 1, 4, in);
+  if (bytes_read == 0 && feof(in))
+    return false;
+  if (bytes_read < 4)
+    throw File_Error(errno, source_name, "Pbf_Reader::read_blob::1");
+
+  uint32 header_size = (uint32(size_buf[0])<<24) | (uint32(size_buf[1])<<16)
+      | (uint32(size_buf[2])<<8) | uint32(size_buf[3]);
+  if (header_size > MAX_BLOB_HEADER_SIZE)
+    throw File_Error(0, source_name, "Pbf_Reader::read_blob::header_too_large");
+
+  std::string header(header_size, '\0');
+  if (header_size > 0 && fread(&header[0], 1, header_size, in) < header_size)
+    throw File_Error(errno, source_name, "Pbf_Reader::read_blob::2");
+
+  uint64 data_size = 0;
+  type.clear();
+  try
+  {
+    Proto_Message message(Byte_Range(header.data(), header.data() + header.size()));
+    while (message.next())
+    {
+      if (message.get_field() == 1)
+        type = message.string();
+      else if (message.get_field() == 3)
+        data_size = message.varint();
+      else
+        message.skip();
+    }
+  }
+  catch (const Proto_Error& e)
+  {
+    throw File_Error(0, source_name, "Pbf_Reader::read_blob::" + e.origin);
+  }
+  if (data_size > MAX_BLOB_SIZE)
+    throw File_Error(0, source_name, "Pbf_Reader::read_blob::blob_too_large");
+
+  data.resize(data_size);
+  if (data_size > 0 && fread(&data[0], 1, data_size, in) < data_size)
+    throw File_Error(errno, source_name, "Pbf_Reader::read_blob::3");
+  return true;
+}
+
+
+void Pbf_Reader::fill_queue()
+{
+  while (!eof && jobs.size() < max_jobs)
+  {
+    Job* job = new Job();
+    std::string type;
+    while (true)
+    {
+      if (!read_blob(type, job->data))
+      {
+        eof = true;
+        break;
+      }
+      // Blobs of unknown types shall be skipped
+      if (type == "OSMData")
+        break;
+    }
+    if (eof)
+    {
+      delete job;
+      break;
+    }
+
+    pthread_mutex_lock(&mutex);
+    jobs.push_back(job);
+    pthread_cond_signal(&job_added);
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+
+void Pbf_Reader::decode(Job& job) const
+{
+  try
+  {
+    std::string buffer;
+    decode_primitive_block(uncompress_blob(job.data, buffer), element_types, with_meta, job.block);
+  }
+  catch (const Proto_Error& e)
+  {
+    job.error = e.origin;
+  }
+  catch (const Zlib_Inflate::Error& e)
+  {
+    job.error = "zlib";
+  }
+  catch (const std::bad_alloc& e)
+  {
+    job.error = "bad_alloc";
+  }
+  std::string().swap(job.data);
+}
+
+
+void* Pbf_Reader::work(void* reader_)
+{
+  Pbf_Reader& reader = *(Pbf_Reader*)reader_;
+  pthread_mutex_lock(&reader.mutex);
+  while (true)
+  {
+    Job* job = 0;
+    for (std::deque< Job* >::const_iterator it = reader.jobs.begin(); it != reader.jobs.end(); ++it)
+    {
+      if (!(*it)->started)
+      {
+        job = *it;
+        break;
+      }
+    }
+
+    if (job)
+    {
+      job->started = true;
+      pthread_mutex_unlock(&reader.mutex);
+      reader.decode(*job);
+      pthread_mutex_lock(&reader.mutex);
+      job->done = true;
+      pthread_cond_broadcast(&reader.job_done);
+    }
+    else if (reader.shutting_down)
+      break;
+    else
+      pthread_cond_wait(&reader.job_added, &reader.mutex);
+  }
+  pthread_mutex_unlock(&reader.mutex);
+  return 0;
+}
+
+
+bool Pbf_Reader::read_block(Pbf_Block& block)
+{
+  fill_queue();
+  if (jobs.empty())
+    return false;
+
+  Job* job = jobs.front();
+  if (workers.empty())
+  {
+    decode(*job);
+    jobs.pop_front();
+  }
+  else
+  {
+    pthread_mutex_lock(&mutex);
+    while (!job->done)
+      pthread_cond_wait(&job_done, &mutex);
+    jobs.pop_front();
+    pthread_mutex_unlock(&mutex);
+  }
+
+  // Keep the workers busy while the caller processes this block
+  fill_queue();
+
+  if (!job->error.empty())
+  {
+    std::string error = job->error;
+    delete job;
+    throw File_Error(0, source_name, "Pbf_Reader::decode::" + error);
+  }
+
+  block.clear();
+  block.swap(job->block);
+  delete job;
+  return true;
+}
+
+
+uint Pbf_Reader::default_num_threads()
+{
+  long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+  return num_processors > 1 ? num_processors - 1 : 0;
+}
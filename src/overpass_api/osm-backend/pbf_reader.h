@@ -0,0 +1,149 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___OVERPASS_API__OSM_BACKEND__PBF_READER_H
+#define DE__OSM3S___OVERPASS_API__OSM_BACKEND__PBF_READER_H
+
+#include "../core/datatypes.h"
+#include "../core/type_node.h"
+#include "../core/type_relation.h"
+#include "../core/type_way.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+
+/** The elements of one type from a decoded OSMData blob. */
+template< typename Element >
+struct Pbf_Elements
+{
+  std::vector< Element > elements;
+  // Parallel to elements. Empty if metadata was not requested.
+  std::vector< OSM_Element_Metadata > meta;
+  // Parallel to elements. History files mark deleted versions as not visible.
+  std::vector< bool > deleted;
+
+  void clear()
+  {
+    elements.clear();
+    meta.clear();
+    deleted.clear();
+  }
+
+  void swap(Pbf_Elements& rhs)
+  {
+    elements.swap(rhs.elements);
+    meta.swap(rhs.meta);
+    deleted.swap(rhs.deleted);
+  }
+};
+
+
+/** The decoded content of one OSMData blob.
+    The role of each relation member is an index into strings, because only the updater can assign role ids. */
+struct Pbf_Block
+{
+  Pbf_Elements< Node > nodes;
+  Pbf_Elements< Way > ways;
+  Pbf_Elements< Relation > relations;
+  std::vector< std::string > strings;
+
+  void clear()
+  {
+    nodes.clear();
+    ways.clear();
+    relations.clear();
+    strings.clear();
+  }
+
+  void swap(Pbf_Block& rhs)
+  {
+    nodes.swap(rhs.nodes);
+    ways.swap(rhs.ways);
+    relations.swap(rhs.relations);
+    strings.swap(rhs.strings);
+  }
+};
+
+
+/** Reads an OSM PBF file. The blobs are read sequentially, decompressed and decoded by num_threads
+    worker threads, and returned in file order. With zero threads, read_block decodes itself.
+    Errors in the file are reported as File_Error. */
+class Pbf_Reader
+{
+public:
+  static const int NODES = 1;
+  static const int WAYS = 2;
+  static const int RELATIONS = 4;
+
+  Pbf_Reader(FILE* in, const std::string& source_name, int element_types, bool with_meta, uint num_threads);
+  ~Pbf_Reader();
+
+  // Returns false at the end of the file
+  bool read_block(Pbf_Block& block);
+
+  // One thread less than processors online, because the calling thread runs the updater
+  static uint default_num_threads();
+
+private:
+  struct Job
+  {
+    Job() : started(false), done(false) {}
+
+    std::string data;
+    Pbf_Block block;
+    bool started;
+    bool done;
+    std::string error;
+  };
+
+  FILE* in;
+  std::string source_name;
+  int element_types;
+  bool with_meta;
+  bool eof;
+  uint max_jobs;
+
+  std::deque< Job* > jobs;
+  std::vector< pthread_t > workers;
+  pthread_mutex_t mutex;
+  pthread_cond_t job_added;
+  pthread_cond_t job_done;
+  bool shutting_down;
+
+  bool read_blob(std::string& type, std::string& data);
+  void fill_queue();
+  void decode(Job& job) const;
+  static void* work(void* reader);
+};
+
+
+/** Returns true if the first bytes of a stream that are already known look like an OSM PBF file
+    rather than OSM XML. */
+inline bool is_pbf_start(int first_byte)
+{
+  // A PBF file starts with the big endian size of its first BlobHeader
+  return first_byte == 0;
+}
+
+
+#endif
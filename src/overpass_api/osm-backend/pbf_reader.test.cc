@@ -0,0 +1,347 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pbf_reader.h"
+#include "../../template_db/types.h"
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+// A minimal protobuf encoder, just enough to write test files.
+
+std::string varint(uint64 value)
+{
+  std::string result;
+  while (value >= 0x80)
+  {
+    result += char((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  return result + char(value);
+}
+
+
+uint64 zigzag(int64 value)
+{
+  return (uint64(value)<<1) ^ uint64(value>>63);
+}
+
+
+std::string field_varint(uint32 field, uint64 value)
+{
+  return varint(field<<3) + varint(value);
+}
+
+
+std::string field_bytes(uint32 field, const std::string& value)
+{
+  return varint((field<<3) | 2) + varint(value.size()) + value;
+}
+
+
+std::string packed(const std::vector< uint64 >& values)
+{
+  std::string result;
+  for (std::vector< uint64 >::const_iterator it = values.begin(); it != values.end(); ++it)
+    result += varint(*it);
+  return result;
+}
+
+
+std::string packed_delta(const std::vector< int64 >& values)
+{
+  std::vector< uint64 > deltas;
+  int64 last = 0;
+  for (std::vector< int64 >::const_iterator it = values.begin(); it != values.end(); ++it)
+  {
+    deltas.push_back(zigzag(*it - last));
+    last = *it;
+  }
+  return packed(deltas);
+}
+
+
+std::string file_block(const std::string& type, const std::string& payload, bool compress)
+{
+  std::string blob;
+  if (compress)
+  {
+    std::vector< Bytef > buffer(compressBound(payload.size()));
+    uLongf size = buffer.size();
+    compress2(&buffer[0], &size, (const Bytef*)payload.data(), payload.size(), 6);
+    blob = field_varint(2, payload.size()) + field_bytes(3, std::string((const char*)&buffer[0], size));
+  }
+  else
+    blob = field_bytes(1, payload);
+
+  std::string header = field_bytes(1, type) + field_varint(3, blob.size());
+  std::string size;
+  size += char(header.size()>>24);
+  size += char(header.size()>>16);
+  size += char(header.size()>>8);
+  size += char(header.size());
+  return size + header + blob;
+}
+
+
+std::string string_table(const char** strings)
+{
+  std::string table;
+  for (; *strings; ++strings)
+    table += field_bytes(1, *strings);
+  return field_bytes(1, table);
+}
+
+
+std::string test_file()
+{
+  std::string result = file_block("OSMHeader",
+      field_bytes(4, "OsmSchema-V0.6") + field_bytes(4, "DenseNodes"), false);
+
+  // Dense nodes with metadata, the last one deleted
+  {
+    const char* strings[] = { "", "highway", "bus_stop", "name", "Halt", "alice", "bob", 0 };
+    std::vector< int64 > ids;
+    ids.push_back(1);
+    ids.push_back(2);
+    ids.push_back(10);
+    std::vector< int64 > lats;
+    lats.push_back(515000000);
+    lats.push_back(515001000);
+    lats.push_back(-335000000);
+    std::vector< int64 > lons;
+    lons.push_back(-1000000);
+    lons.push_back(-999000);
+    lons.push_back(1512000000);
+    std::vector< uint64 > keys_vals;
+    keys_vals.push_back(1);
+    keys_vals.push_back(2);
+    keys_vals.push_back(3);
+    keys_vals.push_back(4);
+    keys_vals.push_back(0);
+    keys_vals.push_back(0);
+    keys_vals.push_back(0);
+    std::vector< uint64 > versions;
+    versions.push_back(1);
+    versions.push_back(3);
+    versions.push_back(2);
+    std::vector< int64 > timestamps;
+    timestamps.push_back(1262304000);
+    timestamps.push_back(1262304061);
+    timestamps.push_back(1500000000);
+    std::vector< int64 > changesets;
+    changesets.push_back(100);
+    changesets.push_back(101);
+    changesets.push_back(99);
+    std::vector< int64 > uids;
+    uids.push_back(7);
+    uids.push_back(8);
+    uids.push_back(7);
+    std::vector< int64 > user_sids;
+    user_sids.push_back(5);
+    user_sids.push_back(6);
+    user_sids.push_back(5);
+    std::vector< uint64 > visibles;
+    visibles.push_back(1);
+    visibles.push_back(1);
+    visibles.push_back(0);
+
+    std::string dense_info = field_bytes(1, packed(versions)) + field_bytes(2, packed_delta(timestamps))
+        + field_bytes(3, packed_delta(changesets)) + field_bytes(4, packed_delta(uids))
+        + field_bytes(5, packed_delta(user_sids)) + field_bytes(6, packed(visibles));
+    std::string dense = field_bytes(1, packed_delta(ids)) + field_bytes(5, dense_info)
+        + field_bytes(8, packed_delta(lats)) + field_bytes(9, packed_delta(lons))
+        + field_bytes(10, packed(keys_vals));
+    result += file_block("OSMData", string_table(strings) + field_bytes(2, field_bytes(2, dense)), false);
+  }
+
+  // Blobs of unknown types must be skipped
+  result += file_block("OSMIndex", "whatever", false);
+
+  // A plain node, a way and a relation in a compressed blob with custom granularity and offset
+  {
+    const char* strings[] = { "", "highway", "residential", "type", "route", "stop", "", "carol", 0 };
+    std::string info = field_varint(1, 4) + field_varint(2, 1262304000) + field_varint(3, 200)
+        + field_varint(4, 9) + field_varint(5, 7);
+    std::string node = field_varint(1, zigzag(3)) + field_bytes(4, info)
+        + field_varint(8, zigzag(5150)) + field_varint(9, zigzag(-10));
+
+    std::vector< uint64 > keys;
+    keys.push_back(1);
+    std::vector< uint64 > vals;
+    vals.push_back(2);
+    std::vector< int64 > refs;
+    refs.push_back(1);
+    refs.push_back(2);
+    refs.push_back(10);
+    refs.push_back(1);
+    std::string way = field_varint(1, 5) + field_bytes(2, packed(keys)) + field_bytes(3, packed(vals))
+        + field_bytes(4, info) + field_bytes(8, packed_delta(refs));
+
+    std::vector< uint64 > rel_keys;
+    rel_keys.push_back(3);
+    std::vector< uint64 > rel_vals;
+    rel_vals.push_back(4);
+    std::vector< uint64 > roles;
+    roles.push_back(5);
+    roles.push_back(6);
+    std::vector< int64 > memids;
+    memids.push_back(1);
+    memids.push_back(5);
+    std::vector< uint64 > types;
+    types.push_back(0);
+    types.push_back(1);
+    std::string relation = field_varint(1, 6) + field_bytes(2, packed(rel_keys))
+        + field_bytes(3, packed(rel_vals)) + field_bytes(8, packed(roles))
+        + field_bytes(9, packed_delta(memids)) + field_bytes(10, packed(types));
+
+    std::string groups = field_bytes(2, field_bytes(1, node)) + field_bytes(2, field_bytes(3, way))
+        + field_bytes(2, field_bytes(4, relation));
+    result += file_block("OSMData", string_table(strings) + groups + field_varint(17, 10000)
+        + field_varint(18, 1000) + field_varint(19, 100000) + field_varint(20, 0), true);
+  }
+
+  return result;
+}
+
+
+void print_meta(const Pbf_Elements< Node >& elems, uint i)
+{
+  if (i < elems.meta.size())
+    std::cout<<" version "<<elems.meta[i].version<<" timestamp "<<elems.meta[i].timestamp
+        <<" changeset "<<elems.meta[i].changeset<<" uid "<<elems.meta[i].user_id
+        <<" user \""<<elems.meta[i].user_name<<'"';
+  std::cout<<(elems.deleted[i] ? " deleted" : "")<<'\n';
+}
+
+
+template< typename Element >
+void print_tags(const Element& elem)
+{
+  for (std::vector< std::pair< std::string, std::string > >::const_iterator it = elem.tags.begin();
+      it != elem.tags.end(); ++it)
+    std::cout<<"  "<<it->first<<" = "<<it->second<<'\n';
+}
+
+
+void print_block(const Pbf_Block& block)
+{
+  std::cout<<"block\n";
+  for (uint i = 0; i < block.nodes.elements.size(); ++i)
+  {
+    const Node& node = block.nodes.elements[i];
+    std::cout<<"node "<<node.id.val()<<' '<<lat(node.index, node.ll_lower_)<<' '
+        <<lon(node.index, node.ll_lower_);
+    print_meta(block.nodes, i);
+    print_tags(node);
+  }
+  for (uint i = 0; i < block.ways.elements.size(); ++i)
+  {
+    const Way& way = block.ways.elements[i];
+    std::cout<<"way "<<way.id.val()<<(block.ways.deleted[i] ? " deleted" : "")
+        <<(i < block.ways.meta.size() ? " with meta" : "")<<'\n';
+    for (std::vector< Node::Id_Type >::const_iterator it = way.nds.begin(); it != way.nds.end(); ++it)
+      std::cout<<"  nd "<<it->val()<<'\n';
+    print_tags(way);
+  }
+  for (uint i = 0; i < block.relations.elements.size(); ++i)
+  {
+    const Relation& relation = block.relations.elements[i];
+    std::cout<<"relation "<<relation.id.val()<<(block.relations.deleted[i] ? " deleted" : "")<<'\n';
+    for (std::vector< Relation_Entry >::const_iterator it = relation.members.begin();
+        it != relation.members.end(); ++it)
+      std::cout<<"  member "<<it->type<<' '<<it->ref.val()<<" \""<<block.strings[it->role]<<"\"\n";
+    print_tags(relation);
+  }
+}
+
+
+void read_file(const std::string& file_name, int element_types, bool with_meta, uint num_threads)
+{
+  FILE* in = fopen(file_name.c_str(), "rb");
+  try
+  {
+    Pbf_Reader reader(in, file_name, element_types, with_meta, num_threads);
+    Pbf_Block block;
+    while (reader.read_block(block))
+      print_block(block);
+  }
+  catch (const File_Error& e)
+  {
+    std::cout<<"File_Error "<<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+  }
+  fclose(in);
+}
+
+
+int main(int argc, char* args[])
+{
+  if (argc < 2)
+  {
+    std::cout<<"Usage: "<<args[0]<<" test_to_execute\n"
+        "       "<<args[0]<<" fixture output_file\n";
+    return 0;
+  }
+  std::string test_to_execute = args[1];
+
+  if (test_to_execute == "fixture" && argc >= 3)
+  {
+    // Only write the test file, e.g. to feed it to update_database
+    std::string content = test_file();
+    FILE* out = fopen(args[2], "wb");
+    fwrite(content.data(), 1, content.size(), out);
+    fclose(out);
+    return 0;
+  }
+
+  std::string file_name = "pbf_reader_test.osm.pbf";
+  {
+    std::string content = test_file();
+    FILE* out = fopen(file_name.c_str(), "wb");
+    fwrite(content.data(), 1, content.size(), out);
+    fclose(out);
+  }
+  const int ALL = Pbf_Reader::NODES | Pbf_Reader::WAYS | Pbf_Reader::RELATIONS;
+
+  if ((test_to_execute == "") || (test_to_execute == "1"))
+    // All elements with metadata, decoded by the calling thread
+    read_file(file_name, ALL, true, 0);
+  if ((test_to_execute == "") || (test_to_execute == "2"))
+    // The same with worker threads
+    read_file(file_name, ALL, true, 3);
+  if ((test_to_execute == "") || (test_to_execute == "3"))
+    // Only ways, without metadata
+    read_file(file_name, Pbf_Reader::WAYS, false, 2);
+  if ((test_to_execute == "") || (test_to_execute == "4"))
+  {
+    // A truncated file
+    std::string content = test_file();
+    FILE* out = fopen(file_name.c_str(), "wb");
+    fwrite(content.data(), 1, content.size() - 10, out);
+    fclose(out);
+    read_file(file_name, ALL, true, 2);
+  }
+
+  remove(file_name.c_str());
+  return 0;
+}
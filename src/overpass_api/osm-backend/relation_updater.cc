@@ -788,7 +788,8 @@ void adapt_newest_existing_attic
      std::map< Uint31_Index, std::set< Attic< Relation_Delta > > >& attic_skeletons_to_delete,
      std::map< Uint31_Index, std::set< Attic< Relation_Delta > > >& full_attic)
 {
-  Relation_Delta new_delta(old_idx == new_idx ? new_reference : Relation_Skeleton(),
+  // Full deltas are kept full such that keyframes survive
+  Relation_Delta new_delta(old_idx == new_idx && !existing_delta.full ? new_reference : Relation_Skeleton(),
 			   existing_delta.expand(existing_reference));
   if (new_delta.members_added != existing_delta.members_added
       || new_delta.members_removed != existing_delta.members_removed
@@ -1169,31 +1170,66 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
   new_current_global_tags< Relation_Skeleton::Id_Type >
       (attic_local_tags, new_local_tags, attic_global_tags, new_global_tags);
 
+  // Compute which reverse references have changed
+  bool reverse_refs = maintain_reverse_refs(*transaction);
+  std::map< Node::Id_Type, std::set< Relation_Skeleton::Id_Type > > attic_node_relations;
+  std::map< Node::Id_Type, std::set< Relation_Skeleton::Id_Type > > new_node_relations;
+  std::map< Way::Id_Type, std::set< Relation_Skeleton::Id_Type > > attic_way_relations;
+  std::map< Way::Id_Type, std::set< Relation_Skeleton::Id_Type > > new_way_relations;
+  std::map< Relation::Id_Type, std::set< Relation_Skeleton::Id_Type > > attic_relation_relations;
+  std::map< Relation::Id_Type, std::set< Relation_Skeleton::Id_Type > > new_relation_relations;
+  if (reverse_refs)
+  {
+    new_current_reverse_refs(attic_skeletons, new_skeletons,
+        Relation_Member_Refs< Node::Id_Type >(Relation_Entry::NODE), attic_node_relations, new_node_relations);
+    new_current_reverse_refs(attic_skeletons, new_skeletons,
+        Relation_Member_Refs< Way::Id_Type >(Relation_Entry::WAY), attic_way_relations, new_way_relations);
+    new_current_reverse_refs(attic_skeletons, new_skeletons,
+        Relation_Member_Refs< Relation::Id_Type >(Relation_Entry::RELATION),
+        attic_relation_relations, new_relation_relations);
+  }
+
   add_deleted_skeletons(attic_skeletons, new_positions);
 
   callback->update_started();
   callback->prepare_delete_tags_finished();
 
-  store_new_keys(new_data, keys, *transaction);
+  {
+    Worker_Pool pool;
 
-  // Update id indexes
-  update_map_positions(new_positions, *transaction, *osm_base_settings().RELATIONS);
-  callback->update_ids_finished();
+    // Update id indexes
+    update_map_positions(new_positions, *transaction, *osm_base_settings().RELATIONS, pool);
 
-  // Update skeletons
-  update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().RELATIONS);
-  callback->update_coords_finished();
+    // Update skeletons
+    update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().RELATIONS, pool);
 
-  // Update meta
-  if (meta)
-    update_elements(attic_meta, new_meta, *transaction, *meta_settings().RELATIONS_META);
+    // Update reverse references
+    if (reverse_refs)
+    {
+      update_elements(attic_node_relations, new_node_relations,
+                      *transaction, *osm_base_settings().NODE_RELATIONS, pool);
+      update_elements(attic_way_relations, new_way_relations,
+                      *transaction, *osm_base_settings().WAY_RELATIONS, pool);
+      update_elements(attic_relation_relations, new_relation_relations,
+                      *transaction, *osm_base_settings().RELATION_RELATIONS, pool);
+    }
 
-  // Update local tags
-  update_elements(attic_local_tags, new_local_tags, *transaction, *osm_base_settings().RELATION_TAGS_LOCAL);
-  callback->tags_local_finished();
+    // Update meta
+    if (meta)
+      update_elements(attic_meta, new_meta, *transaction, *meta_settings().RELATIONS_META, pool);
 
-  // Update global tags
-  update_elements(attic_global_tags, new_global_tags, *transaction, *osm_base_settings().RELATION_TAGS_GLOBAL);
+    // Update local tags
+    update_elements(attic_local_tags, new_local_tags, *transaction, *osm_base_settings().RELATION_TAGS_LOCAL, pool);
+
+    // Update global tags
+    update_elements(attic_global_tags, new_global_tags, *transaction, *osm_base_settings().RELATION_TAGS_GLOBAL, pool);
+
+    store_new_keys(new_data, keys, *transaction);
+    pool.wait();
+  }
+  callback->update_ids_finished();
+  callback->update_coords_finished();
+  callback->tags_local_finished();
   callback->tags_global_finished();
 
   flush_roles();
@@ -1216,13 +1252,15 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
         = get_existing_idx_lists(ids_to_update_, existing_attic_map_positions,
                                  *transaction, *attic_settings().RELATION_IDX_LIST);
 
+    std::map< Relation_Skeleton::Id_Type, Delta_Run > existing_delta_runs;
+
     // Collect known change times of attic elements. This allows that
     // for each object no older version than the youngest known attic version can be written
     std::map< Relation_Skeleton::Id_Type, std::pair< Uint31_Index, Attic< Relation_Delta > > >
         existing_attic_skeleton_timestamps
         = get_existing_attic_skeleton_timestamps< Uint31_Index, Relation_Skeleton, Relation_Delta >
         (existing_attic_map_positions, existing_idx_lists,
-	 *transaction, *attic_settings().RELATIONS, *attic_settings().RELATIONS_UNDELETED);
+	 *transaction, *attic_settings().RELATIONS, *attic_settings().RELATIONS_UNDELETED, &existing_delta_runs);
 
     // Compute which objects really have changed
     new_attic_skeletons.clear();
@@ -1236,6 +1274,9 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
                                 new_way_idx_by_id, new_attic_way_skeletons,
                                 new_attic_skeletons, new_undeleted, new_attic_idx_lists, attic_skeletons_to_delete);
 
+    // Store some versions in full to bound the number of deltas to apply when reconstructing
+    add_attic_keyframes(new_skeletons, existing_delta_runs, new_attic_skeletons);
+
     std::map< Relation_Skeleton::Id_Type, std::vector< Attic< Uint31_Index > > > new_attic_idx_by_id_and_time =
         compute_new_attic_idx_by_id_and_time(new_data, new_skeletons, new_attic_skeletons);
 
@@ -1259,6 +1300,20 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
                             new_node_idx_by_id, new_attic_node_skeletons,
                             new_way_idx_by_id, new_attic_way_skeletons);
 
+    // Compute removed reverse references
+    std::map< Node::Id_Type, std::set< Attic< Relation_Skeleton::Id_Type > > > new_attic_node_relations;
+    std::map< Way::Id_Type, std::set< Attic< Relation_Skeleton::Id_Type > > > new_attic_way_relations;
+    std::map< Relation::Id_Type, std::set< Attic< Relation_Skeleton::Id_Type > > > new_attic_relation_relations;
+    if (reverse_refs)
+    {
+      new_attic_node_relations = new_attic_reverse_refs(new_data, attic_skeletons,
+          Relation_Member_Refs< Node::Id_Type >(Relation_Entry::NODE));
+      new_attic_way_relations = new_attic_reverse_refs(new_data, attic_skeletons,
+          Relation_Member_Refs< Way::Id_Type >(Relation_Entry::WAY));
+      new_attic_relation_relations = new_attic_reverse_refs(new_data, attic_skeletons,
+          Relation_Member_Refs< Relation::Id_Type >(Relation_Entry::RELATION));
+    }
+
     strip_single_idxs(existing_idx_lists);
     std::vector< std::pair< Relation_Skeleton::Id_Type, Uint31_Index > > new_attic_map_positions
         = strip_single_idxs(new_attic_idx_lists);
@@ -1266,36 +1321,41 @@ void Relation_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu
     // Prepare user indices
     copy_idxs_by_id(new_attic_meta, idxs_by_id);
 
+    Worker_Pool pool;
+
     // Update id indexes
-    update_map_positions(new_attic_map_positions, *transaction, *attic_settings().RELATIONS);
+    update_map_positions(new_attic_map_positions, *transaction, *attic_settings().RELATIONS, pool);
 
     // Update id index lists
     update_elements(existing_idx_lists, new_attic_idx_lists,
-                    *transaction, *attic_settings().RELATION_IDX_LIST);
+                    *transaction, *attic_settings().RELATION_IDX_LIST, pool);
 
     // Add attic elements
     update_elements(attic_skeletons_to_delete, new_attic_skeletons,
-                    *transaction, *attic_settings().RELATIONS);
+                    *transaction, *attic_settings().RELATIONS, pool);
 
     // Add attic elements
-    update_elements(std::map< Uint31_Index, std::set< Attic< Relation_Skeleton::Id_Type > > >(),
-                    new_undeleted, *transaction, *attic_settings().RELATIONS_UNDELETED);
+    add_elements(new_undeleted, *transaction, *attic_settings().RELATIONS_UNDELETED, pool);
 
     // Add attic meta
-    update_elements
-        (std::map< Uint31_Index, std::set< OSM_Element_Metadata_Skeleton< Relation_Skeleton::Id_Type > > >(),
-         new_attic_meta, *transaction, *attic_settings().RELATIONS_META);
+    add_elements(new_attic_meta, *transaction, *attic_settings().RELATIONS_META, pool);
 
     // Update tags
-    update_elements(std::map< Tag_Index_Local, std::set< Attic < Relation_Skeleton::Id_Type > > >(),
-                    new_attic_local_tags, *transaction, *attic_settings().RELATION_TAGS_LOCAL);
-    update_elements(std::map< Tag_Index_Global,
-                        std::set< Attic < Tag_Object_Global< Relation_Skeleton::Id_Type > > > >(),
-                    new_attic_global_tags, *transaction, *attic_settings().RELATION_TAGS_GLOBAL);
+    add_elements(new_attic_local_tags, *transaction, *attic_settings().RELATION_TAGS_LOCAL, pool);
+    add_elements(new_attic_global_tags, *transaction, *attic_settings().RELATION_TAGS_GLOBAL, pool);
 
     // Write changelog
-    update_elements(std::map< Timestamp, std::set< Change_Entry< Relation_Skeleton::Id_Type > > >(), changelog,
-                    *transaction, *attic_settings().RELATION_CHANGELOG);
+    add_elements(changelog, *transaction, *attic_settings().RELATION_CHANGELOG, pool);
+
+    // Add removed reverse references
+    if (reverse_refs)
+    {
+      add_elements(new_attic_node_relations, *transaction, *attic_settings().NODE_RELATIONS, pool);
+      add_elements(new_attic_way_relations, *transaction, *attic_settings().WAY_RELATIONS, pool);
+      add_elements(new_attic_relation_relations, *transaction, *attic_settings().RELATION_RELATIONS, pool);
+    }
+
+    pool.wait();
 
     flush_roles();
   }
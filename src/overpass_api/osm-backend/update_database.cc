@@ -29,6 +29,7 @@
 #include "../core/settings.h"
 #include "../frontend/output.h"
 #include "osm_updater.h"
+#include "pbf_reader.h"
 
 
 int main(int argc, char* argv[])
@@ -64,44 +65,32 @@ int main(int argc, char* argv[])
     }
     else if (!(strncmp(argv[argpos], "--compression-method=", 21)))
     {
-      if (std::string(argv[argpos]).substr(21) == "no")
-	basic_settings().compression_method = File_Blocks_Index< Uint31_Index >::NO_COMPRESSION;
-      else if (std::string(argv[argpos]).substr(21) == "gz")
-	basic_settings().compression_method = File_Blocks_Index< Uint31_Index >::ZLIB_COMPRESSION;
-#ifdef HAVE_LZ4
-      else if (std::string(argv[argpos]).substr(21) == "lz4")
-        basic_settings().compression_method = File_Blocks_Index< Uint31_Index >::LZ4_COMPRESSION;
-#endif
-      else
+      int method = compression_method_from_name(std::string(argv[argpos]).substr(21));
+      if (method == File_Blocks_Index_Base::USE_DEFAULT)
       {
-#ifdef HAVE_LZ4
-        std::cerr<<"For --compression-method, please use \"no\", \"gz\", or \"lz4\" as value.\n";
-#else
-        std::cerr<<"For --compression-method, please use \"no\" or \"gz\" as value.\n";
-#endif
+        std::cerr<<"For --compression-method, please use one of "<<compression_method_names()<<" as value.\n";
         abort = true;
       }
+      else
+        basic_settings().compression_method = method;
     }
     else if (!(strncmp(argv[argpos], "--map-compression-method=", 25)))
     {
-      if (std::string(argv[argpos]).substr(25) == "no")
-        basic_settings().map_compression_method = File_Blocks_Index< Uint31_Index >::NO_COMPRESSION;
-      else if (std::string(argv[argpos]).substr(25) == "gz")
-        basic_settings().map_compression_method = File_Blocks_Index< Uint31_Index >::ZLIB_COMPRESSION;
-#ifdef HAVE_LZ4
-      else if (std::string(argv[argpos]).substr(25) == "lz4")
-        basic_settings().map_compression_method = File_Blocks_Index< Uint31_Index >::LZ4_COMPRESSION;
-#endif
-      else
+      int method = compression_method_from_name(std::string(argv[argpos]).substr(25));
+      if (method == File_Blocks_Index_Base::USE_DEFAULT)
       {
-#ifdef HAVE_LZ4
-        std::cerr<<"For --map-compression-method, please use \"no\", \"gz\", or \"lz4\" as value.\n";
-#else
-        std::cerr<<"For --map-compression-method, please use \"no\" or \"gz\" as value.\n";
-#endif
+        std::cerr<<"For --map-compression-method, please use one of "<<compression_method_names()<<" as value.\n";
         abort = true;
       }
+      else
+        basic_settings().map_compression_method = method;
     }
+    else if (!(strncmp(argv[argpos], "--compression-level=", 20)))
+      basic_settings().compression_level = atoi(std::string(argv[argpos]).substr(20).c_str());
+    else if (!(strncmp(argv[argpos], "--reverse-refs", 14)))
+      basic_settings().reverse_refs = true;
+    else if (!(strncmp(argv[argpos], "--keyframe-interval=", 20)))
+      basic_settings().attic_keyframe_interval = atoi(std::string(argv[argpos]).substr(20).c_str());
     else
     {
       std::cerr<<"Unkown argument: "<<argv[argpos]<<'\n';
@@ -111,29 +100,41 @@ int main(int argc, char* argv[])
   }
   if (abort)
   {
-#ifdef HAVE_LZ4
-    std::cerr<<"Usage: "<<argv[0]<<" [--db-dir=DIR] [--version=VER] [--meta|--keep-attic] [--flush_size=FLUSH_SIZE]"
-        " [--compression-method=(no|gz|lz4)] [--map-compression-method=(no|gz|lz4)]\n";
-#else
     std::cerr<<"Usage: "<<argv[0]<<" [--db-dir=DIR] [--version=VER] [--meta|--keep-attic] [--flush_size=FLUSH_SIZE]"
-        " [--compression-method=(no|gz)] [--map-compression-method=(no|gz)]\n";
-#endif
+        " [--compression-method="<<compression_method_names()<<"]"
+        " [--map-compression-method="<<compression_method_names()<<"] [--compression-level=LEVEL]"
+        " [--reverse-refs] [--keyframe-interval=VERSIONS]\n";
     return 1;
   }
 
+  // OSM XML starts with a tag or whitespace, OSM PBF with a binary size
+  int first_byte = getc(stdin);
+  if (first_byte != EOF)
+    ungetc(first_byte, stdin);
+  bool pbf = is_pbf_start(first_byte);
+
+  // Updates read whole files, hence reading ahead pays off
+  block_read_ahead_enabled() = true;
+
   try
   {
     if (transactional)
     {
       Osm_Updater osm_updater(get_verbatim_callback(), data_version, meta, flush_limit);
       //reading the main document
-      osm_updater.parse_file_completely(stdin);
+      if (pbf)
+        osm_updater.parse_pbf_completely(stdin, "stdin", Pbf_Reader::default_num_threads());
+      else
+        osm_updater.parse_file_completely(stdin);
     }
     else
     {
       Osm_Updater osm_updater(get_verbatim_callback(), db_dir, data_version, meta, flush_limit);
       //reading the main document
-      osm_updater.parse_file_completely(stdin);
+      if (pbf)
+        osm_updater.parse_pbf_completely(stdin, "stdin", Pbf_Reader::default_num_threads());
+      else
+        osm_updater.parse_file_completely(stdin);
     }
   }
   catch(Context_Error e)
@@ -35,24 +35,31 @@
 #include "relation_updater.h"
 #include "way_updater.h"
 #include "osm_updater.h"
+#include "pbf_reader.h"
 
 
 struct Node_Caller
 {
   public:
     static void parse(FILE* osc_file) { parse_nodes_only(osc_file); }
+    static void parse_pbf(FILE* pbf_file, const std::string& name)
+    { parse_pbf_nodes_only(pbf_file, name, Pbf_Reader::default_num_threads()); }
 };
 
 struct Way_Caller
 {
   public:
     static void parse(FILE* osc_file) { parse_ways_only(osc_file); }
+    static void parse_pbf(FILE* pbf_file, const std::string& name)
+    { parse_pbf_ways_only(pbf_file, name, Pbf_Reader::default_num_threads()); }
 };
 
 struct Relation_Caller
 {
   public:
     static void parse(FILE* osc_file) { parse_relations_only(osc_file); }
+    static void parse_pbf(FILE* pbf_file, const std::string& name)
+    { parse_pbf_relations_only(pbf_file, name, Pbf_Reader::default_num_threads()); }
 };
 
 template < class Caller >
@@ -71,7 +78,10 @@ void process_source_files(const std::string& source_dir,
     if (osc_file)
     {
       //reading the main document
-      Caller::parse(osc_file);
+      if (it->size() >= 4 && it->substr(it->size() - 4) == ".pbf")
+        Caller::parse_pbf(osc_file, source_dir + *it);
+      else
+        Caller::parse(osc_file);
 
       fclose(osc_file);
     }
@@ -149,6 +159,9 @@ int main(int argc, char* argv[])
   }
   std::sort(source_file_names.begin(), source_file_names.end());
 
+  // Updates read whole files, hence reading ahead pays off
+  block_read_ahead_enabled() = true;
+
   try
   {
     if (db_dir == "")
@@ -277,7 +277,8 @@ void adapt_newest_existing_attic
      std::map< Uint31_Index, std::set< Attic< Way_Delta > > >& attic_skeletons_to_delete,
      std::map< Uint31_Index, std::set< Attic< Way_Delta > > >& full_attic)
 {
-  Way_Delta new_delta(old_idx == new_idx ? new_reference : Way_Skeleton(),
+  // Full deltas are kept full such that keyframes survive
+  Way_Delta new_delta(old_idx == new_idx && !existing_delta.full ? new_reference : Way_Skeleton(),
 		      existing_delta.expand(existing_reference));
   if (!(new_delta.id == existing_delta.id)
       || new_delta.full != existing_delta.full
@@ -893,31 +894,47 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
   new_current_global_tags< Way_Skeleton::Id_Type >
       (attic_local_tags, new_local_tags, attic_global_tags, new_global_tags);
 
+  // Compute which reverse references have changed
+  bool reverse_refs = maintain_reverse_refs(*transaction);
+  std::map< Node::Id_Type, std::set< Way_Skeleton::Id_Type > > attic_node_ways;
+  std::map< Node::Id_Type, std::set< Way_Skeleton::Id_Type > > new_node_ways;
+  if (reverse_refs)
+    new_current_reverse_refs(attic_skeletons, new_skeletons, Way_Node_Refs(), attic_node_ways, new_node_ways);
+
   add_deleted_skeletons(attic_skeletons, new_positions);
 
   callback->update_started();
   callback->prepare_delete_tags_finished();
 
-  store_new_keys(new_data, keys, *transaction);
+  {
+    Worker_Pool pool;
 
-  // Update id indexes
-  update_map_positions(new_positions, *transaction, *osm_base_settings().WAYS);
-  callback->update_ids_finished();
+    // Update id indexes
+    update_map_positions(new_positions, *transaction, *osm_base_settings().WAYS, pool);
 
-  // Update skeletons
-  update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().WAYS);
-  callback->update_coords_finished();
+    // Update skeletons
+    update_elements(attic_skeletons, new_skeletons, *transaction, *osm_base_settings().WAYS, pool);
 
-  // Update meta
-  if (meta)
-    update_elements(attic_meta, new_meta, *transaction, *meta_settings().WAYS_META);
+    // Update reverse references
+    if (reverse_refs)
+      update_elements(attic_node_ways, new_node_ways, *transaction, *osm_base_settings().NODE_WAYS, pool);
 
-  // Update local tags
-  update_elements(attic_local_tags, new_local_tags, *transaction, *osm_base_settings().WAY_TAGS_LOCAL);
-  callback->tags_local_finished();
+    // Update meta
+    if (meta)
+      update_elements(attic_meta, new_meta, *transaction, *meta_settings().WAYS_META, pool);
+
+    // Update local tags
+    update_elements(attic_local_tags, new_local_tags, *transaction, *osm_base_settings().WAY_TAGS_LOCAL, pool);
+
+    // Update global tags
+    update_elements(attic_global_tags, new_global_tags, *transaction, *osm_base_settings().WAY_TAGS_GLOBAL, pool);
 
-  // Update global tags
-  update_elements(attic_global_tags, new_global_tags, *transaction, *osm_base_settings().WAY_TAGS_GLOBAL);
+    store_new_keys(new_data, keys, *transaction);
+    pool.wait();
+  }
+  callback->update_ids_finished();
+  callback->update_coords_finished();
+  callback->tags_local_finished();
   callback->tags_global_finished();
 
   std::map< uint32, std::vector< uint32 > > idxs_by_id;
@@ -937,13 +954,15 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
         = get_existing_idx_lists(ids_to_update_, existing_attic_map_positions,
                                  *transaction, *attic_settings().WAY_IDX_LIST);
 
+    std::map< Way_Skeleton::Id_Type, Delta_Run > existing_delta_runs;
+
     // Collect known change times of attic elements. This allows that
     // for each object no older version than the youngest known attic version can be written
     std::map< Way_Skeleton::Id_Type, std::pair< Uint31_Index, Attic< Way_Delta > > >
         existing_attic_skeleton_timestamps
         = get_existing_attic_skeleton_timestamps< Uint31_Index, Way_Skeleton, Way_Delta >
             (existing_attic_map_positions, existing_idx_lists,
-	     *transaction, *attic_settings().WAYS, *attic_settings().WAYS_UNDELETED);
+	     *transaction, *attic_settings().WAYS, *attic_settings().WAYS_UNDELETED, &existing_delta_runs);
 
     // Compute which objects really have changed
     new_attic_skeletons.clear();
@@ -956,6 +975,9 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
                                 new_node_idx_by_id, new_attic_node_skeletons,
                                 new_attic_skeletons, new_undeleted, new_attic_idx_lists, attic_skeletons_to_delete);
 
+    // Store some versions in full to bound the number of deltas to apply when reconstructing
+    add_attic_keyframes(new_skeletons, existing_delta_runs, new_attic_skeletons);
+
     std::map< Way_Skeleton::Id_Type, std::vector< Attic< Uint31_Index > > > new_attic_idx_by_id_and_time =
         compute_new_attic_idx_by_id_and_time(new_data, new_skeletons, new_attic_skeletons);
 
@@ -978,6 +1000,11 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
                             existing_map_positions, existing_attic_map_positions, attic_skeletons,
                             new_node_idx_by_id, new_attic_node_skeletons);
 
+    // Compute removed reverse references
+    std::map< Node::Id_Type, std::set< Attic< Way_Skeleton::Id_Type > > > new_attic_node_ways;
+    if (reverse_refs)
+      new_attic_node_ways = new_attic_reverse_refs(new_data, attic_skeletons, Way_Node_Refs());
+
     strip_single_idxs(existing_idx_lists);
     std::vector< std::pair< Way_Skeleton::Id_Type, Uint31_Index > > new_attic_map_positions
         = strip_single_idxs(new_attic_idx_lists);
@@ -985,36 +1012,37 @@ void Way_Updater::update(Osm_Backend_Callback* callback, Cpu_Stopwatch* cpu_stop
     // Prepare user indices
     copy_idxs_by_id(new_attic_meta, idxs_by_id);
 
+    Worker_Pool pool;
+
     // Update id indexes
-    update_map_positions(new_attic_map_positions, *transaction, *attic_settings().WAYS);
+    update_map_positions(new_attic_map_positions, *transaction, *attic_settings().WAYS, pool);
 
     // Update id index lists
     update_elements(existing_idx_lists, new_attic_idx_lists,
-                    *transaction, *attic_settings().WAY_IDX_LIST);
+                    *transaction, *attic_settings().WAY_IDX_LIST, pool);
 
     // Add attic elements
     update_elements(attic_skeletons_to_delete, new_attic_skeletons,
-                    *transaction, *attic_settings().WAYS);
+                    *transaction, *attic_settings().WAYS, pool);
 
     // Add attic elements
-    update_elements(std::map< Uint31_Index, std::set< Attic< Way_Skeleton::Id_Type > > >(),
-                    new_undeleted, *transaction, *attic_settings().WAYS_UNDELETED);
+    add_elements(new_undeleted, *transaction, *attic_settings().WAYS_UNDELETED, pool);
 
     // Add attic meta
-    update_elements
-        (std::map< Uint31_Index, std::set< OSM_Element_Metadata_Skeleton< Way_Skeleton::Id_Type > > >(),
-         new_attic_meta, *transaction, *attic_settings().WAYS_META);
+    add_elements(new_attic_meta, *transaction, *attic_settings().WAYS_META, pool);
 
     // Update tags
-    update_elements(std::map< Tag_Index_Local, std::set< Attic < Way_Skeleton::Id_Type > > >(),
-                    new_attic_local_tags, *transaction, *attic_settings().WAY_TAGS_LOCAL);
-    update_elements(std::map< Tag_Index_Global,
-                        std::set< Attic < Tag_Object_Global< Way_Skeleton::Id_Type > > > >(),
-                    new_attic_global_tags, *transaction, *attic_settings().WAY_TAGS_GLOBAL);
+    add_elements(new_attic_local_tags, *transaction, *attic_settings().WAY_TAGS_LOCAL, pool);
+    add_elements(new_attic_global_tags, *transaction, *attic_settings().WAY_TAGS_GLOBAL, pool);
 
     // Write changelog
-    update_elements(std::map< Timestamp, std::set< Change_Entry< Way_Skeleton::Id_Type > > >(), changelog,
-                    *transaction, *attic_settings().WAY_CHANGELOG);
+    add_elements(changelog, *transaction, *attic_settings().WAY_CHANGELOG, pool);
+
+    // Add removed reverse references
+    if (reverse_refs)
+      add_elements(new_attic_node_ways, *transaction, *attic_settings().NODE_WAYS, pool);
+
+    pool.wait();
   }
 
   if (meta != only_data)
@@ -119,7 +119,7 @@ std::string Output_CSV::dump_config() const
 
 template< typename OSM_Element_Metadata_Skeleton >
 void print_meta(const std::string& keyfield,
-    const OSM_Element_Metadata_Skeleton& meta, const std::map< uint32, std::string >* users)
+    const OSM_Element_Metadata_Skeleton& meta, const User_Data_Cache* users)
 {
   if (keyfield == "version")
     std::cout<<meta.version;
@@ -131,16 +131,16 @@ void print_meta(const std::string& keyfield,
     std::cout<<meta.user_id;
   else if (users && keyfield == "user")
   {
-    std::map< uint32, std::string >::const_iterator uit = users->find(meta.user_id);
-    if (uit != users->end())
-      std::cout<<uit->second;
+    const std::string* user_name = users->get_name(meta.user_id);
+    if (user_name)
+      std::cout<<*user_name;
   }
 }
 
 
 template< >
 void print_meta< int >(const std::string& keyfield,
-    const int& meta, const std::map< uint32, std::string >* users) {}
+    const int& meta, const User_Data_Cache* users) {}
 
 std::string get_count_tag(const std::vector< std::pair< std::string, std::string> >* tags, std::string tag)
 {
@@ -157,7 +157,7 @@ template< typename Id_Type, typename OSM_Element_Metadata_Skeleton >
 void process_csv_line(int otype, const std::string& type, Id_Type id, const Opaque_Geometry& geometry,
     const OSM_Element_Metadata_Skeleton* meta,
     const std::vector< std::pair< std::string, std::string> >* tags,
-    const std::map< uint32, std::string >* users,
+    const User_Data_Cache* users,
     const Csv_Settings& csv_settings,
     Output_Mode mode)
 {
@@ -232,7 +232,7 @@ void Output_CSV::print_item(const Node_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Node_Skeleton* new_skel,
@@ -248,7 +248,7 @@ void Output_CSV::print_item(const Way_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Way_Skeleton* new_skel,
@@ -265,7 +265,7 @@ void Output_CSV::print_item(const Relation_Skeleton& skel,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Relation_Skeleton* new_skel,
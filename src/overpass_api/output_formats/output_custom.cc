@@ -21,6 +21,8 @@
 #include "output_custom.h"
 
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 
 
@@ -80,23 +82,23 @@ void Output_Custom::display_error(const std::string& text)
 }
 
 
-std::string::size_type find_block_end(std::string data, std::string::size_type pos)
+std::string::size_type find_block_end(const std::string& data, std::string::size_type pos)
 {
-  if (pos == std::string::npos || data.substr(pos, 2) != "{{")
+  if (pos == std::string::npos || data.compare(pos, 2, "{{") != 0)
     return pos;
 
   std::string::size_type curly_brace_count = 2;
-  if (data.substr(pos, 3) == "{{{")
+  if (data.compare(pos, 3, "{{{") == 0)
     curly_brace_count = 3;
   pos += curly_brace_count;
 
   while (pos < data.size())
   {
-    if (data[pos] == '{' && data.substr(pos, 2) == "{{")
+    if (data[pos] == '{' && data.compare(pos, 2, "{{") == 0)
       pos = find_block_end(data, pos);
-    else if ((data[pos] == '}') && curly_brace_count == 2 && data.substr(pos, 2) == "}}")
+    else if ((data[pos] == '}') && curly_brace_count == 2 && data.compare(pos, 2, "}}") == 0)
       return pos+2;
-    else if ((data[pos] == '}') && curly_brace_count == 3 && data.substr(pos, 3) == "}}}")
+    else if ((data[pos] == '}') && curly_brace_count == 3 && data.compare(pos, 3, "}}}") == 0)
       return pos+3;
     else
       ++pos;
@@ -106,6 +108,123 @@ std::string::size_type find_block_end(std::string data, std::string::size_type p
 }
 
 
+struct Template_Prefix
+{
+  const char* prefix;
+  Template_Node::Kind kind;
+};
+
+
+const Template_Prefix template_prefixes[] =
+{
+  { "{{{id}}}", Template_Node::id },
+  { "{{{type}}}", Template_Node::type },
+  { "{{{key}}}", Template_Node::key },
+  { "{{{value}}}", Template_Node::value },
+  { "{{{ref}}}", Template_Node::ref },
+  { "{{{role}}}", Template_Node::role },
+  { "{{{lat}}}", Template_Node::lat },
+  { "{{{lon}}}", Template_Node::lon },
+  { "{{{south}}}", Template_Node::south },
+  { "{{{west}}}", Template_Node::west },
+  { "{{{north}}}", Template_Node::north },
+  { "{{{east}}}", Template_Node::east },
+  { "{{{zoom}}}", Template_Node::zoom },
+  { "{{coords:", Template_Node::coords },
+  { "{{bbox:", Template_Node::bbox },
+  { "{{tags:", Template_Node::tags },
+  { "{{members:", Template_Node::members },
+  { "{{first:", Template_Node::first },
+  { "{{none:", Template_Node::none }
+};
+
+
+void add_literal(std::vector< Template_Node >& nodes, const std::string& text)
+{
+  if (text.empty())
+    return;
+  if (!nodes.empty() && nodes.back().kind == Template_Node::literal)
+    nodes.back().text += text;
+  else
+    nodes.push_back(Template_Node(Template_Node::literal, text));
+}
+
+
+void parse_template(const std::string& raw_template, std::vector< Template_Node >& nodes);
+
+
+void parse_block(const std::string& block, std::vector< Template_Node >& nodes)
+{
+  for (uint i = 0; i < sizeof(template_prefixes)/sizeof(template_prefixes[0]); ++i)
+  {
+    std::string::size_type prefix_size = strlen(template_prefixes[i].prefix);
+    if (block.compare(0, prefix_size, template_prefixes[i].prefix) != 0)
+      continue;
+
+    nodes.push_back(Template_Node(template_prefixes[i].kind, block));
+    if (block[prefix_size - 1] != ':')
+      return;
+
+    Template_Node& node = nodes.back();
+    std::string content = block.substr(prefix_size, block.size() - prefix_size - 2);
+    if (node.kind == Template_Node::none)
+    {
+      node.none_text = content;
+      return;
+    }
+    parse_template(content, node.body);
+
+    // Only the first {{first:..}} or {{none:..}} block of the content counts
+    if (node.kind == Template_Node::tags || node.kind == Template_Node::members)
+    {
+      for (std::vector< Template_Node >::const_iterator it = node.body.begin(); it != node.body.end(); ++it)
+      {
+        if (it->kind == Template_Node::first)
+        {
+          node.first_body = it->body;
+          break;
+        }
+      }
+    }
+    else if (node.kind == Template_Node::bbox)
+    {
+      node.none_text = content;
+      for (std::vector< Template_Node >::const_iterator it = node.body.begin(); it != node.body.end(); ++it)
+      {
+        if (it->kind == Template_Node::none)
+        {
+          node.none_text = it->none_text;
+          break;
+        }
+      }
+    }
+    return;
+  }
+
+  add_literal(nodes, block);
+}
+
+
+void parse_template(const std::string& raw_template, std::vector< Template_Node >& nodes)
+{
+  std::string::size_type old_pos = 0;
+  std::string::size_type new_pos = raw_template.find("{{");
+  while (new_pos != std::string::npos)
+  {
+    add_literal(nodes, raw_template.substr(old_pos, new_pos - old_pos));
+    old_pos = find_block_end(raw_template, new_pos);
+    if (old_pos == std::string::npos)
+    {
+      add_literal(nodes, raw_template.substr(new_pos));
+      return;
+    }
+    parse_block(raw_template.substr(new_pos, old_pos - new_pos), nodes);
+    new_pos = raw_template.find("{{", old_pos);
+  }
+  add_literal(nodes, raw_template.substr(old_pos));
+}
+
+
 void Output_Custom::set_output_templates()
 {
   std::string data;
@@ -130,9 +249,9 @@ void Output_Custom::set_output_templates()
   if (data == "")
     data = "\n<p>Template not found.</p>\n";
 
-  node_template = "\n<p>No {{node:..}} found in template.</p>\n";
-  way_template = "\n<p>No {{way:..}} found in template.</p>\n";
-  relation_template = "\n<p>No {{relation:..}} found in template.</p>\n";
+  std::string node_raw = "\n<p>No {{node:..}} found in template.</p>\n";
+  std::string way_raw = "\n<p>No {{way:..}} found in template.</p>\n";
+  std::string relation_raw = "\n<p>No {{relation:..}} found in template.</p>\n";
 
   bool header_written = false;
   std::string::size_type pos = 0;
@@ -152,7 +271,7 @@ void Output_Custom::set_output_templates()
 
 	if (end_pos != std::string::npos)
 	{
-	  node_template = data.substr(pos + 7, end_pos - pos - 9);
+	  node_raw = data.substr(pos + 7, end_pos - pos - 9);
 	  pos = end_pos;
 	}
 	else
@@ -170,7 +289,7 @@ void Output_Custom::set_output_templates()
 
 	if (end_pos != std::string::npos)
 	{
-	  way_template = data.substr(pos + 6, end_pos - pos - 8);
+	  way_raw = data.substr(pos + 6, end_pos - pos - 8);
 	  pos = end_pos;
 	}
 	else
@@ -188,7 +307,7 @@ void Output_Custom::set_output_templates()
 
 	if (end_pos != std::string::npos)
 	{
-	  relation_template = data.substr(pos + 11, end_pos - pos - 13);
+	  relation_raw = data.substr(pos + 11, end_pos - pos - 13);
 	  pos = end_pos;
 	}
 	else
@@ -203,334 +322,198 @@ void Output_Custom::set_output_templates()
 
   if (!header_written)
     header = data.substr(0, pos);
+
+  node_template.clear();
+  parse_template(node_raw, node_template);
+  way_template.clear();
+  parse_template(way_raw, way_template);
+  relation_template.clear();
+  parse_template(relation_raw, relation_template);
 }
 
 
-std::string process_members(const std::string& raw_template, Node::Id_Type ref)
+void append_number(std::string& result, unsigned long long value)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
-  {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-    {
-      result<<raw_template.substr(new_pos);
-      return result.str();
-    }
-    else if (raw_template.substr(new_pos, 9) == "{{{ref}}}")
-      result<<ref.val();
-    else if (raw_template.substr(new_pos, 8) == "{{first:")
-      ;
-    else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
-  }
-  result<<raw_template.substr(old_pos, new_pos - old_pos);
-
-  return result.str();
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%llu", value);
+  result += buf;
 }
 
 
-std::string process_members(const std::string& raw_template, uint32 id, const Relation_Entry& entry,
-		       const std::map< uint32, std::string >& roles)
+void append_coord(std::string& result, double value)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
-  {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-    {
-      result<<raw_template.substr(new_pos);
-      return result.str();
-    }
-    else if (raw_template.substr(new_pos, 8) == "{{{id}}}")
-      result<<id;
-    else if (raw_template.substr(new_pos, 9) == "{{{ref}}}")
-      result<<entry.ref.val();
-    else if (raw_template.substr(new_pos, 10) == "{{{type}}}")
-      result<<member_type_name(entry.type);
-    else if (raw_template.substr(new_pos, 10) == "{{{role}}}")
-    {
-      std::map< uint32, std::string >::const_iterator rit = roles.find(entry.role);
-      result<<escape_xml(rit != roles.end() ? rit->second : "???");
-    }
-    else if (raw_template.substr(new_pos, 8) == "{{first:")
-      ;
-    else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
-  }
-  result<<raw_template.substr(old_pos, new_pos - old_pos);
-
-  return result.str();
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.7f", value);
+  result += buf;
 }
 
 
-std::string process_tags(const std::string& raw_template, uint32 id, const std::string& key, const std::string& value)
+void render_members(const std::vector< Template_Node >& nodes, Node::Id_Type ref, std::string& result)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
+  for (std::vector< Template_Node >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
   {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-    {
-      result<<raw_template.substr(new_pos);
-      return result.str();
-    }
-    else if (raw_template.substr(new_pos, 8) == "{{{id}}}")
-      result<<id;
-    else if (raw_template.substr(new_pos, 9) == "{{{key}}}")
-      result<<key;
-    else if (raw_template.substr(new_pos, 11) == "{{{value}}}")
-      result<<value;
-    else if (raw_template.substr(new_pos, 8) == "{{first:")
-      ;
-    else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
+    if (it->kind == Template_Node::ref)
+      append_number(result, ref.val());
+    else if (it->kind != Template_Node::first)
+      result += it->text;
   }
-  result<<raw_template.substr(old_pos, new_pos - old_pos);
-
-  return result.str();
 }
 
 
-std::string process_coords(const std::string& raw_template, uint32 id, double lat, double lon)
+void render_members(const std::vector< Template_Node >& nodes, uint32 id, const Relation_Entry& entry,
+		    const std::map< uint32, std::string >& roles, std::string& result)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
+  for (std::vector< Template_Node >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
   {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
+    if (it->kind == Template_Node::id)
+      append_number(result, id);
+    else if (it->kind == Template_Node::ref)
+      append_number(result, entry.ref.val());
+    else if (it->kind == Template_Node::type)
+      result += member_type_name(entry.type);
+    else if (it->kind == Template_Node::role)
     {
-      result<<raw_template.substr(new_pos);
-      return result.str();
+      std::map< uint32, std::string >::const_iterator rit = roles.find(entry.role);
+      result += escape_xml(rit != roles.end() ? rit->second : "???");
     }
-    else if (raw_template.substr(new_pos, 8) == "{{{id}}}")
-      result<<id;
-    else if (raw_template.substr(new_pos, 9) == "{{{lat}}}")
-      result<<std::fixed<<std::setprecision(7)<<lat;
-    else if (raw_template.substr(new_pos, 9) == "{{{lon}}}")
-      result<<std::fixed<<std::setprecision(7)<<lon;
-    else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
+    else if (it->kind != Template_Node::first)
+      result += it->text;
   }
-  result<<raw_template.substr(old_pos, new_pos - old_pos);
-
-  return result.str();
 }
 
 
-std::string process_coords(const std::string& raw_template, uint32 id,
-		      double south, double west, double north, double east, uint zoom)
+void render_tags(const std::vector< Template_Node >& nodes, uint32 id,
+		 const std::string& key, const std::string& value, std::string& result)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
+  for (std::vector< Template_Node >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
   {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-    {
-      result<<raw_template.substr(new_pos);
-      return result.str();
-    }
-    else if (raw_template.substr(new_pos, 8) == "{{{id}}}")
-      result<<id;
-    else if (raw_template.substr(new_pos, 11) == "{{{south}}}")
-      result<<std::fixed<<std::setprecision(7)<<south;
-    else if (raw_template.substr(new_pos, 10) == "{{{west}}}")
-      result<<std::fixed<<std::setprecision(7)<<west;
-    else if (raw_template.substr(new_pos, 11) == "{{{north}}}")
-      result<<std::fixed<<std::setprecision(7)<<north;
-    else if (raw_template.substr(new_pos, 10) == "{{{east}}}")
-      result<<std::fixed<<std::setprecision(7)<<east;
-    else if (raw_template.substr(new_pos, 9) == "{{{lat}}}")
-      result<<std::fixed<<std::setprecision(7)<<(south + north)/2.0;
-    else if (raw_template.substr(new_pos, 9) == "{{{lon}}}")
-      result<<std::fixed<<std::setprecision(7)<<(east + west)/2.0;
-    else if (raw_template.substr(new_pos, 10) == "{{{zoom}}}")
-      result<<zoom;
-    else if (raw_template.substr(new_pos, 7) == "{{none:")
-      ;
-    else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
+    if (it->kind == Template_Node::id)
+      append_number(result, id);
+    else if (it->kind == Template_Node::key)
+      result += key;
+    else if (it->kind == Template_Node::value)
+      result += value;
+    else if (it->kind != Template_Node::first)
+      result += it->text;
   }
-  result<<raw_template.substr(old_pos, new_pos - old_pos);
-
-  return result.str();
 }
 
 
-std::string extract_first(const std::string& raw_template)
+void render_coords(const std::vector< Template_Node >& nodes, uint32 id, double lat, double lon,
+		   std::string& result)
 {
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
+  for (std::vector< Template_Node >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
   {
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-      return "";
-    else if (raw_template.substr(new_pos, 8) == "{{first:")
-      return raw_template.substr(new_pos + 8, old_pos - new_pos - 10);
-    new_pos = raw_template.find("{{", old_pos);
+    if (it->kind == Template_Node::id)
+      append_number(result, id);
+    else if (it->kind == Template_Node::lat)
+      append_coord(result, lat);
+    else if (it->kind == Template_Node::lon)
+      append_coord(result, lon);
+    else
+      result += it->text;
   }
-
-  return "";
 }
 
 
-std::string antiprocess_coords(const std::string& raw_template)
+void render_coords(const std::vector< Template_Node >& nodes, uint32 id,
+		   double south, double west, double north, double east, uint zoom, std::string& result)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
+  for (std::vector< Template_Node >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
   {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-    {
-      result<<raw_template.substr(new_pos);
-      return result.str();
-    }
-    else if (raw_template.substr(new_pos, 7) == "{{none:")
-      return raw_template.substr(new_pos + 7, old_pos - new_pos - 9);
-    else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
+    if (it->kind == Template_Node::id)
+      append_number(result, id);
+    else if (it->kind == Template_Node::south)
+      append_coord(result, south);
+    else if (it->kind == Template_Node::west)
+      append_coord(result, west);
+    else if (it->kind == Template_Node::north)
+      append_coord(result, north);
+    else if (it->kind == Template_Node::east)
+      append_coord(result, east);
+    else if (it->kind == Template_Node::lat)
+      append_coord(result, (south + north)/2.0);
+    else if (it->kind == Template_Node::lon)
+      append_coord(result, (east + west)/2.0);
+    else if (it->kind == Template_Node::zoom)
+      append_number(result, zoom);
+    else if (it->kind != Template_Node::none)
+      result += it->text;
   }
-  result<<raw_template.substr(old_pos, new_pos - old_pos);
-
-  return result.str();
 }
 
 
-std::string process_template(const std::string& raw_template, unsigned long long id, std::string type,
-			double south, double west, double north, double east, uint zoom,
-			const std::vector< std::pair< std::string, std::string > >* tags,
-			const std::vector< Node::Id_Type >* nds,
-			const std::vector< Relation_Entry >* members,
-			const std::map< uint32, std::string >* roles)
+void render_template(const std::vector< Template_Node >& nodes, unsigned long long id, const std::string& type,
+		     double south, double west, double north, double east, uint zoom,
+		     const std::vector< std::pair< std::string, std::string > >* tags,
+		     const std::vector< Node::Id_Type >* nds,
+		     const std::vector< Relation_Entry >* members,
+		     const std::map< uint32, std::string >* roles,
+		     std::string& result)
 {
-  std::ostringstream result;
-  std::string::size_type old_pos = 0;
-  std::string::size_type new_pos = 0;
-
-  new_pos = raw_template.find("{{", old_pos);
-  while (new_pos != std::string::npos)
+  for (std::vector< Template_Node >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
   {
-    result<<raw_template.substr(old_pos, new_pos - old_pos);
-    old_pos = find_block_end(raw_template, new_pos);
-    if (old_pos == std::string::npos)
-    {
-      result<<raw_template.substr(new_pos);
-      return result.str();
-    }
-    else if (raw_template.substr(new_pos, 8) == "{{{id}}}")
-      result<<id;
-    else if (raw_template.substr(new_pos, 10) == "{{{type}}}")
-      result<<type;
-    else if (raw_template.substr(new_pos, 9) == "{{coords:")
+    if (it->kind == Template_Node::id)
+      append_number(result, id);
+    else if (it->kind == Template_Node::type)
+      result += type;
+    else if (it->kind == Template_Node::coords)
     {
       if (south < 100.0)
-	result<<process_coords(raw_template.substr(new_pos + 9, old_pos - new_pos - 11), id,
-			       south, west);
+	render_coords(it->body, id, south, west, result);
     }
-    else if (raw_template.substr(new_pos, 7) == "{{bbox:")
+    else if (it->kind == Template_Node::bbox)
     {
       if (south < 100.0 && north < 100.0)
-	result<<process_coords(raw_template.substr(new_pos + 7, old_pos - new_pos - 9), id,
-			       south, west, north, east, zoom);
+	render_coords(it->body, id, south, west, north, east, zoom, result);
       else if (south == 200.0)
-	result<<antiprocess_coords(raw_template.substr(new_pos + 7, old_pos - new_pos - 9));
+	result += it->none_text;
     }
-    else if (raw_template.substr(new_pos, 7) == "{{tags:")
+    else if (it->kind == Template_Node::tags)
     {
       if (tags != 0 && !tags->empty())
       {
-	std::vector< std::pair< std::string, std::string > >::const_iterator it = tags->begin();
-
-	std::string first = extract_first(raw_template.substr(new_pos + 7, old_pos - new_pos - 9));
-	if (first != "" && it != tags->end())
+	std::vector< std::pair< std::string, std::string > >::const_iterator tit = tags->begin();
+	if (!it->first_body.empty())
 	{
-	  result<<process_tags(first, id, escape_xml(it->first), escape_xml(it->second));
-	  ++it;
+	  render_tags(it->first_body, id, escape_xml(tit->first), escape_xml(tit->second), result);
+	  ++tit;
 	}
 
-	for (; it != tags->end(); ++it)
-	  result<<process_tags(raw_template.substr(new_pos + 7, old_pos - new_pos - 9), id,
-			       escape_xml(it->first), escape_xml(it->second));
+	for (; tit != tags->end(); ++tit)
+	  render_tags(it->body, id, escape_xml(tit->first), escape_xml(tit->second), result);
       }
     }
-    else if (raw_template.substr(new_pos, 10) == "{{members:")
+    else if (it->kind == Template_Node::members)
     {
       if (nds != 0 && !nds->empty())
       {
-	std::vector< Node::Id_Type >::const_iterator it = nds->begin();
-
-	std::string first = extract_first(raw_template.substr(new_pos + 10, old_pos - new_pos - 12));
-	if (first != "" && it != nds->end())
+	std::vector< Node::Id_Type >::const_iterator mit = nds->begin();
+	if (!it->first_body.empty())
 	{
-	  result<<process_members(first, *it);
-	  ++it;
+	  render_members(it->first_body, *mit, result);
+	  ++mit;
 	}
 
-	for (; it != nds->end(); ++it)
-	  result<<process_members(raw_template.substr(new_pos + 10, old_pos - new_pos - 12), *it);
+	for (; mit != nds->end(); ++mit)
+	  render_members(it->body, *mit, result);
       }
       else if (members != 0 && !members->empty())
       {
-	std::vector< Relation_Entry >::const_iterator it = members->begin();
-
-	std::string first = extract_first(raw_template.substr(new_pos + 10, old_pos - new_pos - 12));
-	if (first != "" && it != members->end())
+	std::vector< Relation_Entry >::const_iterator mit = members->begin();
+	if (!it->first_body.empty())
 	{
-	  result<<process_members(first, id, *it, *roles);
-	  ++it;
+	  render_members(it->first_body, id, *mit, *roles, result);
+	  ++mit;
 	}
 
-	for (; it != members->end(); ++it)
-	  result<<process_members(raw_template.substr(new_pos + 10, old_pos - new_pos - 12), id,
-				  *it, *roles);
+	for (; mit != members->end(); ++mit)
+	  render_members(it->body, id, *mit, *roles, result);
       }
     }
     else
-      result<<raw_template.substr(new_pos, old_pos - new_pos);
-    new_pos = raw_template.find("{{", old_pos);
+      result += it->text;
   }
-  result<<raw_template.substr(old_pos);
-
-  return result.str();
 }
 
 
@@ -544,9 +527,13 @@ void Output_Custom::write_footer()
   }
   else if (count == 1 && redirect)
   {
+    std::vector< Template_Node > url_template;
+    parse_template(url, url_template);
+    std::string location;
+    render_template(url_template, first_id, first_type, 100.0, 200.0, 0, 17, 0, 0, 0, 0, 0, location);
+
     std::cout<<"Status: 302 Moved\n";
-    std::cout<<"Location: "
-        <<process_template(url, first_id, first_type, 100.0, 200.0, 0, 17, 0, 0, 0, 0, 0)<<"\n\n";
+    std::cout<<"Location: "<<location<<"\n\n";
   }
   else
   {
@@ -563,7 +550,7 @@ void Output_Custom::print_item(const Node_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Node_Skeleton* new_skel,
@@ -587,7 +574,7 @@ void Output_Custom::print_item(const Node_Skeleton& skel,
     lat = geometry.center_lat();
     lon = geometry.center_lon();
   }
-  output += process_template(node_template, skel.id.val(), "node", lat, lon, 100.0, 0, 17, tags, 0, 0, 0);
+  render_template(node_template, skel.id.val(), "node", lat, lon, 100.0, 0, 17, tags, 0, 0, 0, output);
 }
 
 
@@ -641,7 +628,7 @@ void Output_Custom::print_item(const Way_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Way_Skeleton* new_skel,
@@ -660,17 +647,17 @@ void Output_Custom::print_item(const Way_Skeleton& skel,
 
   if (geometry.has_bbox())
   {
-    output += process_template(way_template, skel.id.val(), "way",
-			      geometry.south(), geometry.west(), geometry.north(), geometry.east(),
-			      detect_zoom(geometry),
-			      tags, mode.mode & Output_Mode::NDS ? &skel.nds : 0, 0, 0);
+    render_template(way_template, skel.id.val(), "way",
+		    geometry.south(), geometry.west(), geometry.north(), geometry.east(),
+		    detect_zoom(geometry),
+		    tags, mode.mode & Output_Mode::NDS ? &skel.nds : 0, 0, 0, output);
   }
   else
   {
-    output += process_template(way_template, skel.id.val(), "way",
-			      200.0, 200.0, 200.0, 200.0,
-			      detect_zoom(geometry),
-			      tags, mode.mode & Output_Mode::NDS ? &skel.nds : 0, 0, 0);
+    render_template(way_template, skel.id.val(), "way",
+		    200.0, 200.0, 200.0, 200.0,
+		    detect_zoom(geometry),
+		    tags, mode.mode & Output_Mode::NDS ? &skel.nds : 0, 0, 0, output);
   }
 }
 
@@ -680,7 +667,7 @@ void Output_Custom::print_item(const Relation_Skeleton& skel,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Relation_Skeleton* new_skel,
@@ -699,17 +686,17 @@ void Output_Custom::print_item(const Relation_Skeleton& skel,
 
   if (geometry.has_bbox())
   {
-    output += process_template(relation_template, skel.id.val(), "relation",
-			       geometry.south(), geometry.west(), geometry.north(), geometry.east(),
-			       detect_zoom(geometry),
-			       tags, 0, mode.mode & Output_Mode::MEMBERS ? &skel.members : 0, roles);
+    render_template(relation_template, skel.id.val(), "relation",
+		    geometry.south(), geometry.west(), geometry.north(), geometry.east(),
+		    detect_zoom(geometry),
+		    tags, 0, mode.mode & Output_Mode::MEMBERS ? &skel.members : 0, roles, output);
   }
   else
   {
-    output += process_template(relation_template, skel.id.val(), "relation",
-			       200.0, 200.0, 200.0, 200.0,
-			       detect_zoom(geometry),
-			       tags, 0, mode.mode & Output_Mode::MEMBERS ? &skel.members : 0, roles);
+    render_template(relation_template, skel.id.val(), "relation",
+		    200.0, 200.0, 200.0, 200.0,
+		    detect_zoom(geometry),
+		    tags, 0, mode.mode & Output_Mode::MEMBERS ? &skel.members : 0, roles, output);
   }
 }
 
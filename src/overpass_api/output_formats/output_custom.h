@@ -28,6 +28,26 @@
 #include <vector>
 
 
+/* A template split once into literal text and placeholders. Every node keeps its source text
+ * such that a placeholder without meaning at the place where it is used is printed verbatim. */
+struct Template_Node
+{
+  enum Kind { literal, id, type, key, value, ref, role, lat, lon, south, west, north, east, zoom,
+      coords, bbox, tags, members, first, none };
+
+  Template_Node(Kind kind_, const std::string& text_) : kind(kind_), text(text_) {}
+
+  Kind kind;
+  std::string text;
+  // The parsed content of coords, bbox, tags, members and first blocks
+  std::vector< Template_Node > body;
+  // For tags and members: the content of the {{first:..}} block, used for the first entry
+  std::vector< Template_Node > first_body;
+  // For bbox and none: the text to print for an element without a bounding box
+  std::string none_text;
+};
+
+
 class Output_Custom : public Output_Handler
 {
 public:
@@ -47,7 +67,7 @@ public:
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action = keep,
       const Node_Skeleton* new_skel = 0,
@@ -59,7 +79,7 @@ public:
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action = keep,
       const Way_Skeleton* new_skel = 0,
@@ -72,7 +92,7 @@ public:
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action = keep,
       const Relation_Skeleton* new_skel = 0,
@@ -98,9 +118,9 @@ private:
   bool template_contains_js;
   unsigned int count;
   std::string header;
-  std::string node_template;
-  std::string way_template;
-  std::string relation_template;
+  std::vector< Template_Node > node_template;
+  std::vector< Template_Node > way_template;
+  std::vector< Template_Node > relation_template;
   std::string first_type;
   unsigned long long first_id;
   std::string output;
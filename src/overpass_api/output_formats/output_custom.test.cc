@@ -0,0 +1,120 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../core/datatypes.h"
+#include "../core/geometry.h"
+#include "output_custom.h"
+
+
+// Prints the same nodes, ways and relations through the template custom_<test>.wiki in template_dir/templates/
+void print_elements(const std::string& template_dir, const std::string& test)
+{
+  Output_Custom output(false, "custom_" + test + ".wiki", "");
+  output.write_payload_header(template_dir, "mock-up-init", "");
+
+  Output_Mode mode(Output_Mode::ID | Output_Mode::COORDS | Output_Mode::NDS | Output_Mode::MEMBERS
+      | Output_Mode::TAGS);
+
+  std::vector< std::pair< std::string, std::string > > tags;
+  tags.push_back(std::make_pair("name", "A<&>"));
+  tags.push_back(std::make_pair("amenity", "cafe"));
+  std::vector< std::pair< std::string, std::string > > single_tag;
+  single_tag.push_back(std::make_pair("highway", "residential"));
+  std::vector< std::pair< std::string, std::string > > no_tags;
+
+  Node_Skeleton node;
+  node.id = Node::Id_Type(1ull);
+  output.print_item(node, Point_Geometry(51.25, 7.125), &tags, 0, 0, mode);
+  node.id = Node::Id_Type(2ull);
+  output.print_item(node, Null_Geometry(), &no_tags, 0, 0, Output_Mode(Output_Mode::ID));
+
+  Way_Skeleton way(Way::Id_Type(3u));
+  way.nds.push_back(Node::Id_Type(1ull));
+  way.nds.push_back(Node::Id_Type(2ull));
+  way.nds.push_back(Node::Id_Type(1ull<<40));
+  output.print_item(way, Bbox_Geometry(51.25, 7.125, 51.5, 7.5), &single_tag, 0, 0, mode);
+  output.print_item(Way_Skeleton(Way::Id_Type(4u)), Null_Geometry(), 0, 0, 0, mode);
+
+  std::map< uint32, std::string > roles;
+  roles[1] = "inner";
+  roles[2] = "outer";
+  Relation_Skeleton relation(Relation::Id_Type(5u));
+  Relation_Entry entry;
+  entry.ref = Uint64(1ull);
+  entry.type = Relation_Entry::NODE;
+  entry.role = 1;
+  relation.members.push_back(entry);
+  entry.ref = Uint64(3ull);
+  entry.type = Relation_Entry::WAY;
+  entry.role = 2;
+  relation.members.push_back(entry);
+  entry.ref = Uint64(6ull);
+  entry.type = Relation_Entry::RELATION;
+  entry.role = 7;
+  relation.members.push_back(entry);
+  output.print_item(relation, Bbox_Geometry(51.0, 7.0, 52.0, 8.0), &tags, 0, &roles, 0, mode);
+  output.print_item(Relation_Skeleton(Relation::Id_Type(6u)), Null_Geometry(), &single_tag, 0, &roles, 0, mode);
+
+  output.write_footer();
+}
+
+
+// A single element redirects to the URL, which is a template itself
+void print_redirect(const std::string& url)
+{
+  Output_Custom output(true, "", url);
+  output.write_payload_header("", "mock-up-init", "");
+
+  Way_Skeleton way(Way::Id_Type(3u));
+  way.nds.push_back(Node::Id_Type(1ull));
+  output.print_item(way, Bbox_Geometry(51.25, 7.125, 51.5, 7.5), 0, 0, 0,
+      Output_Mode(Output_Mode::ID | Output_Mode::NDS));
+
+  output.write_footer();
+}
+
+
+int main(int argc, char* args[])
+{
+  if (argc < 3)
+  {
+    std::cout<<"Usage: "<<args[0]<<" test_to_execute template_dir\n";
+    return 0;
+  }
+  std::string test_to_execute = args[1];
+
+  // 1: {{first:..}} in tags and members, {{none:..}} in bbox
+  // 2: nested blocks
+  // 3: unterminated blocks, which turn the rest of the template into literal text
+  // 4: placeholders and blocks at places where they have no meaning
+  if (test_to_execute == "1" || test_to_execute == "2" || test_to_execute == "3" || test_to_execute == "4")
+    print_elements(args[2], test_to_execute);
+  else if (test_to_execute == "5")
+    print_redirect("https://www.openstreetmap.org/?{{{type}}}={{{id}}}&map={{{zoom}}}/{{{lat}}}/{{{lon}}}"
+        "&{{{ref}}}&{{members:{{{ref}}}}}&{{{id}}");
+  else if (test_to_execute == "6")
+    print_redirect("https://www.openstreetmap.org/{{bbox:{{{south}}},{{{west}}}}}/{{tags:{{{key}}}");
+
+  return 0;
+}
@@ -79,14 +79,14 @@ void handle_first_elem(bool& first_elem)
 
 template< typename Id_Type >
 void print_meta_json(const OSM_Element_Metadata_Skeleton< Id_Type >& meta,
-		    const std::map< uint32, std::string >& users)
+		    const User_Data_Cache& users)
 {
   std::cout<<",\n  \"timestamp\": \""<<iso_string(meta.timestamp)<<"\""
         ",\n  \"version\": "<<meta.version<<
 	",\n  \"changeset\": "<<meta.changeset;
-  std::map< uint32, std::string >::const_iterator it = users.find(meta.user_id);
-  if (it != users.end())
-    std::cout<<",\n  \"user\": \""<<escape_cstr(it->second)<<"\"";
+  const std::string* user_name = users.get_name(meta.user_id);
+  if (user_name)
+    std::cout<<",\n  \"user\": \""<<escape_cstr(*user_name)<<"\"";
   std::cout<<",\n  \"uid\": "<<meta.user_id;
 }
 
@@ -109,7 +109,7 @@ void Output_JSON::print_item(const Node_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Node_Skeleton* new_skel,
@@ -155,7 +155,7 @@ void Output_JSON::print_item(const Way_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Way_Skeleton* new_skel,
@@ -213,7 +213,7 @@ void Output_JSON::print_item(const Relation_Skeleton& skel,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Relation_Skeleton* new_skel,
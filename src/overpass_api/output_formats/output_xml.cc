@@ -75,13 +75,13 @@ void Output_XML::print_global_bbox(const Bbox_Double& bbox)
 
 template< typename Id_Type >
 void print_meta_xml(const OSM_Element_Metadata_Skeleton< Id_Type >& meta,
-		    const std::map< uint32, std::string >& users)
+		    const User_Data_Cache& users)
 {
   std::cout<<" version=\""<<meta.version<<"\" timestamp=\""<<iso_string(meta.timestamp)
       <<"\" changeset=\""<<meta.changeset<<"\" uid=\""<<meta.user_id<<"\"";
-  std::map< uint32, std::string >::const_iterator it = users.find(meta.user_id);
-  if (it != users.end())
-    std::cout<<" user=\""<<escape_xml(it->second)<<"\"";
+  const std::string* user_name = users.get_name(meta.user_id);
+  if (user_name)
+    std::cout<<" user=\""<<escape_xml(*user_name)<<"\"";
 }
 
 
@@ -369,7 +369,7 @@ void print_node(const Node_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode)
 {
   std::cout<<"  <node";
@@ -395,7 +395,7 @@ void print_way(const Way_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode)
 {
   std::cout<<"  <way";
@@ -420,7 +420,7 @@ void print_relation(const Relation_Skeleton& skel,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode)
 {
   std::cout<<"  <relation";
@@ -445,7 +445,7 @@ template< typename Id_Type >
 void print_deleted(const std::string& type_name, const Id_Type& id,
       const Output_Handler::Feature_Action& action,
       const OSM_Element_Metadata_Skeleton< Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode)
 {
   std::cout<<"  <"<<type_name;
@@ -465,7 +465,7 @@ void Output_XML::print_item(const Node_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Node::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Node_Skeleton* new_skel,
@@ -495,7 +495,7 @@ void Output_XML::print_item(const Way_Skeleton& skel,
       const Opaque_Geometry& geometry,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Way::Id_Type >* meta,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Way_Skeleton* new_skel,
@@ -526,7 +526,7 @@ void Output_XML::print_item(const Relation_Skeleton& skel,
       const std::vector< std::pair< std::string, std::string > >* tags,
       const OSM_Element_Metadata_Skeleton< Relation::Id_Type >* meta,
       const std::map< uint32, std::string >* roles,
-      const std::map< uint32, std::string >* users,
+      const User_Data_Cache* users,
       Output_Mode mode,
       const Feature_Action& action,
       const Relation_Skeleton* new_skel,
@@ -35,7 +35,7 @@ struct Value_Aggregator
   // The code of min and max relies on the relative order to gracefully degrade the type
   enum Type_Indicator { type_void = 0, type_int64 = 1, type_double = 2, type_string = 3 };
 
-  virtual void update_value(const std::string& value) = 0;
+  virtual void update_value(const Eval_Value& value) = 0;
   virtual std::string get_value() = 0;
   virtual ~Value_Aggregator() {}
 };
@@ -193,7 +193,7 @@ public:
 
   struct Aggregator : Value_Aggregator
   {
-    virtual void update_value(const std::string& value);
+    virtual void update_value(const Eval_Value& value);
     virtual std::string get_value() { return agg_value; }
     std::string agg_value;
   };
@@ -217,7 +217,7 @@ public:
 
   struct Aggregator : Value_Aggregator
   {
-    virtual void update_value(const std::string& value);
+    virtual void update_value(const Eval_Value& value);
     virtual std::string get_value();
     std::set< std::string > values;
   };
@@ -269,7 +269,7 @@ public:
   {
     Aggregator() : relevant_type(type_void), result_l(std::numeric_limits< int64 >::max()),
         result_d(std::numeric_limits< double >::max()) {}
-    virtual void update_value(const std::string& value);
+    virtual void update_value(const Eval_Value& value);
     virtual std::string get_value();
     Type_Indicator relevant_type;
     int64 result_l;
@@ -298,7 +298,7 @@ public:
   {
     Aggregator() : relevant_type(type_void), result_l(std::numeric_limits< int64 >::min()),
         result_d(-std::numeric_limits< double >::max()) {}
-    virtual void update_value(const std::string& value);
+    virtual void update_value(const Eval_Value& value);
     virtual std::string get_value();
     Type_Indicator relevant_type;
     int64 result_l;
@@ -341,7 +341,7 @@ public:
   struct Aggregator : Value_Aggregator
   {
     Aggregator() : relevant_type(type_int64), result_l(0), result_d(0) {}
-    virtual void update_value(const std::string& value);
+    virtual void update_value(const Eval_Value& value);
     virtual std::string get_value();
     Type_Indicator relevant_type;
     int64 result_l;
@@ -528,7 +528,7 @@ void Area_Query_Statement::fill_ranges(Resource_Manager& rman)
       it(area_locations_db.flat_begin());
       !(it == area_locations_db.flat_end()); ++it)
   {
-    if (binary_search(area_id.begin(), area_id.end(), it.object().id))
+    if (binary_search(area_id.begin(), area_id.end(), it.handle().id()))
     {
       for (std::vector< uint32 >::const_iterator it2(it.object().used_indices.begin());
           it2 != it.object().used_indices.end(); ++it2)
@@ -625,7 +625,7 @@ void Area_Query_Statement::collect_nodes
     while ((!(area_it == area_blocks_db.discrete_end())) &&
         (area_it.index().val() == current_idx))
     {
-      if (binary_search(area_id.begin(), area_id.end(), area_it.object().id))
+      if (binary_search(area_id.begin(), area_id.end(), area_it.handle().id()))
 	areas[area_it.object().id].push_back(area_it.object());
       ++area_it;
     }
@@ -633,7 +633,7 @@ void Area_Query_Statement::collect_nodes
         ((nodes_it.index().val() & 0xffffff00) == current_idx))
     {
       if ((ids != 0) &&
-	  (!binary_search(ids->begin(), ids->end(), nodes_it.object().id)))
+	  (!binary_search(ids->begin(), ids->end(), nodes_it.handle().id())))
       {
 	++nodes_it;
 	continue;
@@ -701,7 +701,7 @@ void Area_Query_Statement::collect_nodes
     while ((!(area_it == area_blocks_db.discrete_end())) &&
         (area_it.index().val() == current_idx))
     {
-      if (binary_search(area_id.begin(), area_id.end(), area_it.object().id))
+      if (binary_search(area_id.begin(), area_id.end(), area_it.handle().id()))
 	areas[area_it.object().id].push_back(area_it.object());
       ++area_it;
     }
@@ -984,7 +984,7 @@ void Area_Query_Statement::collect_ways
     while ((!(area_it == area_blocks_db.discrete_end())) &&
         (area_it.index().val() == current_idx))
     {
-      if (binary_search(area_id.begin(), area_id.end(), area_it.object().id))
+      if (binary_search(area_id.begin(), area_id.end(), area_it.handle().id()))
 	areas[area_it.object().id].push_back(area_it.object());
       ++area_it;
     }
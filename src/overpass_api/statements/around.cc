@@ -677,19 +677,15 @@ Around_Statement::~Around_Statement()
 }
 
 
-std::vector< double > cartesian(double lat, double lon)
+Vector_3D cartesian(double lat, double lon)
 {
-  std::vector< double > result(3);
-
-  result[0] = sin(lat/90.0*acos(0));
-  result[1] = cos(lat/90.0*acos(0))*sin(lon/90.0*acos(0));
-  result[2] = cos(lat/90.0*acos(0))*cos(lon/90.0*acos(0));
-
-  return result;
+  return Vector_3D(sin(lat/90.0*acos(0)),
+      cos(lat/90.0*acos(0))*sin(lon/90.0*acos(0)),
+      cos(lat/90.0*acos(0))*cos(lon/90.0*acos(0)));
 }
 
 
-void rescale(double a, std::vector< double >& v)
+void rescale(double a, Vector_3D& v)
 {
   v[0] *= a;
   v[1] *= a;
@@ -697,33 +693,21 @@ void rescale(double a, std::vector< double >& v)
 }
 
 
-std::vector< double > sum(const std::vector< double >& v, const std::vector< double >& w)
+Vector_3D sum(const Vector_3D& v, const Vector_3D& w)
 {
-  std::vector< double > result(3);
-
-  result[0] = v[0] + w[0];
-  result[1] = v[1] + w[1];
-  result[2] = v[2] + w[2];
-
-  return result;
+  return Vector_3D(v[0] + w[0], v[1] + w[1], v[2] + w[2]);
 }
 
 
-double scalar_prod(const std::vector< double >& v, const std::vector< double >& w)
+double scalar_prod(const Vector_3D& v, const Vector_3D& w)
 {
   return v[0]*w[0] + v[1]*w[1] + v[2]*w[2];
 }
 
 
-std::vector< double > cross_prod(const std::vector< double >& v, const std::vector< double >& w)
+Vector_3D cross_prod(const Vector_3D& v, const Vector_3D& w)
 {
-  std::vector< double > result(3);
-
-  result[0] = v[1]*w[2] - v[2]*w[1];
-  result[1] = v[2]*w[0] - v[0]*w[2];
-  result[2] = v[0]*w[1] - v[1]*w[0];
-
-  return result;
+  return Vector_3D(v[1]*w[2] - v[2]*w[1], v[2]*w[0] - v[0]*w[2], v[0]*w[1] - v[1]*w[0]);
 }
 
 
@@ -746,25 +730,26 @@ Prepared_Point::Prepared_Point
 }
 
 
-double great_circle_line_dist(const Prepared_Segment& segment, const std::vector< double >& cartesian)
+void Cartesian_Array::push_back(const Vector_3D& v)
 {
-  double scalar_prod_ = std::abs(scalar_prod(cartesian, segment.norm))
-      /sqrt(scalar_prod(segment.norm, segment.norm));
+  x.push_back(v[0]);
+  y.push_back(v[1]);
+  z.push_back(v[2]);
+}
 
-  if (scalar_prod_ > 1)
-    scalar_prod_ = 1;
 
-  return asin(scalar_prod_)*(10*1000*1000/acos(0));
+void Cartesian_Array::clear()
+{
+  x.clear();
+  y.clear();
+  z.clear();
 }
 
 
-double great_circle_line_dist(double llat1, double llon1, double llat2, double llon2,
-                              double plat, double plon)
+double great_circle_line_dist(const Prepared_Segment& segment, const Vector_3D& cartesian)
 {
-  std::vector< double > norm = cross_prod(cartesian(llat1, llon1), cartesian(llat2, llon2));
-
-  double scalar_prod_ = std::abs(scalar_prod(cartesian(plat, plon), norm))
-      /sqrt(scalar_prod(norm, norm));
+  double scalar_prod_ = std::abs(scalar_prod(cartesian, segment.norm))
+      /sqrt(scalar_prod(segment.norm, segment.norm));
 
   if (scalar_prod_ > 1)
     scalar_prod_ = 1;
@@ -776,35 +761,355 @@ double great_circle_line_dist(double llat1, double llon1, double llat2, double l
 bool intersect(const Prepared_Segment& segment_a,
                const Prepared_Segment& segment_b)
 {
-  std::vector< double > intersection_pt = cross_prod(segment_a.norm, segment_b.norm);
+  Vector_3D intersection_pt = cross_prod(segment_a.norm, segment_b.norm);
   rescale(1.0/sqrt(scalar_prod(intersection_pt, intersection_pt)), intersection_pt);
 
-  std::vector< double > asum = sum(segment_a.first_cartesian, segment_a.second_cartesian);
-  std::vector< double > bsum = sum(segment_b.first_cartesian, segment_b.second_cartesian);
+  Vector_3D asum = sum(segment_a.first_cartesian, segment_a.second_cartesian);
+  Vector_3D bsum = sum(segment_b.first_cartesian, segment_b.second_cartesian);
 
   return (std::abs(scalar_prod(asum, intersection_pt)) >= scalar_prod(asum, segment_a.first_cartesian)
       && std::abs(scalar_prod(bsum, intersection_pt)) >= scalar_prod(bsum, segment_b.first_cartesian));
 }
 
 
-bool intersect(double alat1, double alon1, double alat2, double alon2,
-	       double blat1, double blon1, double blat2, double blon2)
+namespace
 {
-  std::vector< double > a1 = cartesian(alat1, alon1);
-  std::vector< double > a2 = cartesian(alat2, alon2);
-  std::vector< double > norm_a = cross_prod(a1, a2);
-  std::vector< double > b1 = cartesian(blat1, blon1);
-  std::vector< double > b2 = cartesian(blat2, blon2);
-  std::vector< double > norm_b = cross_prod(b1, b2);
-
-  std::vector< double > intersection_pt = cross_prod(norm_a, norm_b);
-  rescale(1.0/sqrt(scalar_prod(intersection_pt, intersection_pt)), intersection_pt);
+  // A point can only be within the radius of a great circle
+  // if the scalar product of the point with the unit normal is at most this value.
+  // The limit is slightly too large, such that it never excludes a point that the exact test would accept.
+  double line_dist_limit(double radius)
+  {
+    double angle = radius/(10*1000*1000/acos(0));
+    if (angle >= acos(0))
+      return 2.0;
+    return sin(angle)*(1 + 1e-9) + 1e-12;
+  }
+
+
+  const uint BATCH_SIZE = 64;
+
+
+  /* Appends to hits all positions i from [0, size) for which the vector with index idxs[i] in arr
+   * has an absolute scalar product with v of at most limit. If idxs is null, the position itself is the index.
+   * The work is done in batches that the compiler can vectorize. */
+  void filter_by_scalar_prod(const Cartesian_Array& arr, const uint32* idxs, uint32 size,
+      const Vector_3D& v, double limit, std::vector< uint32 >& hits)
+  {
+    if (size == 0)
+      return;
+
+    const double* x = &arr.x[0];
+    const double* y = &arr.y[0];
+    const double* z = &arr.z[0];
+    double v0 = v[0];
+    double v1 = v[1];
+    double v2 = v[2];
+    double prods[BATCH_SIZE];
+
+    for (uint32 batch_begin = 0; batch_begin < size; batch_begin += BATCH_SIZE)
+    {
+      uint32 batch_size = std::min(size - batch_begin, (uint32)BATCH_SIZE);
+      if (idxs)
+      {
+        const uint32* batch_idxs = idxs + batch_begin;
+        for (uint32 i = 0; i < batch_size; ++i)
+        {
+          uint32 j = batch_idxs[i];
+          prods[i] = x[j]*v0 + y[j]*v1 + z[j]*v2;
+        }
+      }
+      else if (batch_size == BATCH_SIZE)
+      {
+        // The constant trip count allows the compiler to use vector instructions
+        const double* bx = x + batch_begin;
+        const double* by = y + batch_begin;
+        const double* bz = z + batch_begin;
+        for (uint32 i = 0; i < BATCH_SIZE; ++i)
+          prods[i] = bx[i]*v0 + by[i]*v1 + bz[i]*v2;
+      }
+      else
+      {
+        for (uint32 i = 0; i < batch_size; ++i)
+          prods[i] = x[batch_begin + i]*v0 + y[batch_begin + i]*v1 + z[batch_begin + i]*v2;
+      }
+
+      for (uint32 i = 0; i < batch_size; ++i)
+      {
+        if (std::abs(prods[i]) <= limit)
+          hits.push_back(batch_begin + i);
+      }
+    }
+  }
+}
+
+
+// Checks whether the point is within the radius of the segment.
+bool is_near(const Prepared_Segment& segment, double lat, double lon,
+    const Vector_3D& cartesian, double radius)
+{
+  if (great_circle_line_dist(segment, cartesian) <= radius)
+  {
+    double gcdist = great_circle_dist
+        (segment.first_lat, segment.first_lon, segment.second_lat, segment.second_lon);
+    double limit = sqrt(gcdist*gcdist + radius*radius);
+    if (great_circle_dist(lat, lon, segment.first_lat, segment.first_lon) <= limit &&
+        great_circle_dist(lat, lon, segment.second_lat, segment.second_lon) <= limit)
+      return true;
+  }
+  return false;
+}
+
+
+namespace
+{
+  // The expansion of the bounding boxes is a little bit larger than the radius to be on the safe side.
+  double radius_margin(double radius)
+  {
+    return radius*(360.0/(40000.0*1000.0))*1.01 + 1e-6;
+  }
+
+
+  // Latitude range of the great circle arc between the endpoints of the segment.
+  // The arc may reach a higher latitude than both endpoints.
+  void arc_lat_range(const Prepared_Segment& segment, double& south, double& north)
+  {
+    south = std::min(segment.first_lat, segment.second_lat);
+    north = std::max(segment.first_lat, segment.second_lat);
+
+    double norm_sq = scalar_prod(segment.norm, segment.norm);
+    if (norm_sq == 0)
+      return;
+
+    // The point of the great circle that is closest to the north pole
+    Vector_3D top(1.0 - segment.norm[0]*segment.norm[0]/norm_sq,
+        -segment.norm[0]*segment.norm[1]/norm_sq, -segment.norm[0]*segment.norm[2]/norm_sq);
+    double top_length = sqrt(scalar_prod(top, top));
+    if (top_length == 0)
+      return;
+    rescale(1.0/top_length, top);
+
+    for (int sign = 0; sign < 2; ++sign)
+    {
+      if (scalar_prod(cross_prod(segment.first_cartesian, top), segment.norm) > 0
+          && scalar_prod(cross_prod(top, segment.second_cartesian), segment.norm) > 0)
+      {
+        double lat = asin(std::max(-1.0, std::min(1.0, top[0])))/acos(0)*90.0;
+        south = std::min(south, lat);
+        north = std::max(north, lat);
+      }
+      rescale(-1.0, top);
+    }
+  }
+
+
+  struct Grid_Bbox
+  {
+    double south;
+    double north;
+    double west;
+    double east;
+    bool valid;
+
+    Grid_Bbox(double south_, double north_, double west_, double east_)
+        : south(south_), north(north_), west(west_), east(east_), valid(true) {}
+
+    void expand(double margin)
+    {
+      south -= margin;
+      north += margin;
+      if (south < -89.9 || north > 89.9)
+      {
+        valid = false;
+        return;
+      }
+      double lon_margin = margin/cos(std::max(-south, north)/90.0*acos(0));
+      west -= lon_margin;
+      east += lon_margin;
+      if (west < -180.0 || east > 180.0)
+        valid = false;
+    }
+  };
+
+
+  Grid_Bbox segment_bbox(const Prepared_Segment& segment)
+  {
+    double south = 0;
+    double north = 0;
+    arc_lat_range(segment, south, north);
+    Grid_Bbox result(south, north,
+        std::min(segment.first_lon, segment.second_lon), std::max(segment.first_lon, segment.second_lon));
+    // A segment that crosses the date line has its endpoints on opposite ends of the range
+    if (result.east - result.west > 180.0)
+      result.valid = false;
+    return result;
+  }
+}
+
+
+bool Around_Grid::cover(double south, double north, double west, double east, std::vector< uint64 >& result) const
+{
+  uint64 lat_begin = (uint64)((south + 90.0)/cell_size);
+  uint64 lat_end = (uint64)((north + 90.0)/cell_size) + 1;
+  uint64 lon_begin = (uint64)((west + 180.0)/cell_size);
+  uint64 lon_end = (uint64)((east + 180.0)/cell_size) + 1;
+  if ((lat_end - lat_begin)*(lon_end - lon_begin) > MAX_CELLS_PER_ITEM)
+    return false;
+
+  for (uint64 i = lat_begin; i < lat_end; ++i)
+  {
+    for (uint64 j = lon_begin; j < lon_end; ++j)
+      result.push_back(i*lon_cells + j);
+  }
+  return true;
+}
+
 
-  std::vector< double > asum = sum(a1, a2);
-  std::vector< double > bsum = sum(b1, b2);
+void Around_Grid::build_cells(const std::vector< std::pair< uint64, uint32 > >& entries,
+    std::vector< uint64 >& cells, std::vector< uint32 >& cell_begin, std::vector< uint32 >& idxs)
+{
+  cells.clear();
+  cell_begin.clear();
+  idxs.clear();
+  idxs.reserve(entries.size());
+  for (std::vector< std::pair< uint64, uint32 > >::const_iterator it = entries.begin(); it != entries.end(); ++it)
+  {
+    if (cells.empty() || cells.back() != it->first)
+    {
+      cells.push_back(it->first);
+      cell_begin.push_back(idxs.size());
+    }
+    idxs.push_back(it->second);
+  }
+  cell_begin.push_back(idxs.size());
+}
+
+
+void Around_Grid::build(const std::vector< Prepared_Point >& points, const std::vector< Prepared_Segment >& segments,
+    double radius)
+{
+  unbounded_points.clear();
+  unbounded_segments.clear();
+
+  double margin = radius_margin(radius);
+  std::vector< Grid_Bbox > point_bboxes;
+  point_bboxes.reserve(points.size());
+  for (std::vector< Prepared_Point >::const_iterator it = points.begin(); it != points.end(); ++it)
+  {
+    point_bboxes.push_back(Grid_Bbox(it->lat, it->lat, it->lon, it->lon));
+    point_bboxes.back().expand(margin);
+  }
+  std::vector< Grid_Bbox > segment_bboxes;
+  segment_bboxes.reserve(segments.size());
+  for (std::vector< Prepared_Segment >::const_iterator it = segments.begin(); it != segments.end(); ++it)
+  {
+    segment_bboxes.push_back(segment_bbox(*it));
+    segment_bboxes.back().expand(margin);
+  }
+
+  // Choose the cell size such that a typical item covers only a few cells
+  double extent_sum = 0;
+  uint count = 0;
+  for (std::vector< Grid_Bbox >::const_iterator it = point_bboxes.begin(); it != point_bboxes.end(); ++it)
+  {
+    if (it->valid)
+    {
+      extent_sum += std::max(it->north - it->south, it->east - it->west);
+      ++count;
+    }
+  }
+  for (std::vector< Grid_Bbox >::const_iterator it = segment_bboxes.begin(); it != segment_bboxes.end(); ++it)
+  {
+    if (it->valid)
+    {
+      extent_sum += std::max(it->north - it->south, it->east - it->west);
+      ++count;
+    }
+  }
+  cell_size = std::min(std::max(count > 0 ? extent_sum/count : 1.0, 1e-5), 90.0);
+  lon_cells = (uint64)(360.0/cell_size) + 2;
+
+  std::vector< std::pair< uint64, uint32 > > entries;
+  std::vector< uint64 > cells;
+  for (uint32 i = 0; i < point_bboxes.size(); ++i)
+  {
+    cells.clear();
+    const Grid_Bbox& bbox = point_bboxes[i];
+    if (bbox.valid && cover(bbox.south, bbox.north, bbox.west, bbox.east, cells))
+    {
+      for (std::vector< uint64 >::const_iterator it = cells.begin(); it != cells.end(); ++it)
+        entries.push_back(std::make_pair(*it, i));
+    }
+    else
+      unbounded_points.push_back(i);
+  }
+  std::sort(entries.begin(), entries.end());
+  build_cells(entries, point_cells, point_cell_begin, point_idxs);
+
+  entries.clear();
+  for (uint32 i = 0; i < segment_bboxes.size(); ++i)
+  {
+    cells.clear();
+    const Grid_Bbox& bbox = segment_bboxes[i];
+    if (bbox.valid && cover(bbox.south, bbox.north, bbox.west, bbox.east, cells))
+    {
+      for (std::vector< uint64 >::const_iterator it = cells.begin(); it != cells.end(); ++it)
+        entries.push_back(std::make_pair(*it, i));
+    }
+    else
+      unbounded_segments.push_back(i);
+  }
+  std::sort(entries.begin(), entries.end());
+  build_cells(entries, segment_cells, segment_cell_begin, segment_idxs);
+}
 
-  return (std::abs(scalar_prod(asum, intersection_pt)) >= scalar_prod(asum, a1)
-      && std::abs(scalar_prod(bsum, intersection_pt)) >= scalar_prod(bsum, b1));
+
+std::pair< const uint32*, const uint32* > Around_Grid::find(uint64 cell, const std::vector< uint64 >& cells,
+    const std::vector< uint32 >& cell_begin, const std::vector< uint32 >& idxs) const
+{
+  std::vector< uint64 >::const_iterator it = std::lower_bound(cells.begin(), cells.end(), cell);
+  if (it == cells.end() || *it != cell)
+    return std::make_pair((const uint32*)0, (const uint32*)0);
+  uint32 pos = it - cells.begin();
+  return std::make_pair(&idxs[0] + cell_begin[pos], &idxs[0] + cell_begin[pos+1]);
+}
+
+
+std::pair< const uint32*, const uint32* > Around_Grid::segments_near(double lat, double lon) const
+{
+  if (segment_cells.empty() || lat < -90.0 || lat > 90.0 || lon < -180.0 || lon > 180.0)
+    return std::make_pair((const uint32*)0, (const uint32*)0);
+  uint64 cell = (uint64)((lat + 90.0)/cell_size)*lon_cells + (uint64)((lon + 180.0)/cell_size);
+  return find(cell, segment_cells, segment_cell_begin, segment_idxs);
+}
+
+
+bool Around_Grid::items_near(const Prepared_Segment& candidate,
+    std::vector< uint32 >& point_result, std::vector< uint32 >& segment_result) const
+{
+  Grid_Bbox bbox = segment_bbox(candidate);
+  bbox.expand(1e-6);
+  std::vector< uint64 > cells;
+  if (!bbox.valid || !cover(bbox.south, bbox.north, bbox.west, bbox.east, cells))
+    return false;
+
+  for (std::vector< uint64 >::const_iterator it = cells.begin(); it != cells.end(); ++it)
+  {
+    std::pair< const uint32*, const uint32* > range = find(*it, point_cells, point_cell_begin, point_idxs);
+    point_result.insert(point_result.end(), range.first, range.second);
+    range = find(*it, segment_cells, segment_cell_begin, segment_idxs);
+    segment_result.insert(segment_result.end(), range.first, range.second);
+  }
+  point_result.insert(point_result.end(), unbounded_points.begin(), unbounded_points.end());
+  segment_result.insert(segment_result.end(), unbounded_segments.begin(), unbounded_segments.end());
+
+  if (cells.size() > 1)
+  {
+    std::sort(point_result.begin(), point_result.end());
+    point_result.erase(std::unique(point_result.begin(), point_result.end()), point_result.end());
+    std::sort(segment_result.begin(), segment_result.end());
+    segment_result.erase(std::unique(segment_result.begin(), segment_result.end()), segment_result.end());
+  }
+  return true;
 }
 
 
@@ -1038,16 +1343,29 @@ void Around_Statement::calc_lat_lons(const Set& input, Statement& query, Resourc
   simple_segments.clear();
 
   if (points.size() == 1)
-  {
     add_coord(points[0].lat, points[0].lon, radius, radius_lat_lons, simple_lat_lons);
-    return;
-  }
   else if (points.size() > 1)
-  {
     add_way(points, radius, radius_lat_lons, simple_lat_lons, simple_segments);
-    return;
+  else
+    add_lat_lons_from_input(input, query, rman);
+
+  grid.build(simple_lat_lons, simple_segments, radius);
+
+  segment_normals.clear();
+  for (std::vector< Prepared_Segment >::const_iterator it = simple_segments.begin(); it != simple_segments.end(); ++it)
+  {
+    Vector_3D unit_norm = it->norm;
+    rescale(1.0/sqrt(scalar_prod(unit_norm, unit_norm)), unit_norm);
+    segment_normals.push_back(unit_norm);
   }
+  point_cartesians.clear();
+  for (std::vector< Prepared_Point >::const_iterator it = simple_lat_lons.begin(); it != simple_lat_lons.end(); ++it)
+    point_cartesians.push_back(it->cartesian);
+}
 
+
+void Around_Statement::add_lat_lons_from_input(const Set& input, Statement& query, Resource_Manager& rman)
+{
   add_nodes(input.nodes);
   add_ways(input.ways, Way_Geometry_Store(input.ways, query, rman));
 
@@ -1090,40 +1408,69 @@ bool Around_Statement::is_inside(double lat, double lon) const
     }
   }
 
-  std::vector< double > coord_cartesian = cartesian(lat, lon);
-  for (std::vector< Prepared_Segment >::const_iterator
-      it = simple_segments.begin(); it != simple_segments.end(); ++it)
+  Vector_3D coord_cartesian = cartesian(lat, lon);
+  double limit = line_dist_limit(radius);
+  std::vector< uint32 > hits;
+
+  std::pair< const uint32*, const uint32* > near = grid.segments_near(lat, lon);
+  filter_by_scalar_prod(segment_normals, near.first, near.second - near.first, coord_cartesian, limit, hits);
+  for (std::vector< uint32 >::const_iterator it = hits.begin(); it != hits.end(); ++it)
   {
-    if (great_circle_line_dist(*it, coord_cartesian) <= radius)
-    {
-      double gcdist = great_circle_dist
-          (it->first_lat, it->first_lon, it->second_lat, it->second_lon);
-      double limit = sqrt(gcdist*gcdist + radius*radius);
-      if (great_circle_dist(lat, lon, it->first_lat, it->first_lon) <= limit &&
-          great_circle_dist(lat, lon, it->second_lat, it->second_lon) <= limit)
-	return true;
-    }
+    if (is_near(simple_segments[near.first[*it]], lat, lon, coord_cartesian, radius))
+      return true;
+  }
+
+  const std::vector< uint32 >& unbounded = grid.get_unbounded_segments();
+  hits.clear();
+  filter_by_scalar_prod(segment_normals, unbounded.empty() ? 0 : &unbounded[0], unbounded.size(),
+      coord_cartesian, limit, hits);
+  for (std::vector< uint32 >::const_iterator it = hits.begin(); it != hits.end(); ++it)
+  {
+    if (is_near(simple_segments[unbounded[*it]], lat, lon, coord_cartesian, radius))
+      return true;
   }
 
   return false;
 }
 
+
 bool Around_Statement::is_inside
     (double first_lat, double first_lon, double second_lat, double second_lon) const
 {
   Prepared_Segment segment(first_lat, first_lon, second_lat, second_lon);
-
-  for (std::vector< Prepared_Point >::const_iterator cit = simple_lat_lons.begin();
-      cit != simple_lat_lons.end(); ++cit)
+  Vector_3D unit_norm = segment.norm;
+  rescale(1.0/sqrt(scalar_prod(unit_norm, unit_norm)), unit_norm);
+  double limit = line_dist_limit(radius);
+  std::vector< uint32 > hits;
+
+  std::vector< uint32 > point_idxs;
+  std::vector< uint32 > segment_idxs;
+  if (grid.items_near(segment, point_idxs, segment_idxs))
   {
-    if (great_circle_line_dist(segment, cit->cartesian) <= radius)
+    filter_by_scalar_prod(point_cartesians, point_idxs.empty() ? 0 : &point_idxs[0], point_idxs.size(),
+        unit_norm, limit, hits);
+    for (std::vector< uint32 >::const_iterator it = hits.begin(); it != hits.end(); ++it)
     {
-      double gcdist = great_circle_dist(first_lat, first_lon, second_lat, second_lon);
-      double limit = sqrt(gcdist*gcdist + radius*radius);
-      if (great_circle_dist(cit->lat, cit->lon, first_lat, first_lon) <= limit &&
-	  great_circle_dist(cit->lat, cit->lon, second_lat, second_lon) <= limit)
+      const Prepared_Point& point = simple_lat_lons[point_idxs[*it]];
+      if (is_near(segment, point.lat, point.lon, point.cartesian, radius))
         return true;
     }
+
+    for (std::vector< uint32 >::const_iterator it = segment_idxs.begin(); it != segment_idxs.end(); ++it)
+    {
+      if (intersect(simple_segments[*it], segment))
+        return true;
+    }
+
+    return false;
+  }
+
+  filter_by_scalar_prod(point_cartesians, 0, point_cartesians.size(), unit_norm, limit, hits);
+  for (std::vector< uint32 >::const_iterator it = hits.begin(); it != hits.end(); ++it)
+  {
+    const Prepared_Point& point = simple_lat_lons[*it];
+    if (is_near(segment, point.lat, point.lon, point.cartesian, radius))
+      return true;
   }
 
   for (std::vector< Prepared_Segment >::const_iterator
@@ -29,15 +29,29 @@
 #include "statement.h"
 
 
+// A point or direction in three dimensional cartesian space.
+struct Vector_3D
+{
+  Vector_3D() { coord[0] = 0; coord[1] = 0; coord[2] = 0; }
+  Vector_3D(double x, double y, double z) { coord[0] = x; coord[1] = y; coord[2] = z; }
+
+  double& operator[](int i) { return coord[i]; }
+  double operator[](int i) const { return coord[i]; }
+
+private:
+  double coord[3];
+};
+
+
 struct Prepared_Segment
 {
   double first_lat;
   double first_lon;
   double second_lat;
   double second_lon;
-  std::vector< double > first_cartesian;
-  std::vector< double > second_cartesian;
-  std::vector< double > norm;
+  Vector_3D first_cartesian;
+  Vector_3D second_cartesian;
+  Vector_3D norm;
 
   Prepared_Segment(double first_lat, double first_lon, double second_lat, double second_lon);
 };
@@ -47,12 +61,80 @@ struct Prepared_Point
 {
   double lat;
   double lon;
-  std::vector< double > cartesian;
+  Vector_3D cartesian;
 
   Prepared_Point(double lat, double lon);
 };
 
 
+// Checks whether the point is within the radius of the segment.
+bool is_near(const Prepared_Segment& segment, double lat, double lon,
+    const Vector_3D& cartesian, double radius);
+
+
+// Vectors stored as one array per coordinate, such that a kernel can process several vectors at once.
+struct Cartesian_Array
+{
+  std::vector< double > x;
+  std::vector< double > y;
+  std::vector< double > z;
+
+  void push_back(const Vector_3D& v);
+  void clear();
+  uint32 size() const { return x.size(); }
+};
+
+
+/* Buckets the prepared points and segments in a regular grid of lat/lon cells.
+ * Every item is entered in all cells its bounding box, expanded by the radius, touches.
+ * Hence a test only needs to look at the items of the cells the candidate touches.
+ * Items that would cover too many cells or wrap around the poles or the date line
+ * are kept in a list that is checked for every candidate. */
+class Around_Grid
+{
+public:
+  Around_Grid() : cell_size(1.), lon_cells(0) {}
+
+  void build(const std::vector< Prepared_Point >& points, const std::vector< Prepared_Segment >& segments,
+      double radius);
+
+  // Returns the indexes of the segments that may be within the radius of the given point,
+  // except the segments from get_unbounded_segments().
+  std::pair< const uint32*, const uint32* > segments_near(double lat, double lon) const;
+
+  // Collects the indexes of the points and segments that may be within the radius of the candidate,
+  // including the unbounded ones. Returns false if the candidate itself cannot be bounded.
+  // Then all items must be checked.
+  bool items_near(const Prepared_Segment& candidate,
+      std::vector< uint32 >& point_idxs, std::vector< uint32 >& segment_idxs) const;
+
+  const std::vector< uint32 >& get_unbounded_segments() const { return unbounded_segments; }
+
+  static const uint MAX_CELLS_PER_ITEM = 256;
+
+private:
+  double cell_size;
+  uint64 lon_cells;
+
+  // For each nonempty cell the indexes of its items, sorted by cell.
+  std::vector< uint64 > point_cells;
+  std::vector< uint32 > point_cell_begin;
+  std::vector< uint32 > point_idxs;
+  std::vector< uint64 > segment_cells;
+  std::vector< uint32 > segment_cell_begin;
+  std::vector< uint32 > segment_idxs;
+
+  std::vector< uint32 > unbounded_points;
+  std::vector< uint32 > unbounded_segments;
+
+  void build_cells(const std::vector< std::pair< uint64, uint32 > >& entries,
+      std::vector< uint64 >& cells, std::vector< uint32 >& cell_begin, std::vector< uint32 >& idxs);
+  std::pair< const uint32*, const uint32* > find(uint64 cell, const std::vector< uint64 >& cells,
+      const std::vector< uint32 >& cell_begin, const std::vector< uint32 >& idxs) const;
+  bool cover(double south, double north, double west, double east, std::vector< uint64 >& result) const;
+};
+
+
 class Around_Statement : public Output_Statement
 {
   public:
@@ -141,7 +223,13 @@ class Around_Statement : public Output_Statement
     std::map< Uint32_Index, std::vector< Point_Double > > radius_lat_lons;
     std::vector< Prepared_Point > simple_lat_lons;
     std::vector< Prepared_Segment > simple_segments;
+    Around_Grid grid;
+    // The unit normals of simple_segments and the cartesian coordinates of simple_lat_lons
+    Cartesian_Array segment_normals;
+    Cartesian_Array point_cartesians;
     std::vector< Query_Constraint* > constraints;
+
+    void add_lat_lons_from_input(const Set& input, Statement& query, Resource_Manager& rman);
 };
 
 #endif
@@ -16,8 +16,14 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include "../../template_db/block_backend.h"
 #include "../core/settings.h"
 #include "../output_formats/output_xml.h"
@@ -130,11 +136,141 @@ void perform_polyline_in_query_print(uint pattern_size,
 }
 
 
+double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec/1000000.;
+}
+
+
+// Tests random candidate nodes against a polyline shaped like a long route.
+// Returns false if the result differs from a brute force check.
+bool benchmark(uint route_size, uint num_candidates, double radius)
+{
+  srand(42);
+  std::ostringstream polyline;
+  polyline<<std::setprecision(10);
+  double lat = 50.0;
+  double lon = 7.0;
+  double south = lat;
+  double north = lat;
+  double west = lon;
+  double east = lon;
+  for (uint i = 0; i < route_size; ++i)
+  {
+    polyline<<(i == 0 ? "" : ",")<<lat<<','<<lon;
+    lat += 0.001*(rand()%1000)/1000. - 0.0002;
+    lon += 0.0015*(rand()%1000)/1000. - 0.0003;
+    south = std::min(south, lat);
+    north = std::max(north, lat);
+    west = std::min(west, lon);
+    east = std::max(east, lon);
+  }
+
+  Parsed_Query global_settings;
+  Nonsynced_Transaction transaction(false, false, "./", "");
+  Resource_Manager rman(transaction, &global_settings);
+  Around_Statement around(0, Attr()("radius", to_string(radius))("polyline", polyline.str()).kvs(),
+      global_settings);
+
+  double start = now();
+  around.calc_lat_lons(Set(), around, rman);
+  double prepare_time = now() - start;
+
+  std::vector< std::pair< double, double > > candidates;
+  candidates.reserve(num_candidates);
+  for (uint i = 0; i < num_candidates; ++i)
+    candidates.push_back(std::make_pair(south + (north - south)*(rand()%1000000)/1000000.,
+        west + (east - west)*(rand()%1000000)/1000000.));
+
+  start = now();
+  uint inside = 0;
+  for (std::vector< std::pair< double, double > >::const_iterator it = candidates.begin();
+      it != candidates.end(); ++it)
+    inside += around.is_inside(it->first, it->second);
+  double test_time = now() - start;
+
+  std::cout<<route_size<<" route nodes, "<<num_candidates<<" candidates, radius "<<radius<<" m: "
+      <<inside<<" inside, prepared in "<<prepare_time<<" s, tested in "<<test_time<<" s\n";
+
+  // Compare against checking every vertex and every segment of the route.
+  // The route is reparsed from its text form to get exactly the coordinates the statement has seen.
+  std::vector< Prepared_Point > points;
+  std::istringstream route(polyline.str());
+  double point_lat = 0;
+  double point_lon = 0;
+  char separator = 0;
+  while (route>>point_lat>>separator>>point_lon)
+  {
+    points.push_back(Prepared_Point(point_lat, point_lon));
+    route>>separator;
+  }
+  std::vector< Prepared_Segment > segments;
+  for (uint i = 1; i < points.size(); ++i)
+    segments.push_back(Prepared_Segment(points[i-1].lat, points[i-1].lon, points[i].lat, points[i].lon));
+
+  // Uniform candidates rarely hit the route, hence half of the compared candidates is placed close to it.
+  std::vector< std::pair< double, double > > compared(candidates.begin(),
+      candidates.begin() + std::min(num_candidates, 5000u));
+  double offset = 4*radius*(360.0/(40000.0*1000.0));
+  for (uint i = 0; i < 5000 && !points.empty(); ++i)
+  {
+    const Prepared_Point& point = points[rand()%points.size()];
+    compared.push_back(std::make_pair(point.lat + offset*((rand()%2001)/1000. - 1.),
+        point.lon + offset*((rand()%2001)/1000. - 1.)));
+  }
+
+  uint brute_inside = 0;
+  uint mismatches = 0;
+  start = now();
+  for (uint i = 0; i < compared.size(); ++i)
+  {
+    double cand_lat = compared[i].first;
+    double cand_lon = compared[i].second;
+    Prepared_Point candidate(cand_lat, cand_lon);
+    bool brute_result = false;
+    for (std::vector< Prepared_Point >::const_iterator it = points.begin();
+        !brute_result && it != points.end(); ++it)
+      brute_result = (great_circle_dist(it->lat, it->lon, cand_lat, cand_lon) <= radius
+          || (std::abs(it->lat - cand_lat) < 1e-7 && std::abs(it->lon - cand_lon) < 1e-7));
+    for (std::vector< Prepared_Segment >::const_iterator it = segments.begin();
+        !brute_result && it != segments.end(); ++it)
+      brute_result = is_near(*it, cand_lat, cand_lon, candidate.cartesian, radius);
+
+    brute_inside += brute_result;
+    if (brute_result != around.is_inside(cand_lat, cand_lon))
+    {
+      if (mismatches < 10)
+        std::cout<<"Mismatch at "<<std::setprecision(10)<<cand_lat<<','<<cand_lon
+            <<": brute force says "<<(brute_result ? "inside" : "outside")<<'\n';
+      ++mismatches;
+    }
+  }
+  double brute_time = now() - start;
+
+  std::cout<<"brute force on "<<compared.size()<<" candidates: "<<brute_inside<<" inside, tested in "
+      <<brute_time<<" s\n";
+  if (mismatches > 0)
+  {
+    std::cout<<"FAILED: "<<mismatches<<" candidates differ from the brute force check\n";
+    return false;
+  }
+  return true;
+}
+
+
 int main(int argc, char* args[])
 {
+  if (argc >= 2 && std::string(args[1]) == "--benchmark")
+  {
+    return benchmark(argc >= 3 ? atoi(args[2]) : 5000, argc >= 4 ? atoi(args[3]) : 1000000,
+        argc >= 5 ? atof(args[4]) : 50.) ? 0 : 1;
+  }
   if (argc < 5)
   {
-    std::cout<<"Usage: "<<args[0]<<" test_to_execute pattern_size db_dir node_id_offset\n";
+    std::cout<<"Usage: "<<args[0]<<" test_to_execute pattern_size db_dir node_id_offset\n"
+        "       "<<args[0]<<" --benchmark [route_size [num_candidates [radius]]]\n";
     return 0;
   }
   std::string test_to_execute = args[1];
@@ -141,9 +141,13 @@ Statement* Bbox_Query_Statement::Criterion_Maker::create_criterion(const Token_N
 }
 
 
+// Number of nodes after which a streamed result is handed over
+const uint32 STREAM_CHUNK_SIZE = 64*1024;
+
+
 Bbox_Query_Statement::Bbox_Query_Statement
     (int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
-    : Output_Statement(line_number_)
+    : Output_Statement(line_number_), stream_chunk_size(STREAM_CHUNK_SIZE)
 {
   std::map< std::string, std::string > attributes;
 
@@ -199,7 +203,8 @@ Bbox_Query_Statement::Bbox_Query_Statement
 
 
 Bbox_Query_Statement::Bbox_Query_Statement(const Bbox_Double& bbox)
-    : Output_Statement(0), south(bbox.south), north(bbox.north), west(bbox.west), east(bbox.east) {}
+    : Output_Statement(0), south(bbox.south), north(bbox.north), west(bbox.west), east(bbox.east),
+    stream_chunk_size(STREAM_CHUNK_SIZE) {}
 
 
 Bbox_Query_Statement::~Bbox_Query_Statement()
@@ -244,6 +249,49 @@ void Bbox_Query_Statement::execute(Resource_Manager& rman)
 }
 
 
+bool Bbox_Query_Statement::execute_streamed(Resource_Manager& rman, Statement& consumer)
+{
+  if (rman.get_desired_timestamp() != NOW)
+    return false;
+
+  Bbox_Constraint constraint(*this);
+  std::set< std::pair< Uint32_Index, Uint32_Index > > ranges;
+  constraint.get_ranges(rman, ranges);
+
+  Block_Backend< Uint32_Index, Node_Skeleton > nodes_db
+      (rman.get_transaction()->data_index(osm_base_settings().NODES));
+
+  Set into;
+  uint32 count = 0;
+  for (Block_Backend< Uint32_Index, Node_Skeleton >::Range_Iterator
+      it(nodes_db.range_begin(Default_Range_Iterator< Uint32_Index >(ranges.begin()),
+          Default_Range_Iterator< Uint32_Index >(ranges.end())));
+      !(it == nodes_db.range_end()); ++it)
+  {
+    // Hand over only complete indexes such that each index appears in a single piece
+    if (count >= stream_chunk_size && !(into.nodes.rbegin()->first == it.index()))
+    {
+      constraint.filter(rman, into);
+      transfer_output(rman, into);
+      rman.health_check(*this);
+      consumer.execute(rman);
+      into.nodes.clear();
+      count = 0;
+    }
+
+    into.nodes[it.index()].push_back(it.object());
+    ++count;
+  }
+
+  constraint.filter(rman, into);
+  transfer_output(rman, into);
+  rman.health_check(*this);
+  consumer.execute(rman);
+
+  return true;
+}
+
+
 Query_Constraint* Bbox_Query_Statement::get_query_constraint()
 {
   constraints.push_back(new Bbox_Constraint(*this));
@@ -34,8 +34,12 @@ class Bbox_Query_Statement : public Output_Statement
     Bbox_Query_Statement(const Bbox_Double& bbox);
     virtual std::string get_name() const { return "bbox-query"; }
     virtual void execute(Resource_Manager& rman);
+    virtual bool execute_streamed(Resource_Manager& rman, Statement& consumer);
     virtual ~Bbox_Query_Statement();
 
+    // Number of nodes after which execute_streamed hands over a piece at the next index boundary
+    void set_stream_chunk_size(uint32 stream_chunk_size_) { stream_chunk_size = stream_chunk_size_; }
+
     struct Statement_Maker : public Generic_Statement_Maker< Bbox_Query_Statement >
     {
       Statement_Maker() : Generic_Statement_Maker< Bbox_Query_Statement >("bbox-query") {}
@@ -93,6 +97,7 @@ class Bbox_Query_Statement : public Output_Statement
     std::set< std::pair< Uint32_Index, Uint32_Index > > ranges_32;
     std::set< std::pair< Uint31_Index, Uint31_Index > > ranges_31;
     std::vector< Query_Constraint* > constraints;
+    uint32 stream_chunk_size;
 };
 
 
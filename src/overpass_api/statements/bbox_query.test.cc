@@ -23,6 +23,7 @@
 #include "../core/settings.h"
 #include "../output_formats/output_xml.h"
 #include "bbox_query.h"
+#include "osm_script.h"
 #include "print.h"
 
 
@@ -57,6 +58,96 @@ void perform_bbox_print(std::string south, std::string north, std::string west,
 }
 
 
+// Counts the pieces that execute_streamed hands over and prints each of them
+class Counting_Consumer : public Statement
+{
+  public:
+    Counting_Consumer(Statement& consumer_) : Statement(0), consumer(&consumer_), pieces(0) {}
+    virtual std::string get_name() const { return consumer->get_name(); }
+    virtual std::string get_result_name() const { return ""; }
+    virtual void execute(Resource_Manager& rman)
+    {
+      ++pieces;
+      consumer->execute(rman);
+    }
+
+    uint32 get_pieces() const { return pieces; }
+
+  private:
+    Statement* consumer;
+    uint32 pieces;
+};
+
+
+// Prints "out qt" of the bbox once from the complete set and once in pieces of about chunk_size nodes,
+// through the script and directly, and compares the outputs
+void compare_bbox_streamed(std::string south, std::string north, std::string west, std::string east,
+    uint32 chunk_size, Transaction& transaction)
+{
+  Parsed_Query global_settings;
+  global_settings.set_output_handler(Output_Handler_Parser::get_format_parser("xml"), 0, 0);
+  const char* bbox_attributes[] =
+      { "s", south.c_str(), "n", north.c_str(), "w", west.c_str(), "e", east.c_str(), 0 };
+  const char* print_attributes[] = { "mode", "body", "order", "quadtile", 0 };
+  std::streambuf* cout_buf = std::cout.rdbuf();
+
+  try
+  {
+    std::ostringstream unstreamed;
+    std::cout.rdbuf(unstreamed.rdbuf());
+    {
+      Resource_Manager rman(transaction, &global_settings);
+      Bbox_Query_Statement bbox_stmt(0, convert_c_pairs(bbox_attributes), global_settings);
+      bbox_stmt.execute(rman);
+      Print_Statement print_stmt(0, convert_c_pairs(print_attributes), global_settings);
+      print_stmt.execute(rman);
+    }
+
+    std::ostringstream by_script;
+    std::cout.rdbuf(by_script.rdbuf());
+    {
+      Resource_Manager rman(transaction, &global_settings);
+      const char* script_attributes[] = { 0 };
+      Osm_Script_Statement script_stmt(0, convert_c_pairs(script_attributes), global_settings);
+      // The script does not own its substatements
+      Bbox_Query_Statement bbox_stmt(0, convert_c_pairs(bbox_attributes), global_settings);
+      bbox_stmt.set_stream_chunk_size(chunk_size);
+      Print_Statement print_stmt(0, convert_c_pairs(print_attributes), global_settings);
+      script_stmt.add_statement(&bbox_stmt, "");
+      script_stmt.add_statement(&print_stmt, "");
+      script_stmt.execute(rman);
+    }
+
+    std::ostringstream streamed;
+    std::cout.rdbuf(streamed.rdbuf());
+    uint32 pieces = 0;
+    {
+      Resource_Manager rman(transaction, &global_settings);
+      Bbox_Query_Statement bbox_stmt(0, convert_c_pairs(bbox_attributes), global_settings);
+      bbox_stmt.set_stream_chunk_size(chunk_size);
+      Print_Statement print_stmt(0, convert_c_pairs(print_attributes), global_settings);
+      Counting_Consumer consumer(print_stmt);
+      if (bbox_stmt.execute_streamed(rman, consumer))
+        pieces = consumer.get_pieces();
+    }
+    std::cout.rdbuf(cout_buf);
+
+    std::cout<<"Bbox ("<<south<<", "<<west<<", "<<north<<", "<<east<<"): ";
+    if (unstreamed.str().empty())
+      std::cout<<"empty result, ";
+    std::cout<<(pieces > 1 ? "several pieces" : pieces == 1 ? "a single piece" : "not streamed")
+        <<", script output "<<(by_script.str() == unstreamed.str() ? "identical" : "DIFFERS")
+        <<", streamed output "<<(streamed.str() == unstreamed.str() ? "identical" : "DIFFERS")<<".\n";
+  }
+  catch (File_Error e)
+  {
+    std::cout.rdbuf(cout_buf);
+    std::cerr<<"File error caught: "
+    <<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+  }
+}
+
+
 int main(int argc, char* args[])
 {
   Parsed_Query global_settings;
@@ -102,6 +193,13 @@ int main(int argc, char* args[])
     perform_bbox_print(south_ss.str(), south_ss.str(), "-15.0", "-3.0", transaction);
   }
 
+  if ((test_to_execute == "") || (test_to_execute == "9"))
+    compare_bbox_streamed("-10.0", "8.0", "-15.0", "9.0", 5, transaction);
+  if ((test_to_execute == "") || (test_to_execute == "10"))
+    compare_bbox_streamed("-10.0", "-1.0", "93.0", "-3.0", 5, transaction);
+  if ((test_to_execute == "") || (test_to_execute == "11"))
+    compare_bbox_streamed("-80.0", "-70.0", "-170.0", "-160.0", 5, transaction);
+
   std::cout<<"</osm>\n";
   return 0;
 }
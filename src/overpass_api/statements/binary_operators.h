@@ -83,7 +83,7 @@ public:
   virtual Statement::Eval_Return_Type return_type() const { return Statement::string; };
   virtual Eval_Task* get_string_task(Prepare_Task_Context& context, const std::string* key);
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const = 0;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const = 0;
 
   static bool applicable_by_subtree_structure(const Token_Node_Ptr& tree_it) { return tree_it->lhs && tree_it->rhs; }
   static void add_substatements(Statement* result, const std::string& operator_name, const Token_Node_Ptr& tree_it,
@@ -121,6 +121,26 @@ struct Binary_Eval_Task : public Eval_Task
   virtual std::string eval(uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const;
   virtual std::string eval(uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const;
 
+  virtual Eval_Value eval_value(const std::string* key) const;
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const;
+
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Way_Skeleton >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const;
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const;
+
 private:
   Eval_Task* lhs;
   Eval_Task* rhs;
@@ -188,7 +208,7 @@ struct Evaluator_Or : public Evaluator_Pair_Operator_Syntax< Evaluator_Or >
   Evaluator_Or(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Or >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -218,7 +238,7 @@ struct Evaluator_And : public Evaluator_Pair_Operator_Syntax< Evaluator_And >
   Evaluator_And(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_And >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -253,7 +273,7 @@ struct Evaluator_Equal : public Evaluator_Pair_Operator_Syntax< Evaluator_Equal
   Evaluator_Equal(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Equal >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -267,7 +287,7 @@ struct Evaluator_Not_Equal : public Evaluator_Pair_Operator_Syntax< Evaluator_No
   Evaluator_Not_Equal(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Not_Equal >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -302,7 +322,7 @@ struct Evaluator_Less : public Evaluator_Pair_Operator_Syntax< Evaluator_Less >
   Evaluator_Less(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Less >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -316,7 +336,7 @@ struct Evaluator_Less_Equal : public Evaluator_Pair_Operator_Syntax< Evaluator_L
   Evaluator_Less_Equal(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Less_Equal >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -330,7 +350,7 @@ struct Evaluator_Greater : public Evaluator_Pair_Operator_Syntax< Evaluator_Grea
   Evaluator_Greater(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Greater >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -344,7 +364,7 @@ struct Evaluator_Greater_Equal : public Evaluator_Pair_Operator_Syntax< Evaluato
   Evaluator_Greater_Equal(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Greater_Equal >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -378,7 +398,7 @@ struct Evaluator_Plus : public Evaluator_Pair_Operator_Syntax< Evaluator_Plus >
   Evaluator_Plus(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Plus >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -392,7 +412,7 @@ struct Evaluator_Minus : public Evaluator_Pair_Operator_Syntax< Evaluator_Minus
   Evaluator_Minus(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Minus >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -423,7 +443,7 @@ struct Evaluator_Times : public Evaluator_Pair_Operator_Syntax< Evaluator_Times
   Evaluator_Times(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Times >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
@@ -437,7 +457,7 @@ struct Evaluator_Divided : public Evaluator_Pair_Operator_Syntax< Evaluator_Divi
   Evaluator_Divided(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Pair_Operator_Syntax< Evaluator_Divided >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& lhs_result, const std::string& rhs_result) const;
+  virtual Eval_Value process(const Eval_Value& lhs_result, const Eval_Value& rhs_result) const;
 };
 
 
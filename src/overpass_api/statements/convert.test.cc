@@ -16,19 +16,25 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/time.h>
+
 #include "../data/utils.h"
 #include "aggregators.h"
 #include "binary_operators.h"
 #include "id_query.h"
 #include "convert.h"
 #include "explicit_geometry.h"
+#include "filter.h"
 #include "geometry_endomorphisms.h"
+#include "item.h"
 #include "item_geometry.h"
 #include "make.h"
 #include "per_member.h"
 #include "print.h"
+#include "query.h"
 #include "set_prop.h"
 #include "tag_value.h"
+#include "ternary_operator.h"
 #include "testing_tools.h"
 #include "union.h"
 
@@ -465,11 +471,220 @@ void trace_test_2(Parsed_Query& global_settings, Transaction& transaction,
 }
 
 
+// Evaluates expressions with constant subexpressions, which get_string_task folds,
+// both in a convert statement and in a filter of a query
+void constant_folding_test(Parsed_Query& global_settings, Transaction& transaction,
+    std::string type, uint64 global_node_offset)
+{
+  Resource_Manager rman(transaction, &global_settings);
+  Statement_Container stmt_cont(global_settings);
+  prepare_value_test(global_settings, rman, "_", 7, 14, "1000", global_node_offset);
+
+  // way._(if: id() > 100 * 100 || (1 < 2 && id() == 7))->.filtered
+  Query_Statement query(0, Attr()("type", "way")("into", "filtered").kvs(), global_settings);
+  stmt_cont.create_stmt< Item_Statement >(Attr().kvs(), &query);
+  Statement* filter = stmt_cont.create_stmt< Filter_Statement >(Attr().kvs(), &query);
+  Statement* or_ = stmt_cont.create_stmt< Evaluator_Or >(Attr().kvs(), filter);
+  Statement* greater = stmt_cont.create_stmt< Evaluator_Greater >(Attr().kvs(), or_);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), greater);
+  Statement* times = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), greater);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "100").kvs(), times);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "100").kvs(), times);
+  Statement* and_ = stmt_cont.create_stmt< Evaluator_And >(Attr().kvs(), or_);
+  Statement* less = stmt_cont.create_stmt< Evaluator_Less >(Attr().kvs(), and_);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "1").kvs(), less);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "2").kvs(), less);
+  Statement* equal = stmt_cont.create_stmt< Evaluator_Equal >(Attr().kvs(), and_);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), equal);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "7").kvs(), equal);
+  query.execute(rman);
+
+  Convert_Statement stmt(0, Attr()("type", type).kvs(), global_settings);
+
+  // seconds = id() * (60 * 60) + (2 + 3) * 4
+  Statement* seconds = stmt_cont.create_stmt< Set_Prop_Statement >(Attr()("k", "seconds").kvs(), &stmt);
+  Statement* plus = stmt_cont.create_stmt< Evaluator_Plus >(Attr().kvs(), seconds);
+  times = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), plus);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), times);
+  Statement* times_2 = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), times);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "60").kvs(), times_2);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "60").kvs(), times_2);
+  times = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), plus);
+  Statement* plus_2 = stmt_cont.create_stmt< Evaluator_Plus >(Attr().kvs(), times);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "2").kvs(), plus_2);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "3").kvs(), plus_2);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "4").kvs(), times);
+
+  // branch = 1 < 2 ? id() : "never"
+  Statement* branch = stmt_cont.create_stmt< Set_Prop_Statement >(Attr()("k", "branch").kvs(), &stmt);
+  Statement* ternary = stmt_cont.create_stmt< Ternary_Evaluator >(Attr().kvs(), branch);
+  less = stmt_cont.create_stmt< Evaluator_Less >(Attr().kvs(), ternary);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "1").kvs(), less);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "2").kvs(), less);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), ternary);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "never").kvs(), ternary);
+
+  // seven = 2 < 1 || id() == 7
+  Statement* seven = stmt_cont.create_stmt< Set_Prop_Statement >(Attr()("k", "seven").kvs(), &stmt);
+  or_ = stmt_cont.create_stmt< Evaluator_Or >(Attr().kvs(), seven);
+  less = stmt_cont.create_stmt< Evaluator_Less >(Attr().kvs(), or_);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "2").kvs(), less);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "1").kvs(), less);
+  equal = stmt_cont.create_stmt< Evaluator_Equal >(Attr().kvs(), or_);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), equal);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "7").kvs(), equal);
+
+  stmt.execute(rman);
+  Print_Statement(0, Attr().kvs(), global_settings).execute(rman);
+  Print_Statement(0, Attr()("from", "filtered")("mode", "ids_only").kvs(), global_settings).execute(rman);
+}
+
+
+double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec/1000000.;
+}
+
+
+double time_convert(const Eval_Task& task, const std::vector< Way_Skeleton >& ways,
+    std::vector< std::string >& results)
+{
+  std::string key = "v";
+  results.reserve(ways.size());
+  double start = now();
+  for (std::vector< Way_Skeleton >::const_iterator it = ways.begin(); it != ways.end(); ++it)
+    results.push_back(task.eval(Element_With_Context< Way_Skeleton >(&*it, 0, 0, 0, 0), &key));
+  return now() - start;
+}
+
+
+double time_if(const Eval_Task& task, const std::vector< Way_Skeleton >& ways, std::vector< bool >& results)
+{
+  results.reserve(ways.size());
+  double start = now();
+  for (std::vector< Way_Skeleton >::const_iterator it = ways.begin(); it != ways.end(); ++it)
+    results.push_back(
+        task.eval_value(Element_With_Context< Way_Skeleton >(&*it, 0, 0, 0, 0), 0).represents_boolean_true());
+  return now() - start;
+}
+
+
+// Returns the number of elements for which the results differ and prints the first of them
+template< typename Result >
+uint count_differences(const std::string& name, const std::vector< Way_Skeleton >& ways,
+    const std::vector< Result >& compiled, const std::vector< Result >& tree)
+{
+  uint count = 0;
+  for (uint i = 0; i < ways.size(); ++i)
+  {
+    if (compiled[i] == tree[i])
+      continue;
+    if (++count <= 10)
+      std::cout<<name<<": way "<<ways[i].id.val()<<": compiled "<<compiled[i]<<", tree walk "<<tree[i]<<'\n';
+  }
+  return count;
+}
+
+
+// Compares the tasks built by get_string_task, with constant subexpressions folded,
+// against the plain tree of tasks for the same expression. Returns false if any element gets a different value.
+bool benchmark(uint num_elements)
+{
+  Parsed_Query global_settings;
+  Nonsynced_Transaction transaction(false, false, "./", "");
+  Resource_Manager rman(transaction, &global_settings);
+  Statement_Container stmt_cont(global_settings);
+
+  std::vector< Way_Skeleton > ways;
+  for (uint i = 1; i <= num_elements; ++i)
+    ways.push_back(Way_Skeleton(Way::Id_Type(i)));
+
+  // convert ... v = id() * (60 * 60) + (2 + 3) * 4
+  Evaluator_Plus convert_expr(0, Attr().kvs(), global_settings);
+  Statement* stmt0 = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), &convert_expr);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), stmt0);
+  Statement* stmt01 = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), stmt0);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "60").kvs(), stmt01);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "60").kvs(), stmt01);
+  Statement* stmt1 = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), &convert_expr);
+  Statement* stmt10 = stmt_cont.create_stmt< Evaluator_Plus >(Attr().kvs(), stmt1);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "2").kvs(), stmt10);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "3").kvs(), stmt10);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "4").kvs(), stmt1);
+
+  // way._(if: id() > 100 * 100 || (1 < 2 && id() == 7))
+  Evaluator_Or if_expr(0, Attr().kvs(), global_settings);
+  Statement* stmt2 = stmt_cont.create_stmt< Evaluator_Greater >(Attr().kvs(), &if_expr);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), stmt2);
+  Statement* stmt21 = stmt_cont.create_stmt< Evaluator_Times >(Attr().kvs(), stmt2);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "100").kvs(), stmt21);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "100").kvs(), stmt21);
+  Statement* stmt3 = stmt_cont.create_stmt< Evaluator_And >(Attr().kvs(), &if_expr);
+  Statement* stmt30 = stmt_cont.create_stmt< Evaluator_Less >(Attr().kvs(), stmt3);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "1").kvs(), stmt30);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "2").kvs(), stmt30);
+  Statement* stmt31 = stmt_cont.create_stmt< Evaluator_Equal >(Attr().kvs(), stmt3);
+  stmt_cont.create_stmt< Evaluator_Id >(Attr().kvs(), stmt31);
+  stmt_cont.create_stmt< Evaluator_Fixed >(Attr()("v", "7").kvs(), stmt31);
+
+  Prepare_Task_Context convert_context(convert_expr.request_context(), convert_expr, rman);
+  Owner< Eval_Task > convert_compiled(convert_expr.get_string_task(convert_context, 0));
+  Prepare_Task_Context if_context(if_expr.request_context(), if_expr, rman);
+  Owner< Eval_Task > if_compiled(if_expr.get_string_task(if_context, 0));
+
+  Evaluator_Plus plus(0, Attr().kvs(), global_settings);
+  Evaluator_Times times(0, Attr().kvs(), global_settings);
+  Evaluator_Or or_(0, Attr().kvs(), global_settings);
+  Evaluator_And and_(0, Attr().kvs(), global_settings);
+  Evaluator_Greater greater(0, Attr().kvs(), global_settings);
+  Evaluator_Less less(0, Attr().kvs(), global_settings);
+  Evaluator_Equal equal(0, Attr().kvs(), global_settings);
+  Binary_Eval_Task convert_tree(
+      new Binary_Eval_Task(new Id_Eval_Task(),
+          new Binary_Eval_Task(new Const_Eval_Task("60"), new Const_Eval_Task("60"), &times), &times),
+      new Binary_Eval_Task(
+          new Binary_Eval_Task(new Const_Eval_Task("2"), new Const_Eval_Task("3"), &plus),
+          new Const_Eval_Task("4"), &times), &plus);
+  Binary_Eval_Task if_tree(
+      new Binary_Eval_Task(new Id_Eval_Task(),
+          new Binary_Eval_Task(new Const_Eval_Task("100"), new Const_Eval_Task("100"), &times), &greater),
+      new Binary_Eval_Task(
+          new Binary_Eval_Task(new Const_Eval_Task("1"), new Const_Eval_Task("2"), &less),
+          new Binary_Eval_Task(new Id_Eval_Task(), new Const_Eval_Task("7"), &equal), &and_), &or_);
+
+  std::vector< std::string > convert_compiled_results;
+  std::vector< std::string > convert_tree_results;
+  double convert_compiled_time = time_convert(*convert_compiled, ways, convert_compiled_results);
+  double convert_tree_time = time_convert(convert_tree, ways, convert_tree_results);
+  std::vector< bool > if_compiled_results;
+  std::vector< bool > if_tree_results;
+  double if_compiled_time = time_if(*if_compiled, ways, if_compiled_results);
+  double if_tree_time = time_if(if_tree, ways, if_tree_results);
+
+  std::cout<<num_elements<<" ways\n"
+      <<"convert: compiled "<<convert_compiled_time<<" s, tree walk "<<convert_tree_time<<" s\n"
+      <<"if: compiled "<<if_compiled_time<<" s, tree walk "<<if_tree_time<<" s\n";
+
+  uint differences = count_differences("convert", ways, convert_compiled_results, convert_tree_results)
+      + count_differences("if", ways, if_compiled_results, if_tree_results);
+  if (differences > 0)
+    std::cout<<"FAILED: "<<differences<<" results differ between compiled tasks and tree walk.\n";
+  return differences == 0;
+}
+
+
 int main(int argc, char* args[])
 {
+  if (argc >= 2 && std::string(args[1]) == "--benchmark")
+  {
+    return benchmark(argc >= 3 ? atoi(args[2]) : 1000000) ? 0 : 1;
+  }
   if (argc < 5)
   {
-    std::cout<<"Usage: "<<args[0]<<" test_to_execute pattern_size db_dir node_id_offset\n";
+    std::cout<<"Usage: "<<args[0]<<" test_to_execute pattern_size db_dir node_id_offset\n"
+        "       "<<args[0]<<" --benchmark [num_elements]\n";
     return 0;
   }
   std::string test_to_execute = args[1];
@@ -516,6 +731,8 @@ int main(int argc, char* args[])
       lat_lon_test(global_settings, transaction, "lat-lon", global_node_offset);
     if ((test_to_execute == "") || (test_to_execute == "15"))
       per_member_test(global_settings, transaction, "per-member", global_node_offset);
+    if ((test_to_execute == "") || (test_to_execute == "16"))
+      constant_folding_test(global_settings, transaction, "folded", global_node_offset);
 
     std::cout<<"</osm>\n";
   }
@@ -197,10 +197,9 @@ void register_coord(double lat, double lon,
 struct Closedness_Predicate
 {
   bool match(const Way_Skeleton& obj) const { return !obj.nds.empty() && obj.nds.front() == obj.nds.back(); }
-  bool match(const Handle< Way_Skeleton >& h) const
-  { return !h.object().nds.empty() && h.object().nds.front() == h.object().nds.back(); }
+  bool match(const Handle< Way_Skeleton >& h) const { return Way_Skeleton_View(h.get_ptr_to_raw()).is_closed(); }
   bool match(const Handle< Attic< Way_Skeleton > >& h) const
-  { return !h.object().nds.empty() && h.object().nds.front() == h.object().nds.back(); }
+  { return Way_Skeleton_View(h.get_ptr_to_raw()).is_closed(); }
 };
 
 
@@ -16,6 +16,8 @@
  * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+
 #include "../data/tag_store.h"
 #include "../data/utils.h"
 #include "evaluator.h"
@@ -444,6 +446,96 @@ Element_With_Context< Derived_Skeleton > Set_With_Context::get_context(
 }
 
 
+Eval_Value Eval_Value::from_int(int64 value)
+{
+  Eval_Value result;
+  result.text_known = false;
+  result.int_state = VALID;
+  result.int_value = value;
+  result.double_state = VALID;
+  result.double_value = value;
+  return result;
+}
+
+
+// Same digits as to_string(double), but without the overhead of a stream
+Eval_Value Eval_Value::from_double(double value)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.14g", value);
+  return Eval_Value(buf);
+}
+
+
+Eval_Value Eval_Value::from_fixed(double value, unsigned int precision)
+{
+  char buf[64];
+  if (snprintf(buf, sizeof(buf), "%.*f", precision, value) >= (int)sizeof(buf))
+    return Eval_Value(fixed_to_string(value, precision));
+  return Eval_Value(buf);
+}
+
+
+bool Eval_Value::try_int64(int64& result) const
+{
+  if (int_state == UNKNOWN)
+    int_state = ::try_int64(text, int_value) ? VALID : INVALID;
+  result = int_value;
+  return int_state == VALID;
+}
+
+
+bool Eval_Value::try_double(double& result) const
+{
+  if (double_state == UNKNOWN)
+    double_state = ::try_double(text, double_value) ? VALID : INVALID;
+  result = double_value;
+  return double_state == VALID;
+}
+
+
+bool Eval_Value::represents_boolean_true() const
+{
+  double val_d = 0;
+  if (try_double(val_d))
+    return val_d != 0;
+  return !text.empty();
+}
+
+
+const std::string& Eval_Value::str() const
+{
+  if (!text_known)
+  {
+    text = to_string(int_value);
+    text_known = true;
+  }
+  return text;
+}
+
+
+// Parse the constant once instead of once per evaluation
+void parse_number(const Eval_Value& value)
+{
+  int64 value_l = 0;
+  double value_d = 0;
+  value.try_int64(value_l);
+  value.try_double(value_d);
+}
+
+
+Const_Eval_Task::Const_Eval_Task(const std::string& value_) : value(value_)
+{
+  parse_number(value);
+}
+
+
+Const_Eval_Task::Const_Eval_Task(const Eval_Value& value_) : value(value_)
+{
+  parse_number(value);
+}
+
+
 Prepare_Task_Context::Prepare_Task_Context(
     const Requested_Context& requested, const Statement& stmt, Resource_Manager& rman)
     : contexts(requested.set_usage.size()), relation_member_roles_(0), users(0)
@@ -499,8 +591,5 @@ const std::string* Prepare_Task_Context::get_user_name(uint32 user_id) const
 {
   if (!users)
     return 0;
-  std::map< uint32, std::string >::const_iterator it = users->find(user_id);
-  if (it == users->end())
-    return 0;
-  return &it->second;
+  return users->get_name(user_id);
 }
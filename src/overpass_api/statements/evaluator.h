@@ -196,7 +196,7 @@ struct Prepare_Task_Context
 private:
   Array< Set_With_Context > contexts;
   const std::map< uint32, std::string >* relation_member_roles_;
-  const std::map< uint32, std::string >* users;
+  const User_Data_Cache* users;
 };
 
 
@@ -223,6 +223,43 @@ They only make sense in the context of a single element.
 */
 
 
+/* The result of an evaluation.
+   Numbers are kept in binary form and are only printed if their string form is requested.
+   Strings are parsed at most once as numbers.
+   A value behaves in every respect like the string it prints to,
+   in particular a floating point result is rounded to the digits it would have been printed with. */
+class Eval_Value
+{
+public:
+  Eval_Value() : text_known(true), int_state(UNKNOWN), double_state(UNKNOWN), int_value(0), double_value(0) {}
+  explicit Eval_Value(const std::string& text_)
+      : text(text_), text_known(true), int_state(UNKNOWN), double_state(UNKNOWN), int_value(0), double_value(0) {}
+
+  static Eval_Value from_int(int64 value);
+  static Eval_Value from_double(double value);
+  static Eval_Value from_fixed(double value, unsigned int precision);
+  static Eval_Value from_bool(bool value) { return from_int(value ? 1 : 0); }
+
+  bool try_int64(int64& result) const;
+  bool try_double(double& result) const;
+  bool represents_boolean_true() const;
+  const std::string& str() const;
+
+private:
+  enum Parse_State { UNKNOWN, VALID, INVALID };
+
+  mutable std::string text;
+  mutable bool text_known;
+  mutable Parse_State int_state;
+  mutable Parse_State double_state;
+  mutable int64 int_value;
+  mutable double double_value;
+};
+
+
+/* The eval_value methods are the typed counterpart of the eval methods.
+   Tasks that compute numbers or combine other tasks override both,
+   such that chains of operators pass numbers without printing and parsing them in between. */
 struct Eval_Task
 {
   virtual ~Eval_Task() {}
@@ -254,17 +291,86 @@ struct Eval_Task
       { return eval(data, key); }
   virtual std::string eval(uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
       { return eval(data, key); }
+
+  virtual Eval_Value eval_value(const std::string* key) const { return Eval_Value(eval(key)); }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(data, key)); }
+
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(pos, data, key)); }
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return Eval_Value(eval(pos, data, key)); }
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return Eval_Value(eval(pos, data, key)); }
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return Eval_Value(eval(pos, data, key)); }
+
+  // Returns the value if the task evaluates to the same value in every context, otherwise 0
+  virtual const Eval_Value* const_value() const { return 0; }
 };
 
 
 struct Const_Eval_Task : public Eval_Task
 {
-  Const_Eval_Task(const std::string& value_) : value(value_) {}
-
-  virtual std::string eval(const std::string* key) const { return value; }
+  Const_Eval_Task(const std::string& value_);
+  Const_Eval_Task(const Eval_Value& value_);
+
+  virtual std::string eval(const std::string* key) const { return value.str(); }
+  virtual Eval_Value eval_value(const std::string* key) const { return value; }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return value; }
+
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return value; }
+  virtual Eval_Value eval_value(
+      uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return value; }
+
+  virtual const Eval_Value* const_value() const { return &value; }
 
 private:
-  std::string value;
+  Eval_Value value;
 };
 
 
@@ -64,9 +64,7 @@ bool evals_to_true(Evaluator& criterion, const Statement& stmt, Resource_Manager
 {
   Prepare_Task_Context context(criterion.request_context(), stmt, rman);
   Owner< Eval_Task > task(criterion.get_string_task(context, 0));
-  std::string valuation = (*task).eval(0);
-  double val_d = 0;
-  return valuation != "" && (!try_double(valuation, val_d) || val_d != 0);
+  return (*task).eval_value(0).represents_boolean_true();
 }
 
 
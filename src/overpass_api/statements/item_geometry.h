@@ -203,6 +203,23 @@ struct Length_Eval_Task : public Eval_Task
       { return "0"; }
   virtual std::string eval(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
       { return "0"; }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return data.geometry ? Eval_Value::from_fixed(length(*data.geometry), 3) : Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return data.geometry ? Eval_Value::from_fixed(length(*data.geometry), 3) : Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return data.geometry ? Eval_Value::from_fixed(length(*data.geometry), 3) : Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return data.geometry ? Eval_Value::from_fixed(length(*data.geometry), 3) : Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return Eval_Value::from_int(0); }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return Eval_Value::from_int(0); }
 };
 
 
@@ -220,9 +220,25 @@ void Osm_Script_Statement::execute(Resource_Manager& rman)
     rman.switch_diff_rhs(add_deletion_information);
   }
 
-  for (std::vector< Statement* >::iterator it(substatements.begin());
-      it != substatements.end(); ++it)
-    (*it)->execute(rman);
+  // If the final print statement is the only reader of the result of the statement before it,
+  // that result can be printed while it is collected
+  std::vector< Statement* >::size_type num_unstreamed = substatements.size();
+  if (comparison_timestamp == 0 && num_unstreamed >= 2)
+  {
+    Print_Statement* print = dynamic_cast< Print_Statement* >(substatements.back());
+    if (print && print->can_print_in_pieces(substatements[num_unstreamed - 2]->get_result_name()))
+      num_unstreamed -= 2;
+  }
+
+  for (std::vector< Statement* >::size_type i = 0; i < num_unstreamed; ++i)
+    substatements[i]->execute(rman);
+
+  if (num_unstreamed < substatements.size()
+      && !substatements[num_unstreamed]->execute_streamed(rman, *substatements.back()))
+  {
+    substatements[num_unstreamed]->execute(rman);
+    substatements.back()->execute(rman);
+  }
 
   if (rman.area_updater())
     rman.area_updater()->flush();
@@ -42,6 +42,8 @@ const unsigned int NODE_FLUSH_SIZE = 1024*1024;
 const unsigned int WAY_FLUSH_SIZE = 512*1024;
 const unsigned int RELATION_FLUSH_SIZE = 512*1024;
 const unsigned int AREA_FLUSH_SIZE = 64*1024;
+// Maximum number of tags held at once when printing in the order of ids
+const unsigned int TAG_PREFETCH_SIZE = 4*1024*1024;
 
 
 Generic_Statement_Maker< Print_Statement > Print_Statement::statement_maker("print");
@@ -197,7 +199,7 @@ struct Extra_Data
       double south, double north, double west, double east);
   ~Extra_Data();
 
-  const std::map< uint32, std::string >* get_users() const;
+  const User_Data_Cache* get_users() const;
 
   unsigned int mode;
   Output_Handler::Feature_Action action;
@@ -206,7 +208,8 @@ struct Extra_Data
   Relation_Geometry_Store* relation_geometry_store;
   Relation_Geometry_Store* attic_relation_geometry_store;
   const std::map< uint32, std::string >* roles;
-  const std::map< uint32, std::string >* users;
+  const User_Data_Cache* users;
+  const Statement* stmt;
 };
 
 
@@ -215,7 +218,7 @@ Extra_Data::Extra_Data(
     unsigned int mode_, Output_Handler::Feature_Action action_,
     double south, double north, double west, double east)
     : mode(mode_), action(action_), way_geometry_store(0), attic_way_geometry_store(0),
-    relation_geometry_store(0), attic_relation_geometry_store(0), roles(0), users(0)
+    relation_geometry_store(0), attic_relation_geometry_store(0), roles(0), users(0), stmt(&stmt)
 {
   if (mode & (Output_Mode::GEOMETRY | Output_Mode::BOUNDS | Output_Mode::CENTER))
   {
@@ -244,7 +247,7 @@ Extra_Data::Extra_Data(
 }
 
 
-const std::map< uint32, std::string >* Extra_Data::get_users() const
+const User_Data_Cache* Extra_Data::get_users() const
 {
   return users;
 }
@@ -599,6 +602,10 @@ void tags_by_id
 {
   std::vector< std::pair< const Object*, uint32 > > items_by_id = collect_items_by_id(items);
 
+  // The tags are read in as few passes over the tag file as the memory allows
+  typename Object::Id_Type tags_upper_bound;
+  bool tags_complete = false;
+
   // iterate over the result
   for (typename Object::Id_Type id_pos; id_pos < items_by_id.size(); id_pos += FLUSH_SIZE)
   {
@@ -615,8 +622,6 @@ void tags_by_id
       ++upper_id_bound;
     }
 
-    tag_store.prefetch_chunk(items, lower_id_bound, upper_id_bound);
-
     std::set< OSM_Element_Metadata_Skeleton< typename Object::Id_Type > > metadata;
     if (meta_printer)
     {
@@ -631,6 +636,12 @@ void tags_by_id
     {
       if (++element_count > limit)
 	return;
+      if (!tags_complete && !(items_by_id[i.val()].first->id < tags_upper_bound))
+      {
+        tags_upper_bound = tag_store.prefetch_by_id(
+            items, items_by_id[i.val()].first->id, TAG_PREFETCH_SIZE, rman, extra_data.stmt);
+        tags_complete = (tags_upper_bound == typename Object::Id_Type());
+      }
       typename std::set< OSM_Element_Metadata_Skeleton< typename Object::Id_Type > >::const_iterator meta_it
           = metadata.lower_bound(OSM_Element_Metadata_Skeleton< typename Object::Id_Type >
               (items_by_id[i.val()].first->id));
@@ -81,6 +81,14 @@ class Print_Statement : public Statement
     virtual void execute(Resource_Manager& rman);
     virtual ~Print_Statement();
 
+    // True if printing the set piece by piece in ascending order of indexes gives the same output
+    // as printing it at once
+    bool can_print_in_pieces(const std::string& set_name) const
+    {
+      return set_name == input && order == order_by_quadtile && !(mode & Output_Mode::COUNT)
+          && limit == std::numeric_limits< unsigned int >::max();
+    }
+
     static Generic_Statement_Maker< Print_Statement > statement_maker;
 
     static std::string mode_string_xml(Output_Mode mode)
@@ -20,6 +20,7 @@
 #include <sstream>
 #include "../../template_db/block_backend.h"
 #include "../core/settings.h"
+#include "../data/tag_store.h"
 #include "../output_formats/output_xml.h"
 #include "id_query.h"
 #include "print.h"
@@ -45,6 +46,90 @@ Resource_Manager& perform_id_query(Resource_Manager& rman, std::string type, uin
   return rman;
 }
 
+Resource_Manager& perform_id_range_query(Resource_Manager& rman, std::string type, uint64 lower, uint64 upper)
+{
+  std::ostringstream buf("");
+  buf<<lower;
+  std::string lower_ = buf.str();
+  buf.str("");
+  buf<<upper;
+  std::string upper_ = buf.str();
+  Parsed_Query global_settings;
+
+  const char* attributes[7];
+  attributes[0] = "type";
+  attributes[1] = type.c_str();
+  attributes[2] = "lower";
+  attributes[3] = lower_.c_str();
+  attributes[4] = "upper";
+  attributes[5] = upper_.c_str();
+  attributes[6] = 0;
+
+  Id_Query_Statement stmt(1, convert_c_pairs(attributes), global_settings);
+  stmt.execute(rman);
+
+  return rman;
+}
+
+
+// Reads the tags by id in passes of at most max_tags tags and compares them with the tags read in a single chunk
+template< typename Index, typename Object >
+void compare_tags_by_id(Transaction& transaction, Resource_Manager& rman,
+    const std::map< Index, std::vector< Object > >& items, uint64 max_tags, const std::string& type)
+{
+  std::vector< std::pair< typename Object::Id_Type, std::pair< Index, const Object* > > > items_by_id;
+  for (typename std::map< Index, std::vector< Object > >::const_iterator it = items.begin(); it != items.end(); ++it)
+  {
+    for (typename std::vector< Object >::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+      items_by_id.push_back(std::make_pair(it2->id, std::make_pair(it->first, &*it2)));
+  }
+  std::sort(items_by_id.begin(), items_by_id.end());
+  if (items_by_id.empty())
+  {
+    std::cout<<"No "<<type<<" found.\n";
+    return;
+  }
+
+  typename Object::Id_Type upper_id_bound = items_by_id.back().first;
+  ++upper_id_bound;
+  Tag_Store< Index, Object > chunk_store(transaction);
+  chunk_store.prefetch_chunk(items, items_by_id.front().first, upper_id_bound);
+
+  Tag_Store< Index, Object > by_id_store(transaction);
+  typename Object::Id_Type tags_upper_bound;
+  bool tags_complete = false;
+  uint32 passes = 0;
+  uint32 differences = 0;
+  uint32 tagged = 0;
+  for (typename std::vector< std::pair< typename Object::Id_Type, std::pair< Index, const Object* > > >::const_iterator
+      it = items_by_id.begin(); it != items_by_id.end(); ++it)
+  {
+    if (!tags_complete && !(it->first < tags_upper_bound))
+    {
+      tags_upper_bound = by_id_store.prefetch_by_id(items, it->first, max_tags, rman, 0);
+      tags_complete = (tags_upper_bound == typename Object::Id_Type());
+      ++passes;
+    }
+    const std::vector< std::pair< std::string, std::string > >* by_chunk
+        = chunk_store.get(it->second.first, *it->second.second);
+    const std::vector< std::pair< std::string, std::string > >* by_id
+        = by_id_store.get(it->second.first, *it->second.second);
+    if (by_chunk)
+      ++tagged;
+    if ((by_chunk ? *by_chunk : std::vector< std::pair< std::string, std::string > >())
+        != (by_id ? *by_id : std::vector< std::pair< std::string, std::string > >()))
+    {
+      if (++differences <= 10)
+        std::cout<<"Tags of "<<type<<' '<<it->first.val()<<" differ.\n";
+    }
+  }
+
+  std::cout<<"Tags of "<<type<<(tagged > 0 ? " with tags" : " without any tags")
+      <<(differences == 0 ? " are identical" : " DIFFER")
+      <<(passes > 1 ? " in several passes.\n" : " in a single pass.\n");
+}
+
+
 int main(int argc, char* args[])
 {
   if (argc < 5)
@@ -293,6 +378,31 @@ int main(int argc, char* args[])
     }
   }
 
+  if ((test_to_execute == "") || (test_to_execute == "6"))
+  {
+    try
+    {
+      // Few tags per pass force reading the tags by id in many passes
+      Resource_Manager rman(transaction, &global_settings);
+      perform_id_range_query(rman, "node", 1 + global_node_offset, node_id_upper_limit + global_node_offset);
+      const Set* nodes = rman.get_set("_");
+      compare_tags_by_id(transaction, rman, nodes->nodes, 3, "nodes");
+      perform_id_range_query(rman, "way", 1, way_id_upper_limit);
+      const Set* ways = rman.get_set("_");
+      compare_tags_by_id(transaction, rman, ways->ways, 3, "ways");
+      perform_id_range_query(rman, "relation", 1, relation_id_upper_limit);
+      const Set* relations = rman.get_set("_");
+      compare_tags_by_id(transaction, rman, relations->relations, 3, "relations");
+      // An element with more tags than fit in a pass still gets all of its tags
+      compare_tags_by_id(transaction, rman, relations->relations, 1, "relations");
+    }
+    catch (File_Error e)
+    {
+      std::cerr<<"File error caught: "
+      <<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+    }
+  }
+
   std::cout<<"</osm>\n";
   return 0;
 }
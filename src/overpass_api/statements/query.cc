@@ -321,7 +321,8 @@ std::vector< std::pair< Id_Type, Uint31_Index > > Query_Statement::collect_ids
     {
       if (timestamp == NOW)
       {
-        std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req = get_k_req(krit->first);
+        std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
+            = get_k_req(krit->first, krit->second->anchored_prefix());
 	filter_id_list(new_ids, filtered,
 	    tags_db.range_begin(range_req.begin(), range_req.end()), tags_db.range_end(),
 		Trivial_Regex(), *krit->second, check_keys_late);
@@ -347,7 +348,7 @@ std::vector< std::pair< Id_Type, Uint31_Index > > Query_Statement::collect_ids
       if (timestamp == NOW)
       {
 	std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
-	    = get_regk_req< Skeleton >(it->first, rman, *this);
+	    = get_regk_req< Skeleton >(it->first, rman, *this, it->second->anchored_prefix());
 	filter_id_list(new_ids, filtered,
 	    tags_db.range_begin(range_req.begin(), range_req.end()), tags_db.range_end(),
 	    *it->first, *it->second, check_keys_late);
@@ -412,7 +413,8 @@ std::vector< Id_Type > Query_Statement::collect_ids
     for (std::vector< std::pair< std::string, Regular_Expression* > >::const_iterator krit = key_regexes.begin();
 	 krit != key_regexes.end(); ++krit)
     {
-      std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req = get_k_req(krit->first);
+      std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
+          = get_k_req(krit->first, krit->second->anchored_prefix());
       filter_id_list(new_ids, filtered,
 	  tags_db.range_begin(range_req.begin(), range_req.end()), tags_db.range_end(),
 	      Trivial_Regex(), *krit->second);
@@ -424,8 +426,14 @@ std::vector< Id_Type > Query_Statement::collect_ids
     for (std::vector< std::pair< Regular_Expression*, Regular_Expression* > >::const_iterator it = regkey_regexes.begin();
 	 it != regkey_regexes.end(); ++it)
     {
-      filter_id_list(new_ids, filtered,
-	  tags_db.flat_begin(), tags_db.flat_end(), *it->first, *it->second);
+      std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req = get_regk_prefix_req(*it->first);
+      if (range_req.empty())
+        filter_id_list(new_ids, filtered,
+	    tags_db.flat_begin(), tags_db.flat_end(), *it->first, *it->second);
+      else
+        filter_id_list(new_ids, filtered,
+	    tags_db.range_begin(range_req.begin(), range_req.end()), tags_db.range_end(),
+	    *it->first, *it->second);
 
       rman.health_check(*this);
     }
@@ -482,7 +490,8 @@ std::vector< std::pair< Id_Type, Uint31_Index > > Query_Statement::collect_non_i
   {
     if (timestamp == NOW)
     {
-      std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req = get_k_req(knrit->first);
+      std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
+          = get_k_req(knrit->first, knrit->second->anchored_prefix());
       for (typename Block_Backend< Tag_Index_Global, Tag_Object_Global< Id_Type > >::Range_Iterator
           it2(tags_db.range_begin
           (Default_Range_Iterator< Tag_Index_Global >(range_req.begin()),
@@ -546,7 +555,8 @@ std::vector< Id_Type > Query_Statement::collect_non_ids
   for (std::vector< std::pair< std::string, Regular_Expression* > >::const_iterator knrit = key_nregexes.begin();
       knrit != key_nregexes.end(); ++knrit)
   {
-    std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req = get_k_req(knrit->first);
+    std::set< std::pair< Tag_Index_Global, Tag_Index_Global > > range_req
+        = get_k_req(knrit->first, knrit->second->anchored_prefix());
     for (typename Block_Backend< Tag_Index_Global, Id_Type >::Range_Iterator
         it2(tags_db.range_begin
         (Default_Range_Iterator< Tag_Index_Global >(range_req.begin()),
@@ -211,11 +211,12 @@ void collect_relations
 {
   std::vector< Relation_Entry::Ref_Type > ids = extract_children_ids< TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, ids);
+  std::set< Uint31_Index > req = parents.found() ? parents.idxs() : extract_parent_indices(sources);
   rman.health_check(stmt);
 
   collect_items_discrete(&stmt, rman, *osm_base_settings().RELATIONS, req,
-			 Get_Parent_Rels_Predicate(ids, source_type), result);
+			 Get_Parent_Rels_Predicate(ids, source_type, parents.ids()), result);
 }
 
 
@@ -227,11 +228,12 @@ void collect_relations
 {
   std::vector< Relation_Entry::Ref_Type > ids = extract_children_ids< TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, ids);
+  std::set< Uint31_Index > req = parents.found() ? parents.idxs() : extract_parent_indices(sources);
   rman.health_check(stmt);
 
   collect_items_discrete(&stmt, rman, *osm_base_settings().RELATIONS, req,
-                         Get_Parent_Rels_Role_Predicate(ids, source_type, role_id), result);
+                         Get_Parent_Rels_Role_Predicate(ids, source_type, role_id, parents.ids()), result);
 }
 
 
@@ -244,7 +246,8 @@ void collect_relations
 {
   std::vector< Relation_Entry::Ref_Type > children_ids = extract_children_ids< TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, children_ids);
+  std::set< Uint31_Index > req = parents.found() ? parents.idxs() : extract_parent_indices(sources);
   rman.health_check(stmt);
 
   if (!invert_ids)
@@ -252,7 +255,7 @@ void collect_relations
         And_Predicate< Relation_Skeleton,
 	    Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Predicate >
 	    (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Predicate(children_ids, source_type)), result);
+            Get_Parent_Rels_Predicate(children_ids, source_type, parents.ids())), result);
   else
     collect_items_discrete(&stmt, rman, *osm_base_settings().RELATIONS, req,
         And_Predicate< Relation_Skeleton,
@@ -260,7 +263,7 @@ void collect_relations
 	    Get_Parent_Rels_Predicate >
 	    (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
 	      (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Predicate(children_ids, source_type)), result);
+            Get_Parent_Rels_Predicate(children_ids, source_type, parents.ids())), result);
 }
 
 
@@ -273,7 +276,8 @@ void collect_relations
 {
   std::vector< Relation_Entry::Ref_Type > children_ids = extract_children_ids< TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, children_ids);
+  std::set< Uint31_Index > req = parents.found() ? parents.idxs() : extract_parent_indices(sources);
   rman.health_check(stmt);
 
   if (!invert_ids)
@@ -281,7 +285,7 @@ void collect_relations
         And_Predicate< Relation_Skeleton,
             Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Role_Predicate >
             (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id)), result);
+            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id, parents.ids())), result);
   else
     collect_items_discrete(&stmt, rman, *osm_base_settings().RELATIONS, req,
         And_Predicate< Relation_Skeleton,
@@ -289,7 +293,7 @@ void collect_relations
             Get_Parent_Rels_Role_Predicate >
             (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
               (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id)), result);
+            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id, parents.ids())), result);
 }
 
 
@@ -305,23 +309,25 @@ void collect_relations
   std::vector< Relation_Entry::Ref_Type > current_ids = extract_children_ids
       < TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
-  rman.health_check(stmt);
-
   std::vector< Relation_Entry::Ref_Type > attic_ids = extract_children_ids
       < TSourceIndex, Attic< TSourceObject >, Relation_Entry::Ref_Type >(attic_sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
-  rman.health_check(stmt);
 
   std::vector< Uint64 > ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(ids));
-  for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
-    req.insert(*it);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, ids);
+  std::set< Uint31_Index > req = parents.idxs();
+  if (!parents.found())
+  {
+    req = extract_parent_indices(sources);
+    std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
+    req.insert(attic_req.begin(), attic_req.end());
+  }
+  rman.health_check(stmt);
 
   collect_items_discrete_by_timestamp(&stmt, rman, req,
-      Get_Parent_Rels_Predicate(ids, source_type), result, attic_result);
+      Get_Parent_Rels_Predicate(ids, source_type, parents.ids()), result, attic_result);
 }
 
 
@@ -338,23 +344,25 @@ void collect_relations
   std::vector< Relation_Entry::Ref_Type > current_ids = extract_children_ids
       < TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
-  rman.health_check(stmt);
-
   std::vector< Relation_Entry::Ref_Type > attic_ids = extract_children_ids
       < TSourceIndex, Attic< TSourceObject >, Relation_Entry::Ref_Type >(attic_sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
-  rman.health_check(stmt);
 
   std::vector< Uint64 > ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(ids));
-  for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
-    req.insert(*it);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, ids);
+  std::set< Uint31_Index > req = parents.idxs();
+  if (!parents.found())
+  {
+    req = extract_parent_indices(sources);
+    std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
+    req.insert(attic_req.begin(), attic_req.end());
+  }
+  rman.health_check(stmt);
 
   collect_items_discrete_by_timestamp(&stmt, rman, req,
-      Get_Parent_Rels_Role_Predicate(ids, source_type, role_id), result, attic_result);
+      Get_Parent_Rels_Role_Predicate(ids, source_type, role_id, parents.ids()), result, attic_result);
 }
 
 
@@ -371,27 +379,29 @@ void collect_relations
   std::vector< Relation_Entry::Ref_Type > current_ids = extract_children_ids
       < TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
-  rman.health_check(stmt);
-
   std::vector< Relation_Entry::Ref_Type > attic_ids = extract_children_ids
       < TSourceIndex, Attic< TSourceObject >, Relation_Entry::Ref_Type >(attic_sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
-  rman.health_check(stmt);
 
   std::vector< Uint64 > children_ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(children_ids));
-  for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
-    req.insert(*it);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, children_ids);
+  std::set< Uint31_Index > req = parents.idxs();
+  if (!parents.found())
+  {
+    req = extract_parent_indices(sources);
+    std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
+    req.insert(attic_req.begin(), attic_req.end());
+  }
+  rman.health_check(stmt);
 
   if (!invert_ids)
     collect_items_discrete_by_timestamp(&stmt, rman, req,
         And_Predicate< Relation_Skeleton,
             Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Predicate >
             (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Predicate(children_ids, source_type)), result, attic_result);
+            Get_Parent_Rels_Predicate(children_ids, source_type, parents.ids())), result, attic_result);
   else
     collect_items_discrete_by_timestamp(&stmt, rman, req,
         And_Predicate< Relation_Skeleton,
@@ -399,7 +409,7 @@ void collect_relations
             Get_Parent_Rels_Predicate >
             (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
               (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Predicate(children_ids, source_type)), result, attic_result);
+            Get_Parent_Rels_Predicate(children_ids, source_type, parents.ids())), result, attic_result);
 }
 
 
@@ -416,27 +426,30 @@ void collect_relations
   std::vector< Relation_Entry::Ref_Type > current_ids = extract_children_ids
       < TSourceIndex, TSourceObject, Relation_Entry::Ref_Type >(sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > req = extract_parent_indices(sources);
-  rman.health_check(stmt);
-
   std::vector< Relation_Entry::Ref_Type > attic_ids = extract_children_ids
       < TSourceIndex, Attic< TSourceObject >, Relation_Entry::Ref_Type >(attic_sources);
   rman.health_check(stmt);
-  std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
-  rman.health_check(stmt);
 
   std::vector< Uint64 > children_ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(children_ids));
-  for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
-    req.insert(*it);
+  Parent_Candidates parents(rman, source_type, Relation_Entry::RELATION, children_ids);
+  std::set< Uint31_Index > req = parents.idxs();
+  if (!parents.found())
+  {
+    req = extract_parent_indices(sources);
+    std::set< Uint31_Index > attic_req = extract_parent_indices(attic_sources);
+    req.insert(attic_req.begin(), attic_req.end());
+  }
+  rman.health_check(stmt);
 
   if (!invert_ids)
     collect_items_discrete_by_timestamp(&stmt, rman, req,
         And_Predicate< Relation_Skeleton,
             Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Role_Predicate >
             (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id)), result, attic_result);
+            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id, parents.ids())),
+        result, attic_result);
   else
     collect_items_discrete_by_timestamp(&stmt, rman, req,
         And_Predicate< Relation_Skeleton,
@@ -444,7 +457,34 @@ void collect_relations
             Get_Parent_Rels_Role_Predicate >
             (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
               (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id)), result, attic_result);
+            Get_Parent_Rels_Role_Predicate(children_ids, source_type, role_id, parents.ids())),
+        result, attic_result);
+}
+
+
+// Without reverse references, any relation may be a parent of a relation
+template< class Predicate >
+void collect_parent_relations
+    (const Statement& stmt, Resource_Manager& rman, const Parent_Candidates& parents, const Predicate& predicate,
+     std::map< Uint31_Index, std::vector< Relation_Skeleton > >& result)
+{
+  if (parents.found())
+    collect_items_discrete(&stmt, rman, *osm_base_settings().RELATIONS, parents.idxs(), predicate, result);
+  else
+    collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS, predicate, result);
+}
+
+
+template< class Predicate >
+void collect_parent_relations
+    (const Statement& stmt, Resource_Manager& rman, const Parent_Candidates& parents, const Predicate& predicate,
+     std::map< Uint31_Index, std::vector< Relation_Skeleton > >& result,
+     std::map< Uint31_Index, std::vector< Attic< Relation_Skeleton > > >& attic_result)
+{
+  if (parents.found())
+    collect_items_discrete_by_timestamp(&stmt, rman, parents.idxs(), predicate, result, attic_result);
+  else
+    collect_items_flat_by_timestamp(stmt, rman, predicate, result, attic_result);
 }
 
 
@@ -455,9 +495,10 @@ void collect_relations
 {
   std::vector< Uint64 > ids = extract_children_ids< Uint31_Index, Relation_Skeleton, Uint64 >(sources);
   rman.health_check(stmt);
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, ids);
 
-  collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
-      Get_Parent_Rels_Predicate(ids, Relation_Entry::RELATION), result);
+  collect_parent_relations(stmt, rman, parents,
+      Get_Parent_Rels_Predicate(ids, Relation_Entry::RELATION, parents.ids()), result);
 }
 
 
@@ -468,9 +509,10 @@ void collect_relations
 {
   std::vector< Uint64 > ids = extract_children_ids< Uint31_Index, Relation_Skeleton, Uint64 >(sources);
   rman.health_check(stmt);
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, ids);
 
-  collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
-      Get_Parent_Rels_Role_Predicate(ids, Relation_Entry::RELATION, role_id), result);
+  collect_parent_relations(stmt, rman, parents,
+      Get_Parent_Rels_Role_Predicate(ids, Relation_Entry::RELATION, role_id, parents.ids()), result);
 }
 
 
@@ -482,22 +524,23 @@ void collect_relations
 {
   std::vector< Uint64 > children_ids = extract_children_ids< Uint31_Index, Relation_Skeleton, Uint64 >(sources);
   rman.health_check(stmt);
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, children_ids);
 
   if (!invert_ids)
-    collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
 	    Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Predicate >
 	    (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION)),
+            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION, parents.ids())),
         result);
   else
-    collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
 	    Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >,
 	    Get_Parent_Rels_Predicate >
 	    (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
 	      (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION)),
+            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION, parents.ids())),
         result);
 }
 
@@ -510,22 +553,23 @@ void collect_relations
 {
   std::vector< Uint64 > children_ids = extract_children_ids< Uint31_Index, Relation_Skeleton, Uint64 >(sources);
   rman.health_check(stmt);
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, children_ids);
 
   if (!invert_ids)
-    collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
             Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Role_Predicate >
             (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id)),
+            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id, parents.ids())),
         result);
   else
-    collect_items_flat(stmt, rman, *osm_base_settings().RELATIONS,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
             Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >,
             Get_Parent_Rels_Role_Predicate >
             (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
               (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id)),
+            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id, parents.ids())),
         result);
 }
 
@@ -548,9 +592,10 @@ void collect_relations
   std::vector< Uint64 > ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(ids));
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, ids);
 
-  collect_items_flat_by_timestamp(stmt, rman,
-      Get_Parent_Rels_Predicate(ids, Relation_Entry::RELATION), result, attic_result);
+  collect_parent_relations(stmt, rman, parents,
+      Get_Parent_Rels_Predicate(ids, Relation_Entry::RELATION, parents.ids()), result, attic_result);
 }
 
 
@@ -572,9 +617,10 @@ void collect_relations
   std::vector< Uint64 > ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(ids));
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, ids);
 
-  collect_items_flat_by_timestamp(stmt, rman,
-      Get_Parent_Rels_Role_Predicate(ids, Relation_Entry::RELATION, role_id), result, attic_result);
+  collect_parent_relations(stmt, rman, parents,
+      Get_Parent_Rels_Role_Predicate(ids, Relation_Entry::RELATION, role_id, parents.ids()), result, attic_result);
 }
 
 
@@ -597,22 +643,23 @@ void collect_relations
   std::vector< Uint64 > children_ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(children_ids));
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, children_ids);
 
   if (!invert_ids)
-    collect_items_flat_by_timestamp(stmt, rman,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
             Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Predicate >
             (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION)),
+            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION, parents.ids())),
         result, attic_result);
   else
-    collect_items_flat_by_timestamp(stmt, rman,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
             Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >,
             Get_Parent_Rels_Predicate >
             (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
               (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION)),
+            Get_Parent_Rels_Predicate(children_ids, Relation_Entry::RELATION, parents.ids())),
         result, attic_result);
 }
 
@@ -636,22 +683,23 @@ void collect_relations
   std::vector< Uint64 > children_ids;
   std::set_union(current_ids.begin(), current_ids.end(), attic_ids.begin(), attic_ids.end(),
                  std::back_inserter(children_ids));
+  Parent_Candidates parents(rman, Relation_Entry::RELATION, Relation_Entry::RELATION, children_ids);
 
   if (!invert_ids)
-    collect_items_flat_by_timestamp(stmt, rman,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
             Id_Predicate< Relation_Skeleton >, Get_Parent_Rels_Role_Predicate >
             (Id_Predicate< Relation_Skeleton >(ids),
-            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id)),
+            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id, parents.ids())),
         result, attic_result);
   else
-    collect_items_flat_by_timestamp(stmt, rman,
+    collect_parent_relations(stmt, rman, parents,
         And_Predicate< Relation_Skeleton,
             Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >,
             Get_Parent_Rels_Role_Predicate >
             (Not_Predicate< Relation_Skeleton, Id_Predicate< Relation_Skeleton > >
               (Id_Predicate< Relation_Skeleton >(ids)),
-            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id)),
+            Get_Parent_Rels_Role_Predicate(children_ids, Relation_Entry::RELATION, role_id, parents.ids())),
         result, attic_result);
 }
 
@@ -1091,6 +1139,16 @@ bool Recurse_Constraint::get_ranges(Resource_Manager& rman, std::set< std::pair<
 }
 
 
+// The indexes of the possible parents, narrowed down to the parents themselves if the database has reverse references
+template< class TIndex, class TObject >
+std::set< Uint31_Index > candidate_parent_indices(Resource_Manager& rman,
+    const std::map< TIndex, std::vector< TObject > >& children, uint32 child_type, uint32 parent_type)
+{
+  Parent_Candidates parents(rman, child_type, parent_type, extract_children_ids< TIndex, TObject, Uint64 >(children));
+  return parents.found() ? parents.idxs() : extract_parent_indices(children);
+}
+
+
 bool Recurse_Constraint::get_way_ranges(Resource_Manager& rman, std::set< std::pair< Uint31_Index, Uint31_Index > >& ranges)
 {
   ranges.clear();
@@ -1117,7 +1175,7 @@ bool Recurse_Constraint::get_way_ranges(Resource_Manager& rman, std::set< std::p
       return false;
     else if (stmt->get_type() == RECURSE_NODE_WAY)
     {
-      std::set< Uint31_Index > req = extract_parent_indices(input->nodes);
+      std::set< Uint31_Index > req = candidate_parent_indices(rman, input->nodes, Relation_Entry::NODE, Relation_Entry::WAY);
       for (std::set< Uint31_Index >::const_iterator it = req.begin(); it != req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
 
@@ -1149,10 +1207,10 @@ bool Recurse_Constraint::get_way_ranges(Resource_Manager& rman, std::set< std::p
       return false;
     else if (stmt->get_type() == RECURSE_NODE_WAY)
     {
-      std::set< Uint31_Index > req = extract_parent_indices(input->nodes);
+      std::set< Uint31_Index > req = candidate_parent_indices(rman, input->nodes, Relation_Entry::NODE, Relation_Entry::WAY);
       for (std::set< Uint31_Index >::const_iterator it = req.begin(); it != req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
-      std::set< Uint31_Index > attic_req = extract_parent_indices(input->attic_nodes);
+      std::set< Uint31_Index > attic_req = candidate_parent_indices(rman, input->attic_nodes, Relation_Entry::NODE, Relation_Entry::WAY);
       for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
 
@@ -1189,7 +1247,7 @@ bool Recurse_Constraint::get_relation_ranges(Resource_Manager& rman, std::set< s
       return false;
     else if (stmt->get_type() == RECURSE_NODE_RELATION)
     {
-      std::set< Uint31_Index > req = extract_parent_indices(input->nodes);
+      std::set< Uint31_Index > req = candidate_parent_indices(rman, input->nodes, Relation_Entry::NODE, Relation_Entry::RELATION);
       for (std::set< Uint31_Index >::const_iterator it = req.begin(); it != req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
 
@@ -1197,7 +1255,7 @@ bool Recurse_Constraint::get_relation_ranges(Resource_Manager& rman, std::set< s
     }
     else if (stmt->get_type() == RECURSE_WAY_RELATION)
     {
-      std::set< Uint31_Index > req = extract_parent_indices(input->ways);
+      std::set< Uint31_Index > req = candidate_parent_indices(rman, input->ways, Relation_Entry::WAY, Relation_Entry::RELATION);
       for (std::set< Uint31_Index >::const_iterator it = req.begin(); it != req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
 
@@ -1223,10 +1281,10 @@ bool Recurse_Constraint::get_relation_ranges(Resource_Manager& rman, std::set< s
       return false;
     else if (stmt->get_type() == RECURSE_NODE_RELATION)
     {
-      std::set< Uint31_Index > req = extract_parent_indices(input->nodes);
+      std::set< Uint31_Index > req = candidate_parent_indices(rman, input->nodes, Relation_Entry::NODE, Relation_Entry::RELATION);
       for (std::set< Uint31_Index >::const_iterator it = req.begin(); it != req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
-      std::set< Uint31_Index > attic_req = extract_parent_indices(input->attic_nodes);
+      std::set< Uint31_Index > attic_req = candidate_parent_indices(rman, input->attic_nodes, Relation_Entry::NODE, Relation_Entry::RELATION);
       for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
 
@@ -1234,10 +1292,10 @@ bool Recurse_Constraint::get_relation_ranges(Resource_Manager& rman, std::set< s
     }
     else if (stmt->get_type() == RECURSE_WAY_RELATION)
     {
-      std::set< Uint31_Index > req = extract_parent_indices(input->ways);
+      std::set< Uint31_Index > req = candidate_parent_indices(rman, input->ways, Relation_Entry::WAY, Relation_Entry::RELATION);
       for (std::set< Uint31_Index >::const_iterator it = req.begin(); it != req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
-      std::set< Uint31_Index > attic_req = extract_parent_indices(input->attic_ways);
+      std::set< Uint31_Index > attic_req = candidate_parent_indices(rman, input->attic_ways, Relation_Entry::WAY, Relation_Entry::RELATION);
       for (std::set< Uint31_Index >::const_iterator it = attic_req.begin(); it != attic_req.end(); ++it)
         ranges.insert(std::make_pair(*it, inc(*it)));
 
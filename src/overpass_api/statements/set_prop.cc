@@ -330,7 +330,7 @@ void Set_Prop_Plain_Task::process(Derived_Structure& result, bool& id_set) const
     if (!id_set)
     {
       int64 id = 0;
-      id_set |= try_int64(rhs->eval(0), id);
+      id_set |= rhs->eval_value(0).try_int64(id);
       if (id_set)
         result.id = Uint64(id);
     }
@@ -371,7 +371,7 @@ void process(const std::string& key, Set_Prop_Task::Mode mode, Eval_Task* rhs,
     if (!id_set)
     {
       int64 id = 0;
-      id_set |= try_int64(rhs->eval(data, 0), id);
+      id_set |= rhs->eval_value(data, 0).try_int64(id);
       if (id_set)
         result.id = Uint64(id);
     }
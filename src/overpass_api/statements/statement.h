@@ -184,6 +184,11 @@ class Statement
     // object.
     virtual Query_Constraint* get_query_constraint() { return 0; }
 
+    // Executes the statement such that its result is delivered in pieces in ascending order of indexes.
+    // After each piece has been put into the result set, consumer is executed.
+    // Returns false without doing anything if the statement cannot deliver its result that way.
+    virtual bool execute_streamed(Resource_Manager& rman, Statement& consumer) { return false; }
+
     virtual ~Statement() {}
 
     int get_progress() const { return progress; }
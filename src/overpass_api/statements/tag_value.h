@@ -127,6 +127,23 @@ struct Id_Eval_Task : public Eval_Task
       { return data.object ? to_string(data.object->id.val()) : ""; }
   virtual std::string eval(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
       { return data.object ? to_string(data.object->id.val()) : ""; }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return data.object ? Eval_Value::from_int(data.object->id.val()) : Eval_Value(); }
 };
 
 
@@ -568,6 +585,23 @@ struct Version_Eval_Task : public Eval_Task
       { return data.meta ? to_string(data.meta->version) : ""; }
   virtual std::string eval(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
       { return data.meta ? to_string(data.meta->version) : ""; }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->version) : Eval_Value(); }
 };
 
 
@@ -680,6 +714,23 @@ struct Changeset_Eval_Task : public Eval_Task
       { return data.meta ? to_string(data.meta->changeset) : ""; }
   virtual std::string eval(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
       { return data.meta ? to_string(data.meta->changeset) : ""; }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->changeset) : Eval_Value(); }
 };
 
 
@@ -736,6 +787,23 @@ struct Uid_Eval_Task : public Eval_Task
       { return data.meta ? to_string(data.meta->user_id) : ""; }
   virtual std::string eval(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
       { return data.meta ? to_string(data.meta->user_id) : ""; }
+
+  virtual Eval_Value eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
+  virtual Eval_Value eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+      { return data.meta ? Eval_Value::from_int(data.meta->user_id) : Eval_Value(); }
 };
 
 
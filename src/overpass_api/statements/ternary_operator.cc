@@ -103,6 +103,15 @@ Eval_Task* Ternary_Evaluator::get_string_task(Prepare_Task_Context& context, con
   Eval_Task* cond_task = condition ? condition->get_string_task(context, key) : 0;
   Eval_Task* lhs_task = lhs ? lhs->get_string_task(context, key) : 0;
   Eval_Task* rhs_task = rhs ? rhs->get_string_task(context, key) : 0;
+  if (cond_task && cond_task->const_value())
+  {
+    // Only the chosen branch can ever be evaluated
+    bool cond = cond_task->const_value()->represents_boolean_true();
+    delete cond_task;
+    delete (cond ? rhs_task : lhs_task);
+    Eval_Task* chosen = (cond ? lhs_task : rhs_task);
+    return chosen ? chosen : new Const_Eval_Task(Eval_Value());
+  }
   return new Ternary_Eval_Task(cond_task, lhs_task, rhs_task);
 }
 
@@ -111,7 +120,7 @@ std::string Ternary_Eval_Task::eval(const std::string* key) const
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(key)))
+  if (condition->eval_value(key).represents_boolean_true())
     return lhs ? lhs->eval(key) : "";
   return rhs ? rhs->eval(key) : "";
 }
@@ -121,7 +130,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Node_Skeleton >&
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -131,7 +140,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Attic< Node_Skel
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -141,7 +150,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Way_Skeleton >&
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -151,7 +160,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Attic< Way_Skele
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -161,7 +170,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Relation_Skeleto
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -171,7 +180,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Attic< Relation_
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -181,7 +190,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Area_Skeleton >&
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -191,7 +200,7 @@ std::string Ternary_Eval_Task::eval(const Element_With_Context< Derived_Skeleton
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(data, key)))
+  if (condition->eval_value(data, key).represents_boolean_true())
     return lhs ? lhs->eval(data, key) : "";
   return rhs ? rhs->eval(data, key) : "";
 }
@@ -201,7 +210,7 @@ std::string Ternary_Eval_Task::eval(uint pos, const Element_With_Context< Way_Sk
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(pos, data, key)))
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
     return lhs ? lhs->eval(pos, data, key) : "";
   return rhs ? rhs->eval(pos, data, key) : "";
 }
@@ -211,7 +220,7 @@ std::string Ternary_Eval_Task::eval(uint pos, const Element_With_Context< Attic<
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(pos, data, key)))
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
     return lhs ? lhs->eval(pos, data, key) : "";
   return rhs ? rhs->eval(pos, data, key) : "";
 }
@@ -221,7 +230,7 @@ std::string Ternary_Eval_Task::eval(uint pos, const Element_With_Context< Relati
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(pos, data, key)))
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
     return lhs ? lhs->eval(pos, data, key) : "";
   return rhs ? rhs->eval(pos, data, key) : "";
 }
@@ -231,12 +240,146 @@ std::string Ternary_Eval_Task::eval(uint pos, const Element_With_Context< Attic<
 {
   if (!condition)
     return "0";
-  if (string_represents_boolean_true(condition->eval(pos, data, key)))
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
     return lhs ? lhs->eval(pos, data, key) : "";
   return rhs ? rhs->eval(pos, data, key) : "";
 }
 
 
+Eval_Value Ternary_Eval_Task::eval_value(const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(key).represents_boolean_true())
+    return lhs ? lhs->eval_value(key) : Eval_Value();
+  return rhs ? rhs->eval_value(key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(pos, data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(pos, data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(pos, data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(pos, data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(pos, data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(pos, data, key) : Eval_Value();
+}
+
+
+Eval_Value Ternary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+{
+  if (!condition)
+    return Eval_Value::from_int(0);
+  if (condition->eval_value(pos, data, key).represents_boolean_true())
+    return lhs ? lhs->eval_value(pos, data, key) : Eval_Value();
+  return rhs ? rhs->eval_value(pos, data, key) : Eval_Value();
+}
+
+
 Eval_Geometry_Task* Ternary_Evaluator::get_geometry_task(Prepare_Task_Context& context)
 {
   Eval_Task* cond_task = condition ? condition->get_string_task(context, 0) : 0;
@@ -250,7 +393,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval() const
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(0)))
+  if (condition->eval_value(0).represents_boolean_true())
     return lhs ? lhs->eval() : 0;
   return rhs ? rhs->eval() : 0;
 }
@@ -260,7 +403,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< No
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -270,7 +413,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< At
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -280,7 +423,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< Wa
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -290,7 +433,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< At
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -300,7 +443,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< Re
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -310,7 +453,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< At
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -320,7 +463,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< Ar
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
@@ -330,7 +473,7 @@ Opaque_Geometry* Ternary_Eval_Geometry_Task::eval(const Element_With_Context< De
 {
   if (!condition)
     return 0;
-  if (string_represents_boolean_true(condition->eval(data, 0)))
+  if (condition->eval_value(data, 0).represents_boolean_true())
     return lhs ? lhs->eval(data) : 0;
   return rhs ? rhs->eval(data) : 0;
 }
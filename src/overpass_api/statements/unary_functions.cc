@@ -37,6 +37,12 @@ void Evaluator_Unary_Function::add_statement(Statement* statement, std::string t
 Eval_Task* Evaluator_Unary_Function::get_string_task(Prepare_Task_Context& context, const std::string* key)
 {
   Eval_Task* rhs_task = rhs ? rhs->get_string_task(context, key) : 0;
+  if (rhs_task && rhs_task->const_value())
+  {
+    Eval_Task* result = new Const_Eval_Task(process_value(*rhs_task->const_value()));
+    delete rhs_task;
+    return result;
+  }
   return new Unary_Eval_Task(rhs_task, this);
 }
 
@@ -51,79 +57,161 @@ Requested_Context Evaluator_Unary_Function::request_context() const
 
 std::string Unary_Eval_Task::eval(const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(key) : "");
+  return eval_value(key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(data, key) : "");
+  return eval_value(data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(uint pos, const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(pos, data, key) : "");
+  return eval_value(pos, data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(uint pos, const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(pos, data, key) : "");
+  return eval_value(pos, data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(pos, data, key) : "");
+  return eval_value(pos, data, key).str();
 }
 
 
 std::string Unary_Eval_Task::eval(uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
 {
-  return evaluator->process(rhs ? rhs->eval(pos, data, key) : "");
+  return eval_value(pos, data, key).str();
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Node_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Attic< Node_Skeleton > >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Area_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(const Element_With_Context< Derived_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Way_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(pos, data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Attic< Way_Skeleton > >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(pos, data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Relation_Skeleton >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(pos, data, key) : Eval_Value());
+}
+
+
+Eval_Value Unary_Eval_Task::eval_value(
+    uint pos, const Element_With_Context< Attic< Relation_Skeleton > >& data, const std::string* key) const
+{
+  return evaluator->process_value(rhs ? rhs->eval_value(pos, data, key) : Eval_Value());
 }
 
 
@@ -240,6 +328,14 @@ Eval_Task* Evaluator_Binary_Function::get_string_task(Prepare_Task_Context& cont
 {
   Eval_Task* first_task = first ? first->get_string_task(context, key) : 0;
   Eval_Task* second_task = second ? second->get_string_task(context, key) : 0;
+  if (first_task && first_task->const_value() && second_task && second_task->const_value())
+  {
+    Eval_Task* result = new Const_Eval_Task(
+        process(first_task->const_value()->str(), second_task->const_value()->str()));
+    delete first_task;
+    delete second_task;
+    return result;
+  }
   return new Binary_Func_Eval_Task(first_task, second_task, this);
 }
 
@@ -49,9 +49,9 @@ Operator_Stmt_Maker< Evaluator_Not > Evaluator_Not::statement_maker;
 Operator_Eval_Maker< Evaluator_Not > Evaluator_Not::evaluator_maker;
 
 
-std::string Evaluator_Not::process(const std::string& rhs_s) const
+Eval_Value Evaluator_Not::process_value(const Eval_Value& rhs) const
 {
-  return string_represents_boolean_true(rhs_s) ? "0" : "1";
+  return Eval_Value::from_bool(!rhs.represents_boolean_true());
 }
 
 
@@ -62,15 +62,15 @@ Operator_Stmt_Maker< Evaluator_Negate > Evaluator_Negate::statement_maker;
 Operator_Eval_Maker< Evaluator_Negate > Evaluator_Negate::evaluator_maker;
 
 
-std::string Evaluator_Negate::process(const std::string& rhs_s) const
+Eval_Value Evaluator_Negate::process_value(const Eval_Value& rhs) const
 {
   int64 rhs_l = 0;
-  if (try_int64(rhs_s, rhs_l))
-    return to_string(-rhs_l);
+  if (rhs.try_int64(rhs_l))
+    return Eval_Value::from_int(-rhs_l);
 
   double rhs_d = 0;
-  if (try_double(rhs_s, rhs_d))
-    return to_string(-rhs_d);
+  if (rhs.try_double(rhs_d))
+    return Eval_Value::from_double(-rhs_d);
 
-  return "NaN";
+  return Eval_Value("NaN");
 }
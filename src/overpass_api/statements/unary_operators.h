@@ -65,6 +65,10 @@ class Evaluator_Prefix_Operator : public Evaluator_Unary_Function
 public:
   Evaluator_Prefix_Operator(int line_number_);
 
+  virtual std::string process(const std::string& rhs_result) const
+  { return process_value(Eval_Value(rhs_result)).str(); }
+  virtual Eval_Value process_value(const Eval_Value& rhs_result) const = 0;
+
   static bool applicable_by_subtree_structure(const Token_Node_Ptr& tree_it) { return !tree_it->lhs && tree_it->rhs; }
   static void add_substatements(Statement* result, const std::string& operator_name, const Token_Node_Ptr& tree_it,
       Statement::QL_Context tree_context, Statement::Factory& stmt_factory, Error_Output* error_output);
@@ -127,7 +131,7 @@ public:
   Evaluator_Not(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Prefix_Operator_Syntax< Evaluator_Not >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& rhs_result) const;
+  virtual Eval_Value process_value(const Eval_Value& rhs_result) const;
 };
 
 
@@ -155,7 +159,7 @@ public:
   Evaluator_Negate(int line_number_, const std::map< std::string, std::string >& input_attributes, Parsed_Query& global_settings)
       : Evaluator_Prefix_Operator_Syntax< Evaluator_Negate >(line_number_, input_attributes) {}
 
-  virtual std::string process(const std::string& rhs_result) const;
+  virtual Eval_Value process_value(const Eval_Value& rhs_result) const;
 };
 
 
@@ -93,6 +93,11 @@ struct Block_Backend_Basic_Iterator
   {
     return idx_cache.object();
   }
+  // Gives access to the stored index without decoding it
+  const Idx_Handle< Index >& index_handle()
+  {
+    return idx_cache;
+  }
   const Object& object()
   {
     return obj_cache.object();
@@ -302,7 +307,7 @@ struct Flat_File_Handle
   {
     if (file_it == file_end)
       return false;
-    file_blocks->read_block(file_it, ptr, check_idx);
+    file_blocks->read_block_ahead(file_it, file_end, ptr, check_idx);
     ++file_it;
     return true;
   }
@@ -445,7 +450,7 @@ struct Range_File_Handle
   {
     if (file_it == file_end)
       return false;
-    file_blocks->read_block(file_it, ptr, check_idx);
+    file_blocks->read_block_ahead(file_it, file_end, ptr, check_idx);
     ++file_it;
     return true;
   }
@@ -672,6 +677,7 @@ void Block_Backend< TIndex, TObject, TIterator >::update
     else //if (file_it.block_type() == File_Block_Index_Entry< TIndex >::SEGMENT)
       update_segments(file_it, to_delete, to_insert, update_logger);
   }
+  file_blocks.flush();
 }
 
 template< class TIndex, class TObject, class TIterator >
@@ -1047,12 +1053,13 @@ void Block_Backend< TIndex, TObject, TIterator >::update_group
       while (pos < it->second.source_end)
       {
 	TObject obj(pos);
+	// Kept objects are copied verbatim, hence in the format they have been stored with
 	if ((it->second.delete_it == to_delete.end()) ||
 	  (it->second.delete_it->second.find(obj) == it->second.delete_it->second.end()))
-	  current_size += obj.size_of();
+	  current_size += TObject::size_of(pos);
 	else
 	  update_logger.deletion(it->first, obj);
-	pos = pos + obj.size_of();
+	pos = pos + TObject::size_of(pos);
       }
       if (current_size > 0)
 	current_size += TIndex::size_of((it->second.source_begin) + 4) + 4;
@@ -1115,13 +1122,14 @@ void Block_Backend< TIndex, TObject, TIterator >::update_group
 	while (spos < it->second.source_end)
 	{
 	  TObject obj(spos);
+	  uint32 obj_size = TObject::size_of(spos);
 	  if ((it->second.delete_it == to_delete.end()) ||
 	    (it->second.delete_it->second.find(obj) == it->second.delete_it->second.end()))
 	  {
-	    memcpy(pos, spos, obj.size_of());
-	    pos = pos + obj.size_of();
+	    memcpy(pos, spos, obj_size);
+	    pos = pos + obj_size;
 	  }
-	  spos = spos + obj.size_of();
+	  spos = spos + obj_size;
 	}
       }
 
@@ -1152,13 +1160,14 @@ void Block_Backend< TIndex, TObject, TIterator >::update_group
 	while (spos < it->second.source_end)
 	{
 	  TObject obj(spos);
+	  uint32 obj_size = TObject::size_of(spos);
 	  if ((it->second.delete_it == to_delete.end()) ||
 	    (it->second.delete_it->second.find(obj) == it->second.delete_it->second.end()))
 	  {
-	    memcpy(pos, spos, obj.size_of());
-	    pos = pos + obj.size_of();
+	    memcpy(pos, spos, obj_size);
+	    pos = pos + obj_size;
 	  }
-	  spos = spos + obj.size_of();
+	  spos = spos + obj_size;
 	}
       }
 
@@ -1241,17 +1250,18 @@ void Block_Backend< TIndex, TObject, TIterator >::copy_and_delete_on_the_fly(
   while ((uint32)(spos - (uint8*)source_start_ptr) < *(uint32*)source_start_ptr)
   {
     TObject obj(spos);
+    uint32 obj_size = TObject::size_of(spos);
     if (delete_it->second.find(obj) == delete_it->second.end())
     {
-      memcpy(insert_ptr, spos, obj.size_of());
-      insert_ptr = insert_ptr + obj.size_of();
+      memcpy(insert_ptr, spos, obj_size);
+      insert_ptr = insert_ptr + obj_size;
     }
     else
     {
       block_modified = true;
       update_logger.deletion(delete_it->first, obj);
     }
-    spos = spos + obj.size_of();
+    spos = spos + obj_size;
   }
 }
 
@@ -1300,17 +1310,18 @@ uint32 Block_Backend< TIndex, TObject, TIterator >::skip_deleted_objects(
   while (src_obj_offset < src_size)
   {
     TObject obj(((uint8*)source_start_ptr) + src_obj_offset);
+    uint32 obj_size = TObject::size_of(((uint8*)source_start_ptr) + src_obj_offset);
     if (objs_to_delete.find(obj) == objs_to_delete.end())
     {
       memcpy(
           ((uint8*)dest_start_ptr) + dest_obj_offset, ((uint8*)source_start_ptr) + src_obj_offset,
-          obj.size_of());
-      dest_obj_offset += obj.size_of();
+          obj_size);
+      dest_obj_offset += obj_size;
     }
     else
       update_logger.deletion(idx, obj);
 
-    src_obj_offset += obj.size_of();
+    src_obj_offset += obj_size;
   }
 
   *(uint32*)dest_start_ptr = dest_obj_offset;
@@ -225,6 +225,11 @@ struct Test_File : File_Properties
     return File_Blocks_Index< IntIndex >::NO_COMPRESSION;
   }
 
+  int get_compression_level() const
+  {
+    return 0;
+  }
+
   uint32 get_map_block_size() const
   {
     return 16;
@@ -480,6 +485,8 @@ int main(int argc, char* args[])
   std::string test_to_execute;
   if (argc > 1)
     test_to_execute = args[1];
+  // The flat and range reads shall also cover reading ahead
+  block_read_ahead_enabled() = true;
 
   if ((test_to_execute == "") || (test_to_execute == "1"))
     std::cout<<"** Test the behaviour for non-exsiting files\n";
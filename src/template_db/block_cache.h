@@ -0,0 +1,428 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___TEMPLATE_DB__BLOCK_CACHE_H
+#define DE__OSM3S___TEMPLATE_DB__BLOCK_CACHE_H
+
+#include "types.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+/* The block cache keeps decompressed blocks of the data files in a shared memory segment.
+ * The dispatcher creates it, announces which files it controls, and clears it on every commit.
+ * Reading processes attach to it, look up blocks before they read and decompress them,
+ * and insert the blocks they had to read themselves.
+ *
+ * A cached block is identified by the data file, its position in the file and the commit
+ * counter of the dispatcher at the time the reading process has loaded its indexes.
+ * Hence a process never sees a block from a different version of the database.
+ *
+ * The slots are direct mapped. Every slot carries a sequence counter that is odd while
+ * a process writes to the slot. Readers copy the slot and compare the counter afterwards;
+ * a concurrent write turns the lookup into a miss instead of blocking. */
+
+
+const std::string BLOCK_CACHE_SUFFIX = "_blocks";
+
+
+inline uint64 block_cache_file_id(const std::string& data_file_name)
+{
+  // FNV-1a
+  uint64 result = 14695981039346656037ull;
+  for (std::string::size_type i = 0; i < data_file_name.size(); ++i)
+  {
+    result ^= (uint8)data_file_name[i];
+    result *= 1099511628211ull;
+  }
+  return result;
+}
+
+
+class Shared_Block_Cache
+{
+  Shared_Block_Cache(const Shared_Block_Cache&);
+  Shared_Block_Cache& operator=(const Shared_Block_Cache&);
+
+public:
+  static const uint32 MAGIC = 0x6f73336b;
+  static const uint32 MAX_NUM_FILES = 128;
+
+  /** Creates the shared memory segment. Only the dispatcher does this. */
+  Shared_Block_Cache(const std::string& name_, uint64 total_size, uint32 slot_size,
+                     const std::vector< uint64 >& file_ids);
+
+  /** Attaches to the segment created by a dispatcher. Throws File_Error if there is none. */
+  explicit Shared_Block_Cache(const std::string& name_);
+
+  ~Shared_Block_Cache();
+
+  bool controls(uint64 file_id) const;
+
+  /** Returns false if the owning dispatcher has terminated in the meantime. */
+  bool valid() const { return header()->magic == MAGIC; }
+
+  /** Copies the block into buffer and returns true if it is cached. */
+  bool lookup(uint64 file_id, uint32 pos, uint32 version, uint64* buffer, uint32 buffer_size);
+
+  /** Stores the block. The first four bytes of the buffer must contain its used size. */
+  void insert(uint64 file_id, uint32 pos, uint32 version, const uint64* buffer, uint32 buffer_size);
+
+  /** Empties all slots. Called by the dispatcher on every commit. */
+  void clear();
+
+  uint32 get_num_slots() const { return header()->num_slots; }
+  uint32 get_slot_size() const { return header()->slot_size; }
+  uint64 get_hits() const { return header()->hits; }
+  uint64 get_misses() const { return header()->misses; }
+  uint64 get_insertions() const { return header()->insertions; }
+  uint64 get_invalidations() const { return header()->invalidations; }
+
+private:
+  struct Header
+  {
+    volatile uint32 magic;
+    uint32 num_slots;
+    uint32 slot_size;
+    uint32 num_files;
+    volatile uint64 hits;
+    volatile uint64 misses;
+    volatile uint64 insertions;
+    volatile uint64 invalidations;
+    uint64 file_ids[MAX_NUM_FILES];
+  };
+
+  struct Slot_Head
+  {
+    volatile uint32 seq;
+    uint32 version;
+    uint32 pos;
+    uint32 size;
+    uint64 file_id;
+  };
+
+  std::string name;
+  bool owner;
+  uint8* ptr;
+  uint64 mapped_size;
+  std::vector< uint32 > stuck_seq;
+
+  Header* header() const { return (Header*)ptr; }
+  uint64 slot_stride() const { return sizeof(Slot_Head) + header()->slot_size; }
+  Slot_Head* slot(uint64 file_id, uint32 pos) const
+  {
+    uint64 hash = (file_id ^ ((uint64)pos * 0x9e3779b97f4a7c15ull));
+    hash ^= (hash>>29);
+    return (Slot_Head*)(ptr + sizeof(Header) + (hash % header()->num_slots) * slot_stride());
+  }
+};
+
+
+/** The binding of a data file to the cache of its dispatcher. Reading processes only use it
+ * between request_read_and_idx and read_finished, and only with the version they have
+ * got their indexes for. */
+struct Block_Cache_Binding
+{
+  Block_Cache_Binding(const std::string& name_) : name(name_), cache(0), version(0), active(false) {}
+
+  std::string name;
+  Shared_Block_Cache* cache;
+  uint32 version;
+  bool active;
+};
+
+
+class Block_Cache_Registry
+{
+public:
+  ~Block_Cache_Registry();
+
+  /** Attaches to the cache of the given name if it exists and enables it for version. */
+  void activate(const std::string& name, uint32 version);
+  void deactivate(const std::string& name);
+
+  /** Returns the binding responsible for the given data file or zero. */
+  const Block_Cache_Binding* find(uint64 file_id) const;
+
+private:
+  std::vector< Block_Cache_Binding* > bindings;
+};
+
+
+inline Block_Cache_Registry& global_block_cache_registry()
+{
+  static Block_Cache_Registry registry;
+  return registry;
+}
+
+
+/** Implementation Shared_Block_Cache: --------------------------------------*/
+
+inline Shared_Block_Cache::Shared_Block_Cache(
+    const std::string& name_, uint64 total_size, uint32 slot_size, const std::vector< uint64 >& file_ids)
+    : name(name_), owner(true), ptr(0), mapped_size(0)
+{
+  if (file_ids.size() > MAX_NUM_FILES)
+    throw File_Error(0, name, "Shared_Block_Cache::1");
+
+  slot_size = (slot_size + 7) / 8 * 8;
+  uint64 num_slots = total_size / (sizeof(Slot_Head) + slot_size);
+  if (num_slots == 0)
+    num_slots = 1;
+  mapped_size = sizeof(Header) + num_slots * (sizeof(Slot_Head) + slot_size);
+
+  // A segment left over from a crashed dispatcher is useless.
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_RDWR|O_CREAT|O_TRUNC|O_EXCL, S_666);
+  if (fd < 0)
+    throw File_Error(errno, name, "Shared_Block_Cache::2");
+  fchmod(fd, S_666);
+  if (ftruncate(fd, mapped_size) != 0)
+  {
+    close(fd);
+    shm_unlink(name.c_str());
+    throw File_Error(errno, name, "Shared_Block_Cache::3");
+  }
+  void* result = mmap(0, mapped_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (result == MAP_FAILED)
+  {
+    shm_unlink(name.c_str());
+    throw File_Error(errno, name, "Shared_Block_Cache::4");
+  }
+  ptr = (uint8*)result;
+
+  // The segment is zero-filled, hence all slots are empty.
+  header()->num_slots = num_slots;
+  header()->slot_size = slot_size;
+  header()->num_files = file_ids.size();
+  for (uint32 i = 0; i < file_ids.size(); ++i)
+    header()->file_ids[i] = file_ids[i];
+  __sync_synchronize();
+  header()->magic = MAGIC;
+
+  stuck_seq.resize(num_slots, 0);
+}
+
+
+inline Shared_Block_Cache::Shared_Block_Cache(const std::string& name_)
+    : name(name_), owner(false), ptr(0), mapped_size(0)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, S_666);
+  if (fd < 0)
+    throw File_Error(errno, name, "Shared_Block_Cache::5");
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0 || (uint64)stat_buf.st_size < sizeof(Header))
+  {
+    close(fd);
+    throw File_Error(errno, name, "Shared_Block_Cache::6");
+  }
+  mapped_size = stat_buf.st_size;
+  void* result = mmap(0, mapped_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (result == MAP_FAILED)
+    throw File_Error(errno, name, "Shared_Block_Cache::7");
+  ptr = (uint8*)result;
+
+  if (!valid() || mapped_size < sizeof(Header) + header()->num_slots * slot_stride())
+  {
+    munmap(ptr, mapped_size);
+    throw File_Error(0, name, "Shared_Block_Cache::8");
+  }
+}
+
+
+inline Shared_Block_Cache::~Shared_Block_Cache()
+{
+  if (owner)
+  {
+    // Tell attached processes that this segment is orphaned.
+    header()->magic = 0;
+    shm_unlink(name.c_str());
+  }
+  munmap(ptr, mapped_size);
+}
+
+
+inline bool Shared_Block_Cache::controls(uint64 file_id) const
+{
+  for (uint32 i = 0; i < header()->num_files && i < MAX_NUM_FILES; ++i)
+  {
+    if (header()->file_ids[i] == file_id)
+      return true;
+  }
+  return false;
+}
+
+
+inline bool Shared_Block_Cache::lookup(
+    uint64 file_id, uint32 pos, uint32 version, uint64* buffer, uint32 buffer_size)
+{
+  Slot_Head* head = slot(file_id, pos);
+  uint32 seq = head->seq;
+  __sync_synchronize();
+
+  bool found = false;
+  if (!(seq & 1) && head->file_id == file_id && head->pos == pos && head->version == version)
+  {
+    uint32 size = head->size;
+    if (size <= buffer_size && size <= header()->slot_size)
+    {
+      memcpy(buffer, ((uint8*)head) + sizeof(Slot_Head), size);
+      __sync_synchronize();
+      found = (head->seq == seq);
+    }
+  }
+
+  __sync_fetch_and_add(found ? &header()->hits : &header()->misses, 1);
+  return found;
+}
+
+
+inline void Shared_Block_Cache::insert(
+    uint64 file_id, uint32 pos, uint32 version, const uint64* buffer, uint32 buffer_size)
+{
+  uint32 size = *(const uint32*)buffer;
+  if (size < sizeof(uint32) || size > buffer_size || size > header()->slot_size)
+    return;
+
+  Slot_Head* head = slot(file_id, pos);
+  uint32 seq = head->seq;
+  if ((seq & 1) || !__sync_bool_compare_and_swap(&head->seq, seq, seq + 1))
+    return;
+
+  head->file_id = file_id;
+  head->pos = pos;
+  head->version = version;
+  head->size = size;
+  memcpy(((uint8*)head) + sizeof(Slot_Head), buffer, size);
+  __sync_synchronize();
+  head->seq = seq + 2;
+
+  __sync_fetch_and_add(&header()->insertions, 1);
+}
+
+
+inline void Shared_Block_Cache::clear()
+{
+  for (uint32 i = 0; i < header()->num_slots; ++i)
+  {
+    Slot_Head* head = (Slot_Head*)(ptr + sizeof(Header) + i * slot_stride());
+    uint32 seq = head->seq;
+    if (seq & 1)
+    {
+      // A slot that is still locked since the previous commit belongs to a process that died
+      // while writing to it.
+      if (i < stuck_seq.size() && stuck_seq[i] == seq)
+      {
+        head->file_id = 0;
+        __sync_synchronize();
+        head->seq = seq + 1;
+      }
+      else if (i < stuck_seq.size())
+        stuck_seq[i] = seq;
+    }
+    else if (head->file_id != 0 && __sync_bool_compare_and_swap(&head->seq, seq, seq + 1))
+    {
+      head->file_id = 0;
+      __sync_synchronize();
+      head->seq = seq + 2;
+    }
+  }
+  __sync_fetch_and_add(&header()->invalidations, 1);
+}
+
+
+/** Implementation Block_Cache_Registry: ------------------------------------*/
+
+inline Block_Cache_Registry::~Block_Cache_Registry()
+{
+  for (std::vector< Block_Cache_Binding* >::iterator it = bindings.begin(); it != bindings.end(); ++it)
+  {
+    delete (*it)->cache;
+    delete *it;
+  }
+}
+
+
+inline void Block_Cache_Registry::activate(const std::string& name, uint32 version)
+{
+  Block_Cache_Binding* binding = 0;
+  for (std::vector< Block_Cache_Binding* >::iterator it = bindings.begin(); it != bindings.end(); ++it)
+  {
+    if ((*it)->name == name)
+      binding = *it;
+  }
+  if (!binding)
+  {
+    binding = new Block_Cache_Binding(name);
+    bindings.push_back(binding);
+  }
+
+  if (binding->cache && !binding->cache->valid())
+  {
+    delete binding->cache;
+    binding->cache = 0;
+  }
+  if (!binding->cache)
+  {
+    try
+    {
+      binding->cache = new Shared_Block_Cache(name);
+    }
+    catch (const File_Error& e)
+    {
+      // The dispatcher runs without a block cache.
+    }
+  }
+
+  binding->version = version;
+  binding->active = (binding->cache != 0);
+}
+
+
+inline void Block_Cache_Registry::deactivate(const std::string& name)
+{
+  for (std::vector< Block_Cache_Binding* >::iterator it = bindings.begin(); it != bindings.end(); ++it)
+  {
+    if ((*it)->name == name)
+      (*it)->active = false;
+  }
+}
+
+
+inline const Block_Cache_Binding* Block_Cache_Registry::find(uint64 file_id) const
+{
+  for (std::vector< Block_Cache_Binding* >::const_iterator it = bindings.begin(); it != bindings.end(); ++it)
+  {
+    if ((*it)->active && (*it)->cache && (*it)->cache->controls(file_id))
+      return *it;
+  }
+  return 0;
+}
+
+
+#endif
@@ -30,6 +30,7 @@
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -117,7 +118,8 @@ bool Global_Resource_Planner::is_active(pid_t pid) const
 }
 
 
-int Global_Resource_Planner::probe(pid_t pid, uint32 client_token, uint32 time_units, uint64 max_space)
+int Global_Resource_Planner::probe(pid_t pid, uint32 client_token, uint32 time_units, uint64 max_space,
+    uint32& queue_position, uint32& eta)
 {
   std::map< uint32, std::vector< Pending_Client > >::iterator pending_it = pending.find(client_token);
   Pending_Client* handle = 0;
@@ -193,16 +195,103 @@ int Global_Resource_Planner::probe(pid_t pid, uint32 client_token, uint32 time_u
     }
   }
 
-  // Simple checks: is the query acceptable from a global point of view?
-  if (global_available_time < global_used_time ||
-      time_units > (global_available_time - global_used_time)/2 ||
-      global_available_space < global_used_space ||
-      max_space > (global_available_space - global_used_space)/2)
+  // Drop entries of clients that have stopped asking
+  for (std::vector< Waiting_Entry >::iterator it = waiting.begin(); it != waiting.end(); )
   {
-    if (!handle || cur_time - handle->first_seen < 15)
-      return 0;
+    if (it->client_pid != pid && cur_time - it->last_seen > WAITING_EXPIRY)
+    {
+      *it = waiting.back();
+      waiting.pop_back();
+    }
     else
+      ++it;
+  }
+
+  Waiting_Entry* entry = 0;
+  for (std::vector< Waiting_Entry >::iterator it = waiting.begin(); it != waiting.end(); ++it)
+  {
+    if (it->client_pid == pid)
+      entry = &*it;
+  }
+  if (!entry)
+  {
+    // Requests without a token do not form a common flow
+    uint64 start_tag = virtual_time;
+    if (client_token > 0)
+    {
+      std::map< uint32, uint64 >::const_iterator finish_it = token_finish_tags.find(client_token);
+      if (finish_it != token_finish_tags.end() && start_tag < finish_it->second)
+        start_tag = finish_it->second;
+    }
+    uint64 finish_tag = start_tag + request_cost(time_units, max_space);
+    if (client_token > 0)
+      token_finish_tags[client_token] = finish_tag;
+
+    waiting.push_back(Waiting_Entry(pid, client_token, time_units, max_space,
+        priority_class(time_units, max_space), start_tag, finish_tag, cur_time));
+    entry = &waiting.back();
+  }
+  entry->last_seen = cur_time;
+
+  // Serve by aged priority class, then by finish tag
+  std::vector< std::pair< std::pair< uint32, uint64 >, std::pair< uint32, pid_t > > > order;
+  for (std::vector< Waiting_Entry >::const_iterator it = waiting.begin(); it != waiting.end(); ++it)
+  {
+    uint32 promotion = (cur_time - it->first_seen)/AGING_INTERVAL;
+    order.push_back(std::make_pair(
+        std::make_pair(promotion < it->priority_class ? it->priority_class - promotion : 0, it->finish_tag),
+        std::make_pair(it->first_seen, it->client_pid)));
+  }
+  std::sort(order.begin(), order.end());
+
+  // Entries ahead that fit will be admitted at their next probe, hence their resources are reserved.
+  // If the head of the queue has waited too long, it blocks everything behind it until it fits.
+  uint64 reserved_time = 0;
+  uint64 reserved_space = 0;
+  bool blocked = false;
+  uint32 position = 0;
+  uint32 expected_time_ahead = 0;
+  for (; position < order.size() && order[position].second.second != pid; ++position)
+  {
+    const Waiting_Entry* ahead = 0;
+    for (std::vector< Waiting_Entry >::const_iterator it = waiting.begin(); it != waiting.end(); ++it)
+    {
+      if (it->client_pid == order[position].second.second)
+        ahead = &*it;
+    }
+    expected_time_ahead += expected_run_time(ahead->priority_class, ahead->max_time);
+
+    if (fits(ahead->max_time, ahead->max_space, reserved_time, reserved_space))
+    {
+      reserved_time += ahead->max_time;
+      reserved_space += ahead->max_space;
+    }
+    else if (position == 0 && cur_time - ahead->first_seen >= MAX_QUEUE_TIME)
+      blocked = true;
+  }
+
+  if (blocked || !fits(time_units, max_space, reserved_time, reserved_space))
+  {
+    if (cur_time - entry->first_seen >= (position == 0 ? MAX_HEAD_QUEUE_TIME : MAX_QUEUE_TIME))
+    {
+      remove_waiting(pid);
       return Dispatcher::QUERY_REJECTED;
+    }
+
+    // The first slot is expected to become free when the earliest active reader finishes
+    uint32 next_release = 1;
+    for (std::vector< Reader_Entry >::const_iterator it = active.begin(); it != active.end(); ++it)
+    {
+      uint32 expected_end = it->start_time + expected_run_time(
+          priority_class(it->max_time, it->max_space), it->max_time);
+      uint32 remaining = expected_end > cur_time ? expected_end - cur_time : 1;
+      if (it == active.begin() || remaining < next_release)
+        next_release = remaining;
+    }
+
+    queue_position = position + 1;
+    eta = next_release + expected_time_ahead / std::max(uint32(active.size()), 1u);
+    return Dispatcher::QUEUED;
   }
 
   if (handle)
@@ -213,6 +302,19 @@ int Global_Resource_Planner::probe(pid_t pid, uint32 client_token, uint32 time_u
       pending.erase(pending_it);
   }
 
+  if (virtual_time < entry->start_tag)
+  {
+    virtual_time = entry->start_tag;
+    for (std::map< uint32, uint64 >::iterator it = token_finish_tags.begin(); it != token_finish_tags.end(); )
+    {
+      if (it->second <= virtual_time)
+        token_finish_tags.erase(it++);
+      else
+        ++it;
+    }
+  }
+  remove_waiting(pid);
+
   active.push_back(Reader_Entry(pid, max_space, time_units, client_token, time(0)));
 
   global_used_space += max_space;
@@ -221,6 +323,61 @@ int Global_Resource_Planner::probe(pid_t pid, uint32 client_token, uint32 time_u
 }
 
 
+uint32 Global_Resource_Planner::priority_class(uint32 time_units, uint64 max_space)
+{
+  if (time_units <= 30 && max_space <= 256ull*1024*1024)
+    return 0;
+  if (time_units <= 180 && max_space <= 1024ull*1024*1024)
+    return 1;
+  return 2;
+}
+
+
+uint64 Global_Resource_Planner::request_cost(uint32 time_units, uint64 max_space) const
+{
+  // Measured in millionths of the total capacity, such that time and space weigh equally
+  uint64 cost = 1;
+  if (global_available_time > 0)
+    cost += uint64(time_units)*1000000/global_available_time;
+  if (global_available_space > 0)
+    cost += max_space/(global_available_space/1000000 + 1);
+  return cost;
+}
+
+
+bool Global_Resource_Planner::fits(
+    uint32 time_units, uint64 max_space, uint64 reserved_time, uint64 reserved_space) const
+{
+  uint64 used_time = global_used_time + reserved_time;
+  uint64 used_space = global_used_space + reserved_space;
+  return used_time <= global_available_time && time_units <= (global_available_time - used_time)/2
+      && used_space <= global_available_space && max_space <= (global_available_space - used_space)/2;
+}
+
+
+uint32 Global_Resource_Planner::expected_run_time(uint32 prio_class, uint32 time_units) const
+{
+  // Fall back to the declared timeout as long as nothing of this class has been observed
+  if (average_run_time[prio_class] > 0)
+    return average_run_time[prio_class];
+  return std::max(time_units, 1u);
+}
+
+
+void Global_Resource_Planner::remove_waiting(pid_t pid)
+{
+  for (std::vector< Waiting_Entry >::iterator it = waiting.begin(); it != waiting.end(); ++it)
+  {
+    if (it->client_pid == pid)
+    {
+      *it = waiting.back();
+      waiting.pop_back();
+      break;
+    }
+  }
+}
+
+
 void Global_Resource_Planner::remove_entry(std::vector< Reader_Entry >::iterator& it)
 {
   uint32 end_time = time(0);
@@ -262,6 +419,11 @@ void Global_Resource_Planner::remove_entry(std::vector< Reader_Entry >::iterator
   last_used_time += global_used_time;
   ++last_counted;
 
+  // Track how long the readers of each priority class actually run
+  uint32 run_time = std::max(end_time - it->start_time, 1u);
+  uint32& average = average_run_time[priority_class(it->max_time, it->max_space)];
+  average = (average == 0 ? run_time : (7*average + run_time)/8);
+
   // Adjust global counters
   global_used_space -= it->max_space;
   global_used_time -= it->max_time;
@@ -287,6 +449,7 @@ void Global_Resource_Planner::remove_entry(std::vector< Reader_Entry >::iterator
 void Global_Resource_Planner::remove(pid_t pid)
 {
   bool was_active = false;
+  remove_waiting(pid);
 
   for (std::vector< Reader_Entry >::iterator it = active.begin(); it != active.end(); ++it)
   {
@@ -341,6 +504,17 @@ void Global_Resource_Planner::purge(Connection_Per_Pid_Map& connection_per_pid)
       ++it;
   }
 
+  for (std::vector< Waiting_Entry >::iterator it = waiting.begin(); it != waiting.end(); )
+  {
+    if (connection_per_pid.get(it->client_pid) == 0)
+    {
+      *it = waiting.back();
+      waiting.pop_back();
+    }
+    else
+      ++it;
+  }
+
   for (std::map< uint32, std::vector< Pending_Client > >::iterator pending_it = pending.begin();
       pending_it != pending.end(); )
   {
@@ -377,7 +551,8 @@ Dispatcher::Dispatcher
      uint64 total_available_space_,
      uint64 total_available_time_units_,
      const std::vector< File_Properties* >& controlled_files_,
-     Dispatcher_Logger* logger_)
+     Dispatcher_Logger* logger_,
+     uint64 block_cache_size)
     : socket(dispatcher_share_name_, shadow_name_, db_dir_, max_num_reading_processes_),
       transaction_insulator(db_dir_, controlled_files_),
       shadow_name(shadow_name_),
@@ -386,7 +561,8 @@ Dispatcher::Dispatcher
       pending_commit(false),
       requests_started_counter(0),
       requests_finished_counter(0),
-      global_resource_planner(total_available_time_units_, total_available_space_, 0)
+      global_resource_planner(total_available_time_units_, total_available_space_, 0),
+      block_cache(0)
 {
   signal(SIGPIPE, SIG_IGN);
 
@@ -426,6 +602,8 @@ Dispatcher::Dispatcher
 
   // Set command state to zero.
   *(uint32*)dispatcher_shm_ptr = 0;
+  // Start the commit counter at a value that differs from any previous run of the dispatcher.
+  *(uint32*)(dispatcher_shm_ptr + OFFSET_COMMIT_COUNTER) = time(0);
 
   if (file_exists(shadow_name))
   {
@@ -435,11 +613,26 @@ Dispatcher::Dispatcher
   transaction_insulator.remove_shadows();
   remove((shadow_name + ".lock").c_str());
   transaction_insulator.set_current_footprints();
+
+  if (block_cache_size > 0)
+  {
+    std::vector< uint64 > file_ids;
+    uint32 slot_size = 0;
+    for (std::vector< File_Properties* >::const_iterator it = controlled_files_.begin();
+        it != controlled_files_.end(); ++it)
+    {
+      file_ids.push_back(block_cache_file_id(db_dir + (*it)->get_file_name_trunk() + (*it)->get_data_suffix()));
+      slot_size = std::max(slot_size, (*it)->get_block_size() * (*it)->get_compression_factor());
+    }
+    block_cache = new Shared_Block_Cache(
+        dispatcher_share_name + BLOCK_CACHE_SUFFIX, block_cache_size, slot_size, file_ids);
+  }
 }
 
 
 Dispatcher::~Dispatcher()
 {
+  delete block_cache;
   munmap((void*)dispatcher_shm_ptr, SHM_SIZE + transaction_insulator.db_dir().size() + shadow_name.size());
   shm_unlink(dispatcher_share_name.c_str());
 }
@@ -521,6 +714,9 @@ void Dispatcher::write_commit(pid_t pid)
   transaction_insulator.remove_shadows();
   remove((shadow_name + ".lock").c_str());
   transaction_insulator.set_current_footprints();
+  ++*(uint32*)(dispatcher_shm_ptr + OFFSET_COMMIT_COUNTER);
+  if (block_cache)
+    block_cache->clear();
 }
 
 
@@ -683,11 +879,21 @@ void Dispatcher::standby_loop(uint64 milliseconds)
 	  continue;
 	}
 
-	command = global_resource_planner.probe(client_pid, client_token, max_allowed_time, max_allowed_space);
+	uint32 queue_position = 0;
+	uint32 eta = 0;
+	command = global_resource_planner.probe(client_pid, client_token, max_allowed_time, max_allowed_space,
+	    queue_position, eta);
 	if (command == REQUEST_READ_AND_IDX)
 	  request_read_and_idx(client_pid, max_allowed_time, max_allowed_space, client_token);
 
-	connection_per_pid.get(client_pid)->send_result(command);
+	if (command == QUEUED)
+	{
+	  connection_per_pid.get(client_pid)->send_data(QUEUED);
+	  connection_per_pid.get(client_pid)->send_data(queue_position);
+	  connection_per_pid.get(client_pid)->send_result(eta);
+	}
+	else
+	  connection_per_pid.get(client_pid)->send_result(command);
       }
       else if (command == PURGE)
       {
@@ -818,6 +1024,13 @@ void Dispatcher::output_status()
         <<"Average claimed time units: "<<global_resource_planner.get_average_claimed_time()<<'\n'
         <<"Counter of started requests: "<<requests_started_counter<<'\n'
         <<"Counter of finished requests: "<<requests_finished_counter<<'\n';
+    if (block_cache)
+      status<<"Block cache slots: "<<block_cache->get_num_slots()
+          <<" of "<<block_cache->get_slot_size()<<" bytes\n"
+          <<"Block cache hits: "<<block_cache->get_hits()<<'\n'
+          <<"Block cache misses: "<<block_cache->get_misses()<<'\n'
+          <<"Block cache insertions: "<<block_cache->get_insertions()<<'\n'
+          <<"Block cache invalidations: "<<block_cache->get_invalidations()<<'\n';
 
     std::set< ::pid_t > collected_pids = transaction_insulator.registered_pids();
 
@@ -834,6 +1047,14 @@ void Dispatcher::output_status()
       collected_pids.insert(it->client_pid);
     }
 
+    for (std::vector< Waiting_Entry >::const_iterator it = global_resource_planner.get_waiting().begin();
+	 it != global_resource_planner.get_waiting().end(); ++it)
+    {
+      status<<"queued\t"<<it->client_pid<<' '<<it->client_token<<' '<<it->max_space<<' '<<it->max_time<<' '
+          <<it->priority_class<<' '<<it->first_seen<<'\n';
+      collected_pids.insert(it->client_pid);
+    }
+
     for (std::map< pid_t, Blocking_Client_Socket* >::const_iterator it = connection_per_pid.base_map().begin();
 	 it != connection_per_pid.base_map().end(); ++it)
     {
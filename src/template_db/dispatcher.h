@@ -19,6 +19,7 @@
 #ifndef DE__OSM3S___TEMPLATE_DB__DISPATCHER_H
 #define DE__OSM3S___TEMPLATE_DB__DISPATCHER_H
 
+#include "block_cache.h"
 #include "file_tools.h"
 #include "types.h"
 #include "transaction_insulator.h"
@@ -82,6 +83,27 @@ struct Pending_Client
 };
 
 
+/** A reader that has asked for admission but has not been admitted yet.
+    Entries are served by priority class first and by their fair queuing finish tag second. */
+struct Waiting_Entry
+{
+  Waiting_Entry(pid_t client_pid_, uint32 client_token_, uint32 max_time_, uint64 max_space_,
+                uint32 priority_class_, uint64 start_tag_, uint64 finish_tag_, uint32 first_seen_)
+    : client_pid(client_pid_), client_token(client_token_), max_time(max_time_), max_space(max_space_),
+      priority_class(priority_class_), start_tag(start_tag_), finish_tag(finish_tag_), first_seen(first_seen_), last_seen(first_seen_) {}
+
+  pid_t client_pid;
+  uint32 client_token;
+  uint32 max_time;
+  uint64 max_space;
+  uint32 priority_class;
+  uint64 start_tag;
+  uint64 finish_tag;
+  uint32 first_seen;
+  uint32 last_seen;
+};
+
+
 class Global_Resource_Planner
 {
 public:
@@ -90,11 +112,30 @@ public:
         global_used_space(0), global_available_space(global_available_space_),
         rate_limit(rate_limit_), recent_average_used_time(15), recent_average_used_space(15),
         last_update_time(0), last_used_time(0), last_used_space(0), last_counted(0),
-        average_used_time(0), average_used_space(0) {}
-
-  // Returns true if the process is acceptable in terms of server load and quotas
-  // In this case it is registered as running
-  int probe(pid_t pid, uint32 client_token, uint32 time_units, uint64 max_space);
+        average_used_time(0), average_used_space(0), virtual_time(0),
+        average_run_time(NUM_PRIORITY_CLASSES, 0) {}
+
+  // Priority classes are derived from the declared timeout and maxsize.
+  // A lower class is served first. Waiting entries move up one class per AGING_INTERVAL seconds.
+  static const uint32 NUM_PRIORITY_CLASSES = 3;
+  static const uint32 AGING_INTERVAL = 10;
+  // After this many seconds, an entry reserves resources against all entries behind it.
+  // Entries that are not at the head of the queue by then are rejected as before.
+  static const uint32 MAX_QUEUE_TIME = 15;
+  // The head of the queue is rejected only after this many seconds.
+  static const uint32 MAX_HEAD_QUEUE_TIME = 60;
+  // Clients probe every 300 ms. Entries that have not probed for this long are dropped.
+  static const uint32 WAITING_EXPIRY = 5;
+
+  static uint32 priority_class(uint32 time_units, uint64 max_space);
+
+  // Returns REQUEST_READ_AND_IDX if the process is acceptable in terms of server load and quotas.
+  // In this case it is registered as running.
+  // Returns QUEUED if the process has to wait. Then queue_position and eta are set.
+  // Returns 0 if the process has to wait for the rate limit and RATE_LIMITED or QUERY_REJECTED
+  // if the process shall give up.
+  int probe(pid_t pid, uint32 client_token, uint32 time_units, uint64 max_space,
+            uint32& queue_position, uint32& eta);
 
   // Unregisters the process
   void remove(pid_t pid);
@@ -109,6 +150,7 @@ public:
   const std::vector< Reader_Entry >& get_active() const { return active; }
   bool is_active(pid_t client_pid) const;
   const std::vector< Quota_Entry >& get_afterwards() const { return afterwards; }
+  const std::vector< Waiting_Entry >& get_waiting() const { return waiting; }
   uint32 get_total_claimed_time() const { return global_used_time; }
   uint32 get_total_available_time() const { return global_available_time; }
   uint64 get_total_claimed_space() const { return global_used_space; }
@@ -116,11 +158,13 @@ public:
   uint32 get_rate_limit() const { return rate_limit; }
   uint32 get_average_claimed_time() const { return average_used_time; }
   uint64 get_average_claimed_space() const { return average_used_space; }
+  uint32 get_average_run_time(uint32 prio_class) const { return average_run_time[prio_class]; }
 
 private:
   std::map< uint32, std::vector< Pending_Client > > pending;
   std::vector< Reader_Entry > active;
   std::vector< Quota_Entry > afterwards;
+  std::vector< Waiting_Entry > waiting;
   uint32 global_used_time;
   uint32 global_available_time;
   uint64 global_used_space;
@@ -136,7 +180,18 @@ private:
   uint32 average_used_time;
   uint64 average_used_space;
 
+  // Weighted fair queuing: the virtual time advances with the start tags of admitted entries,
+  // and each client token continues from the finish tag of its last request.
+  uint64 virtual_time;
+  std::map< uint32, uint64 > token_finish_tags;
+  // Moving averages of the observed run times in seconds, per priority class
+  std::vector< uint32 > average_run_time;
+
   void remove_entry(std::vector< Reader_Entry >::iterator& it);
+  void remove_waiting(pid_t pid);
+  uint64 request_cost(uint32 time_units, uint64 max_space) const;
+  bool fits(uint32 time_units, uint64 max_space, uint64 reserved_time, uint64 reserved_space) const;
+  uint32 expected_run_time(uint32 prio_class, uint32 time_units) const;
 };
 
 
@@ -169,6 +224,9 @@ class Dispatcher
     static const int OFFSET_BACK = 20;
     static const int OFFSET_DB_1 = OFFSET_BACK+12;
     static const int OFFSET_DB_2 = OFFSET_DB_1+(256+4);
+    // Incremented by every completed write_commit. Readers that keep indexes across queries
+    // compare it to decide whether their copy of the index is still current.
+    static const int OFFSET_COMMIT_COUNTER = sizeof(uint32);
 
     static const uint32 TERMINATE = 1;
     static const uint32 OUTPUT_STATUS = 2;
@@ -185,6 +243,7 @@ class Dispatcher
 
     static const uint32 RATE_LIMITED = 31;
     static const uint32 QUERY_REJECTED = 32;
+    static const uint32 QUEUED = 33;
 
     static const uint32 WRITE_START = 101;
     static const uint32 WRITE_ROLLBACK = 102;
@@ -205,7 +264,8 @@ class Dispatcher
 	       uint64 total_available_space,
 	       uint64 total_available_time_units,
 	       const std::vector< File_Properties* >& controlled_files,
-	       Dispatcher_Logger* logger = 0);
+	       Dispatcher_Logger* logger = 0,
+	       uint64 block_cache_size = 0);
 
     ~Dispatcher();
 
@@ -273,6 +333,7 @@ class Dispatcher
     uint32 requests_started_counter;
     uint32 requests_finished_counter;
     Global_Resource_Planner global_resource_planner;
+    Shared_Block_Cache* block_cache;
 
     uint64 total_claimed_space() const;
     uint64 total_claimed_time_units() const;
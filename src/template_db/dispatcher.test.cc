@@ -182,6 +182,11 @@ struct Test_File : File_Properties
     return 0;
   }
 
+  int get_compression_level() const
+  {
+    return 0;
+  }
+
   uint32 get_map_block_size() const
   {
     return 16*IntIndex::max_size_of();
@@ -1539,4 +1544,39 @@ int main(int argc, char* args[])
           <<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
     }
   }
+
+  if ((test_to_execute == "") || (test_to_execute == "28"))
+  {
+    // Admission scheduling: one token floods the queue, a second token must not wait behind all of it
+    Global_Resource_Planner planner(100, 1000, 0);
+    uint32 position = 0;
+    uint32 eta = 0;
+
+    std::cout<<"Probe 1: "<<planner.probe(1, 1, 40, 10, position, eta)<<'\n';
+    for (uint32 pid = 2; pid <= 4; ++pid)
+    {
+      uint32 result = planner.probe(pid, 1, 35, 10, position, eta);
+      std::cout<<"Probe "<<pid<<": "<<result<<" at position "<<position<<'\n';
+    }
+    uint32 result = planner.probe(5, 2, 35, 10, position, eta);
+    std::cout<<"Probe 5: "<<result<<" at position "<<position<<'\n';
+    bool second_token_ahead = (result == Dispatcher::QUEUED && position == 1);
+    result = planner.probe(6, 3, 200, 10, position, eta);
+    std::cout<<"Probe 6: "<<result<<" at position "<<position<<'\n';
+    bool long_query_behind = (result == Dispatcher::QUEUED && position == 5);
+
+    planner.remove(1);
+    result = planner.probe(2, 1, 35, 10, position, eta);
+    std::cout<<"Probe 2: "<<result<<" at position "<<position<<'\n';
+    result = planner.probe(5, 2, 35, 10, position, eta);
+    std::cout<<"Probe 5: "<<result<<'\n';
+    bool second_token_admitted = (result == Dispatcher::REQUEST_READ_AND_IDX);
+    std::cout<<"Waiting: "<<planner.get_waiting().size()<<'\n';
+
+    if (second_token_ahead && long_query_behind && second_token_admitted
+        && planner.get_waiting().size() == 4)
+      std::cout<<"Admission order is as expected.\n";
+    else
+      std::cout<<"FAILED: Admission order differs from the expected order.\n";
+  }
 }
@@ -35,7 +35,7 @@
 
 Dispatcher_Client::Dispatcher_Client
     (const std::string& dispatcher_share_name_)
-    : dispatcher_share_name(dispatcher_share_name_), socket("")
+    : dispatcher_share_name(dispatcher_share_name_), socket(""), queue_position(0), queue_eta(0)
 {
   signal(SIGPIPE, SIG_IGN);
 
@@ -202,9 +202,15 @@ void Dispatcher_Client::request_read_and_idx(uint32 max_allowed_time, uint64 max
 {
 //   *(uint32*)(dispatcher_shm_ptr + 2*sizeof(uint32)) = 0;
 
+  queue_position = 0;
+  queue_eta = 0;
+
+  // While the dispatcher reports a queue position, it decides itself when to give up.
+  // The second counter only protects against a dispatcher that never does.
   uint counter = 0;
+  uint queued_counter = 0;
   uint32 ack = 0;
-  while (ack == 0 && ++counter <= 100)
+  while (counter <= 100 && queued_counter <= 300)
   {
     send_message(Dispatcher::REQUEST_READ_AND_IDX,
 		 "Dispatcher_Client::request_read_and_idx::socket::1");
@@ -214,7 +220,23 @@ void Dispatcher_Client::request_read_and_idx(uint32 max_allowed_time, uint64 max
 
     ack = ack_arrived();
     if (ack == Dispatcher::REQUEST_READ_AND_IDX)
+    {
+      // No commit can happen before read_idx_finished, hence the counter identifies
+      // the version of the indexes this process is about to load.
+      global_block_cache_registry().activate(
+          dispatcher_share_name + BLOCK_CACHE_SUFFIX, get_commit_counter());
       return;
+    }
+    else if (ack == Dispatcher::QUEUED)
+    {
+      queue_position = ack_arrived();
+      queue_eta = ack_arrived();
+      ++queued_counter;
+    }
+    else if (ack == 0)
+      ++counter;
+    else
+      break;
 
     millisleep(300);
   }
@@ -245,6 +267,8 @@ void Dispatcher_Client::read_finished()
 {
 //   *(uint32*)(dispatcher_shm_ptr + 2*sizeof(uint32)) = 0;
 
+  global_block_cache_registry().deactivate(dispatcher_share_name + BLOCK_CACHE_SUFFIX);
+
   uint counter = 0;
   while (++counter <= 300)
   {
@@ -337,6 +361,29 @@ void Dispatcher_Client::set_global_limits(uint64 max_allowed_space, uint64 max_a
 }
 
 
+uint32 Dispatcher_Client::get_commit_counter() const
+{
+  return *(volatile uint32*)(dispatcher_shm_ptr + Dispatcher::OFFSET_COMMIT_COUNTER);
+}
+
+
+uint32 probe_commit_counter(const std::string& dispatcher_share_name)
+{
+  int shm_fd = shm_open(dispatcher_share_name.c_str(), O_RDONLY, S_666);
+  if (shm_fd < 0)
+    throw File_Error(errno, dispatcher_share_name, "probe_commit_counter::1");
+
+  void* shm_ptr = mmap(0, Dispatcher::SHM_SIZE, PROT_READ, MAP_SHARED, shm_fd, 0);
+  close(shm_fd);
+  if (shm_ptr == MAP_FAILED)
+    throw File_Error(errno, dispatcher_share_name, "probe_commit_counter::2");
+
+  uint32 result = *(volatile uint32*)((uint8*)shm_ptr + Dispatcher::OFFSET_COMMIT_COUNTER);
+  munmap(shm_ptr, Dispatcher::SHM_SIZE);
+  return result;
+}
+
+
 void Dispatcher_Client::ping()
 {
 // Ping-Feature removed. The concept of unassured messages doesn't fit in the context of strict
@@ -69,6 +69,11 @@ class Dispatcher_Client
     void request_read_and_idx(uint32 max_allowed_time, uint64 max_allowed_space,
 			      uint32 client_token);
 
+    /** Position in the admission queue and estimated seconds until admission,
+    as last reported during request_read_and_idx. Both are 0 if the process never had to queue. */
+    uint32 get_queue_position() const { return queue_position; }
+    uint32 get_queue_eta() const { return queue_eta; }
+
     /** Changes the registered state from reading the index to reading the
     database. Can be safely called multiple times for the same process. */
     void read_idx_finished();
@@ -97,6 +102,10 @@ class Dispatcher_Client
     /** Called regularly to tell the dispatcher that this process is still alive */
     void ping();
 
+    /** Returns the number of commits the dispatcher has completed. Compare two values only
+        for equality: the counter starts at an arbitrary value and may wrap around. */
+    uint32 get_commit_counter() const;
+
     const std::string& get_db_dir() { return db_dir; }
     const std::string& get_shadow_name() { return shadow_name; }
 
@@ -106,6 +115,8 @@ class Dispatcher_Client
     volatile uint8* dispatcher_shm_ptr;
     std::string db_dir, shadow_name;
     Unix_Socket socket;
+    uint32 queue_position;
+    uint32 queue_eta;
 
     uint32 ack_arrived();
 
@@ -117,6 +128,10 @@ class Dispatcher_Client
 bool file_present(const std::string& full_path);
 
 
+/** Reads the commit counter of the dispatcher without registering a connection. */
+uint32 probe_commit_counter(const std::string& dispatcher_share_name);
+
+
 struct Context_Error
 {
   Context_Error(const std::string message_) : message(message_) {}
@@ -19,10 +19,13 @@
 #ifndef DE__OSM3S___TEMPLATE_DB__FILE_BLOCKS_H
 #define DE__OSM3S___TEMPLATE_DB__FILE_BLOCKS_H
 
+#include "block_cache.h"
 #include "file_blocks_index.h"
 #include "types.h"
 #include "lz4_wrapper.h"
+#include "worker_pool.h"
 #include "zlib_wrapper.h"
+#include "zstd_wrapper.h"
 
 #include <unistd.h>
 
@@ -40,8 +43,8 @@ template< typename TIndex >
 struct File_Blocks_Basic_Iterator
 {
   File_Blocks_Basic_Iterator(
-      const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& begin,
-      const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& end)
+      const File_Block_Index_Iterator< TIndex >& begin,
+      const File_Block_Index_Iterator< TIndex >& end)
       : block_it(begin), block_end(end) {}
 
   File_Blocks_Basic_Iterator(const File_Blocks_Basic_Iterator& a)
@@ -51,8 +54,8 @@ struct File_Blocks_Basic_Iterator
 
   const File_Block_Index_Entry< TIndex >& block() const { return *block_it; }
 
-  typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator block_it;
-  typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator block_end;
+  File_Block_Index_Iterator< TIndex > block_it;
+  File_Block_Index_Iterator< TIndex > block_end;
 };
 
 
@@ -60,8 +63,8 @@ template< typename TIndex >
 struct File_Blocks_Flat_Iterator : File_Blocks_Basic_Iterator< TIndex >
 {
   File_Blocks_Flat_Iterator
-  (const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& begin,
-   const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& end)
+  (const File_Block_Index_Iterator< TIndex >& begin,
+   const File_Block_Index_Iterator< TIndex >& end)
     : File_Blocks_Basic_Iterator< TIndex >(begin, end) {}
 
   File_Blocks_Flat_Iterator(const File_Blocks_Flat_Iterator& a)
@@ -82,8 +85,8 @@ struct File_Blocks_Discrete_Iterator : File_Blocks_Basic_Iterator< TIndex >
 {
   File_Blocks_Discrete_Iterator
       (TIterator const& index_it_, TIterator const& index_end_,
-       const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& begin,
-       const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& end)
+       const File_Block_Index_Iterator< TIndex >& begin,
+       const File_Block_Index_Iterator< TIndex >& end)
     : File_Blocks_Basic_Iterator< TIndex >(begin, end),
       index_lower(index_it_), index_upper(index_it_), index_end(index_end_)
   {
@@ -91,7 +94,7 @@ struct File_Blocks_Discrete_Iterator : File_Blocks_Basic_Iterator< TIndex >
   }
 
   File_Blocks_Discrete_Iterator
-      (const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& end)
+      (const File_Block_Index_Iterator< TIndex >& end)
     : File_Blocks_Basic_Iterator< TIndex >(end, end) {}
 
   File_Blocks_Discrete_Iterator(const File_Blocks_Discrete_Iterator& a)
@@ -123,8 +126,8 @@ template< typename TIndex, typename TRangeIterator >
 struct File_Blocks_Range_Iterator : File_Blocks_Basic_Iterator< TIndex >
 {
   File_Blocks_Range_Iterator
-      (const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& begin,
-       const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& end,
+      (const File_Block_Index_Iterator< TIndex >& begin,
+       const File_Block_Index_Iterator< TIndex >& end,
        const TRangeIterator& index_it_,  const TRangeIterator& index_end_)
     : File_Blocks_Basic_Iterator< TIndex >(begin, end),
       index_it(index_it_), index_end(index_end_), index_equals_last_index(false)
@@ -133,7 +136,7 @@ struct File_Blocks_Range_Iterator : File_Blocks_Basic_Iterator< TIndex >
   }
 
   File_Blocks_Range_Iterator
-      (const typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator& end)
+      (const File_Block_Index_Iterator< TIndex >& end)
     : File_Blocks_Basic_Iterator< TIndex >(end, end) {}
 
   File_Blocks_Range_Iterator(const File_Blocks_Range_Iterator& a)
@@ -202,8 +205,13 @@ struct File_Blocks_Write_Iterator
   const TIterator& upper_bound() const { return index_upper; }
 
   const File_Block_Index_Entry< TIndex >& block() const { return *block_it; }
-  void set_block(const File_Block_Index_Entry< TIndex >& rhs) { *block_it = rhs; }
-  void insert_block(File_Blocks_Index< TIndex >& index, const File_Block_Index_Entry< TIndex >& entry);
+  File_Block_Index_Entry< TIndex >* set_block(const File_Block_Index_Entry< TIndex >& rhs)
+  {
+    *block_it = rhs;
+    return &*block_it;
+  }
+  File_Block_Index_Entry< TIndex >* insert_block(
+      File_Blocks_Index< TIndex >& index, const File_Block_Index_Entry< TIndex >& entry);
   void erase_block(File_Blocks_Index< TIndex >& index);
   void erase_blocks(File_Blocks_Index< TIndex >& index, const File_Blocks_Write_Iterator& upper_limit);
 
@@ -222,6 +230,128 @@ private:
 };
 
 
+/** The threads that compress and decompress blocks for all File_Blocks of the process.
+    On a single processor there are none, and File_Blocks compresses and decompresses synchronously. */
+inline Worker_Pool& block_codec_pool()
+{
+  static Worker_Pool pool;
+  return pool;
+}
+
+
+/** Whether read_block_ahead() actually reads ahead. Only processes that read whole files, i.e. updates
+    and clones, turn it on. A query process would otherwise start the codec threads and hold blocks
+    in memory that its Resource_Manager does not account for. */
+inline bool& block_read_ahead_enabled()
+{
+  static bool enabled = false;
+  return enabled;
+}
+
+
+inline void inflate_block(int compression_method, const Zstd_Dictionary* dictionary,
+    const void* in, uint32 in_size, void* out, uint32 out_size,
+    const std::string& file_name, uint32 pos, uint32 block_size)
+{
+  try
+  {
+    if (compression_method == File_Blocks_Index_Base::ZLIB_COMPRESSION)
+      Zlib_Inflate().decompress(in, in_size, out, out_size);
+    else if (compression_method == File_Blocks_Index_Base::ZSTD_COMPRESSION)
+      Zstd_Inflate(dictionary).decompress(in, in_size, out, out_size);
+    else
+      LZ4_Inflate().decompress(in, in_size, out, out_size);
+  }
+  catch (const Zlib_Inflate::Error& e)
+  {
+    std::ostringstream out;
+    out<<"File_Blocks::read_block: Zlib_Inflate::Error "<<e.error_code
+        <<" at offset "<<((int64)pos * block_size + 8)<<"; "
+        <<" in_size: "<<in_size<<", "
+        <<" out_size: "<<out_size;
+    throw File_Error(pos, file_name, out.str());
+  }
+  catch (const LZ4_Inflate::Error& e)
+  {
+    std::ostringstream out;
+    out<<"File_Blocks::read_block: LZ4_Inflate::Error "<<e.error_code
+        <<" at offset "<<((int64)pos * block_size + 8)<<"; "
+        <<" in_size: "<<in_size<<", "
+        <<" out_size: "<<out_size;
+    throw File_Error(pos, file_name, out.str());
+  }
+  catch (const Zstd_Inflate::Error& e)
+  {
+    std::ostringstream out;
+    out<<"File_Blocks::read_block: Zstd_Inflate::Error "<<e.error_code
+        <<" at offset "<<((int64)pos * block_size + 8)<<"; "
+        <<" in_size: "<<in_size<<", "
+        <<" out_size: "<<out_size;
+    throw File_Error(pos, file_name, out.str());
+  }
+}
+
+
+/** Compresses a block on a codec thread. The position of the block is assigned once the compressed size
+    is known, in the order the blocks have been written, such that the file layout is the same as
+    with synchronous compression. */
+template< typename TIndex >
+struct File_Blocks_Deflate_Job
+{
+  File_Blocks_Deflate_Job(const uint64* buf, uint32 buffer_size_, uint32 payload_size_,
+      int compression_method_, int compression_level_, const Zstd_Dictionary* dictionary_,
+      const std::string& file_name_, File_Block_Index_Entry< TIndex >* entry_)
+      : uncompressed(buffer_size_), compressed(buffer_size_ * 2), buffer_size(buffer_size_),
+        payload_size(payload_size_), compressed_size(0), compression_method(compression_method_),
+        compression_level(compression_level_), dictionary(dictionary_), file_name(file_name_), entry(entry_)
+  {
+    memcpy(uncompressed.ptr, buf, buffer_size);
+  }
+
+  void run();
+
+  Void64_Pointer< uint64 > uncompressed;
+  Void64_Pointer< uint64 > compressed;
+  uint32 buffer_size;
+  uint32 payload_size;
+  uint32 compressed_size;
+  int compression_method;
+  int compression_level;
+  const Zstd_Dictionary* dictionary;
+  std::string file_name;
+  File_Block_Index_Entry< TIndex >* entry;
+};
+
+
+/** Reads ahead a block of a Flat_Iterator or Range_Iterator.
+    The compressed data is read by the calling thread and decompressed on a codec thread. */
+struct File_Blocks_Inflate_Job
+{
+  File_Blocks_Inflate_Job(uint32 pos_, uint32 size_, uint32 block_size_, uint32 compression_factor,
+      int compression_method_, const Zstd_Dictionary* dictionary_, const std::string& file_name_)
+      : pos(pos_), size(size_), block_size(block_size_), compressed(block_size_ * size_),
+        uncompressed(block_size_ * compression_factor), uncompressed_size(block_size_ * compression_factor),
+        compression_method(compression_method_), dictionary(dictionary_), file_name(file_name_) {}
+
+  void run()
+  {
+    inflate_block(compression_method, dictionary, compressed.ptr, block_size * size,
+        uncompressed.ptr, uncompressed_size, file_name, pos, block_size);
+    compressed.clear();
+  }
+
+  uint32 pos;
+  uint32 size;
+  uint32 block_size;
+  Void64_Pointer< uint64 > compressed;
+  Void64_Pointer< uint64 > uncompressed;
+  uint32 uncompressed_size;
+  int compression_method;
+  const Zstd_Dictionary* dictionary;
+  std::string file_name;
+};
+
+
 template< typename TIndex, typename TIterator, typename TRangeIterator >
 struct File_Blocks
 {
@@ -235,7 +365,7 @@ private:
 
 public:
   File_Blocks(File_Blocks_Index_Base* index);
-  ~File_Blocks() {}
+  ~File_Blocks();
 
   Flat_Iterator flat_begin();
   Flat_Iterator flat_end();
@@ -252,6 +382,14 @@ public:
   uint64* read_block(const File_Blocks_Write_Iterator< TIndex, TIterator >& it, bool check_idx = true) const;
   uint64* read_block(
       const File_Blocks_Write_Iterator< TIndex, TIterator >& it, uint64* buffer, bool check_idx = true) const;
+  // Like read_block, but also decompresses the next blocks up to end in advance on the codec threads
+  // if block_read_ahead_enabled() is set
+  template< typename File_Blocks_Iterator >
+  uint64* read_block_ahead(
+      const File_Blocks_Iterator& it, const File_Blocks_Iterator& end, bool check_idx = true) const;
+  template< typename File_Blocks_Iterator >
+  uint64* read_block_ahead(const File_Blocks_Iterator& it, const File_Blocks_Iterator& end,
+      uint64* buffer, bool check_idx = true) const;
 
   uint32 answer_size(const Flat_Iterator& it) const
   {
@@ -275,6 +413,9 @@ public:
   Write_Iterator erase_block(Write_Iterator it);
   void erase_blocks(
       Write_Iterator& block_it, const Write_Iterator& it);
+  // Writes all blocks that are still being compressed. Must be called before the index is written,
+  // because the destructor drops blocks still pending.
+  void flush();
 
   const File_Blocks_Index< TIndex >& get_index() const { return *index; }
 
@@ -288,15 +429,82 @@ private:
 
   Raw_File data_file;
   Void64_Pointer< uint64 > buffer;
+  uint64 cache_file_id;
+  const Block_Cache_Binding* cache_binding;
+  // Zero if blocks are compressed and decompressed synchronously
+  uint32 pipeline_depth;
+  Ordered_Jobs< File_Blocks_Deflate_Job< TIndex > >* pending_writes;
+  mutable Ordered_Jobs< File_Blocks_Inflate_Job >* read_ahead;
 
   template< typename File_Blocks_Iterator >
   uint64* read_block(
       const File_Blocks_Iterator& it, uint64* temp_buffer, uint64* buffer_, bool check_idx) const;
+  template< typename File_Blocks_Iterator >
+  void check_block(const File_Blocks_Iterator& it, uint64* buffer_, bool check_idx) const;
   uint32 allocate_block(uint32 data_size);
   void write_block(uint64* buf, uint32 uncompressed_size, uint32& data_size, uint32& pos);
+  void write_block_async(uint64* buf, uint32 payload_size, File_Block_Index_Entry< TIndex >* entry);
+  void retire_write();
 };
 
 
+/** Implementation skip_blocks_below: --------------------------------------*/
+
+/* Returns the first block of the group of blocks that immediately precedes the first block with
+ * an index not less than target. Iterating from there yields the same relevant blocks as
+ * iterating from it, but the blocks in between are skipped by binary search.
+ * Returns it unchanged if the underlying index does not allow random access. */
+template< typename TIndex >
+File_Block_Index_Iterator< TIndex > skip_blocks_below(
+    const File_Block_Index_Iterator< TIndex >& it, const File_Block_Index_Iterator< TIndex >& end,
+    const TIndex& target)
+{
+  if (!it.random_access() || it == end || !(it->index < target))
+    return it;
+
+  File_Block_Index_Iterator< TIndex > first = it;
+  int64 count = end - it;
+  while (count > 0)
+  {
+    int64 step = count / 2;
+    File_Block_Index_Iterator< TIndex > middle = first;
+    middle += step;
+    if (middle->index < target)
+    {
+      first = middle;
+      ++first;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+
+  // first is now the first block not below target, hence first - 1 is below target
+  if (first - it <= 1)
+    return it;
+  first += -1;
+  TIndex group_index = first->index;
+
+  count = first - it;
+  first = it;
+  while (count > 0)
+  {
+    int64 step = count / 2;
+    File_Block_Index_Iterator< TIndex > middle = first;
+    middle += step;
+    if (middle->index < group_index)
+    {
+      first = middle;
+      ++first;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+
 /** Implementation File_Blocks_Flat_Iterator: -------------------------------*/
 
 template< typename TIndex >
@@ -336,8 +544,7 @@ bool File_Blocks_Flat_Iterator< TIndex >::is_out_of_range(const TIndex& index)
     return false;
   if (index < this->block_it->index)
     return true;
-  typename std::vector< File_Block_Index_Entry< TIndex > >::iterator
-      next_it(this->block_it);
+  File_Block_Index_Iterator< TIndex > next_it(this->block_it);
   if (++next_it == this->block_end)
     return false;
   if (!(index < next_it->index))
@@ -373,9 +580,9 @@ template< typename TIndex, typename TIterator >
 File_Blocks_Discrete_Iterator< TIndex, TIterator >&
 File_Blocks_Discrete_Iterator< TIndex, TIterator >::operator++()
 {
-  typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator it = this->block_it;
+  File_Block_Index_Iterator< TIndex > it = this->block_it;
   ++(this->block_it);
-  if (!(this->block_it->index == it->index))
+  if (this->block_it == this->block_end || !(this->block_it->index == it->index))
     find_next_block();
   return *this;
 }
@@ -397,7 +604,8 @@ void File_Blocks_Discrete_Iterator< TIndex, TIterator >::find_next_block()
       return;
     }
 
-    typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator next_block = this->block_it;
+    this->block_it = skip_blocks_below(this->block_it, this->block_end, *index_lower);
+    File_Block_Index_Iterator< TIndex > next_block = this->block_it;
     ++next_block;
 
     if (next_block == this->block_end)
@@ -493,8 +701,15 @@ void File_Blocks_Range_Iterator< TIndex, TRangeIterator >::find_next_block()
       return;
     }
 
-    typename std::vector< File_Block_Index_Entry< TIndex > >::const_iterator
-    next_block(this->block_it);
+    File_Block_Index_Iterator< TIndex > skipped_to
+        = skip_blocks_below(this->block_it, this->block_end, index_it.lower_bound());
+    if (skipped_to != this->block_it)
+    {
+      this->block_it = skipped_to;
+      index_equals_last_index = false;
+    }
+
+    File_Block_Index_Iterator< TIndex > next_block(this->block_it);
     ++next_block;
     while ((next_block != this->block_end) &&
       (!(index_it.lower_bound() < next_block->index)))
@@ -600,7 +815,7 @@ File_Blocks_Write_Iterator< TIndex, TIterator >::operator++()
 
 
 template< typename TIndex, typename TIterator >
-void File_Blocks_Write_Iterator< TIndex, TIterator >::insert_block(
+File_Block_Index_Entry< TIndex >* File_Blocks_Write_Iterator< TIndex, TIterator >::insert_block(
     File_Blocks_Index< TIndex >& index, const File_Block_Index_Entry< TIndex >& entry)
 {
   index.drop_block_array();
@@ -611,7 +826,9 @@ void File_Blocks_Write_Iterator< TIndex, TIterator >::insert_block(
   }
   else
     block_it = index.get_block_list().insert(block_it, entry);
+  File_Block_Index_Entry< TIndex >* result = &*block_it;
   ++block_it;
+  return result;
 }
 
 
@@ -733,15 +950,32 @@ File_Blocks< TIndex, TIterator, TRangeIterator >::File_Blocks
      data_file(index->get_data_file_name(),
 	       writeable ? O_RDWR|O_CREAT : O_RDONLY,
 	       S_666, "File_Blocks::File_Blocks::1"),
-     buffer(index->get_block_size() * index->get_compression_factor() * 2)      // increased buffer size for lz4
+     buffer(index->get_block_size() * index->get_compression_factor() * 2),      // increased buffer size for lz4
+     cache_file_id(block_cache_file_id(index->get_data_file_name())),
+     cache_binding(writeable ? 0 : global_block_cache_registry().find(cache_file_id)),
+     pipeline_depth(compression_method == File_Blocks_Index< TIndex >::NO_COMPRESSION ? 0
+         : 2 * block_codec_pool().get_max_threads()),
+     pending_writes(writeable && pipeline_depth > 0
+         ? new Ordered_Jobs< File_Blocks_Deflate_Job< TIndex > >(block_codec_pool()) : 0),
+     read_ahead(0)
 {}
 
 
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+File_Blocks< TIndex, TIterator, TRangeIterator >::~File_Blocks()
+{
+  // Writers flush() before the index is written. Blocks still pending here belong to a write
+  // aborted by an exception, hence they are dropped instead of written.
+  delete pending_writes;
+  delete read_ahead;
+}
+
+
 template< typename TIndex, typename TIterator, typename TRangeIterator >
 typename File_Blocks< TIndex, TIterator, TRangeIterator >::Flat_Iterator
     File_Blocks< TIndex, TIterator, TRangeIterator >::flat_begin()
 {
-  return Flat_Iterator(index->get_blocks().begin(), index->get_blocks().end());
+  return Flat_Iterator(index->blocks_begin(), index->blocks_end());
 }
 
 
@@ -749,7 +983,7 @@ template< typename TIndex, typename TIterator, typename TRangeIterator >
 typename File_Blocks< TIndex, TIterator, TRangeIterator >::Flat_Iterator
     File_Blocks< TIndex, TIterator, TRangeIterator >::flat_end()
 {
-  return Flat_Iterator(index->get_blocks().end(), index->get_blocks().end());
+  return Flat_Iterator(index->blocks_end(), index->blocks_end());
 }
 
 
@@ -759,7 +993,7 @@ typename File_Blocks< TIndex, TIterator, TRangeIterator >::Discrete_Iterator
     (const TIterator& begin, const TIterator& end)
 {
   return File_Blocks_Discrete_Iterator< TIndex, TIterator >
-      (begin, end, index->get_blocks().begin(), index->get_blocks().end());
+      (begin, end, index->blocks_begin(), index->blocks_end());
 }
 
 
@@ -767,7 +1001,7 @@ template< typename TIndex, typename TIterator, typename TRangeIterator >
 typename File_Blocks< TIndex, TIterator, TRangeIterator >::Discrete_Iterator
     File_Blocks< TIndex, TIterator, TRangeIterator >::discrete_end()
 {
-  return Discrete_Iterator(index->get_blocks().end());
+  return Discrete_Iterator(index->blocks_end());
 }
 
 
@@ -776,7 +1010,7 @@ typename File_Blocks< TIndex, TIterator, TRangeIterator >::Range_Iterator
 File_Blocks< TIndex, TIterator, TRangeIterator >::range_begin(const TRangeIterator& begin, const TRangeIterator& end)
 {
   return File_Blocks_Range_Iterator< TIndex, TRangeIterator >
-      (index->get_blocks().begin(), index->get_blocks().end(), begin, end);
+      (index->blocks_begin(), index->blocks_end(), begin, end);
 }
 
 
@@ -784,7 +1018,7 @@ template< typename TIndex, typename TIterator, typename TRangeIterator >
 typename File_Blocks< TIndex, TIterator, TRangeIterator >::Range_Iterator
     File_Blocks< TIndex, TIterator, TRangeIterator >::range_end()
 {
-  return Range_Iterator(index->get_blocks().end());
+  return Range_Iterator(index->blocks_end());
 }
 
 
@@ -811,47 +1045,38 @@ template< typename File_Blocks_Iterator >
 uint64* File_Blocks< TIndex, TIterator, TRangeIterator >::read_block
     (const File_Blocks_Iterator& it, uint64* temp_buffer, uint64* buffer_, bool check_idx) const
 {
-  data_file.seek((int64)(it.block().pos) * block_size, "File_Blocks::read_block::1");
+  Shared_Block_Cache* cache = (cache_binding && cache_binding->active) ? cache_binding->cache : 0;
+  uint32 uncompressed_size = block_size *
+      (compression_method == File_Blocks_Index< TIndex >::NO_COMPRESSION ? it.block().size : compression_factor);
+  bool from_disk = !cache
+      || !cache->lookup(cache_file_id, it.block().pos, cache_binding->version, buffer_, uncompressed_size);
 
-  if (compression_method == File_Blocks_Index< TIndex >::NO_COMPRESSION)
-    data_file.read((uint8*)buffer_, block_size * it.block().size, "File_Blocks::read_block::2");
-  else if (compression_method == File_Blocks_Index< TIndex >::ZLIB_COMPRESSION)
+  if (from_disk)
   {
-    data_file.read((uint8*)temp_buffer, block_size * it.block().size, "File_Blocks::read_block::3");
-    try
-    {
-      Zlib_Inflate().decompress(
-          temp_buffer, block_size * it.block().size, buffer_, block_size * compression_factor);
-    }
-    catch (const Zlib_Inflate::Error& e)
-    {
-      std::ostringstream out;
-      out<<"File_Blocks::read_block: Zlib_Inflate::Error "<<e.error_code
-          <<" at offset "<<((int64)(it.block().pos) * block_size + 8)<<"; "
-          <<" in_size: "<<(block_size * it.block().size)<<", "
-          <<" out_size: "<<(block_size * compression_factor);
-      throw File_Error(it.block().pos, index->get_data_file_name(), out.str());
-    }
-  }
-  else if (compression_method == File_Blocks_Index< TIndex >::LZ4_COMPRESSION)
-  {
-    data_file.read((uint8*)temp_buffer, block_size * it.block().size, "File_Blocks::read_block::4");
-    try
-    {
-      LZ4_Inflate().decompress(
-          temp_buffer, block_size * it.block().size, buffer_, block_size * compression_factor);
-    }
-    catch (const LZ4_Inflate::Error& e)
+    data_file.seek((int64)(it.block().pos) * block_size, "File_Blocks::read_block::1");
+
+    if (compression_method == File_Blocks_Index< TIndex >::NO_COMPRESSION)
+      data_file.read((uint8*)buffer_, block_size * it.block().size, "File_Blocks::read_block::2");
+    else
     {
-      std::ostringstream out;
-      out<<"File_Blocks::read_block: LZ4_Inflate::Error "<<e.error_code
-          <<" at offset "<<((int64)(it.block().pos) * block_size + 8)<<"; "
-          <<" in_size: "<<(block_size * it.block().size)<<", "
-          <<" out_size: "<<(block_size * compression_factor);
-      throw File_Error(it.block().pos, index->get_data_file_name(), out.str());
+      data_file.read((uint8*)temp_buffer, block_size * it.block().size, "File_Blocks::read_block::3");
+      inflate_block(compression_method, index->get_dictionary(), temp_buffer, block_size * it.block().size,
+          buffer_, block_size * compression_factor, index->get_data_file_name(), it.block().pos, block_size);
     }
   }
 
+  check_block(it, buffer_, check_idx);
+  if (from_disk && cache)
+    cache->insert(cache_file_id, it.block().pos, cache_binding->version, buffer_, uncompressed_size);
+  return buffer_;
+}
+
+
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+template< typename File_Blocks_Iterator >
+void File_Blocks< TIndex, TIterator, TRangeIterator >::check_block
+    (const File_Blocks_Iterator& it, uint64* buffer_, bool check_idx) const
+{
   if (check_idx && !(it.block().index ==
         TIndex(((uint8*)buffer_)+(sizeof(uint32)+sizeof(uint32)))))
   {
@@ -860,7 +1085,70 @@ uint64* File_Blocks< TIndex, TIterator, TRangeIterator >::read_block
     throw File_Error(it.block().pos, index->get_data_file_name(), out.str());
   }
   ++read_count_;
-  ++global_read_counter();
+  // Updaters read blocks from several threads at once
+  __sync_add_and_fetch(&global_read_counter(), 1);
+}
+
+
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+template< typename File_Blocks_Iterator >
+uint64* File_Blocks< TIndex, TIterator, TRangeIterator >::read_block_ahead
+    (const File_Blocks_Iterator& it, const File_Blocks_Iterator& end, bool check_idx) const
+{
+  return read_block_ahead(it, end, buffer.ptr, check_idx);
+}
+
+
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+template< typename File_Blocks_Iterator >
+uint64* File_Blocks< TIndex, TIterator, TRangeIterator >::read_block_ahead
+    (const File_Blocks_Iterator& it, const File_Blocks_Iterator& end, uint64* buffer_, bool check_idx) const
+{
+  // The shared block cache serves the reads of query processes, and writers may change the file
+  if (pipeline_depth == 0 || writeable || !block_read_ahead_enabled()
+      || (cache_binding && cache_binding->active))
+    return buffer_ == buffer.ptr ? read_block(it, check_idx) : read_block(it, buffer_, check_idx);
+
+  if (!read_ahead)
+    read_ahead = new Ordered_Jobs< File_Blocks_Inflate_Job >(block_codec_pool());
+
+  // Blocks read ahead for a different sequence of reads are useless
+  while (!read_ahead->empty() && read_ahead->front().pos != it.block().pos)
+    read_ahead->drop_front();
+
+  if (read_ahead->empty())
+    buffer_ == buffer.ptr ? read_block(it, check_idx) : read_block(it, buffer_, check_idx);
+  else
+  {
+    File_Blocks_Inflate_Job* job = read_ahead->pop_front();
+    memcpy(buffer_, job->uncompressed.ptr, block_size * compression_factor);
+    delete job;
+    check_block(it, buffer_, check_idx);
+  }
+
+  File_Blocks_Iterator next = it;
+  ++next;
+  for (uint i = 0; i < read_ahead->size() && !(next == end); ++i)
+    ++next;
+  while (read_ahead->size() < pipeline_depth && !(next == end))
+  {
+    File_Blocks_Inflate_Job* job = new File_Blocks_Inflate_Job(next.block().pos, next.block().size,
+        block_size, compression_factor, compression_method, index->get_dictionary(),
+        index->get_data_file_name());
+    try
+    {
+      data_file.seek((int64)(job->pos) * block_size, "File_Blocks::read_block::4");
+      data_file.read((uint8*)job->compressed.ptr, block_size * job->size, "File_Blocks::read_block::5");
+    }
+    catch (...)
+    {
+      delete job;
+      throw;
+    }
+    read_ahead->push_back(job);
+    ++next;
+  }
+
   return buffer_;
 }
 
@@ -985,7 +1273,16 @@ void File_Blocks< TIndex, TIterator, TRangeIterator >::write_block(uint64* buf,
   {
     payload = buffer.ptr;
     block_count = (
-        Zlib_Deflate(1).compress(buf, payload_size, payload, block_size * compression_factor)
+        Zlib_Deflate(zlib_level(index->get_compression_level()))
+            .compress(buf, payload_size, payload, block_size * compression_factor)
+        - 1) / block_size + 1;
+  }
+  else if (compression_method == File_Blocks_Index< TIndex >::ZSTD_COMPRESSION)
+  {
+    payload = buffer.ptr;
+    block_count = (
+        Zstd_Deflate(index->get_compression_level(), index->get_dictionary())
+            .compress(buf, payload_size, payload, block_size * compression_factor * 2)
         - 1) / block_size + 1;
   }
   else if (compression_method == File_Blocks_Index< TIndex >::LZ4_COMPRESSION)
@@ -1003,6 +1300,55 @@ void File_Blocks< TIndex, TIterator, TRangeIterator >::write_block(uint64* buf,
 }
 
 
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+void File_Blocks< TIndex, TIterator, TRangeIterator >::write_block_async
+    (uint64* buf, uint32 payload_size, File_Block_Index_Entry< TIndex >* entry)
+{
+  pending_writes->push_back(new File_Blocks_Deflate_Job< TIndex >(
+      buf, block_size * compression_factor, payload_size, compression_method,
+      index->get_compression_level(), index->get_dictionary(),
+      index->get_data_file_name(), entry));
+  while (pending_writes->size() > pipeline_depth)
+    retire_write();
+}
+
+
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+void File_Blocks< TIndex, TIterator, TRangeIterator >::retire_write()
+{
+  File_Blocks_Deflate_Job< TIndex >* job = pending_writes->pop_front();
+  try
+  {
+    uint32 block_count = (job->compressed_size - 1) / block_size + 1;
+    memset(((uint8*)job->compressed.ptr) + job->compressed_size, 0, block_size * block_count - job->compressed_size);
+    uint32 pos = allocate_block(block_count);
+
+    data_file.seek(((int64)pos)*block_size, "File_Blocks::write_block::3");
+    data_file.write((uint8*)job->compressed.ptr, block_size * block_count, "File_Blocks::write_block::4");
+
+    job->entry->pos = pos;
+    job->entry->size = block_count;
+  }
+  catch (...)
+  {
+    delete job;
+    throw;
+  }
+  delete job;
+}
+
+
+template< typename TIndex, typename TIterator, typename TRangeIterator >
+void File_Blocks< TIndex, TIterator, TRangeIterator >::flush()
+{
+  if (pending_writes)
+  {
+    while (!pending_writes->empty())
+      retire_write();
+  }
+}
+
+
 template< typename TIndex, typename TIterator, typename TRangeIterator >
 typename File_Blocks< TIndex, TIterator, TRangeIterator >::Write_Iterator
     File_Blocks< TIndex, TIterator, TRangeIterator >::insert_block
@@ -1021,14 +1367,18 @@ typename File_Blocks< TIndex, TIterator, TRangeIterator >::Write_Iterator
     return it;
 
   uint32 data_size = payload_size == 0 ? 0 : (payload_size - 1) / block_size + 1;
-  uint32 pos;
+  uint32 pos = 0;
   if (payload_size < block_size * compression_factor)
     memset(((uint8*)buf) + payload_size, 0, block_size * compression_factor - payload_size);
-  write_block(buf, payload_size, data_size, pos);
+  if (!pending_writes)
+    write_block(buf, payload_size, data_size, pos);
 
   Write_Iterator return_it = it;
-  return_it.insert_block(*index, File_Block_Index_Entry< TIndex >(block_idx, pos, data_size, max_keysize));
+  File_Block_Index_Entry< TIndex >* entry = return_it.insert_block(
+      *index, File_Block_Index_Entry< TIndex >(block_idx, pos, data_size, max_keysize));
   return_it.is_empty = it.is_empty;
+  if (pending_writes)
+    write_block_async(buf, payload_size, entry);
   return return_it;
 }
 
@@ -1054,9 +1404,13 @@ typename File_Blocks< TIndex, TIterator, TRangeIterator >::Write_Iterator
   if (payload_size < block_size * compression_factor)
     memset(((uint8*)buf) + payload_size, 0, block_size * compression_factor - payload_size);
   uint32 pos = 0;
-  write_block(buf, payload_size, data_size, pos);
+  if (!pending_writes)
+    write_block(buf, payload_size, data_size, pos);
 
-  it.set_block(File_Block_Index_Entry< TIndex >(block_idx, pos, data_size, max_keysize));
+  File_Block_Index_Entry< TIndex >* entry
+      = it.set_block(File_Block_Index_Entry< TIndex >(block_idx, pos, data_size, max_keysize));
+  if (pending_writes)
+    write_block_async(buf, payload_size, entry);
   return it;
 }
 
@@ -1078,4 +1432,28 @@ void File_Blocks< TIndex, TIterator, TRangeIterator >::erase_blocks(
 }
 
 
+
+/** Implementation of File_Blocks_Deflate_Job: ----------------------------*/
+
+template< typename TIndex >
+void File_Blocks_Deflate_Job< TIndex >::run()
+{
+  try
+  {
+    if (compression_method == File_Blocks_Index_Base::ZLIB_COMPRESSION)
+      compressed_size = Zlib_Deflate(zlib_level(compression_level))
+          .compress(uncompressed.ptr, payload_size, compressed.ptr, buffer_size);
+    else if (compression_method == File_Blocks_Index_Base::ZSTD_COMPRESSION)
+      compressed_size = Zstd_Deflate(compression_level, dictionary)
+          .compress(uncompressed.ptr, payload_size, compressed.ptr, buffer_size * 2);
+    else
+      compressed_size = LZ4_Deflate().compress(uncompressed.ptr, payload_size, compressed.ptr, buffer_size * 2);
+  }
+  catch (const std::runtime_error& e)
+  {
+    throw File_Error(0, file_name, std::string("File_Blocks::write_block: ") + e.what());
+  }
+  uncompressed.clear();
+}
+
 #endif
@@ -153,6 +153,11 @@ struct Test_File : File_Properties
     return File_Blocks_Index< IntIndex >::NO_COMPRESSION;
   }
 
+  int get_compression_level() const
+  {
+    return 0;
+  }
+
   uint32 get_map_block_size() const
   {
     return 16;
@@ -244,6 +249,11 @@ struct Variable_Block_Test_File : File_Properties
     return File_Blocks_Index< IntIndex >::NO_COMPRESSION;
   }
 
+  int get_compression_level() const
+  {
+    return 0;
+  }
+
   uint32 get_map_block_size() const
   {
     return 16;
@@ -339,6 +349,11 @@ struct Compressed_Test_File : File_Properties
     return File_Blocks_Index< IntIndex >::NO_COMPRESSION;
   }
 
+  int get_compression_level() const
+  {
+    return 0;
+  }
+
   uint32 get_map_block_size() const
   {
     return 4*1024;
@@ -793,6 +808,8 @@ int main(int argc, char* args[])
       std::cout<<"Using zlib compression for bin files.\n";
     else if (tf.get_compression_method() == File_Blocks_Index< IntIndex >::LZ4_COMPRESSION)
       std::cout<<"Using lz4 compression for bin files.\n";
+    else if (tf.get_compression_method() == File_Blocks_Index< IntIndex >::ZSTD_COMPRESSION)
+      std::cout<<"Using zstd compression for bin files.\n";
 
     if (tf.get_map_compression_method() == File_Blocks_Index< IntIndex >::NO_COMPRESSION)
       std::cout<<"Using no compression for map files.\n";
@@ -800,6 +817,8 @@ int main(int argc, char* args[])
       std::cout<<"Using zlib compression for map files.\n";
     else if (tf.get_map_compression_method() == File_Blocks_Index< IntIndex >::LZ4_COMPRESSION)
       std::cout<<"Using lz4 compression for map files.\n";
+    else if (tf.get_map_compression_method() == File_Blocks_Index< IntIndex >::ZSTD_COMPRESSION)
+      std::cout<<"Using zstd compression for map files.\n";
   }
 
   if ((test_to_execute == "") || (test_to_execute == "1"))
@@ -1909,6 +1928,7 @@ int main(int argc, char* args[])
       indices.push_back(IntIndex(i));
     max_keysize = prepare_block(buf, indices);
     blocks.insert_block(blocks.write_end(), buf, max_keysize);
+    blocks.flush();
 
     free(buf);
   }
@@ -1927,5 +1947,77 @@ int main(int argc, char* args[])
   remove((BASE_DIRECTORY
       + Compressed_Test_File().get_file_name_trunk() + Compressed_Test_File().get_data_suffix()).c_str());
 
+  data_fd = open64
+      ((BASE_DIRECTORY
+        + Test_File().get_file_name_trunk() + Test_File().get_data_suffix()).c_str(),
+       O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+  close(data_fd);
+  index_fd = open64
+      ((BASE_DIRECTORY
+        + Test_File().get_file_name_trunk() + Test_File().get_data_suffix()
+        + Test_File().get_index_suffix()).c_str(),
+       O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+  close(index_fd);
+  if ((test_to_execute == "") || (test_to_execute == "31"))
+  {
+    std::cout<<"** Test the behaviour for an index file with bad entries\n";
+    try
+    {
+      Nonsynced_Transaction transaction(true, false, BASE_DIRECTORY, "");
+      Test_File tf;
+      File_Blocks< IntIndex, IntIterator, IntRangeIterator > blocks
+          (transaction.data_index(&tf));
+      std::list< IntIndex > indices;
+
+      uint64* buf = (uint64*)aligned_alloc(8, Test_File().get_block_size());
+      indices.push_back(IntIndex(10));
+      uint32 max_keysize = prepare_block(buf, indices);
+      blocks.insert_block(blocks.write_end(), buf, max_keysize);
+      indices.clear();
+      indices.push_back(IntIndex(20));
+      max_keysize = prepare_block(buf, indices);
+      blocks.insert_block(blocks.write_end(), buf, max_keysize);
+      free(buf);
+    }
+    catch (File_Error e)
+    {
+      std::cout<<"File error catched: "
+          <<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+      std::cout<<"(This is unexpected)\n";
+    }
+    read_test();
+
+    // The first entry follows the 8 byte header and starts with its position and its size.
+    std::string index_file_name = BASE_DIRECTORY
+        + Test_File().get_file_name_trunk() + Test_File().get_data_suffix() + Test_File().get_index_suffix();
+    uint32 offsets[] = { 8, 12, 12 };
+    uint32 bad_values[] = { 1000, 0, 1000 };
+    for (uint i = 0; i < sizeof(offsets)/sizeof(offsets[0]); ++i)
+    {
+      int fd = open64(index_file_name.c_str(), O_RDWR);
+      uint32 good_value = 0;
+      pread64(fd, &good_value, 4, offsets[i]);
+      pwrite64(fd, &bad_values[i], 4, offsets[i]);
+      close(fd);
+
+      std::cout<<"Set "<<(offsets[i] == 8 ? "position" : "size")
+          <<" of the first entry to "<<bad_values[i]<<'\n';
+      read_test();
+
+      fd = open64(index_file_name.c_str(), O_RDWR);
+      pwrite64(fd, &good_value, 4, offsets[i]);
+      close(fd);
+    }
+  }
+
+  remove((BASE_DIRECTORY
+      + Test_File().get_file_name_trunk() + Test_File().get_data_suffix()
+      + Test_File().get_index_suffix()).c_str());
+  remove((BASE_DIRECTORY
+      + Test_File().get_file_name_trunk() + Test_File().get_data_suffix()
+      + Test_File().get_shadow_suffix()).c_str());
+  remove((BASE_DIRECTORY
+      + Test_File().get_file_name_trunk() + Test_File().get_data_suffix()).c_str());
+
   return 0;
 }
@@ -20,7 +20,9 @@
 #define DE__OSM3S___TEMPLATE_DB__FILE_BLOCKS_INDEX_H
 
 #include "types.h"
+#include "zstd_wrapper.h"
 
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -51,6 +53,137 @@ struct File_Block_Index_Entry
 };
 
 
+/** Iterates over the block entries of an index. The entries either come from an array of
+ * decoded entries or are decoded on the fly from the memory mapped index file of a read-only
+ * index. In the latter case no entry is decoded unless it is visited, and every entry is
+ * checked against the size of the data file when it is decoded. */
+template< class TIndex >
+struct File_Block_Index_Iterator
+{
+  typedef File_Block_Index_Entry< TIndex > Entry;
+
+  explicit File_Block_Index_Iterator(const Entry* entry_ptr_)
+    : entry_ptr(entry_ptr_), raw_ptr(0), stride(0), raw(false), block_count(0), file_name(0),
+      decoded_valid(false) {}
+
+  // stride is the size of each entry in the index file or zero if the entries vary in size.
+  // block_count is the number of blocks in the data file, file_name is used in error messages.
+  File_Block_Index_Iterator(const uint8* raw_ptr_, uint32 stride_,
+      uint32 block_count_, const std::string* file_name_)
+    : entry_ptr(0), raw_ptr(raw_ptr_), stride(stride_), raw(true),
+      block_count(block_count_), file_name(file_name_), decoded_valid(false) {}
+
+  File_Block_Index_Iterator(const File_Block_Index_Iterator& rhs)
+    : entry_ptr(rhs.entry_ptr), raw_ptr(rhs.raw_ptr), stride(rhs.stride),
+      raw(rhs.raw), block_count(rhs.block_count), file_name(rhs.file_name), decoded_valid(false) {}
+
+  ~File_Block_Index_Iterator() { clear_decoded(); }
+
+  File_Block_Index_Iterator& operator=(const File_Block_Index_Iterator& rhs)
+  {
+    if (this == &rhs)
+      return *this;
+    clear_decoded();
+    entry_ptr = rhs.entry_ptr;
+    raw_ptr = rhs.raw_ptr;
+    stride = rhs.stride;
+    raw = rhs.raw;
+    block_count = rhs.block_count;
+    file_name = rhs.file_name;
+    return *this;
+  }
+
+  const Entry& operator*() const { return raw ? decoded() : *entry_ptr; }
+  const Entry* operator->() const { return &operator*(); }
+
+  File_Block_Index_Iterator& operator++()
+  {
+    if (raw)
+    {
+      clear_decoded();
+      raw_ptr += stride > 0 ? stride : 12 + TIndex::size_of((void*)(raw_ptr + 12));
+    }
+    else
+      ++entry_ptr;
+    return *this;
+  }
+
+  bool operator==(const File_Block_Index_Iterator& rhs) const
+  { return raw ? raw_ptr == rhs.raw_ptr : entry_ptr == rhs.entry_ptr; }
+  bool operator!=(const File_Block_Index_Iterator& rhs) const { return !operator==(rhs); }
+
+  // Only if random_access() is true the following three operations are available.
+  bool random_access() const { return !raw || stride > 0; }
+  int64 operator-(const File_Block_Index_Iterator& rhs) const
+  { return raw ? (raw_ptr - rhs.raw_ptr)/stride : entry_ptr - rhs.entry_ptr; }
+  File_Block_Index_Iterator& operator+=(int64 count)
+  {
+    if (raw)
+    {
+      clear_decoded();
+      raw_ptr += count * stride;
+    }
+    else
+      entry_ptr += count;
+    return *this;
+  }
+
+private:
+  const Entry* entry_ptr;
+  const uint8* raw_ptr;
+  uint32 stride;
+  bool raw;
+  uint32 block_count;
+  const std::string* file_name;
+
+  // Storage for the entry decoded from the index file. The entry is constructed in place
+  // to avoid a heap allocation per visited entry.
+  mutable bool decoded_valid;
+  mutable uint64 decoded_buf[(sizeof(Entry) + sizeof(uint64) - 1)/sizeof(uint64)];
+
+  const Entry& decoded() const
+  {
+    if (!decoded_valid)
+    {
+      check_entry(raw_ptr, block_count, *file_name);
+      new (decoded_buf) Entry(TIndex((void*)(raw_ptr + 12)),
+          *(uint32*)raw_ptr, *(uint32*)(raw_ptr + 4), *(uint32*)(raw_ptr + 8));
+      decoded_valid = true;
+    }
+    return *(const Entry*)decoded_buf;
+  }
+
+  void clear_decoded()
+  {
+    if (decoded_valid)
+      ((Entry*)decoded_buf)->~Entry();
+    decoded_valid = false;
+  }
+
+public:
+  // Throws if the entry at raw_ptr refers to blocks outside the data file.
+  static void check_entry(const uint8* raw_ptr, uint32 block_count, const std::string& file_name)
+  {
+    uint32 pos = *(uint32*)raw_ptr;
+    uint32 size = *(uint32*)(raw_ptr + 4);
+    if (pos >= block_count)
+      throw File_Error(0, file_name, "File_Blocks_Index: bad pos in index file");
+    if (size == 0 || (uint64)pos + size > block_count)
+      throw File_Error(0, file_name, "File_Blocks_Index: bad size in index file");
+  }
+};
+
+
+/** If the size of every index entry of this type is the same then specializations
+ * of this template shall return this size. This allows to binary search the memory mapped
+ * index file. */
+template< class TIndex >
+struct File_Block_Index_Fixed_Size
+{
+  static uint32 value() { return 0; }
+};
+
+
 template< class TIndex >
 struct File_Blocks_Index : public File_Blocks_Index_Base
 {
@@ -58,7 +191,7 @@ public:
   File_Blocks_Index(const File_Properties& file_prop,
 	      bool writeable, bool use_shadow,
 	      const std::string& db_dir, const std::string& file_name_extension,
-              int compression_method_ = USE_DEFAULT);
+              int compression_method_ = USE_DEFAULT, int compression_level_ = USE_DEFAULT);
   virtual ~File_Blocks_Index();
   bool writeable() const { return (empty_index_file_name != ""); }
   const std::string& file_name_extension() const { return file_name_extension_; }
@@ -67,6 +200,9 @@ public:
   uint64 get_block_size() const { return block_size_; }
   uint32 get_compression_factor() const { return compression_factor; }
   uint32 get_compression_method() const { return compression_method; }
+  int get_compression_level() const { return compression_level; }
+  // Null unless the file is compressed with zstd and has a dictionary
+  const Zstd_Dictionary* get_dictionary() const { return dictionary; }
   virtual bool empty() const { return file_size == 0; }
 
   std::list< File_Block_Index_Entry< TIndex > >& get_block_list()
@@ -79,7 +215,7 @@ public:
   }
   const std::vector< File_Block_Index_Entry< TIndex > >& get_blocks()
   {
-    if (index_buf.ptr)
+    if (index_buf.ptr || mapped_ptr)
       init_blocks();
     if (block_array.empty() && !block_list.empty())
       block_array.assign(block_list.begin(), block_list.end());
@@ -91,6 +227,21 @@ public:
       init_void_blocks();
     return void_blocks;
   }
+  // Read-only indexes iterate directly over the memory mapped index file.
+  File_Block_Index_Iterator< TIndex > blocks_begin()
+  {
+    if (mapped_ptr)
+      return File_Block_Index_Iterator< TIndex >(mapped_ptr + 8, mapped_stride, block_count, &index_file_name);
+    return File_Block_Index_Iterator< TIndex >(get_blocks().empty() ? 0 : &block_array[0]);
+  }
+  File_Block_Index_Iterator< TIndex > blocks_end()
+  {
+    if (mapped_ptr)
+      return File_Block_Index_Iterator< TIndex >(
+          mapped_ptr + index_size, mapped_stride, block_count, &index_file_name);
+    return File_Block_Index_Iterator< TIndex >
+        (get_blocks().empty() ? 0 : &block_array[0] + block_array.size());
+  }
   void drop_block_array()
   {
     if (block_list.empty() && !block_array.empty())
@@ -98,10 +249,12 @@ public:
     block_array.clear();
   }
 
-  static const int FILE_FORMAT_VERSION = 7560;
+  // Since 7561, objects may be stored in compact formats that older versions cannot read.
+  static const int FILE_FORMAT_VERSION = 7561;
   static const int NO_COMPRESSION = 0;
   static const int ZLIB_COMPRESSION = 1;
   static const int LZ4_COMPRESSION = 2;
+  static const int ZSTD_COMPRESSION = 3;
 
 private:
   std::string index_file_name;
@@ -109,6 +262,8 @@ private:
   std::string data_file_name;
   std::string file_name_extension_;
   Void_Pointer< uint8 > index_buf;
+  uint8* mapped_ptr;
+  uint32 mapped_stride;
   uint64 file_size;
   uint32 index_size;
   std::vector< File_Block_Index_Entry< TIndex > > block_array;
@@ -119,8 +274,11 @@ private:
   uint64 block_size_;
   uint32 compression_factor;
   int compression_method;
+  int compression_level;
+  Zstd_Dictionary* dictionary;
 
-  void init_structure_params();
+  void init_structure_params(const uint8* header);
+  void check_mapped_blocks();
   void init_blocks();
   void init_void_blocks();
 
@@ -133,13 +291,56 @@ template< class TIndex >
 std::vector< bool > get_data_index_footprint(const File_Properties& file_prop,
 					std::string db_dir);
 
+
+/** A zstd dictionary is stored next to the data file and applies to all blocks of that file.
+    Hence it can only be added when the data file is written from scratch. */
+inline std::string dictionary_file_name(const std::string& data_file_name)
+{
+  return data_file_name + ".dict";
+}
+
+// Returns null if there is no dictionary. The caller takes ownership.
+inline Zstd_Dictionary* load_dictionary(const std::string& file_name, int compression_level)
+{
+  std::string content;
+  try
+  {
+    Raw_File dict_file(file_name, O_RDONLY, S_666, "load_dictionary:1");
+    content.resize(dict_file.size("load_dictionary:2"));
+    if (content.empty())
+      return 0;
+    dict_file.read(&content[0], content.size(), "load_dictionary:3");
+  }
+  catch (const File_Error& e)
+  {
+    if (e.error_number != 2)
+      throw;
+    return 0;
+  }
+
+  try
+  {
+    return new Zstd_Dictionary(content, compression_level);
+  }
+  catch (const std::runtime_error& e)
+  {
+    throw File_Error(0, file_name, std::string("load_dictionary: ") + e.what());
+  }
+}
+
+inline void save_dictionary(const std::string& file_name, const std::string& content)
+{
+  Raw_File dict_file(file_name, O_RDWR|O_CREAT|O_TRUNC, S_666, "save_dictionary:1");
+  dict_file.write((void*)content.data(), content.size(), "save_dictionary:2");
+}
+
 /** Implementation File_Blocks_Index: ---------------------------------------*/
 
 template< class TIndex >
 File_Blocks_Index< TIndex >::File_Blocks_Index
     (const File_Properties& file_prop, bool writeable, bool use_shadow,
      const std::string& db_dir, const std::string& file_name_extension,
-     int compression_method_) :
+     int compression_method_, int compression_level_) :
      index_file_name(db_dir + file_prop.get_file_name_trunk()
          + file_name_extension + file_prop.get_data_suffix()
          + file_prop.get_index_suffix()
@@ -150,13 +351,15 @@ File_Blocks_Index< TIndex >::File_Blocks_Index
      data_file_name(db_dir + file_prop.get_file_name_trunk()
          + file_name_extension + file_prop.get_data_suffix()),
      file_name_extension_(file_name_extension),
-     index_buf(0), file_size(0), index_size(0),
+     index_buf(0), mapped_ptr(0), mapped_stride(0), file_size(0), index_size(0),
      void_blocks_initialized(false),
      block_size_(file_prop.get_block_size()), // can be overwritten by index file
      compression_factor(file_prop.get_compression_factor()), // can be overwritten by index file
      compression_method(compression_method_ == USE_DEFAULT ?
         file_prop.get_compression_method() : compression_method_), // can be overwritten by index file
-     block_count(0)
+     compression_level(compression_level_ == USE_DEFAULT ?
+        file_prop.get_compression_level() : compression_level_),
+     dictionary(0), block_count(0)
 {
   try
   {
@@ -174,10 +377,22 @@ File_Blocks_Index< TIndex >::File_Blocks_Index
     Raw_File source_file(index_file_name, O_RDONLY, S_666,
 			 "File_Blocks_Index::File_Blocks_Index::3");
 
-    // read index file
     index_size = source_file.size("File_Blocks_Index::File_Blocks_Index::4");
-    index_buf.resize(index_size);
-    source_file.read(index_buf.ptr, index_size, "File_Blocks_Index::File_Blocks_Index::5");
+    if (!writeable && file_name_extension != ".legacy" && index_size > 8)
+    {
+      // The dispatcher replaces index files only by renaming, hence the mapping stays valid
+      // and unchanged for the lifetime of this object.
+      void* ptr = mmap(0, index_size, PROT_READ, MAP_SHARED, source_file.fd(), 0);
+      if (ptr == MAP_FAILED)
+        throw File_Error(errno, index_file_name, "File_Blocks_Index::File_Blocks_Index::mmap");
+      mapped_ptr = (uint8*)ptr;
+    }
+    else
+    {
+      // read index file
+      index_buf.resize(index_size);
+      source_file.read(index_buf.ptr, index_size, "File_Blocks_Index::File_Blocks_Index::5");
+    }
   }
   catch (File_Error e)
   {
@@ -186,7 +401,16 @@ File_Blocks_Index< TIndex >::File_Blocks_Index
     index_buf.resize(0);
   }
 
-  init_structure_params();
+  if (mapped_ptr)
+  {
+    init_structure_params(mapped_ptr);
+    check_mapped_blocks();
+  }
+  else
+    init_structure_params(index_buf.ptr);
+
+  if (compression_method == ZSTD_COMPRESSION)
+    dictionary = load_dictionary(dictionary_file_name(data_file_name), compression_level);
 
   if (empty_index_file_name != "")
     init_void_blocks();
@@ -194,21 +418,21 @@ File_Blocks_Index< TIndex >::File_Blocks_Index
 
 
 template< class TIndex >
-void File_Blocks_Index< TIndex >::init_structure_params()
+void File_Blocks_Index< TIndex >::init_structure_params(const uint8* header)
 {
-  if (index_buf.ptr)
+  if (header)
   {
     if (file_name_extension_ != ".legacy")
     {
-      if (*(int32*)index_buf.ptr != FILE_FORMAT_VERSION && *(int32*)index_buf.ptr != 7512)
+      if (*(int32*)header != FILE_FORMAT_VERSION && *(int32*)header != 7560 && *(int32*)header != 7512)
 	throw File_Error(0, index_file_name, "File_Blocks_Index: Unsupported index file format version");
-      block_size_ = 1ull<<*(uint8*)(index_buf.ptr + 4);
+      block_size_ = 1ull<<*(uint8*)(header + 4);
       if (!block_size_)
         throw File_Error(0, index_file_name, "File_Blocks_Index: Illegal block size");
-      compression_factor = 1u<<*(uint8*)(index_buf.ptr + 5);
+      compression_factor = 1u<<*(uint8*)(header + 5);
       if (!compression_factor || compression_factor > block_size_)
         throw File_Error(0, index_file_name, "File_Blocks_Index: Illegal compression factor");
-      compression_method = *(uint16*)(index_buf.ptr + 6);
+      compression_method = *(uint16*)(header + 6);
     }
     if (file_size % block_size_)
       throw File_Error(0, index_file_name, "File_Blocks_Index: Data file size does not match block size");
@@ -217,9 +441,48 @@ void File_Blocks_Index< TIndex >::init_structure_params()
 }
 
 
+template< class TIndex >
+void File_Blocks_Index< TIndex >::check_mapped_blocks()
+{
+  // With entries of fixed size the layout is checked here and every entry is checked
+  // by the iterator when it is decoded. Otherwise, the entries must be visited anyway
+  // to find their boundaries, hence they are all checked here.
+  uint32 fixed_size = File_Block_Index_Fixed_Size< TIndex >::value();
+  if (fixed_size > 0)
+  {
+    if ((index_size - 8) % (12 + fixed_size) != 0)
+      throw File_Error(0, index_file_name, "File_Blocks_Index: bad size of index file");
+    mapped_stride = 12 + fixed_size;
+    return;
+  }
+
+  uint32 pos = 8;
+  while (pos < index_size)
+  {
+    if (index_size - pos < 12 + sizeof(uint32))
+      throw File_Error(0, index_file_name, "File_Blocks_Index: bad size of index file");
+    File_Block_Index_Iterator< TIndex >::check_entry(mapped_ptr + pos, block_count, index_file_name);
+    pos += 12 + TIndex::size_of((void*)(mapped_ptr + pos + 12));
+  }
+  if (pos != index_size)
+    throw File_Error(0, index_file_name, "File_Blocks_Index: bad size of index file");
+}
+
+
 template< class TIndex >
 void File_Blocks_Index< TIndex >::init_blocks()
 {
+  if (mapped_ptr)
+  {
+    // Someone needs the decoded entries. This is not the fast path.
+    if (block_array.empty())
+    {
+      for (File_Block_Index_Iterator< TIndex > it = blocks_begin(); it != blocks_end(); ++it)
+        block_array.push_back(*it);
+    }
+    return;
+  }
+
   if (index_buf.ptr)
   {
     if (file_name_extension_ == ".legacy")
@@ -275,7 +538,7 @@ void File_Blocks_Index< TIndex >::init_blocks()
 template< class TIndex >
 void File_Blocks_Index< TIndex >::init_void_blocks()
 {
-  if (index_buf.ptr)
+  if (index_buf.ptr || mapped_ptr)
     init_blocks();
 
   bool empty_index_file_used = false;
@@ -334,6 +597,11 @@ void File_Blocks_Index< TIndex >::init_void_blocks()
 template< class TIndex >
 File_Blocks_Index< TIndex >::~File_Blocks_Index()
 {
+  delete dictionary;
+
+  if (mapped_ptr)
+    munmap(mapped_ptr, index_size);
+
   if (!writeable())
     return;
 
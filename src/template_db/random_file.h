@@ -23,6 +23,7 @@
 #include "types.h"
 #include "lz4_wrapper.h"
 #include "zlib_wrapper.h"
+#include "zstd_wrapper.h"
 
 #include <unistd.h>
 
@@ -128,11 +129,19 @@ void Random_File< Key, Value >::move_cache_window(uint32 pos)
     if (index->get_compression_method() == File_Blocks_Index_Base::ZLIB_COMPRESSION)
     {
       target = buffer.ptr;
-      uint32 compressed_size = Zlib_Deflate(1)
+      uint32 compressed_size = Zlib_Deflate(zlib_level(index->get_compression_level()))
           .compress(cache.ptr, block_size * compression_factor, target, block_size * index->get_compression_factor());
       data_size = (compressed_size - 1) / block_size + 1;
       zero_padding((uint8*)target + compressed_size, block_size * data_size - compressed_size);
     }
+    else if (index->get_compression_method() == File_Blocks_Index_Base::ZSTD_COMPRESSION)
+    {
+      target = buffer.ptr;
+      uint32 compressed_size = Zstd_Deflate(index->get_compression_level())
+          .compress(cache.ptr, block_size * compression_factor, target, block_size * index->get_compression_factor() * 2);
+      data_size = (compressed_size - 1) / block_size + 1;
+      zero_padding((uint8*)target + compressed_size, block_size * data_size - compressed_size);
+    }
     else if (index->get_compression_method() == File_Blocks_Index_Base::LZ4_COMPRESSION)
     {
       target = buffer.ptr;
@@ -176,6 +185,12 @@ void Random_File< Key, Value >::move_cache_window(uint32 pos)
       Zlib_Inflate().decompress
           (buffer.ptr, block_size * index->get_blocks()[pos].size, cache.ptr, block_size * index->get_compression_factor());
     }
+    else if (index->get_compression_method() == File_Blocks_Index_Base::ZSTD_COMPRESSION)
+    {
+      val_file.read(buffer.ptr, block_size * index->get_blocks()[pos].size, "Random_File:27");
+      Zstd_Inflate().decompress
+          (buffer.ptr, block_size * index->get_blocks()[pos].size, cache.ptr, block_size * index->get_compression_factor());
+    }
     else if (index->get_compression_method() == File_Blocks_Index_Base::LZ4_COMPRESSION)
     {
       val_file.read(buffer.ptr, block_size * index->get_blocks()[pos].size, "Random_File:26");
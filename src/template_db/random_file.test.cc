@@ -129,6 +129,11 @@ struct Test_File : File_Properties
     return 0;
   }
 
+  int get_compression_level() const
+  {
+    return 0;
+  }
+
   uint32 get_map_block_size() const
   {
     return 16*IntIndex::max_size_of();
@@ -50,7 +50,8 @@ public:
   Random_File_Index(const File_Properties& file_prop,
 	      bool writeable, bool use_shadow,
 	      const std::string& db_dir, const std::string& file_name_extension,
-              int compression_method_ = File_Blocks_Index_Base::USE_DEFAULT);
+              int compression_method_ = File_Blocks_Index_Base::USE_DEFAULT,
+              int compression_level_ = File_Blocks_Index_Base::USE_DEFAULT);
   ~Random_File_Index();
   bool writeable() const { return (empty_index_file_name != ""); }
   const std::string& file_name_extension() const { return file_name_extension_; }
@@ -59,6 +60,7 @@ public:
   uint64 get_block_size() const { return block_size_; }
   uint32 get_compression_factor() const { return compression_factor; }
   uint32 get_compression_method() const { return compression_method; }
+  int get_compression_level() const { return compression_level; }
 
   std::vector< Random_File_Index_Entry >& get_blocks()
   {
@@ -87,6 +89,7 @@ private:
   uint64 block_size_;
   uint32 compression_factor;
   int compression_method;
+  int compression_level;
 
   void init_void_blocks();
 
@@ -107,7 +110,8 @@ static const int VOID_BLOCK_ENTRY_SIZE = 8;
 inline Random_File_Index::Random_File_Index
     (const File_Properties& file_prop,
      bool writeable, bool use_shadow,
-     const std::string& db_dir, const std::string& file_name_extension, int compression_method_) :
+     const std::string& db_dir, const std::string& file_name_extension,
+     int compression_method_, int compression_level_) :
     npos(std::numeric_limits< uint32 >::max()),
     index_file_name(db_dir + file_prop.get_file_name_trunk()
         + file_prop.get_id_suffix()
@@ -124,6 +128,8 @@ inline Random_File_Index::Random_File_Index
     compression_factor(file_prop.get_map_compression_factor()),
     compression_method(compression_method_ == File_Blocks_Index_Base::USE_DEFAULT ?
         file_prop.get_map_compression_method() : compression_method_),
+    compression_level(compression_level_ == File_Blocks_Index_Base::USE_DEFAULT ?
+        file_prop.get_compression_level() : compression_level_),
     block_count(0)
 {
   uint64 file_size = 0;
@@ -160,7 +166,7 @@ inline Random_File_Index::Random_File_Index
       uint16 guessed_compression_method = *(uint16*)(index_buf.ptr + 6);
       uint32 guessed_compression_factor = 1u<<compression_exp;
 
-      if (block_exp < 32 && compression_exp < 32 && guessed_compression_method < 3)
+      if (block_exp < 32 && compression_exp < 32 && guessed_compression_method <= File_Blocks_Index_Base::ZSTD_COMPRESSION)
       {
         block_count = file_size / (1ull<<block_exp);
 
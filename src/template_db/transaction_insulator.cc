@@ -112,16 +112,29 @@ void Transaction_Insulator::read_finished(pid_t pid)
 }
 
 
+// Replaces dest by a copy of source. Processes that have dest still open or memory mapped
+// keep seeing the old content because dest is replaced by rename.
+void replace_by_copy(const std::string& source, const std::string& dest)
+{
+  if (!file_exists(source))
+    return;
+
+  copy_file(source, dest + ".next");
+  if (rename((dest + ".next").c_str(), dest.c_str()) == -1)
+    throw File_Error(errno, dest, "replace_by_copy:1");
+}
+
+
 void Transaction_Insulator::copy_shadows_to_mains()
 {
   for (std::vector< File_Properties* >::const_iterator it(controlled_files.begin());
       it != controlled_files.end(); ++it)
   {
-      copy_file(db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix()
+      replace_by_copy(db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix()
                 + (*it)->get_index_suffix() + (*it)->get_shadow_suffix(),
 		db_dir() + (*it)->get_file_name_trunk() + (*it)->get_data_suffix()
 		+ (*it)->get_index_suffix());
-      copy_file(db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix()
+      replace_by_copy(db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix()
                 + (*it)->get_index_suffix() + (*it)->get_shadow_suffix(),
 		db_dir() + (*it)->get_file_name_trunk() + (*it)->get_id_suffix()
 		+ (*it)->get_index_suffix());
@@ -80,6 +80,7 @@ struct File_Blocks_Index_Base
   static const int NO_COMPRESSION = 0;
   static const int ZLIB_COMPRESSION = 1;
   static const int LZ4_COMPRESSION = 2;
+  static const int ZSTD_COMPRESSION = 3;
 };
 
 
@@ -93,6 +94,8 @@ struct File_Properties
   virtual uint32 get_block_size() const = 0;
   virtual uint32 get_compression_factor() const = 0;
   virtual uint32 get_compression_method() const = 0;
+  // Applies to data and map files. Zero selects the default level of the compression method.
+  virtual int get_compression_level() const = 0;
   virtual uint32 get_map_block_size() const = 0;
   virtual uint32 get_map_compression_factor() const = 0;
   virtual uint32 get_map_compression_method() const = 0;
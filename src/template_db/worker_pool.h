@@ -0,0 +1,454 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___TEMPLATE_DB__WORKER_POOL_H
+#define DE__OSM3S___TEMPLATE_DB__WORKER_POOL_H
+
+#include "types.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/** Keeps the first error of a job until it is rethrown in the thread that collects the result.
+    File_Error and std::bad_alloc keep their type. Any other exception is rethrown as
+    std::runtime_error with the same message, because its type cannot be preserved. */
+class Job_Error
+{
+public:
+  Job_Error() : file_error(0), out_of_memory(false), message(0) {}
+  ~Job_Error() { clear(); }
+
+  // Must be called from within a catch block. Later errors are ignored.
+  void catch_current();
+  // Takes the error of rhs if this object does not already hold one
+  void take(Job_Error& rhs);
+  // Throws the held error, if any, and clears this object
+  void rethrow();
+
+  bool is_set() const { return file_error || out_of_memory || message; }
+
+private:
+  Job_Error(const Job_Error&);
+  Job_Error& operator=(const Job_Error&);
+
+  File_Error* file_error;
+  bool out_of_memory;
+  std::string* message;
+
+  void clear();
+};
+
+
+inline void Job_Error::catch_current()
+{
+  try
+  {
+    throw;
+  }
+  catch (const File_Error& e)
+  {
+    if (!is_set())
+      file_error = new File_Error(e);
+  }
+  catch (const std::bad_alloc&)
+  {
+    if (!is_set())
+      out_of_memory = true;
+  }
+  catch (const std::exception& e)
+  {
+    if (!is_set())
+      message = new std::string(e.what());
+  }
+  catch (...)
+  {
+    if (!is_set())
+      message = new std::string("Worker_Pool: unknown exception in job");
+  }
+}
+
+
+inline void Job_Error::take(Job_Error& rhs)
+{
+  if (!is_set())
+  {
+    std::swap(file_error, rhs.file_error);
+    std::swap(out_of_memory, rhs.out_of_memory);
+    std::swap(message, rhs.message);
+  }
+}
+
+
+inline void Job_Error::rethrow()
+{
+  if (file_error)
+  {
+    File_Error e = *file_error;
+    clear();
+    throw e;
+  }
+  if (out_of_memory)
+  {
+    clear();
+    throw std::bad_alloc();
+  }
+  if (message)
+  {
+    std::runtime_error e(*message);
+    clear();
+    throw e;
+  }
+}
+
+
+inline void Job_Error::clear()
+{
+  delete file_error;
+  file_error = 0;
+  out_of_memory = false;
+  delete message;
+  message = 0;
+}
+
+
+/** Runs independent jobs on at most max_threads threads. Threads are started on demand when jobs are added,
+    and jobs may run as soon as they are added. wait() returns once all jobs added so far have finished.
+    The first error of a job is rethrown by wait() after all jobs have finished, see Job_Error. The destructor
+    waits only for the jobs already running, hence the pool must be destroyed before the data of its jobs.
+    With zero threads, wait() runs the jobs in the calling thread in the order they have been added. */
+class Worker_Pool
+{
+public:
+  struct Job
+  {
+    virtual ~Job() {}
+    virtual void run() = 0;
+  };
+
+  Worker_Pool(uint max_threads_ = default_num_threads());
+  ~Worker_Pool();
+
+  // Takes ownership of the job
+  void add(Job* job);
+  void wait();
+
+  uint get_max_threads() const { return max_threads; }
+
+  // Zero on a single processor, because then nothing can be gained from threads
+  static uint default_num_threads();
+
+private:
+  Worker_Pool(const Worker_Pool&);
+  Worker_Pool& operator=(const Worker_Pool&);
+
+  uint max_threads;
+  std::deque< Job* > jobs;
+  std::vector< pthread_t > threads;
+  uint idle_threads;
+  uint running_jobs;
+  bool shutting_down;
+  Job_Error error;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t job_added;
+  pthread_cond_t job_done;
+
+  void run_job(Job* job);
+  static void* work(void* pool);
+};
+
+
+inline uint Worker_Pool::default_num_threads()
+{
+  long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  return num_cpus > 1 ? num_cpus : 0;
+}
+
+
+inline Worker_Pool::Worker_Pool(uint max_threads_)
+  : max_threads(max_threads_), idle_threads(0), running_jobs(0), shutting_down(false)
+{
+  pthread_mutex_init(&mutex, 0);
+  pthread_cond_init(&job_added, 0);
+  pthread_cond_init(&job_done, 0);
+}
+
+
+inline Worker_Pool::~Worker_Pool()
+{
+  pthread_mutex_lock(&mutex);
+  shutting_down = true;
+  pthread_cond_broadcast(&job_added);
+  pthread_mutex_unlock(&mutex);
+
+  for (std::vector< pthread_t >::const_iterator it = threads.begin(); it != threads.end(); ++it)
+    pthread_join(*it, 0);
+
+  for (std::deque< Job* >::iterator it = jobs.begin(); it != jobs.end(); ++it)
+    delete *it;
+
+  pthread_cond_destroy(&job_done);
+  pthread_cond_destroy(&job_added);
+  pthread_mutex_destroy(&mutex);
+}
+
+
+inline void Worker_Pool::add(Job* job)
+{
+  pthread_mutex_lock(&mutex);
+  jobs.push_back(job);
+  if (idle_threads == 0 && threads.size() < max_threads)
+  {
+    pthread_t thread;
+    if (pthread_create(&thread, 0, &Worker_Pool::work, this) == 0)
+      threads.push_back(thread);
+  }
+  pthread_cond_signal(&job_added);
+  pthread_mutex_unlock(&mutex);
+}
+
+
+inline void Worker_Pool::wait()
+{
+  pthread_mutex_lock(&mutex);
+  // Without threads, or if no thread could be started, the calling thread does the work
+  while (threads.empty() && !jobs.empty())
+  {
+    Job* job = jobs.front();
+    jobs.pop_front();
+    ++running_jobs;
+    pthread_mutex_unlock(&mutex);
+    run_job(job);
+    pthread_mutex_lock(&mutex);
+  }
+  while (!jobs.empty() || running_jobs > 0)
+    pthread_cond_wait(&job_done, &mutex);
+
+  Job_Error error_;
+  error_.take(error);
+  pthread_mutex_unlock(&mutex);
+
+  error_.rethrow();
+}
+
+
+inline void Worker_Pool::run_job(Job* job)
+{
+  Job_Error error_;
+  try
+  {
+    job->run();
+  }
+  catch (...)
+  {
+    error_.catch_current();
+  }
+  delete job;
+
+  pthread_mutex_lock(&mutex);
+  error.take(error_);
+  --running_jobs;
+  pthread_cond_broadcast(&job_done);
+  pthread_mutex_unlock(&mutex);
+}
+
+
+inline void* Worker_Pool::work(void* pool_)
+{
+  Worker_Pool& pool = *(Worker_Pool*)pool_;
+
+  pthread_mutex_lock(&pool.mutex);
+  while (true)
+  {
+    ++pool.idle_threads;
+    while (pool.jobs.empty() && !pool.shutting_down)
+      pthread_cond_wait(&pool.job_added, &pool.mutex);
+    --pool.idle_threads;
+    // Jobs not yet started are dropped by the destructor
+    if (pool.shutting_down)
+      break;
+
+    Job* job = pool.jobs.front();
+    pool.jobs.pop_front();
+    ++pool.running_jobs;
+    pthread_mutex_unlock(&pool.mutex);
+    pool.run_job(job);
+    pthread_mutex_lock(&pool.mutex);
+  }
+  pthread_mutex_unlock(&pool.mutex);
+
+  return 0;
+}
+
+
+/** Runs jobs on a Worker_Pool and hands them back in the order they have been added.
+    Job_Type must have a method void run(). An exception thrown by run() is rethrown by pop_front()
+    as described for Job_Error.
+    The pool must have at least one thread. */
+template< typename Job_Type >
+class Ordered_Jobs
+{
+public:
+  Ordered_Jobs(Worker_Pool& pool_);
+  ~Ordered_Jobs();
+
+  // Takes ownership of the job
+  void push_back(Job_Type* job);
+  // Waits for the oldest job and returns it. The caller takes ownership.
+  Job_Type* pop_front();
+  // Waits for the oldest job and deletes it without reporting errors
+  void drop_front();
+  // Waits for all jobs and deletes them without reporting errors
+  void clear();
+
+  bool empty() const { return slots.empty(); }
+  uint size() const { return slots.size(); }
+  // Does not wait. Only members set before push_back() may be accessed.
+  const Job_Type& front() const { return *slots.front()->job; }
+
+private:
+  Ordered_Jobs(const Ordered_Jobs&);
+  Ordered_Jobs& operator=(const Ordered_Jobs&);
+
+  struct Slot
+  {
+    Slot(Job_Type* job_) : job(job_), done(false) {}
+
+    Job_Type* job;
+    bool done;
+    Job_Error error;
+  };
+
+  struct Run_Slot : Worker_Pool::Job
+  {
+    Run_Slot(Ordered_Jobs& owner_, Slot& slot_) : owner(owner_), slot(slot_) {}
+    void run();
+
+    Ordered_Jobs& owner;
+    Slot& slot;
+  };
+
+  Worker_Pool& pool;
+  std::deque< Slot* > slots;
+  pthread_mutex_t mutex;
+  pthread_cond_t slot_done;
+
+  Slot* wait_front();
+};
+
+
+template< typename Job_Type >
+Ordered_Jobs< Job_Type >::Ordered_Jobs(Worker_Pool& pool_) : pool(pool_)
+{
+  pthread_mutex_init(&mutex, 0);
+  pthread_cond_init(&slot_done, 0);
+}
+
+
+template< typename Job_Type >
+Ordered_Jobs< Job_Type >::~Ordered_Jobs()
+{
+  clear();
+  pthread_cond_destroy(&slot_done);
+  pthread_mutex_destroy(&mutex);
+}
+
+
+template< typename Job_Type >
+void Ordered_Jobs< Job_Type >::push_back(Job_Type* job)
+{
+  Slot* slot = new Slot(job);
+  slots.push_back(slot);
+  pool.add(new Run_Slot(*this, *slot));
+}
+
+
+template< typename Job_Type >
+typename Ordered_Jobs< Job_Type >::Slot* Ordered_Jobs< Job_Type >::wait_front()
+{
+  Slot* slot = slots.front();
+  slots.pop_front();
+  pthread_mutex_lock(&mutex);
+  while (!slot->done)
+    pthread_cond_wait(&slot_done, &mutex);
+  pthread_mutex_unlock(&mutex);
+  return slot;
+}
+
+
+template< typename Job_Type >
+Job_Type* Ordered_Jobs< Job_Type >::pop_front()
+{
+  Slot* slot = wait_front();
+  Job_Type* job = slot->job;
+  Job_Error error;
+  error.take(slot->error);
+  delete slot;
+
+  if (error.is_set())
+    delete job;
+  error.rethrow();
+  return job;
+}
+
+
+template< typename Job_Type >
+void Ordered_Jobs< Job_Type >::drop_front()
+{
+  Slot* slot = wait_front();
+  delete slot->job;
+  delete slot;
+}
+
+
+template< typename Job_Type >
+void Ordered_Jobs< Job_Type >::clear()
+{
+  while (!slots.empty())
+    drop_front();
+}
+
+
+template< typename Job_Type >
+void Ordered_Jobs< Job_Type >::Run_Slot::run()
+{
+  try
+  {
+    slot.job->run();
+  }
+  catch (...)
+  {
+    slot.error.catch_current();
+  }
+
+  pthread_mutex_lock(&owner.mutex);
+  slot.done = true;
+  pthread_cond_broadcast(&owner.slot_done);
+  pthread_mutex_unlock(&owner.mutex);
+}
+
+
+#endif
@@ -62,4 +62,11 @@ private:
 };
 
 
+// Level zero selects the fast level that database files have always been written with
+inline int zlib_level(int level)
+{
+  return level == 0 ? 1 : level;
+}
+
+
 #endif
@@ -0,0 +1,192 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "zstd_wrapper.h"
+
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef HAVE_ZSTD
+#include <zdict.h>
+#endif
+
+
+namespace
+{
+  template < typename T >
+  std::string to_string(T t)
+  {
+    std::ostringstream out;
+    out<<std::setprecision(14)<<t;
+    return out.str();
+  }
+}
+
+
+Zstd_Dictionary::Zstd_Dictionary(const std::string& content_, int level) : content(content_)
+{
+#ifdef HAVE_ZSTD
+
+  cdict_ = ZSTD_createCDict(content.data(), content.size(), level == 0 ? ZSTD_CLEVEL_DEFAULT : level);
+  ddict_ = ZSTD_createDDict(content.data(), content.size());
+  if (!cdict_ || !ddict_)
+  {
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+    throw std::runtime_error("Zstd_Dictionary: invalid dictionary");
+  }
+
+#else
+
+  throw std::runtime_error("Overpass API was compiled without zstd compression library support");
+
+#endif
+}
+
+
+Zstd_Dictionary::~Zstd_Dictionary()
+{
+#ifdef HAVE_ZSTD
+  ZSTD_freeCDict(cdict_);
+  ZSTD_freeDDict(ddict_);
+#endif
+}
+
+
+std::string Zstd_Dictionary::train(const std::vector< std::string >& samples, unsigned int capacity)
+{
+#ifdef HAVE_ZSTD
+
+  std::string concatenated;
+  std::vector< size_t > sizes;
+  for (std::vector< std::string >::const_iterator it = samples.begin(); it != samples.end(); ++it)
+  {
+    concatenated += *it;
+    sizes.push_back(it->size());
+  }
+  if (sizes.empty())
+    return "";
+
+  std::vector< char > result(capacity);
+  size_t ret = ZDICT_trainFromBuffer(&result[0], capacity, concatenated.data(), &sizes[0], sizes.size());
+  if (ZDICT_isError(ret))
+    return "";
+  return std::string(&result[0], ret);
+
+#else
+
+  throw std::runtime_error("Overpass API was compiled without zstd compression library support");
+
+#endif
+}
+
+
+Zstd_Deflate::Error::Error(int error_code_)
+    : std::runtime_error("Zstd_Deflate: " + to_string(error_code_)), error_code(error_code_)
+{}
+
+
+Zstd_Deflate::Zstd_Deflate(int level_, const Zstd_Dictionary* dictionary_)
+    : level(level_), dictionary(dictionary_)
+{
+#ifdef HAVE_ZSTD
+  cctx = ZSTD_createCCtx();
+  if (!cctx)
+    throw std::bad_alloc();
+#endif
+}
+
+
+Zstd_Deflate::~Zstd_Deflate()
+{
+#ifdef HAVE_ZSTD
+  ZSTD_freeCCtx(cctx);
+#endif
+}
+
+
+int Zstd_Deflate::compress(const void* in, int in_size, void* out, int out_buffer_size)
+{
+#ifdef HAVE_ZSTD
+
+  size_t ret = dictionary
+      ? ZSTD_compress_usingCDict(cctx, out, out_buffer_size, in, in_size, dictionary->cdict())
+      : ZSTD_compressCCtx(cctx, out, out_buffer_size, in, in_size, level == 0 ? ZSTD_CLEVEL_DEFAULT : level);
+  if (ZSTD_isError(ret))
+  {
+    if (ZSTD_getErrorCode(ret) == ZSTD_error_dstSize_tooSmall)
+      throw std::runtime_error("Zstd: output buffer too small during compression");
+    throw Error(ZSTD_getErrorCode(ret));
+  }
+  return ret;
+
+#else
+
+  throw std::runtime_error("Overpass API was compiled without zstd compression library support");
+
+#endif
+}
+
+
+Zstd_Inflate::Error::Error(int error_code_)
+    : std::runtime_error("Zstd_Inflate: " + to_string(error_code_)), error_code(error_code_)
+{}
+
+
+Zstd_Inflate::Zstd_Inflate(const Zstd_Dictionary* dictionary_) : dictionary(dictionary_)
+{
+#ifdef HAVE_ZSTD
+  dctx = ZSTD_createDCtx();
+  if (!dctx)
+    throw std::bad_alloc();
+#endif
+}
+
+
+Zstd_Inflate::~Zstd_Inflate()
+{
+#ifdef HAVE_ZSTD
+  ZSTD_freeDCtx(dctx);
+#endif
+}
+
+
+int Zstd_Inflate::decompress(const void* in, int in_size, void* out, int out_buffer_size)
+{
+#ifdef HAVE_ZSTD
+
+  // Blocks are padded with zeros up to the block size, but zstd needs the exact size of the frame
+  size_t frame_size = ZSTD_findFrameCompressedSize(in, in_size);
+  if (ZSTD_isError(frame_size))
+    throw Error(ZSTD_getErrorCode(frame_size));
+
+  size_t ret = dictionary
+      ? ZSTD_decompress_usingDDict(dctx, out, out_buffer_size, in, frame_size, dictionary->ddict())
+      : ZSTD_decompressDCtx(dctx, out, out_buffer_size, in, frame_size);
+  if (ZSTD_isError(ret))
+    throw Error(ZSTD_getErrorCode(ret));
+  return ret;
+
+#else
+
+  throw std::runtime_error("Overpass API was compiled without zstd compression library support");
+
+#endif
+}
@@ -0,0 +1,120 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DE__OSM3S___TEMPLATE_DB__ZSTD_WRAPPER_H
+#define DE__OSM3S___TEMPLATE_DB__ZSTD_WRAPPER_H
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#undef VERSION
+#endif
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+/** A dictionary for the blocks of one file. It must be the same for compression and decompression.
+    Once constructed, it can be shared between threads. */
+class Zstd_Dictionary
+{
+public:
+  Zstd_Dictionary(const std::string& content, int level);
+  ~Zstd_Dictionary();
+
+  const std::string& get_content() const { return content; }
+
+  // Returns an empty string if the samples are not suitable for a dictionary
+  static std::string train(const std::vector< std::string >& samples, unsigned int capacity);
+
+#ifdef HAVE_ZSTD
+  const ZSTD_CDict* cdict() const { return cdict_; }
+  const ZSTD_DDict* ddict() const { return ddict_; }
+#endif
+
+private:
+  Zstd_Dictionary(const Zstd_Dictionary&);
+  Zstd_Dictionary& operator=(const Zstd_Dictionary&);
+
+  std::string content;
+#ifdef HAVE_ZSTD
+  ZSTD_CDict* cdict_;
+  ZSTD_DDict* ddict_;
+#endif
+};
+
+
+class Zstd_Deflate
+{
+public:
+  struct Error : public std::runtime_error
+  {
+    Error(int error_code_);
+    int error_code;
+  };
+
+  // Level zero selects the default level of the library. The level is ignored if a dictionary is given.
+  explicit Zstd_Deflate(int level, const Zstd_Dictionary* dictionary = 0);
+  ~Zstd_Deflate();
+
+  int compress(const void* in, int in_size, void* out, int out_buffer_size);
+
+private:
+  Zstd_Deflate(const Zstd_Deflate&);
+  Zstd_Deflate& operator=(const Zstd_Deflate&);
+
+  int level;
+  const Zstd_Dictionary* dictionary;
+#ifdef HAVE_ZSTD
+  ZSTD_CCtx* cctx;
+#endif
+};
+
+
+class Zstd_Inflate
+{
+public:
+  struct Error : public std::runtime_error
+  {
+    Error(int error_code_);
+    int error_code;
+  };
+
+  explicit Zstd_Inflate(const Zstd_Dictionary* dictionary = 0);
+  ~Zstd_Inflate();
+
+  // The input may be followed by padding
+  int decompress(const void* in, int in_size, void* out, int out_buffer_size);
+
+private:
+  Zstd_Inflate(const Zstd_Inflate&);
+  Zstd_Inflate& operator=(const Zstd_Inflate&);
+
+  const Zstd_Dictionary* dictionary;
+#ifdef HAVE_ZSTD
+  ZSTD_DCtx* dctx;
+#endif
+};
+
+
+#endif
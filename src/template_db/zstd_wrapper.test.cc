@@ -0,0 +1,208 @@
+/** Copyright 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 Roland Olbricht et al.
+ *
+ * This file is part of Overpass_API.
+ *
+ * Overpass_API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Overpass_API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Overpass_API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "file_blocks_index.h"
+#include "zstd_wrapper.h"
+
+
+/**
+ * Tests the zstd wrapper with and without a dictionary
+ */
+
+//-----------------------------------------------------------------------------
+
+const uint32 BLOCK_SIZE = 4096;
+
+
+// Something that resembles a block of a bin file: similar records with varying numbers
+std::string sample_block(uint32 seed, uint32 size)
+{
+  std::ostringstream out;
+  uint32 value = seed;
+  while (out.str().size() < size)
+  {
+    value = value * 1103515245 + 12345;
+    out<<"<node id=\""<<(value>>8)%100000<<"\" lat=\"51."<<(value>>4)%10000
+        <<"\"><tag k=\"highway\" v=\""<<((value>>16)%2 ? "residential" : "bus_stop")<<"\"/></node>";
+  }
+  return out.str().substr(0, size);
+}
+
+
+// Compresses the block, pads the result with zeros to full blocks like File_Blocks does,
+// and decompresses it again
+bool round_trip(const std::string& block, const Zstd_Dictionary* dictionary)
+{
+  std::vector< char > compressed(2 * block.size() + BLOCK_SIZE);
+  int compressed_size = Zstd_Deflate(0, dictionary).compress(
+      block.data(), block.size(), &compressed[0], compressed.size());
+  uint32 padded_size = (compressed_size / BLOCK_SIZE + 1) * BLOCK_SIZE;
+  memset(&compressed[compressed_size], 0, padded_size - compressed_size);
+
+  std::vector< char > decompressed(block.size() + 1);
+  int decompressed_size = Zstd_Inflate(dictionary).decompress(
+      &compressed[0], padded_size, &decompressed[0], decompressed.size());
+  return (uint32)compressed_size < block.size() && (uint32)decompressed_size == block.size()
+      && std::string(&decompressed[0], decompressed_size) == block;
+}
+
+
+void print_round_trips(const Zstd_Dictionary* dictionary)
+{
+  uint32 sizes[] = { 300, 1000, 32*1024 };
+  for (uint32 i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i)
+    std::cout<<"Block of "<<sizes[i]<<" bytes: "
+        <<(round_trip(sample_block(1000 + i, sizes[i]), dictionary) ? "round trip ok" : "round trip FAILED")<<'\n';
+}
+
+
+int main(int argc, char* args[])
+{
+  std::string test_to_execute;
+  if (argc > 1)
+    test_to_execute = args[1];
+
+  if (test_to_execute == "info")
+  {
+#ifdef HAVE_ZSTD
+    std::cout<<"Compiled with zstd support.\n";
+#else
+    std::cout<<"Compiled without zstd support.\n";
+#endif
+    return 0;
+  }
+
+  if ((test_to_execute == "") || (test_to_execute == "1"))
+  {
+    std::cout<<"** Compress and decompress without a dictionary\n";
+    try
+    {
+      print_round_trips(0);
+    }
+    catch (const std::exception& e)
+    {
+      std::cout<<"Exception: "<<e.what()<<'\n';
+    }
+  }
+
+  if ((test_to_execute == "") || (test_to_execute == "2"))
+  {
+    std::cout<<"** Compress and decompress with a dictionary stored next to the data file\n";
+    std::string dict_file_name = dictionary_file_name("./zstd_test.bin");
+    try
+    {
+      Zstd_Dictionary* dictionary = load_dictionary(dict_file_name, 0);
+      std::cout<<"Dictionary before saving: "<<(dictionary ? "found" : "none")<<'\n';
+      delete dictionary;
+
+      std::vector< std::string > samples;
+      for (uint32 i = 0; i < 200; ++i)
+        samples.push_back(sample_block(i, 2048));
+      std::string content = Zstd_Dictionary::train(samples, 16*1024);
+      std::cout<<"Dictionary trained: "<<(content.empty() ? "no" : "yes")<<'\n';
+      save_dictionary(dict_file_name, content);
+
+      dictionary = load_dictionary(dict_file_name, 0);
+      std::cout<<"Dictionary after saving: "<<(dictionary ? "found" : "none")<<'\n';
+      if (dictionary)
+      {
+        std::cout<<"Content unchanged: "<<(dictionary->get_content() == content ? "yes" : "no")<<'\n';
+        print_round_trips(dictionary);
+
+        // Blocks compressed with a dictionary cannot be read without it
+        std::string block = sample_block(7, 2048);
+        std::vector< char > compressed(2 * block.size());
+        int compressed_size = Zstd_Deflate(0, dictionary).compress(
+            block.data(), block.size(), &compressed[0], compressed.size());
+        std::vector< char > decompressed(block.size());
+        try
+        {
+          Zstd_Inflate().decompress(&compressed[0], compressed_size, &decompressed[0], decompressed.size());
+          std::cout<<"Decompression without the dictionary succeeded unexpectedly.\n";
+        }
+        catch (const Zstd_Inflate::Error& e)
+        {
+          std::cout<<"Decompression without the dictionary fails.\n";
+        }
+      }
+      delete dictionary;
+    }
+    catch (const File_Error& e)
+    {
+      std::cout<<"File error catched: "
+          <<e.error_number<<' '<<e.filename<<' '<<e.origin<<'\n';
+    }
+    catch (const std::exception& e)
+    {
+      std::cout<<"Exception: "<<e.what()<<'\n';
+    }
+    remove(dict_file_name.c_str());
+  }
+
+  if ((test_to_execute == "") || (test_to_execute == "3"))
+  {
+    std::cout<<"** Every operation reports the missing library if compiled without zstd\n";
+    std::string block = sample_block(1, 1000);
+    std::vector< char > buffer(2 * block.size());
+    try
+    {
+      Zstd_Deflate(0).compress(block.data(), block.size(), &buffer[0], buffer.size());
+      std::cout<<"Compression succeeded.\n";
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cout<<"Compression: "<<e.what()<<'\n';
+    }
+    try
+    {
+      Zstd_Inflate().decompress(block.data(), block.size(), &buffer[0], buffer.size());
+      std::cout<<"Decompression succeeded.\n";
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cout<<"Decompression: "<<e.what()<<'\n';
+    }
+    try
+    {
+      Zstd_Dictionary dictionary(block, 0);
+      std::cout<<"Dictionary created.\n";
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cout<<"Dictionary: "<<e.what()<<'\n';
+    }
+    try
+    {
+      Zstd_Dictionary::train(std::vector< std::string >(1, block), 16*1024);
+      std::cout<<"Dictionary trained.\n";
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cout<<"Training: "<<e.what()<<'\n';
+    }
+  }
+
+  return 0;
+}
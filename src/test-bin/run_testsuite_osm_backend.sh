@@ -113,3 +113,137 @@ date +%T
 perform_serial_test run_and_compare.sh 3
 
 rm -R input/run_and_compare.sh_3
+
+# Test reading OSM PBF files
+I=1
+while [[ $I -le 4 ]]; do
+{
+  date +%T
+  perform_serial_test pbf_reader $I
+  I=$(($I + 1))
+}; done
+
+# Test that a PBF file gives the same database as the equivalent OSM XML file
+date +%T
+mkdir -p run/pbf_update_1/pbf_db run/pbf_update_1/osm_db
+rm -fR run/pbf_update_1/pbf_db/* run/pbf_update_1/osm_db/*
+$BASEDIR/test-bin/pbf_reader fixture run/pbf_update_1/fixture.osm.pbf
+$BASEDIR/bin/update_database --db-dir=run/pbf_update_1/pbf_db/ --meta <run/pbf_update_1/fixture.osm.pbf
+$BASEDIR/bin/update_database --db-dir=run/pbf_update_1/osm_db/ --meta <input/pbf_update_1/fixture.osm
+$BASEDIR/bin/osm3s_query --db-dir=run/pbf_update_1/pbf_db/ <input/pbf_update_1/query.xml >run/pbf_update_1/pbf.log 2>&1
+$BASEDIR/bin/osm3s_query --db-dir=run/pbf_update_1/osm_db/ <input/pbf_update_1/query.xml >run/pbf_update_1/osm.log 2>&1
+RES=`diff -q run/pbf_update_1/osm.log run/pbf_update_1/pbf.log`
+if [[ -n $RES || -z `grep '<way id="5"' run/pbf_update_1/osm.log` ]]; then
+{
+  echo `date +%T` "Test pbf_update 1 FAILED."
+}; else
+{
+  echo `date +%T` "Test pbf_update 1 succeeded."
+  rm -R run/pbf_update_1
+}; fi
+
+# Test that backward recursion gives the same results with and without reverse references,
+# and that reverse references cannot be started on a populated database
+date +%T
+mkdir -p run/reverse_refs_1/plain_db run/reverse_refs_1/refs_db
+rm -fR run/reverse_refs_1/plain_db/* run/reverse_refs_1/refs_db/*
+$BASEDIR/test-bin/generate_test_file $DATA_SIZE >run/reverse_refs_1/stdin.log
+$BASEDIR/bin/update_database --db-dir=run/reverse_refs_1/plain_db/ <run/reverse_refs_1/stdin.log
+$BASEDIR/bin/update_database --db-dir=run/reverse_refs_1/refs_db/ --reverse-refs <run/reverse_refs_1/stdin.log
+$BASEDIR/bin/update_database --db-dir=run/reverse_refs_1/plain_db/ --reverse-refs \
+    <run/reverse_refs_1/stdin.log >run/reverse_refs_1/refused.log 2>&1
+REFUSED=$?
+$BASEDIR/bin/osm3s_query --db-dir=run/reverse_refs_1/plain_db/ <input/reverse_refs_1/query.xml \
+    >run/reverse_refs_1/plain.log 2>&1
+$BASEDIR/bin/osm3s_query --db-dir=run/reverse_refs_1/refs_db/ <input/reverse_refs_1/query.xml \
+    >run/reverse_refs_1/refs.log 2>&1
+RES=`diff -q run/reverse_refs_1/plain.log run/reverse_refs_1/refs.log`
+if [[ -n $RES || -z `grep '<relation id=' run/reverse_refs_1/plain.log` \
+    || ! -f run/reverse_refs_1/refs_db/reverse_refs_complete || -f run/reverse_refs_1/plain_db/reverse_refs_complete \
+    || $REFUSED -ne 3 ]]; then
+{
+  echo `date +%T` "Test reverse_refs 1 FAILED."
+}; else
+{
+  echo `date +%T` "Test reverse_refs 1 succeeded."
+  rm -R run/reverse_refs_1
+}; fi
+
+# Test that attic queries give the same results with keyframes, without keyframes,
+# and after keyframes have been added afterwards, and that the backfill refuses a served database
+attic_keyframes_queries()
+{
+  DB="$1"
+  for DATE in "" 09:01 09:02 09:03 09:04 09:05; do
+  {
+    { if [[ -n $DATE ]]; then echo "[date:\"2013-07-01T${DATE}:00Z\"];"; fi; cat input/attic_updater/query.ql; } \
+        | $BASEDIR/bin/osm3s_query --concise --db-dir=run/attic_keyframes_1/$DB/ 2>&1
+  }; done
+  $BASEDIR/bin/osm3s_query --concise --db-dir=run/attic_keyframes_1/$DB/ <input/attic_updater/timeline.ql 2>&1
+};
+
+date +%T
+mkdir -p run/attic_keyframes_1/keyframes_db run/attic_keyframes_1/plain_db
+rm -fR run/attic_keyframes_1/keyframes_db/* run/attic_keyframes_1/plain_db/*
+for DB in keyframes_db plain_db; do
+{
+  if [[ $DB == "keyframes_db" ]]; then INTERVAL=2; else INTERVAL=0; fi
+  $BASEDIR/bin/update_database --db-dir=run/attic_keyframes_1/$DB/ --keep-attic --keyframe-interval=$INTERVAL \
+      <input/attic_updater/init.osm
+  for DIFF in diff_1 diff_2 diff_3; do
+  {
+    $BASEDIR/bin/update_database --db-dir=run/attic_keyframes_1/$DB/ --keep-attic --keyframe-interval=$INTERVAL \
+        <input/attic_updater/$DIFF.osc
+  }; done
+}; done
+attic_keyframes_queries keyframes_db >run/attic_keyframes_1/keyframes.log
+attic_keyframes_queries plain_db >run/attic_keyframes_1/plain.log
+VERSION=`$BASEDIR/bin/osm3s_query --version 2>&1 | sed 's/^Overpass API version \([^ ]*\).*$/\1/'`
+touch "run/attic_keyframes_1/plain_db/osm3s_v${VERSION}_osm_base"
+$BASEDIR/bin/backfill_keyframes --db-dir=run/attic_keyframes_1/plain_db/ --keyframe-interval=2 \
+    >run/attic_keyframes_1/refused.log 2>&1
+REFUSED=$?
+rm "run/attic_keyframes_1/plain_db/osm3s_v${VERSION}_osm_base"
+$BASEDIR/bin/backfill_keyframes --db-dir=run/attic_keyframes_1/plain_db/ --keyframe-interval=2 \
+    >run/attic_keyframes_1/backfill.log 2>&1
+BACKFILLED=$?
+attic_keyframes_queries plain_db >run/attic_keyframes_1/backfilled.log
+RES=`diff -q run/attic_keyframes_1/plain.log run/attic_keyframes_1/keyframes.log; \
+    diff -q run/attic_keyframes_1/plain.log run/attic_keyframes_1/backfilled.log`
+if [[ -n $RES || -z `grep '<way id=' run/attic_keyframes_1/plain.log` || -z `grep '<relation id=' run/attic_keyframes_1/plain.log` \
+    || $REFUSED -ne 3 || $BACKFILLED -ne 0 ]]; then
+{
+  echo `date +%T` "Test attic_keyframes 1 FAILED."
+}; else
+{
+  echo `date +%T` "Test attic_keyframes 1 succeeded."
+  rm -R run/attic_keyframes_1
+}; fi
+
+# Test that a clone compressed with zstd dictionaries contains the same data as its source
+if [[ `$BASEDIR/test-bin/zstd_wrapper info` == "Compiled with zstd support." ]]; then
+{
+  date +%T
+  mkdir -p run/zstd_clone_1/db run/zstd_clone_1/clone
+  rm -fR run/zstd_clone_1/db/* run/zstd_clone_1/clone/*
+  $BASEDIR/test-bin/generate_test_file $DATA_SIZE >run/zstd_clone_1/stdin.log
+  $BASEDIR/bin/update_database --db-dir=run/zstd_clone_1/db/ <run/zstd_clone_1/stdin.log
+  $BASEDIR/bin/osm3s_query --db-dir=run/zstd_clone_1/db/ --clone=run/zstd_clone_1/clone/ \
+      --clone-compression=zstd --clone-dictionary >run/zstd_clone_1/clone.out 2>run/zstd_clone_1/clone.err
+  $BASEDIR/test-bin/dump_database --db-dir=run/zstd_clone_1/db/
+  $BASEDIR/test-bin/dump_database --db-dir=run/zstd_clone_1/clone/
+  DUMPS=`ls run/zstd_clone_1/db/ | grep '\.csv$'`
+  RES=
+  for FILE in $DUMPS; do
+  {
+    RES="$RES`diff -q run/zstd_clone_1/db/$FILE run/zstd_clone_1/clone/$FILE`"
+  }; done
+  if [[ -n $RES || -z $DUMPS || -z `ls run/zstd_clone_1/clone/ | grep '\.bin\.dict$'` ]]; then
+  {
+    echo `date +%T` "Test zstd_clone 1 FAILED."
+  }; else
+  {
+    echo `date +%T` "Test zstd_clone 1 succeeded."
+    rm -R run/zstd_clone_1
+  }; fi
+}; fi
@@ -171,12 +171,20 @@ dispatcher_two_clients()
 date +%T
 $BASEDIR/test-bin/file_blocks info
 date +%T
-perform_test_loop file_blocks 30
+perform_test_loop file_blocks 31
 date +%T
 perform_test_loop block_backend 20
 date +%T
 perform_test_loop random_file 8
 date +%T
+if [[ `$BASEDIR/test-bin/zstd_wrapper info` == "Compiled with zstd support." ]]; then
+{
+  perform_test_loop zstd_wrapper 2
+}; else
+{
+  perform_serial_test zstd_wrapper 3
+}; fi
+date +%T
 perform_test_loop test_dispatcher 20
 
 dispatcher_client_server 21
@@ -188,3 +196,6 @@ dispatcher_two_clients 26
 
 # don't use that test because we cannot control the assigned pids
 #dispatcher_two_clients 27
+
+# Admission scheduling of the resource planner, no server needed
+perform_serial_test test_dispatcher 28
@@ -148,6 +148,14 @@ prepare_test_loop()
   }; done
 };
 
+# Test the regular expression engines against the C library
+date +%T
+perform_test_loop regular_expression 4
+
+# Test the custom output templates
+date +%T
+perform_test_loop output_custom 6 "../../input/output_custom/"
+
 # Prepare testing the statements
 mkdir -p input/update_database/
 rm -f input/update_database/*
@@ -159,10 +167,14 @@ prepare_test_loop print 4 $DATA_SIZE
 mkdir -p expected/print_5/
 $BASEDIR/test-bin/generate_test_file $DATA_SIZE print_4 $NODE_OFFSET | grep "^  <" | sort >expected/print_5/stdout.log
 touch expected/print_5/stderr.log
+mkdir -p expected/print_6/
+$BASEDIR/test-bin/generate_test_file $DATA_SIZE print_6 $NODE_OFFSET >expected/print_6/stdout.log
+touch expected/print_6/stderr.log
 
 date +%T
 perform_test_loop print 4 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
 print_test_5 print 5 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
+perform_serial_test print 6 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
 
 # Test the recurse statement
 prepare_test_loop recurse 28 $DATA_SIZE
@@ -170,9 +182,9 @@ date +%T
 perform_test_loop recurse 28 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
 
 # Test the bbox_query statement
-prepare_test_loop bbox_query 8 $DATA_SIZE
+prepare_test_loop bbox_query 11 $DATA_SIZE
 date +%T
-perform_test_loop bbox_query 8 "$DATA_SIZE ../../input/update_database/"
+perform_test_loop bbox_query 11 "$DATA_SIZE ../../input/update_database/"
 
 # Test the bbox_query statement
 prepare_test_loop around 19 $DATA_SIZE
@@ -215,9 +227,9 @@ date +%T
 perform_test_loop make 132 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
 
 # Test the make statement
-prepare_test_loop convert 15 $DATA_SIZE
+prepare_test_loop convert 16 $DATA_SIZE
 date +%T
-perform_test_loop convert 15 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
+perform_test_loop convert 16 "$DATA_SIZE ../../input/update_database/ $NODE_OFFSET"
 
 # Test the make statement
 prepare_test_loop if 6 $DATA_SIZE